@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+namespace bmpf {
+
+    /**
+     * @brief Матрица разрешённых столкновений
+     *
+     * Симметричная матрица размера linkCnt x linkCnt над звеньями сцены
+     * коллайдера (в порядке `Scene::getGroupedModelPaths()`). Если пара
+     * звеньев разрешена, коллайдер не проверяет её на столкновение.
+     * Пустая матрица (linkCnt = 0) не разрешает ни одной пары
+     */
+    class AllowedCollisionMatrix {
+    public:
+        /**
+         * конструктор пустой матрицы
+         */
+        AllowedCollisionMatrix() = default;
+
+        /**
+         * конструктор
+         * @param linkCnt количество звеньев
+         */
+        explicit AllowedCollisionMatrix(unsigned long linkCnt);
+
+        /**
+         * разрешить столкновение пары звеньев
+         * @param i индекс первого звена
+         * @param j индекс второго звена
+         */
+        void allow(unsigned long i, unsigned long j);
+
+        /**
+         * проверить, разрешено ли столкновение пары звеньев
+         * @param i индекс первого звена
+         * @param j индекс второго звена
+         * @return флаг, разрешено ли столкновение пары звеньев
+         */
+        bool isAllowed(unsigned long i, unsigned long j) const;
+
+        /**
+         * получить список разрешённых пар (i < j)
+         * @return список разрешённых пар
+         */
+        std::vector<std::pair<unsigned long, unsigned long>> getAllowedPairs() const;
+
+    private:
+        /**
+         * количество звеньев
+         */
+        unsigned long _linkCnt = 0;
+        /**
+         * флаги разрешённых пар, хранятся по строкам
+         */
+        std::vector<char> _allowed;
+
+    public:
+        /**
+         * получить количество звеньев
+         * @return количество звеньев
+         */
+        unsigned long getLinkCnt() const { return _linkCnt; }
+    };
+}
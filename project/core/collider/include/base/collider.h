@@ -3,6 +3,7 @@
 #include <Eigen/Dense>
 
 #include "solid_3d_object.h"
+#include "allowed_collision_matrix.h"
 #include "MT_Quaternion.h"
 
 namespace bmpf {
@@ -40,14 +41,14 @@ namespace bmpf {
          * @param onlyRobot флаг, нужно ли рисовать только роботов
          * или ещё и статические объекты сцены
          */
-        virtual void paint(std::vector<Eigen::Matrix4d> matrices, bool onlyRobot) = 0;
+        virtual void paint(const std::vector<Eigen::Matrix4d> &matrices, bool onlyRobot) = 0;
 
         /**
          * проверка соответствует ли состояние сцены столкновению
          * @param matrices список матриц преобразований звеньев
          * @return флаг, соответствует ли состояние сцены столкновению
          */
-        virtual bool isCollided(std::vector<Eigen::Matrix4d> matrices) = 0;
+        virtual bool isCollided(const std::vector<Eigen::Matrix4d> &matrices) = 0;
 
         /**
          * @brief проверка соответствует ли состояние сцены столкновению
@@ -58,7 +59,39 @@ namespace bmpf {
          * @param robotIndexes индексы роботов
          * @return флаг, соответствует ли состояние сцены столкновению
          */
-        virtual bool isCollided(std::vector<Eigen::Matrix4d> matrices, std::vector<int> robotIndexes) = 0;
+        virtual bool isCollided(const std::vector<Eigen::Matrix4d> &matrices, const std::vector<int> &robotIndexes) = 0;
+
+        /**
+         * @brief пакетная проверка состояний сцены на столкновения
+         * пакетная проверка состояний сцены на столкновения: матрицы всех
+         * состояний записаны подряд в один буфер, на каждое состояние
+         * приходится одинаковое число матриц (по одной на звено сцены)
+         * @param matrices матрицы преобразований звеньев всех состояний
+         * @param stateCnt количество состояний
+         * @return битовая маска: i-й элемент равен true, если
+         * i-е состояние соответствует столкновению
+         */
+        virtual std::vector<bool> areCollided(const std::vector<Eigen::Matrix4d> &matrices, unsigned long stateCnt) = 0;
+
+        /**
+         * @brief получить все пересекающиеся пары звеньев
+         * получить все пересекающиеся пары звеньев (i < j) без учёта
+         * матрицы разрешённых столкновений, соседние звенья одного
+         * робота не проверяются
+         * @param matrices список матриц преобразований звеньев
+         * @return список пересекающихся пар звеньев
+         */
+        virtual std::vector<std::pair<unsigned long, unsigned long>>
+        getCollidedPairs(const std::vector<Eigen::Matrix4d> &matrices) = 0;
+
+        /**
+         * задать матрицу разрешённых столкновений, разрешённые пары
+         * звеньев не проверяются на коллизии. Матрица сбрасывается
+         * при повторной инициализации коллайдера, пустая матрица
+         * сбрасывает все разрешённые пары
+         * @param allowedCollisions матрица разрешённых столкновений
+         */
+        virtual void setAllowedCollisionMatrix(const AllowedCollisionMatrix &allowedCollisions) = 0;
 
         /**
          * возвращает список всех координат полигона (вектор нормали и координаты вершины):
@@ -66,7 +99,7 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return возвращает список всех координат полигона
          */
-        virtual std::vector<float> getPoints(std::vector<Eigen::Matrix4d> matrices) = 0;
+        virtual std::vector<float> getPoints(const std::vector<Eigen::Matrix4d> &matrices) = 0;
 
         /**
          * @brief  получить координаты куба, ограничивающего объём робота
@@ -79,7 +112,8 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return получить координаты куба, ограничивающего объём робота
          */
-        virtual std::vector<double> getBoxCoords(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) = 0;
+        virtual std::vector<double>
+        getBoxCoords(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) = 0;
 
         /**
          * @brief получить точки куба, ограничивающего объём робота
@@ -93,7 +127,8 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return получить точки куба, ограничивающего объём робота
          */
-        virtual std::vector<double> getBoxPoints(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) = 0;
+        virtual std::vector<double>
+        getBoxPoints(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) = 0;
 
 
     };
@@ -44,7 +44,7 @@ namespace bmpf {
          */
         Solid3Object(const std::shared_ptr<bmpf::StlShape> &shape, bool isRobot, MT_Scalar margin = 0.0f)
                 : _stl_shape(shape),
-                  _object(DT_CreateObject(this, shape->getDTShape())),
+                  _object(shape->createObject(this)),
                   _isRobot(isRobot) {
             DT_SetMargin(_object, margin);
         }
@@ -52,7 +52,7 @@ namespace bmpf {
         /**
          *  деструктор
          */
-        virtual ~Solid3Object() { DT_DestroyObject(_object); }
+        virtual ~Solid3Object() { _stl_shape->destroyObject(_object); }
 
         /**
          * загрузить объект из stl файла
@@ -4,6 +4,7 @@
 #include <GL/glut.h>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <fstream>
 #include "MT_Point3.h"
 #include "SOLID.h"
@@ -11,16 +12,32 @@
 namespace bmpf {
 
     /**
-     * Класс STL модели
+     * @brief Класс STL модели
+     * Класс STL модели. Модели, загруженные из файлов, хранятся в общем
+     * для всего процесса кеше и не меняются после создания, поэтому одна
+     * модель используется всеми коллайдерами, в которых есть соответствующее
+     * звено. Solid3 ведёт у модели список созданных по ней объектов, поэтому
+     * объекты нужно создавать и удалять только через `createObject` и
+     * `destroyObject`
      */
     class StlShape {
     public:
         /**
-         * Получить STL-модель из файла
+         * @brief Получить STL-модель из файла
+         * Получить STL-модель из файла. Модель берётся из кеша, если она
+         * уже была загружена и файл с тех пор не менялся (сравниваются время
+         * изменения и размер файла), иначе модель читается с диска
+         * и сохраняется в кеш
          * @param path - путь к файлу модели
          */
         static std::shared_ptr<StlShape> fromStlFile(const std::string &path);
 
+        /**
+         * Очистить кеш моделей, уже созданные объекты продолжают
+         * владеть своими моделями
+         */
+        static void clearCache();
+
         /**
          * Прочитать точки STL-модели из файла
          *
@@ -41,6 +58,23 @@ namespace bmpf {
          */
         ~StlShape();
 
+        StlShape(const StlShape &) = delete;
+
+        StlShape &operator=(const StlShape &) = delete;
+
+        /**
+         * Создать solid3-объект на основе модели
+         * @param clientObject - указатель на объект-владелец
+         * @return solid3-объект
+         */
+        DT_ObjectHandle createObject(void *clientObject);
+
+        /**
+         * Удалить solid3-объект, созданный на основе модели
+         * @param object - solid3-объект
+         */
+        void destroyObject(DT_ObjectHandle object);
+
         /**
          * Рисование модели средствами OpenGl
          */
@@ -72,6 +106,11 @@ namespace bmpf {
          */
         static std::vector<float> getCoords(char *data);
 
+        /**
+         * мьютекс списка объектов solid3, созданных на основе модели
+         */
+        std::mutex _objectMutex;
+
         /**
          * Модель из библиотеки Solid3
          */
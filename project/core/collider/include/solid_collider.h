@@ -8,6 +8,7 @@
 #include <thread>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 #include "base/collider.h"
 #include "log.h"
@@ -52,14 +53,60 @@ namespace bmpf {
          * @param onlyRobot флаг, нужно ли рисовать только роботов
          * или ещё и статические объекты сцены
          */
-        void paint(std::vector<Eigen::Matrix4d> matrices, bool onlyRobot) override;
+        void paint(const std::vector<Eigen::Matrix4d> &matrices, bool onlyRobot) override;
 
         /**
          * проверка соответствует ли состояние сцены столкновению
          * @param matrices список матриц преобразований звеньев
          * @return флаг, соответствует ли состояние сцены столкновению
          */
-        bool isCollided(std::vector<Eigen::Matrix4d> matrices) override;
+        bool isCollided(const std::vector<Eigen::Matrix4d> &matrices) override;
+
+        /**
+         * @brief пакетная проверка состояний сцены на столкновения
+         * пакетная проверка состояний сцены на столкновения: матрицы всех
+         * состояний записаны подряд в один буфер, на каждое состояние
+         * приходится по одной матрице на звено сцены
+         * @param matrices матрицы преобразований звеньев всех состояний
+         * @param stateCnt количество состояний
+         * @return битовая маска: i-й элемент равен true, если
+         * i-е состояние соответствует столкновению
+         */
+        std::vector<bool> areCollided(const std::vector<Eigen::Matrix4d> &matrices, unsigned long stateCnt) override;
+
+        /**
+         * @brief пакетная проверка состояний сцены на столкновения
+         * пакетная проверка состояний, матрицы которых записаны подряд
+         * начиная с указателя matrices. Мьютекс сцены блокируется один
+         * раз на весь пакет. Результаты записываются в массив collided
+         * (char, а не bool, чтобы разные потоки могли заполнять
+         * разные части одного массива)
+         * @param matrices указатель на матрицы первого состояния
+         * @param stateCnt количество состояний
+         * @param collided массив флагов длины stateCnt, в него записывается,
+         * соответствует ли каждое состояние столкновению
+         */
+        void areCollided(const Eigen::Matrix4d *matrices, unsigned long stateCnt, char *collided);
+
+        /**
+         * @brief получить все пересекающиеся пары звеньев
+         * получить все пересекающиеся пары звеньев (i < j) без учёта
+         * матрицы разрешённых столкновений, соседние звенья одного
+         * робота не проверяются
+         * @param matrices список матриц преобразований звеньев
+         * @return список пересекающихся пар звеньев
+         */
+        std::vector<std::pair<unsigned long, unsigned long>>
+        getCollidedPairs(const std::vector<Eigen::Matrix4d> &matrices) override;
+
+        /**
+         * задать матрицу разрешённых столкновений, разрешённые пары
+         * звеньев не проверяются на коллизии. Матрица сбрасывается
+         * при повторной инициализации коллайдера, пустая матрица
+         * сбрасывает все разрешённые пары
+         * @param allowedCollisions матрица разрешённых столкновений
+         */
+        void setAllowedCollisionMatrix(const AllowedCollisionMatrix &allowedCollisions) override;
 
         /**
          * возвращает список всех координат полигона (вектор нормали и координаты вершины):
@@ -67,7 +114,7 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return возвращает список всех координат полигона
          */
-        std::vector<float> getPoints(std::vector<Eigen::Matrix4d> matrices) override;
+        std::vector<float> getPoints(const std::vector<Eigen::Matrix4d> &matrices) override;
 
         /**
          * @brief  получить координаты куба, ограничивающего объём робота
@@ -80,7 +127,7 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return получить координаты куба, ограничивающего объём робота
          */
-        std::vector<double> getBoxCoords(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) override;
+        std::vector<double> getBoxCoords(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) override;
 
         /**
          * @brief проверка соответствует ли состояние сцены столкновению
@@ -91,7 +138,7 @@ namespace bmpf {
          * @param robotIndexes индексы роботов
          * @return флаг, соответствует ли состояние сцены столкновению
          */
-        bool isCollided(std::vector<Eigen::Matrix4d> matrices, std::vector<int> robotIndexes) override;
+        bool isCollided(const std::vector<Eigen::Matrix4d> &matrices, const std::vector<int> &robotIndexes) override;
 
         /**
          * @brief получить точки куба, ограничивающего объём робота
@@ -105,7 +152,7 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return получить точки куба, ограничивающего объём робота
          */
-        std::vector<double> getBoxPoints(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) override;
+        std::vector<double> getBoxPoints(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) override;
 
 
     private:
@@ -160,32 +207,33 @@ namespace bmpf {
          * библиотека solid построена так,
          * что нужно сначала задать матрицы преобразования, а потом
          * выполнить то или иное действие: нарисовать, проверить коллизии и т.д.
-         * поэтому метод в начале пытается заблокировать мьютекс _setTransformMutex
-         * с заданным интервалом, когда закончите использование текущее состояние сцены
+         * поэтому метод в начале блокирует мьютекс _setTransformMutex,
+         * когда закончите использование текущее состояние сцены
          * НЕ ЗАБУДЬТЕ ВЫЗВАТЬ МЕТОД _makeFree()
          * @param robotNum номер робота
          * @param matrices матрицы преобразования
          */
-        void _setTransformMatrices(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices);
+        void _setTransformMatrices(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices);
 
         /**
          * задать матрицы преобразования, библиотека solid построена так,
          * что нужно сначала задать матрицы преобразования, а потом
          * выполнить то или иное действие: нарисовать, проверить коллизии и т.д.
-         * поэтому метод в начале пытается заблокировать мьютекс _setTransformMutex
-         * с заданным интервалом, когда закончите использование текущее состояние сцены
+         * поэтому метод в начале блокирует мьютекс _setTransformMutex,
+         * когда закончите использование текущее состояние сцены
          * НЕ ЗАБУДЬТЕ ВЫЗВАТЬ МЕТОД _makeFree()
          * @param matrices матрицы преобразования
          */
-        void _setTransformMatrices(std::vector<Eigen::Matrix4d> matrices);
+        void _setTransformMatrices(const std::vector<Eigen::Matrix4d> &matrices);
 
         /**
-         *  порождает массив из 16 элементов из значений матрицы m
-         * (после использования не забудьте освободить память)
-         * @param m матрица преобразования
-         * @return массив из 16 элементов из значений матрицы
+         * записать матрицы преобразования в объекты сцены solid3 без
+         * блокировки мьютекса, вызывающий метод должен сам владеть
+         * мьютексом _setTransformMutex
+         * @param matrices указатель на матрицы преобразования, их
+         * количество должно совпадать с количеством звеньев
          */
-        static double *_eigenToDouble(Eigen::Matrix4d m);
+        void _loadTransformMatrices(const Eigen::Matrix4d *matrices);
 
         /**
          * проверка, соответствует ли коллизии текущее состояние сцены
@@ -193,6 +241,57 @@ namespace bmpf {
          */
         bool _isCollided();
 
+        /**
+         * проверка текущего состояния сцены перебором всех упорядоченных пар звеньев
+         * @return флаг, соответствует ли коллизии текущее состояние сцены
+         */
+        bool _isCollidedAllPairs();
+
+        /**
+         * @brief проверка текущего состояния сцены с отсечением пар по AABB
+         * звенья сортируются по нижней границе ограничивающего параллелепипеда
+         * вдоль оси x, после чего для каждого звена перебираются только те,
+         * чьи проекции на x пересекаются с его проекцией (sweep and prune).
+         * Точная проверка (GJK) запускается только для пар, параллелепипеды
+         * которых пересекаются по всем трём осям, каждая неупорядоченная
+         * пара проверяется один раз
+         * @return флаг, соответствует ли коллизии текущее состояние сцены
+         */
+        bool _isCollidedBroadPhase();
+
+        /**
+         * заполнить матрицу пар звеньев, которые нужно проверять на коллизии:
+         * проверяются все пары, кроме соседних звеньев одного робота
+         * и пар из матрицы разрешённых столкновений
+         */
+        void _initPairMask();
+
+        /**
+         * проверить, являются ли звенья соседними звеньями одного робота
+         * @param i индекс первого звена
+         * @param j индекс второго звена
+         * @return флаг, являются ли звенья соседними
+         */
+        bool _areLinksAdjacent(long i, long j) const;
+
+        /**
+         * ограничивающий параллелепипед звена в мировой СК
+         */
+        struct LinkBox {
+            /**
+             * минимальные координаты
+             */
+            DT_Vector3 min;
+            /**
+             * максимальные координаты
+             */
+            DT_Vector3 max;
+            /**
+             * индекс звена
+             */
+            unsigned long index;
+        };
+
         /**
          * флаг, состоит ли система из одного робота,
          * в этом случае по-другому выполняется проверка коллизий
@@ -227,6 +326,82 @@ namespace bmpf {
          * построенных на этом наборе
          */
         std::map<std::vector<int>, std::shared_ptr<SolidCollider>> _collidersMap;
+        /**
+         * матрица разрешённых столкновений
+         */
+        AllowedCollisionMatrix _allowedCollisions;
+        /**
+         * матрица пар звеньев размера _links.size() x _links.size(),
+         * ненулевой элемент означает, что пару нужно проверять на коллизии
+         */
+        std::vector<char> _pairMask;
+        /**
+         * количество неупорядоченных пар звеньев, которые нужно проверять
+         */
+        unsigned long _checkedPairCnt = 0;
+        /**
+         * флаг, нужно ли отсекать пары по ограничивающим параллелепипедам
+         */
+        bool _broadPhase = true;
+        /**
+         * буфер ограничивающих параллелепипедов звеньев
+         */
+        std::vector<LinkBox> _linkBoxes;
+        /**
+         * количество пар, дошедших до точной проверки
+         */
+        std::atomic<unsigned long> _testedPairCnt{0};
+        /**
+         * количество пар, отсечённых по ограничивающим параллелепипедам
+         */
+        std::atomic<unsigned long> _culledPairCnt{0};
+
+    public:
+        /**
+         * получить количество звеньев сцены
+         * @return количество звеньев сцены
+         */
+        unsigned long getLinkCnt() const { return _links.size(); }
 
+        /**
+         * получить количество неупорядоченных пар звеньев, которые проверяются на коллизии
+         * @return количество пар звеньев, которые проверяются на коллизии
+         */
+        unsigned long getCheckedPairCnt() const { return _checkedPairCnt; }
+
+        /**
+         * задать режим проверки коллизий
+         * @param broadPhase флаг, нужно ли отсекать пары по ограничивающим
+         * параллелепипедам перед точной проверкой
+         */
+        void setBroadPhase(bool broadPhase) { _broadPhase = broadPhase; }
+
+        /**
+         * получить режим проверки коллизий
+         * @return флаг, отсекаются ли пары по ограничивающим параллелепипедам
+         */
+        bool isBroadPhase() const { return _broadPhase; }
+
+        /**
+         * получить количество пар звеньев, дошедших до точной проверки
+         * @return количество пар звеньев, дошедших до точной проверки
+         */
+        unsigned long getTestedPairCnt() const { return _testedPairCnt; }
+
+        /**
+         * получить количество пар звеньев, отсечённых по ограничивающим
+         * параллелепипедам (учитываются только состояния, проверка которых
+         * дошла до конца, т.е. состояния без коллизий)
+         * @return количество отсечённых пар звеньев
+         */
+        unsigned long getCulledPairCnt() const { return _culledPairCnt; }
+
+        /**
+         * обнулить счётчики пар звеньев
+         */
+        void resetPairCounters() {
+            _testedPairCnt = 0;
+            _culledPairCnt = 0;
+        }
     };
 }
\ No newline at end of file
@@ -1,35 +1,36 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 #include "solid_collider.h"
+#include "thread_pool.h"
 
 
 namespace bmpf {
 /**
  * @brief Класс класс многопоточного коллайдера
  * Класс класс многопоточного коллайдера. Он является надстройкой
- * над массивом однопоточных коллайдеров заданной длины. Каждому
- * колладйеру соответствует свой мьютекс.
- * При обращении к методу проверки коллизий происходит
- * поиск первого незанятого мьютекса, он блокируется, запускается проверка коллизии
- * с помощью соответствующего коллайдера, после чего мьютекс освобождается.
- * Если все мьютексы заняты, то после паузы в одну микросекунду
- * поиск свободного мьютекса запускается заново, пока проверка не будет выполнена.
- * Остальные методы просто пробрасывают обращение к первому однопоточному коллайдеру
+ * над набором однопоточных коллайдеров: каждый поток при первом обращении
+ * получает собственный коллайдер и дальше работает только с ним, поэтому
+ * при проверке коллизий потоки не ждут друг друга и не блокируют мьютексы.
+ * Коллайдером владеет thread_local-словарь потока, поэтому он удаляется
+ * вместе с потоком; реестр хранит на коллайдеры потоков только слабые
+ * ссылки, мёртвые ссылки удаляются при создании следующего коллайдера.
+ * Мьютекс реестра блокируется только при создании коллайдера и в методах
+ * настройки.
+ * Пакетная проверка `areCollided` делит состояния на части по числу
+ * потоков и проверяет их в собственном пуле потоков коллайдера.
+ * Остальные методы выполняются коллайдером вызывающего потока
  */
     class SolidSyncCollider : public Collider {
     public:
 
-        /**
-         * максимальное количество потоков
-         */
-        const static int MAX_MUTES_CNT = 60;
-
         /**
          * конструктор
-         * @param mutexCnt количество мьютексов
+         * @param threadCnt количество потоков пакетной проверки
          */
-        explicit SolidSyncCollider(unsigned int mutexCnt);
+        explicit SolidSyncCollider(unsigned int threadCnt);
 
         /**
          * инициализация коллайдера
@@ -49,8 +50,8 @@ namespace bmpf {
          * @param onlyRobot флаг, нужно ли рисовать только роботов
          * или ещё и статические объекты сцены
          */
-        void paint(std::vector<Eigen::Matrix4d> matrices, bool onlyRobot) override {
-            _colliders.front()->paint(matrices, onlyRobot);
+        void paint(const std::vector<Eigen::Matrix4d> &matrices, bool onlyRobot) override {
+            _getCollider()->paint(matrices, onlyRobot);
         }
 
         /**
@@ -58,7 +59,38 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return флаг, соответствует ли состояние сцены столкновению
          */
-        bool isCollided(std::vector<Eigen::Matrix4d> matrices) override;
+        bool isCollided(const std::vector<Eigen::Matrix4d> &matrices) override;
+
+        /**
+         * @brief пакетная проверка состояний сцены на столкновения
+         * пакетная проверка состояний сцены на столкновения: матрицы всех
+         * состояний записаны подряд в один буфер, на каждое состояние
+         * приходится по одной матрице на звено сцены. Состояния делятся
+         * на непрерывные части, которые проверяются параллельно
+         * на свободных коллайдерах
+         * @param matrices матрицы преобразований звеньев всех состояний
+         * @param stateCnt количество состояний
+         * @return битовая маска: i-й элемент равен true, если
+         * i-е состояние соответствует столкновению
+         */
+        std::vector<bool> areCollided(const std::vector<Eigen::Matrix4d> &matrices, unsigned long stateCnt) override;
+
+        /**
+         * @brief получить все пересекающиеся пары звеньев
+         * получить все пересекающиеся пары звеньев (i < j) без учёта
+         * матрицы разрешённых столкновений, соседние звенья одного
+         * робота не проверяются
+         * @param matrices список матриц преобразований звеньев
+         * @return список пересекающихся пар звеньев
+         */
+        std::vector<std::pair<unsigned long, unsigned long>>
+        getCollidedPairs(const std::vector<Eigen::Matrix4d> &matrices) override;
+
+        /**
+         * задать матрицу разрешённых столкновений всем коллайдерам
+         * @param allowedCollisions матрица разрешённых столкновений
+         */
+        void setAllowedCollisionMatrix(const AllowedCollisionMatrix &allowedCollisions) override;
 
         /**
          * возвращает список всех координат полигона (вектор нормали и координаты вершины):
@@ -66,8 +98,8 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return возвращает список всех координат полигона
          */
-        std::vector<float> getPoints(std::vector<Eigen::Matrix4d> matrices) override {
-            return _colliders.front()->getPoints(matrices);
+        std::vector<float> getPoints(const std::vector<Eigen::Matrix4d> &matrices) override {
+            return _getCollider()->getPoints(matrices);
         }
 
         /**
@@ -81,8 +113,9 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return получить координаты куба, ограничивающего объём робота
          */
-        std::vector<double> getBoxCoords(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) override {
-            return _colliders.front()->getBoxCoords(robotNum, matrices);
+        std::vector<double>
+        getBoxCoords(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) override {
+            return _getCollider()->getBoxCoords(robotNum, matrices);
         }
 
         /**
@@ -97,8 +130,9 @@ namespace bmpf {
          * @param matrices список матриц преобразований звеньев
          * @return получить точки куба, ограничивающего объём робота
          */
-        std::vector<double> getBoxPoints(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) override {
-            return _colliders.front()->getBoxPoints(robotNum, matrices);
+        std::vector<double>
+        getBoxPoints(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) override {
+            return _getCollider()->getBoxPoints(robotNum, matrices);
         }
 
 
@@ -111,15 +145,161 @@ namespace bmpf {
          * @param robotIndexes индексы роботов
          * @return флаг, соответствует ли состояние сцены столкновению
          */
-        bool isCollided(std::vector<Eigen::Matrix4d> matrices, std::vector<int> robotIndexes) override;
+        bool isCollided(const std::vector<Eigen::Matrix4d> &matrices, const std::vector<int> &robotIndexes) override;
 
     private:
-        // кол-во мьютексов
-        unsigned int _mutexCnt{};
-        // список коллайдеров
-        std::vector<std::shared_ptr<SolidCollider>> _colliders;
-        // массив мьютексов
-        std::mutex _colliderMutexes[MAX_MUTES_CNT];
+        /**
+         * @brief коллайдер потока
+         */
+        struct ThreadCollider {
+            /**
+             * слабая ссылка на метку жизни многопоточного коллайдера,
+             * по ней поток удаляет коллайдеры удалённых многопоточных коллайдеров
+             */
+            std::weak_ptr<void> owner;
+            /**
+             * поколение многопоточного коллайдера, в котором создан коллайдер
+             */
+            unsigned long generation;
+            /**
+             * коллайдер
+             */
+            std::shared_ptr<SolidCollider> collider;
+        };
+
+        /**
+         * получить коллайдер текущего потока, при первом обращении
+         * потока коллайдер создаётся и регистрируется
+         * @return коллайдер текущего потока
+         */
+        std::shared_ptr<SolidCollider> _getCollider();
+
+        /**
+         * создать коллайдер текущего потока и добавить его в реестр
+         * @return коллайдер текущего потока
+         */
+        std::shared_ptr<SolidCollider> _createCollider();
+
+        /**
+         * получить коллайдеры ещё работающих потоков, мьютекс реестра
+         * должен быть заблокирован вызывающим кодом
+         * @return коллайдеры потоков
+         */
+        std::vector<std::shared_ptr<SolidCollider>> _getLiveColliders() const;
+
+        /**
+         * получить коллайдеры текущего потока
+         * @return словарь: ключ - идентификатор многопоточного коллайдера,
+         * значение - коллайдер потока
+         */
+        static std::unordered_map<unsigned long, ThreadCollider> &_getThreadColliders();
+
+        /**
+         * счётчик, по которому коллайдерам выдаются идентификаторы
+         */
+        static std::atomic<unsigned long> _nextInstanceId;
+        /**
+         * идентификатор коллайдера, по нему потоки находят свои коллайдеры
+         */
+        unsigned long _instanceId;
+        /**
+         * метка жизни коллайдера, потоки хранят на неё слабые ссылки
+         */
+        std::shared_ptr<char> _aliveToken = std::make_shared<char>();
+        /**
+         * поколение коллайдера, увеличивается при каждой инициализации,
+         * коллайдеры потоков старых поколений создаются заново
+         */
+        std::atomic<unsigned long> _generation{0};
+        /**
+         * количество потоков пакетной проверки
+         */
+        unsigned int _threadCnt{};
+        /**
+         * реестр слабых ссылок на коллайдеры потоков
+         */
+        std::vector<std::weak_ptr<SolidCollider>> _colliders;
+        /**
+         * мьютекс реестра коллайдеров и их настроек
+         */
+        mutable std::mutex _registryMutex;
+        /**
+         * пути к моделям, по которым инициализируются коллайдеры потоков
+         */
+        std::vector<std::vector<std::string>> _groupedModelPaths;
+        /**
+         * количество звеньев сцены
+         */
+        std::atomic<unsigned long> _linkCnt{0};
+        /**
+         * флаг, нужно ли отсекать пары по ограничивающим параллелепипедам
+         */
+        bool _broadPhase = true;
+        /**
+         * матрица разрешённых столкновений
+         */
+        AllowedCollisionMatrix _allowedCollisions;
+        /**
+         * пул потоков для пакетной проверки состояний
+         */
+        std::shared_ptr<ThreadPool> _threadPool;
+
+    public:
+        /**
+         * задать режим проверки коллизий всем коллайдерам
+         * @param broadPhase флаг, нужно ли отсекать пары по ограничивающим
+         * параллелепипедам перед точной проверкой
+         */
+        void setBroadPhase(bool broadPhase) {
+            std::lock_guard<std::mutex> lock(_registryMutex);
+            _broadPhase = broadPhase;
+            for (auto &collider: _getLiveColliders())
+                collider->setBroadPhase(broadPhase);
+        }
+
+        /**
+         * получить суммарное по всем коллайдерам количество пар звеньев,
+         * дошедших до точной проверки
+         * @return количество пар звеньев, дошедших до точной проверки
+         */
+        unsigned long getTestedPairCnt() const {
+            std::lock_guard<std::mutex> lock(_registryMutex);
+            unsigned long cnt = 0;
+            for (auto &collider: _getLiveColliders())
+                cnt += collider->getTestedPairCnt();
+            return cnt;
+        }
+
+        /**
+         * получить суммарное по всем коллайдерам количество пар звеньев,
+         * отсечённых по ограничивающим параллелепипедам
+         * @return количество отсечённых пар звеньев
+         */
+        unsigned long getCulledPairCnt() const {
+            std::lock_guard<std::mutex> lock(_registryMutex);
+            unsigned long cnt = 0;
+            for (auto &collider: _getLiveColliders())
+                cnt += collider->getCulledPairCnt();
+            return cnt;
+        }
+
+        /**
+         * обнулить счётчики пар звеньев всех коллайдеров
+         */
+        void resetPairCounters() {
+            std::lock_guard<std::mutex> lock(_registryMutex);
+            for (auto &collider: _getLiveColliders())
+                collider->resetPairCounters();
+        }
+
+        /**
+         * получить количество коллайдеров ещё работающих потоков
+         * @return количество коллайдеров потоков
+         */
+        unsigned long getColliderCnt() const {
+            std::lock_guard<std::mutex> lock(_registryMutex);
+            return _getLiveColliders().size();
+        }
 
     };
 
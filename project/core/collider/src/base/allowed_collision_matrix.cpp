@@ -0,0 +1,56 @@
+#include "base/allowed_collision_matrix.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+using namespace bmpf;
+
+/**
+ * конструктор
+ * @param linkCnt количество звеньев
+ */
+AllowedCollisionMatrix::AllowedCollisionMatrix(unsigned long linkCnt) :
+        _linkCnt(linkCnt), _allowed(linkCnt * linkCnt, 0) {}
+
+/**
+ * разрешить столкновение пары звеньев
+ * @param i индекс первого звена
+ * @param j индекс второго звена
+ */
+void AllowedCollisionMatrix::allow(unsigned long i, unsigned long j) {
+    if (i >= _linkCnt || j >= _linkCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "AllowedCollisionMatrix::allow() ERROR: \n pair is (%lu, %lu), but link count is %lu",
+                i, j, _linkCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+    _allowed[i * _linkCnt + j] = 1;
+    _allowed[j * _linkCnt + i] = 1;
+}
+
+/**
+ * проверить, разрешено ли столкновение пары звеньев
+ * @param i индекс первого звена
+ * @param j индекс второго звена
+ * @return флаг, разрешено ли столкновение пары звеньев
+ */
+bool AllowedCollisionMatrix::isAllowed(unsigned long i, unsigned long j) const {
+    if (i >= _linkCnt || j >= _linkCnt)
+        return false;
+    return _allowed[i * _linkCnt + j];
+}
+
+/**
+ * получить список разрешённых пар (i < j)
+ * @return список разрешённых пар
+ */
+std::vector<std::pair<unsigned long, unsigned long>> AllowedCollisionMatrix::getAllowedPairs() const {
+    std::vector<std::pair<unsigned long, unsigned long>> pairs;
+    for (unsigned long i = 0; i < _linkCnt; i++)
+        for (unsigned long j = i + 1; j < _linkCnt; j++)
+            if (_allowed[i * _linkCnt + j])
+                pairs.emplace_back(i, j);
+    return pairs;
+}
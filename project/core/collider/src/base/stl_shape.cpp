@@ -1,7 +1,50 @@
 #include "base/stl_shape.h"
 
+#include <climits>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <sys/stat.h>
+
 using namespace bmpf;
 
+namespace {
+    /**
+     * запись кеша моделей
+     */
+    struct CachedShape {
+        /**
+         * время изменения файла
+         */
+        time_t mtime;
+        /**
+         * размер файла
+         */
+        off_t size;
+        /**
+         * модель
+         */
+        std::shared_ptr<StlShape> shape;
+    };
+
+    /**
+     * мьютекс кеша моделей, под ним же строятся сами модели:
+     * solid3 собирает составную модель в глобальных переменных
+     */
+    std::mutex cacheMutex;
+
+    /**
+     * получить кеш моделей, ключ - канонический путь к файлу.
+     * Кеш создаётся в куче и не удаляется, чтобы модели не удалялись
+     * при завершении процесса позже объектов solid3
+     * @return кеш моделей
+     */
+    std::map<std::string, CachedShape> &getShapeCache() {
+        static auto *cache = new std::map<std::string, CachedShape>();
+        return *cache;
+    }
+}
+
 /**
  * Конструктор
  * @param points - список вершин модели
@@ -115,16 +158,62 @@ std::vector<float> StlShape::getCoords(char *data) {
  * @param path - путь к файлу модели
  */
 std::shared_ptr<StlShape> StlShape::fromStlFile(const std::string &path) {
+    struct stat fileStat{};
+    if (stat(path.c_str(), &fileStat) != 0)
+        throw std::invalid_argument("header error: " + path);
+
+    // один и тот же файл может быть задан разными относительными путями
+    char canonicalPath[PATH_MAX];
+    std::string key = realpath(path.c_str(), canonicalPath) ? canonicalPath : path;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto &cache = getShapeCache();
+    auto it = cache.find(key);
+    if (it != cache.end() && it->second.mtime == fileStat.st_mtime && it->second.size == fileStat.st_size)
+        return it->second.shape;
+
     std::vector<float> points = readStl(path);
-    return std::make_shared<StlShape>(points);
+    std::shared_ptr<StlShape> shape = std::make_shared<StlShape>(points);
+    cache[key] = {fileStat.st_mtime, fileStat.st_size, shape};
+    return shape;
+}
+
+/**
+ * Очистить кеш моделей, уже созданные объекты продолжают
+ * владеть своими моделями
+ */
+void StlShape::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    getShapeCache().clear();
+}
+
+/**
+ * Создать solid3-объект на основе модели
+ * @param clientObject - указатель на объект-владелец
+ * @return solid3-объект
+ */
+DT_ObjectHandle StlShape::createObject(void *clientObject) {
+    std::lock_guard<std::mutex> lock(_objectMutex);
+    return DT_CreateObject(clientObject, _dtShape);
+}
+
+/**
+ * Удалить solid3-объект, созданный на основе модели
+ * @param object - solid3-объект
+ */
+void StlShape::destroyObject(DT_ObjectHandle object) {
+    std::lock_guard<std::mutex> lock(_objectMutex);
+    DT_DestroyObject(object);
 }
 
 /**
  * Деструктор
  */
 StlShape::~StlShape() {
-    DT_DeleteVertexBase(_base);
+    // составная модель при удалении отписывается от своей базы вершин,
+    // поэтому база удаляется после неё
     DT_DeleteShape(_dtShape);
+    DT_DeleteVertexBase(_base);
     delete[] _points;
 }
 
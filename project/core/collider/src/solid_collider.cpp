@@ -1,5 +1,7 @@
 #include "solid_collider.h"
 
+#include <algorithm>
+
 using namespace bmpf;
 
 /**
@@ -114,33 +116,22 @@ void SolidCollider::init(std::vector<std::vector<std::string>> groupedModelPaths
     // добавляем на неё все звенья
     for (std::shared_ptr<Solid3Object> &obj: _links)
         DT_AddObject(_scene, obj->getHandle());
-}
 
-/**
- *  порождает массив из 16 элементов из значений матрицы m
- * (после использования не забудьте освободить память)
- * @param m матрица преобразования
- * @return массив из 16 элементов из значений матрицы
- */
-double *SolidCollider::_eigenToDouble(Eigen::Matrix4d m) {
-    auto *matrix = new double[16];
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++)
-            matrix[4 * i + j] = m(i, j);
-    }
-    return matrix;
+    // матрица разрешённых столкновений относится к прежнему набору звеньев
+    _allowedCollisions = AllowedCollisionMatrix();
+    _initPairMask();
 }
 
 /**
  * задать матрицы преобразования, библиотека solid построена так,
  * что нужно сначала задать матрицы преобразования, а потом
  * выполнить то или иное действие: нарисовать, проверить коллизии и т.д.
- * поэтому метод в начале пытается заблокировать мьютекс _setTransformMutex
- * с заданным интервалом, когда закончите использование текущее состояние сцены
+ * поэтому метод в начале блокирует мьютекс _setTransformMutex,
+ * когда закончите использование текущее состояние сцены
  * НЕ ЗАБУДЬТЕ ВЫЗВАТЬ МЕТОД _makeFree()
  * @param matrices матрицы преобразования
  */
-void SolidCollider::_setTransformMatrices(std::vector<Eigen::Matrix4d> matrices) {
+void SolidCollider::_setTransformMatrices(const std::vector<Eigen::Matrix4d> &matrices) {
     if (_links.size() != matrices.size()) {
         char buf[1024];
         sprintf(buf,
@@ -151,18 +142,27 @@ void SolidCollider::_setTransformMatrices(std::vector<Eigen::Matrix4d> matrices)
         throw std::invalid_argument(buf);
     }
 
-    // пока не получается выставить мьютекс
-    while (!_setTransformMutex.try_lock())
-        // делаем паузу в одну мкросекунду
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
+    // коллайдер обычно принадлежит одному потоку, поэтому мьютекс свободен
+    _setTransformMutex.lock();
 
     // задаём матрицы трансформации
+    _loadTransformMatrices(matrices.data());
+}
+
+/**
+ * записать матрицы преобразования в объекты сцены solid3 без
+ * блокировки мьютекса, вызывающий метод должен сам владеть
+ * мьютексом _setTransformMutex
+ * @param matrices указатель на матрицы преобразования, их
+ * количество должно совпадать с количеством звеньев
+ */
+void SolidCollider::_loadTransformMatrices(const Eigen::Matrix4d *matrices) {
+    // solid3 принимает матрицы по столбцам, как и Eigen по умолчанию,
+    // поэтому данные передаются без копирования
+    static_assert(!Eigen::Matrix4d::IsRowMajor, "solid3 expects column-major matrices");
     const unsigned long itCnt = _links.size();
-    for (unsigned long i = 0; i < itCnt; i++) {
-        double *position = _eigenToDouble(matrices.at(i).transpose());
-        DT_SetMatrixd(_links.at(i)->getHandle(), position);
-        delete[] position;
-    }
+    for (unsigned long i = 0; i < itCnt; i++)
+        DT_SetMatrixd(_links[i]->getHandle(), matrices[i].data());
 }
 
 /**
@@ -170,13 +170,13 @@ void SolidCollider::_setTransformMatrices(std::vector<Eigen::Matrix4d> matrices)
  * библиотека solid построена так,
  * что нужно сначала задать матрицы преобразования, а потом
  * выполнить то или иное действие: нарисовать, проверить коллизии и т.д.
- * поэтому метод в начале пытается заблокировать мьютекс _setTransformMutex
- * с заданным интервалом, когда закончите использование текущее состояние сцены
+ * поэтому метод в начале блокирует мьютекс _setTransformMutex,
+ * когда закончите использование текущее состояние сцены
  * НЕ ЗАБУДЬТЕ ВЫЗВАТЬ МЕТОД _makeFree()
  * @param robotNum номер робота
  * @param matrices матрицы преобразования
  */
-void SolidCollider::_setTransformMatrices(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) {
+void SolidCollider::_setTransformMatrices(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) {
     if (robotNum >= _groupedLinks.size()) {
         char buf[1024];
         sprintf(buf,
@@ -186,19 +186,15 @@ void SolidCollider::_setTransformMatrices(unsigned long robotNum, std::vector<Ei
         throw std::invalid_argument(buf);
     }
 
-    // пока не получается выставить мьютекс
-    while (!_setTransformMutex.try_lock())
-        // делаем паузу в одну мкросекунду
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
+    // коллайдер обычно принадлежит одному потоку, поэтому мьютекс свободен
+    _setTransformMutex.lock();
 
     // обновляем матрицы для робота с индексом robotNum
+    // матрицы передаются в solid3 без копирования (см. _loadTransformMatrices)
     for (unsigned long i = _objectIndexRanges.at(robotNum).first;
-         i < _objectIndexRanges.at(robotNum).second;
-         i++) {
-        double *position = _eigenToDouble(matrices.at(i).transpose());
-        DT_SetMatrixd(_links.at(i)->getHandle(), position);
-        delete[] position;
-    }
+         i <= _objectIndexRanges.at(robotNum).second;
+         i++)
+        DT_SetMatrixd(_links.at(i)->getHandle(), matrices.at(i).data());
 }
 
 /**
@@ -208,7 +204,7 @@ void SolidCollider::_setTransformMatrices(unsigned long robotNum, std::vector<Ei
  * @param onlyRobot флаг, нужно ли рисовать только роботов
  * или ещё и статические объекты сцены
  */
-void SolidCollider::paint(std::vector<Eigen::Matrix4d> matrices, bool onlyRobot) {
+void SolidCollider::paint(const std::vector<Eigen::Matrix4d> &matrices, bool onlyRobot) {
     _setTransformMatrices(matrices);
     for (auto &_link: _links)
         _link->paintGL(onlyRobot);
@@ -226,7 +222,7 @@ void SolidCollider::paint(std::vector<Eigen::Matrix4d> matrices, bool onlyRobot)
  * @param matrices список матриц преобразований звеньев
  * @return получить координаты куба, ограничивающего объём робота
  */
-std::vector<double> SolidCollider::getBoxCoords(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) {
+std::vector<double> SolidCollider::getBoxCoords(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) {
     if (robotNum >= _groupedLinks.size()) {
         char buf[1024];
         sprintf(buf,
@@ -272,7 +268,7 @@ std::vector<double> SolidCollider::getBoxCoords(unsigned long robotNum, std::vec
  * @param matrices список матриц преобразований звеньев
  * @return получить точки куба, ограничивающего объём робота
  */
-std::vector<double> SolidCollider::getBoxPoints(unsigned long robotNum, std::vector<Eigen::Matrix4d> matrices) {
+std::vector<double> SolidCollider::getBoxPoints(unsigned long robotNum, const std::vector<Eigen::Matrix4d> &matrices) {
     if (robotNum >= _groupedLinks.size()) {
         char buf[1024];
         sprintf(buf,
@@ -332,58 +328,258 @@ std::vector<double> SolidCollider::getBoxPoints(unsigned long robotNum, std::vec
  * @return флаг, соответствует ли коллизии текущее состояние сцены
  */
 bool SolidCollider::_isCollided() {
+    return _broadPhase ? _isCollidedBroadPhase() : _isCollidedAllPairs();
+}
+
+/**
+ * проверка текущего состояния сцены перебором всех упорядоченных пар звеньев
+ * @return флаг, соответствует ли коллизии текущее состояние сцены
+ */
+bool SolidCollider::_isCollidedAllPairs() {
     // специальная переменная, в которую solid3 сохраняет точку пересечения
     MT_Point3 cp1;
+    const unsigned long linkCnt = _links.size();
+    unsigned long testedPairCnt = 0;
+    bool collided = false;
     // перебираем пары звеньев
-    for (int i = 0; i < _links.size(); i++)
-        for (int j = 0; j < _links.size(); j++) {
-            // если робот всего один
-            if (_isSingleObject) {
-                // если звенья соседние, пропускаем это проверку
-                if (std::abs(i - j) <= 1)
-                    continue;
-
-                // если звенья пересекаются
-                if (DT_GetCommonPoint(
-                        _links.at(i)->getHandle(), _links.at(j)->getHandle(), cp1))
-                    return true;
-            } else {
-                // если звенья совпадают, пропускаем это проверку
-                if (i == j)
-                    continue;
-                // определяем, являются ли звенья соседними в одном и то же роботом
-                bool neighbors = false;
-                for (auto robotRange: _objectIndexRanges) {
-                    if (i >= robotRange.first && i <= robotRange.second &&
-                        j >= robotRange.first && j <= robotRange.second &&
-                        (i == j + 1 || i == j - 1)) {
-                        neighbors = true;
-                        break;
-                    }
-                }
-                // если звенья не являются соседями и пересекаются
-                if (!neighbors && DT_GetCommonPoint(
-                        _links.at(i)->getHandle(), _links.at(j)->getHandle(), cp1))
-                    return true;
+    for (unsigned long i = 0; i < linkCnt && !collided; i++)
+        for (unsigned long j = 0; j < linkCnt; j++) {
+            // пропускаем совпадающие и соседние звенья
+            if (!_pairMask[i * linkCnt + j])
+                continue;
+
+            testedPairCnt++;
+            // если звенья пересекаются
+            if (DT_GetCommonPoint(_links[i]->getHandle(), _links[j]->getHandle(), cp1)) {
+                collided = true;
+                break;
+            }
+        }
+
+    _testedPairCnt.fetch_add(testedPairCnt, std::memory_order_relaxed);
+    return collided;
+}
+
+/**
+ * @brief проверка текущего состояния сцены с отсечением пар по AABB
+ * звенья сортируются по нижней границе ограничивающего параллелепипеда
+ * вдоль оси x, после чего для каждого звена перебираются только те,
+ * чьи проекции на x пересекаются с его проекцией (sweep and prune).
+ * Точная проверка (GJK) запускается только для пар, параллелепипеды
+ * которых пересекаются по всем трём осям, каждая неупорядоченная
+ * пара проверяется один раз
+ * @return флаг, соответствует ли коллизии текущее состояние сцены
+ */
+bool SolidCollider::_isCollidedBroadPhase() {
+    const unsigned long linkCnt = _links.size();
+
+    // параллелепипеды solid3 пересчитывает при задании матриц преобразования
+    _linkBoxes.resize(linkCnt);
+    for (unsigned long i = 0; i < linkCnt; i++) {
+        DT_GetBBox(_links[i]->getHandle(), _linkBoxes[i].min, _linkBoxes[i].max);
+        _linkBoxes[i].index = i;
+    }
+    std::sort(_linkBoxes.begin(), _linkBoxes.end(), [](const LinkBox &a, const LinkBox &b) {
+        return a.min[0] < b.min[0];
+    });
+
+    // специальная переменная, в которую solid3 сохраняет точку пересечения
+    MT_Point3 cp1;
+    unsigned long testedPairCnt = 0;
+    bool collided = false;
+    for (unsigned long i = 0; i < linkCnt && !collided; i++) {
+        const LinkBox &a = _linkBoxes[i];
+        // звенья отсортированы по нижней границе x, поэтому перебор
+        // заканчивается на первом звене, лежащем правее текущего
+        for (unsigned long j = i + 1; j < linkCnt && _linkBoxes[j].min[0] <= a.max[0]; j++) {
+            const LinkBox &b = _linkBoxes[j];
+            if (!_pairMask[a.index * linkCnt + b.index])
+                continue;
+            if (a.min[1] > b.max[1] || b.min[1] > a.max[1] ||
+                a.min[2] > b.max[2] || b.min[2] > a.max[2])
+                continue;
+
+            testedPairCnt++;
+            if (DT_GetCommonPoint(_links[a.index]->getHandle(), _links[b.index]->getHandle(), cp1)) {
+                collided = true;
+                break;
             }
         }
+    }
+
+    _testedPairCnt.fetch_add(testedPairCnt, std::memory_order_relaxed);
+    // отсечённые пары можно посчитать только после полного перебора
+    if (!collided)
+        _culledPairCnt.fetch_add(_checkedPairCnt - testedPairCnt, std::memory_order_relaxed);
+    return collided;
+}
+
+/**
+ * заполнить матрицу пар звеньев, которые нужно проверять на коллизии:
+ * проверяются все пары, кроме соседних звеньев одного робота
+ * и пар из матрицы разрешённых столкновений
+ */
+void SolidCollider::_initPairMask() {
+    const long linkCnt = (long) _links.size();
+    _pairMask.assign(linkCnt * linkCnt, 0);
+    _checkedPairCnt = 0;
+
+    for (long i = 0; i < linkCnt; i++)
+        for (long j = i + 1; j < linkCnt; j++)
+            if (!_areLinksAdjacent(i, j) && !_allowedCollisions.isAllowed(i, j)) {
+                _pairMask[i * linkCnt + j] = 1;
+                _pairMask[j * linkCnt + i] = 1;
+                _checkedPairCnt++;
+            }
+}
 
+/**
+ * проверить, являются ли звенья соседними звеньями одного робота
+ * @param i индекс первого звена
+ * @param j индекс второго звена
+ * @return флаг, являются ли звенья соседними
+ */
+bool SolidCollider::_areLinksAdjacent(long i, long j) const {
+    if (i > j)
+        std::swap(i, j);
+
+    // если робот всего один, соседними считаются звенья с соседними индексами
+    if (_isSingleObject)
+        return j - i <= 1;
+
+    if (j != i + 1)
+        return false;
+    for (auto robotRange: _objectIndexRanges)
+        if (i >= robotRange.first && j <= robotRange.second)
+            return true;
     return false;
 }
 
+/**
+ * @brief получить все пересекающиеся пары звеньев
+ * получить все пересекающиеся пары звеньев (i < j) без учёта
+ * матрицы разрешённых столкновений, соседние звенья одного
+ * робота не проверяются
+ * @param matrices список матриц преобразований звеньев
+ * @return список пересекающихся пар звеньев
+ */
+std::vector<std::pair<unsigned long, unsigned long>>
+SolidCollider::getCollidedPairs(const std::vector<Eigen::Matrix4d> &matrices) {
+    _setTransformMatrices(matrices);
+
+    // специальная переменная, в которую solid3 сохраняет точку пересечения
+    MT_Point3 cp1;
+    DT_Vector3 minA, maxA, minB, maxB;
+    std::vector<std::pair<unsigned long, unsigned long>> pairs;
+    for (unsigned long i = 0; i < _links.size(); i++)
+        for (unsigned long j = i + 1; j < _links.size(); j++) {
+            if (_areLinksAdjacent((long) i, (long) j))
+                continue;
+
+            DT_GetBBox(_links[i]->getHandle(), minA, maxA);
+            DT_GetBBox(_links[j]->getHandle(), minB, maxB);
+            bool boxesOverlap = true;
+            for (int k = 0; k < 3; k++)
+                if (minA[k] > maxB[k] || minB[k] > maxA[k])
+                    boxesOverlap = false;
+
+            if (boxesOverlap && DT_GetCommonPoint(_links[i]->getHandle(), _links[j]->getHandle(), cp1))
+                pairs.emplace_back(i, j);
+        }
+
+    _makeFree();
+    return pairs;
+}
+
+/**
+ * задать матрицу разрешённых столкновений, разрешённые пары
+ * звеньев не проверяются на коллизии. Матрица сбрасывается
+ * при повторной инициализации коллайдера, пустая матрица
+ * сбрасывает все разрешённые пары
+ * @param allowedCollisions матрица разрешённых столкновений
+ */
+void SolidCollider::setAllowedCollisionMatrix(const AllowedCollisionMatrix &allowedCollisions) {
+    // пустая матрица сбрасывает все разрешённые пары
+    if (allowedCollisions.getLinkCnt() != 0 && allowedCollisions.getLinkCnt() != _links.size()) {
+        char buf[1024];
+        sprintf(buf,
+                "SolidCollider::setAllowedCollisionMatrix() ERROR: \n matrix link count is %lu,"
+                " but _links size is %zu\nthey must be equal",
+                allowedCollisions.getLinkCnt(), _links.size()
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    // матрица пар меняется под мьютексом, чтобы не помешать идущей проверке
+    _setTransformMutex.lock();
+    _allowedCollisions = allowedCollisions;
+    _initPairMask();
+    _makeFree();
+}
+
 
 /**
  * проверка соответствует ли состояние сцены столкновению
  * @param matrices список матриц преобразований звеньев
  * @return флаг, соответствует ли состояние сцены столкновению
  */
-bool SolidCollider::isCollided(std::vector<Eigen::Matrix4d> matrices) {
-    _setTransformMatrices(std::move(matrices));
+bool SolidCollider::isCollided(const std::vector<Eigen::Matrix4d> &matrices) {
+    _setTransformMatrices(matrices);
     bool ic = _isCollided();
     _makeFree();
     return ic;
 }
 
+/**
+ * @brief пакетная проверка состояний сцены на столкновения
+ * пакетная проверка состояний сцены на столкновения: матрицы всех
+ * состояний записаны подряд в один буфер, на каждое состояние
+ * приходится по одной матрице на звено сцены
+ * @param matrices матрицы преобразований звеньев всех состояний
+ * @param stateCnt количество состояний
+ * @return битовая маска: i-й элемент равен true, если
+ * i-е состояние соответствует столкновению
+ */
+std::vector<bool> SolidCollider::areCollided(const std::vector<Eigen::Matrix4d> &matrices, unsigned long stateCnt) {
+    if (matrices.size() != stateCnt * _links.size()) {
+        char buf[1024];
+        sprintf(buf,
+                "SolidCollider::areCollided() ERROR: \n matrices size is %zu, but stateCnt is %lu"
+                " and _links size is %zu\nmatrices size must be equal to their product",
+                matrices.size(), stateCnt, _links.size()
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    std::vector<char> collided(stateCnt);
+    areCollided(matrices.data(), stateCnt, collided.data());
+    return {collided.begin(), collided.end()};
+}
+
+/**
+ * @brief пакетная проверка состояний сцены на столкновения
+ * пакетная проверка состояний, матрицы которых записаны подряд
+ * начиная с указателя matrices. Мьютекс сцены блокируется один
+ * раз на весь пакет. Результаты записываются в массив collided
+ * (char, а не bool, чтобы разные потоки могли заполнять
+ * разные части одного массива)
+ * @param matrices указатель на матрицы первого состояния
+ * @param stateCnt количество состояний
+ * @param collided массив флагов длины stateCnt, в него записывается,
+ * соответствует ли каждое состояние столкновению
+ */
+void SolidCollider::areCollided(const Eigen::Matrix4d *matrices, unsigned long stateCnt, char *collided) {
+    // коллайдер обычно принадлежит одному потоку, поэтому мьютекс свободен
+    _setTransformMutex.lock();
+
+    const unsigned long linkCnt = _links.size();
+    for (unsigned long i = 0; i < stateCnt; i++) {
+        _loadTransformMatrices(matrices + i * linkCnt);
+        collided[i] = _isCollided();
+    }
+    _makeFree();
+}
+
 /**
  * @brief проверка соответствует ли состояние сцены столкновению
  * проверка соответствует ли состояние сцены (список матриц преобразований звеньев
@@ -393,7 +589,7 @@ bool SolidCollider::isCollided(std::vector<Eigen::Matrix4d> matrices) {
  * @param robotIndexes индексы роботов
  * @return флаг, соответствует ли состояние сцены столкновению
  */
-bool SolidCollider::isCollided(std::vector<Eigen::Matrix4d> matrices, std::vector<int> robotIndexes) {
+bool SolidCollider::isCollided(const std::vector<Eigen::Matrix4d> &matrices, const std::vector<int> &robotIndexes) {
     if (_collidersMap.empty()) {
         throw std::runtime_error("SolidCollider::isCollided() ERROR: \n _collidersMap is empty");
     }
@@ -407,8 +603,8 @@ bool SolidCollider::isCollided(std::vector<Eigen::Matrix4d> matrices, std::vecto
  * @param matrices список матриц преобразований звеньев
  * @return возвращает список всех координат полигона
  */
-std::vector<float> SolidCollider::getPoints(std::vector<Eigen::Matrix4d> matrices) {
-    _setTransformMatrices(std::move(matrices));
+std::vector<float> SolidCollider::getPoints(const std::vector<Eigen::Matrix4d> &matrices) {
+    _setTransformMatrices(matrices);
     std::vector<float> pointList;
     for (auto &link: _links) {
         std::vector<float> points = link->getTransformedPointsList();
@@ -1,28 +1,20 @@
+#include <algorithm>
 #include <thread>
 #include "solid_sync_collider.h"
 
 
 using namespace bmpf;
 
+std::atomic<unsigned long> SolidSyncCollider::_nextInstanceId{0};
+
 /**
  * конструктор
- * @param mutexCnt количество мьютексов
+ * @param threadCnt количество потоков пакетной проверки
  */
-SolidSyncCollider::SolidSyncCollider(unsigned int mutexCnt) {
-    if (mutexCnt > MAX_MUTES_CNT) {
-        char buf[1024];
-        sprintf(buf,
-                "SolidSyncCollider::SolidSyncCollider() ERROR: \n mutexCnt is %u, but MAX_MUTES_CNT is %d",
-                mutexCnt, MAX_MUTES_CNT
-        );
-        throw std::invalid_argument(buf);
-    }
-    _mutexCnt = mutexCnt;
-
-    for (unsigned int i = 0; i < _mutexCnt; i++) {
-        _colliders.push_back(std::make_shared<SolidCollider>());
-        _colliderMutexes[i].unlock();
-    }
+SolidSyncCollider::SolidSyncCollider(unsigned int threadCnt) {
+    _instanceId = _nextInstanceId.fetch_add(1);
+    _threadCnt = std::max(1u, threadCnt);
+    _threadPool = std::make_shared<ThreadPool>(_threadCnt);
 }
 
 /**
@@ -35,10 +27,16 @@ SolidSyncCollider::SolidSyncCollider(unsigned int mutexCnt) {
  * каждого подмножества объектов сцены
  */
 void SolidSyncCollider::init(std::vector<std::vector<std::string>> groupedModelPaths, bool subColliders) {
-    for (unsigned int i = 0; i < _mutexCnt; i++) {
-        _colliders.at(i)->init(groupedModelPaths, false);
-        _colliderMutexes[i].unlock();
-    }
+    std::lock_guard<std::mutex> lock(_registryMutex);
+    _groupedModelPaths = std::move(groupedModelPaths);
+    _linkCnt = 0;
+    for (auto &modelPaths: _groupedModelPaths)
+        _linkCnt += modelPaths.size();
+    _allowedCollisions = AllowedCollisionMatrix();
+    // коллайдеры потоков прошлого поколения становятся недействительными,
+    // при следующем обращении потоки создадут новые коллайдеры
+    _generation++;
+    _colliders.clear();
 }
 
 /**
@@ -46,24 +44,135 @@ void SolidSyncCollider::init(std::vector<std::vector<std::string>> groupedModelP
  * @param matrices список матриц преобразований звеньев
  * @return флаг, соответствует ли состояние сцены столкновению
  */
-bool SolidSyncCollider::isCollided(std::vector<Eigen::Matrix4d> matrices) {
-    // повторяем, пока не будет выполнена проверка на
-    // том или ином коллайдере
-    while (true) {
-        // перебираем мьютексы и ищем свободный
-        for (unsigned i = 0; i < _mutexCnt; i++)
-            if (_colliderMutexes[i].try_lock()) {
-                // если получилось его заблокировать, запускаем проверку
-                // на соответствующем коллайдере
-                bool result = _colliders.at(i)->isCollided(matrices);
-                // освобождаем мьютекс
-                _colliderMutexes[i].unlock();
-                // возвращаем результат проверки
-                return result;
-            }
-        // делаем паузу в одну микросекунду
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
+bool SolidSyncCollider::isCollided(const std::vector<Eigen::Matrix4d> &matrices) {
+    return _getCollider()->isCollided(matrices);
+}
+
+/**
+ * @brief пакетная проверка состояний сцены на столкновения
+ * пакетная проверка состояний сцены на столкновения: матрицы всех
+ * состояний записаны подряд в один буфер, на каждое состояние
+ * приходится по одной матрице на звено сцены. Состояния делятся
+ * на непрерывные части, которые проверяются параллельно
+ * на свободных коллайдерах
+ * @param matrices матрицы преобразований звеньев всех состояний
+ * @param stateCnt количество состояний
+ * @return битовая маска: i-й элемент равен true, если
+ * i-е состояние соответствует столкновению
+ */
+std::vector<bool> SolidSyncCollider::areCollided(const std::vector<Eigen::Matrix4d> &matrices, unsigned long stateCnt) {
+    unsigned long linkCnt = _linkCnt;
+    if (matrices.size() != stateCnt * linkCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "SolidSyncCollider::areCollided() ERROR: \n matrices size is %zu, but stateCnt is %lu"
+                " and link count is %lu\nmatrices size must be equal to their product",
+                matrices.size(), stateCnt, linkCnt
+        );
+        throw std::invalid_argument(buf);
     }
+
+    std::vector<char> collided(stateCnt);
+    // каждая часть - непрерывный диапазон состояний, проверяемый
+    // коллайдером рабочего потока пула
+    unsigned long partCnt = std::min((unsigned long) _threadCnt, stateCnt);
+    _threadPool->parallelFor(partCnt, [&](unsigned long part) {
+        unsigned long begin = stateCnt * part / partCnt;
+        unsigned long end = stateCnt * (part + 1) / partCnt;
+        _getCollider()->areCollided(matrices.data() + begin * linkCnt, end - begin, collided.data() + begin);
+    });
+
+    return {collided.begin(), collided.end()};
+}
+
+/**
+ * @brief получить все пересекающиеся пары звеньев
+ * получить все пересекающиеся пары звеньев (i < j) без учёта
+ * матрицы разрешённых столкновений, соседние звенья одного
+ * робота не проверяются
+ * @param matrices список матриц преобразований звеньев
+ * @return список пересекающихся пар звеньев
+ */
+std::vector<std::pair<unsigned long, unsigned long>>
+SolidSyncCollider::getCollidedPairs(const std::vector<Eigen::Matrix4d> &matrices) {
+    return _getCollider()->getCollidedPairs(matrices);
+}
+
+/**
+ * задать матрицу разрешённых столкновений всем коллайдерам
+ * @param allowedCollisions матрица разрешённых столкновений
+ */
+void SolidSyncCollider::setAllowedCollisionMatrix(const AllowedCollisionMatrix &allowedCollisions) {
+    std::lock_guard<std::mutex> lock(_registryMutex);
+    _allowedCollisions = allowedCollisions;
+    for (auto &collider: _getLiveColliders())
+        collider->setAllowedCollisionMatrix(allowedCollisions);
+}
+
+/**
+ * получить коллайдер текущего потока, при первом обращении
+ * потока коллайдер создаётся и регистрируется
+ * @return коллайдер текущего потока
+ */
+std::shared_ptr<SolidCollider> SolidSyncCollider::_getCollider() {
+    // коллайдеры потока, ключ - идентификатор многопоточного коллайдера
+    auto &threadColliders = _getThreadColliders();
+    auto it = threadColliders.find(_instanceId);
+    if (it != threadColliders.end() && it->second.generation == _generation)
+        return it->second.collider;
+    return _createCollider();
+}
+
+/**
+ * создать коллайдер текущего потока и добавить его в реестр
+ * @return коллайдер текущего потока
+ */
+std::shared_ptr<SolidCollider> SolidSyncCollider::_createCollider() {
+    auto &threadColliders = _getThreadColliders();
+    // удаляем коллайдеры, принадлежащие уже удалённым многопоточным коллайдерам
+    for (auto it = threadColliders.begin(); it != threadColliders.end();)
+        if (it->second.owner.expired())
+            it = threadColliders.erase(it);
+        else
+            it++;
+
+    std::lock_guard<std::mutex> lock(_registryMutex);
+    // удаляем ссылки на коллайдеры завершившихся потоков
+    _colliders.erase(std::remove_if(_colliders.begin(), _colliders.end(),
+                                    [](const std::weak_ptr<SolidCollider> &collider) {
+                                        return collider.expired();
+                                    }), _colliders.end());
+
+    auto collider = std::make_shared<SolidCollider>();
+    collider->init(_groupedModelPaths, false);
+    collider->setBroadPhase(_broadPhase);
+    collider->setAllowedCollisionMatrix(_allowedCollisions);
+    _colliders.emplace_back(collider);
+    threadColliders[_instanceId] = ThreadCollider{_aliveToken, _generation, collider};
+    return collider;
+}
+
+/**
+ * получить коллайдеры ещё работающих потоков, мьютекс реестра
+ * должен быть заблокирован вызывающим кодом
+ * @return коллайдеры потоков
+ */
+std::vector<std::shared_ptr<SolidCollider>> SolidSyncCollider::_getLiveColliders() const {
+    std::vector<std::shared_ptr<SolidCollider>> colliders;
+    for (auto &weakCollider: _colliders)
+        if (auto collider = weakCollider.lock())
+            colliders.emplace_back(collider);
+    return colliders;
+}
+
+/**
+ * получить коллайдеры текущего потока
+ * @return словарь: ключ - идентификатор многопоточного коллайдера,
+ * значение - коллайдер потока
+ */
+std::unordered_map<unsigned long, SolidSyncCollider::ThreadCollider> &SolidSyncCollider::_getThreadColliders() {
+    static thread_local std::unordered_map<unsigned long, ThreadCollider> threadColliders;
+    return threadColliders;
 }
 
 /**
@@ -75,22 +184,6 @@ bool SolidSyncCollider::isCollided(std::vector<Eigen::Matrix4d> matrices) {
  * @param robotIndexes индексы роботов
  * @return флаг, соответствует ли состояние сцены столкновению
  */
-bool SolidSyncCollider::isCollided(std::vector<Eigen::Matrix4d> matrices, std::vector<int> robotIndexes) {
-    // повторяем, пока не будет выполнена проверка на
-    // том или ином коллайдере
-    while (true) {
-        // перебираем мьютексы и ищем свободный
-        for (unsigned i = 0; i < _mutexCnt; i++)
-            if (_colliderMutexes[i].try_lock()) {
-                // если получилось его заблокировать, запускаем проверку
-                // на соответствующем коллайдере
-                bool result = _colliders.at(i)->isCollided(matrices, robotIndexes);
-                // освобождаем мьютекс
-                _colliderMutexes[i].unlock();
-                // возвращаем результат проверки
-                return result;
-            }
-        // делаем паузу в одну микросекунду
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
-    }
+bool SolidSyncCollider::isCollided(const std::vector<Eigen::Matrix4d> &matrices, const std::vector<int> &robotIndexes) {
+    return _getCollider()->isCollided(matrices, robotIndexes);
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "solid_sync_collider.h"
 
 
-void test1(const std::shared_ptr<bmpf::Collider> &sc) {
+std::vector<Eigen::Matrix4d> getFreeMatrices() {
 
     Eigen::Matrix4d m1;
     m1 << 0.00079696, -0.000795692, -0.999999, 0,
@@ -42,12 +42,10 @@ void test1(const std::shared_ptr<bmpf::Collider> &sc) {
             0.999995, 0.00318593, -0.000798223, -1.19968,
             0, 0, 0, 1;
 
-    std::vector<Eigen::Matrix4d> matrices{m1, m2, m3, m4, m5, m6, m7};
-
-    assert(!sc->isCollided(matrices));
+    return {m1, m2, m3, m4, m5, m6, m7};
 }
 
-void test2(const std::shared_ptr<bmpf::Collider> &sc) {
+std::vector<Eigen::Matrix4d> getCollidedMatrices() {
 
     Eigen::Matrix4d m1;
     m1 << 0.00079696, -0.000795692, -0.999999, 0,
@@ -89,8 +87,192 @@ void test2(const std::shared_ptr<bmpf::Collider> &sc) {
             0.266727, 0.00260262, -0.963769, -0.373068,
             0, 0, 0, 1;
 
-    std::vector<Eigen::Matrix4d> matrices{m1, m2, m3, m4, m5, m6, m7};
-    assert(sc->isCollided(matrices));
+    return {m1, m2, m3, m4, m5, m6, m7};
+}
+
+void test1(const std::shared_ptr<bmpf::Collider> &sc) {
+    assert(!sc->isCollided(getFreeMatrices()));
+}
+
+void test2(const std::shared_ptr<bmpf::Collider> &sc) {
+    assert(sc->isCollided(getCollidedMatrices()));
+}
+
+/**
+ * пакетная проверка должна совпадать с проверкой каждого состояния по отдельности
+ */
+void test3(const std::shared_ptr<bmpf::Collider> &sc) {
+    std::vector<Eigen::Matrix4d> free = getFreeMatrices();
+    std::vector<Eigen::Matrix4d> collided = getCollidedMatrices();
+
+    std::vector<bool> expected;
+    std::vector<Eigen::Matrix4d> matrices;
+    for (unsigned long i = 0; i < 25; i++) {
+        bool isCollided = i % 3 == 1;
+        const std::vector<Eigen::Matrix4d> &state = isCollided ? collided : free;
+        matrices.insert(matrices.end(), state.begin(), state.end());
+        expected.push_back(isCollided);
+    }
+
+    assert(sc->areCollided(matrices, expected.size()) == expected);
+    assert(sc->areCollided({}, 0).empty());
+
+    bool thrown = false;
+    try {
+        sc->areCollided(matrices, expected.size() + 1);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+/**
+ * отсечение пар по ограничивающим параллелепипедам не должно менять результат проверки
+ */
+void test4(const std::shared_ptr<bmpf::SolidCollider> &sc) {
+    sc->setBroadPhase(false);
+    bool freeAllPairs = sc->isCollided(getFreeMatrices());
+    bool collidedAllPairs = sc->isCollided(getCollidedMatrices());
+
+    sc->setBroadPhase(true);
+    sc->resetPairCounters();
+    assert(sc->isCollided(getFreeMatrices()) == freeAllPairs);
+    // для состояния без коллизий каждая пара либо проверена, либо отсечена
+    assert(sc->getTestedPairCnt() + sc->getCulledPairCnt() == sc->getCheckedPairCnt());
+    assert(sc->getCulledPairCnt() > 0);
+
+    assert(sc->isCollided(getCollidedMatrices()) == collidedAllPairs);
+    assert(sc->getTestedPairCnt() + sc->getCulledPairCnt() <= 2 * sc->getCheckedPairCnt());
+}
+
+void test5(const std::shared_ptr<bmpf::Collider> &sc, unsigned long linkCnt) {
+    auto collidedPairs = sc->getCollidedPairs(getCollidedMatrices());
+    assert(!collidedPairs.empty());
+    assert(sc->getCollidedPairs(getFreeMatrices()).empty());
+
+    // разрешаем все пересекающиеся пары, после этого состояние считается свободным
+    bmpf::AllowedCollisionMatrix allowedCollisions(linkCnt);
+    for (auto &pair: collidedPairs) {
+        assert(pair.first < pair.second);
+        allowedCollisions.allow(pair.first, pair.second);
+        assert(allowedCollisions.isAllowed(pair.second, pair.first));
+    }
+    sc->setAllowedCollisionMatrix(allowedCollisions);
+    assert(!sc->isCollided(getCollidedMatrices()));
+    // список пар не зависит от матрицы разрешённых столкновений
+    assert(sc->getCollidedPairs(getCollidedMatrices()) == collidedPairs);
+
+    // пустая матрица сбрасывает разрешённые пары
+    sc->setAllowedCollisionMatrix(bmpf::AllowedCollisionMatrix());
+    assert(sc->isCollided(getCollidedMatrices()));
+
+    try {
+        allowedCollisions.allow(0, linkCnt);
+        assert(false);
+    } catch (std::invalid_argument &e) {
+    }
+}
+
+void test6(const std::string &path) {
+    // модель загружается с диска один раз, в том числе по другому пути к тому же файлу
+    std::shared_ptr<bmpf::StlShape> shape = bmpf::StlShape::fromStlFile(path);
+    assert(bmpf::StlShape::fromStlFile(path) == shape);
+    std::string otherPath = path.substr(0, path.find_last_of('/')) + "/." + path.substr(path.find_last_of('/'));
+    assert(bmpf::StlShape::fromStlFile(otherPath) == shape);
+
+    bmpf::StlShape::clearCache();
+    assert(bmpf::StlShape::fromStlFile(path) != shape);
+}
+
+void test7(const std::shared_ptr<bmpf::SolidSyncCollider> &sc, const std::vector<std::vector<std::string>> &paths) {
+    const unsigned int threadCnt = 8;
+    unsigned long colliderCnt = sc->getColliderCnt();
+    std::vector<char> results(threadCnt, 1);
+    std::atomic<unsigned int> checkedThreadCnt{0};
+    std::atomic<bool> released{false};
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadCnt; i++)
+        threads.emplace_back([&sc, &results, &checkedThreadCnt, &released, i] {
+            for (int j = 0; j < 20; j++)
+                if (sc->isCollided(getFreeMatrices()) || !sc->isCollided(getCollidedMatrices()))
+                    results[i] = 0;
+            // потоки не завершаются, пока не будут посчитаны их коллайдеры
+            checkedThreadCnt++;
+            while (!released)
+                std::this_thread::yield();
+        });
+    while (checkedThreadCnt < threadCnt)
+        std::this_thread::yield();
+
+    // каждый поток получил собственный коллайдер
+    assert(sc->getColliderCnt() == colliderCnt + threadCnt);
+
+    released = true;
+    for (auto &thread: threads)
+        thread.join();
+
+    for (char result: results)
+        assert(result);
+    // коллайдеры завершившихся потоков удалены вместе с потоками
+    assert(sc->getColliderCnt() == colliderCnt);
+
+    // повторная инициализация сбрасывает коллайдеры потоков
+    sc->init(paths, false);
+    assert(sc->getColliderCnt() == 0);
+    assert(sc->isCollided(getCollidedMatrices()));
+    assert(sc->getColliderCnt() == 1);
+}
+
+/**
+ * после повторной инициализации пакетная проверка в потоках пула
+ * выполняется по новой сцене
+ */
+void test8(const std::shared_ptr<bmpf::SolidSyncCollider> &sc, const std::vector<std::vector<std::string>> &paths) {
+    std::vector<Eigen::Matrix4d> collided = getCollidedMatrices();
+    // потоки пула получают коллайдеры полной сцены
+    assert(sc->areCollided(collided, 1) == std::vector<bool>{true});
+
+    // сцена только из первых звеньев робота
+    const unsigned long linkCnt = 3;
+    std::vector<std::vector<std::string>> subPaths{
+            {paths.front().begin(), paths.front().begin() + linkCnt}
+    };
+    sc->init(subPaths, false);
+
+    std::vector<Eigen::Matrix4d> matrices;
+    std::vector<bool> expected;
+    for (unsigned long i = 0; i < 8; i++) {
+        const std::vector<Eigen::Matrix4d> state = i % 2 ? getCollidedMatrices() : getFreeMatrices();
+        std::vector<Eigen::Matrix4d> subState(state.begin(), state.begin() + linkCnt);
+        matrices.insert(matrices.end(), subState.begin(), subState.end());
+        expected.push_back(sc->isCollided(subState));
+    }
+    assert(sc->areCollided(matrices, expected.size()) == expected);
+
+    // матрицы прежней сцены больше не подходят
+    bool thrown = false;
+    try {
+        sc->areCollided(collided, 1);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    sc->init(paths, false);
+}
+
+/**
+ * ограничивающий параллелепипед объекта не зависит от предыдущей
+ * проверки: матрицы задаются всем звеньям объекта, включая последнее
+ */
+void test9(const std::shared_ptr<bmpf::Collider> &sc) {
+    assert(!sc->isCollided(getFreeMatrices()));
+    std::vector<double> boxAfterFree = sc->getBoxCoords(0, getCollidedMatrices());
+
+    assert(sc->isCollided(getCollidedMatrices()));
+    std::vector<double> boxAfterCollided = sc->getBoxCoords(0, getCollidedMatrices());
+
+    assert(boxAfterFree == boxAfterCollided);
 }
 
 int main() {
@@ -111,11 +293,27 @@ int main() {
     sc->init(paths, false);
     test1(sc);
     test2(sc);
+    test3(sc);
+    test9(sc);
+
+    std::shared_ptr<bmpf::SolidCollider> sc3 = std::make_shared<bmpf::SolidCollider>();
+    sc3->init(paths, false);
+    test4(sc3);
+    test5(sc3, paths.front().size());
 
     std::shared_ptr<bmpf::Collider> sc2 = std::make_shared<bmpf::SolidSyncCollider>(10);
     sc2->init(paths, false);
     test1(sc2);
     test2(sc2);
+    test3(sc2);
+    test5(sc2, paths.front().size());
+
+    test6(paths.front().front());
+
+    std::shared_ptr<bmpf::SolidSyncCollider> sc4 = std::make_shared<bmpf::SolidSyncCollider>(4);
+    sc4->init(paths, false);
+    test7(sc4, paths);
+    test8(sc4, paths);
 
     return 0;
 }
\ No newline at end of file
@@ -209,7 +209,7 @@ namespace bmpf {
                 0,
                 0,
                 0,
-                1;
+                0;
         return rotM;
     }
 
@@ -226,10 +226,22 @@ namespace bmpf {
         double z = axis(2);
         Eigen::Matrix4d rotM;
 
-        rotM << 2 * x * sin(theta), y * sin(theta), z * sin(theta), 0,
-                y * sin(theta), 0, -cos(theta), 0,
-                z * sin(theta), cos(theta), 0, 0,
-                0, 0, 0, 1;
+        rotM << cos(theta) * x * x - cos(theta),
+                x * y * cos(theta) + z * sin(theta),
+                x * z * cos(theta) - y * sin(theta),
+                0,
+                x * y * cos(theta) - z * sin(theta),
+                cos(theta) * y * y - cos(theta),
+                y * z * cos(theta) + x * sin(theta),
+                0,
+                x * z * cos(theta) + y * sin(theta),
+                y * z * cos(theta) - x * sin(theta),
+                cos(theta) * z * z - cos(theta),
+                0,
+                0,
+                0,
+                0,
+                0;
         return rotM;
     }
 
@@ -261,4 +273,38 @@ namespace bmpf {
         return R;
     }
 
+    /**
+     * @brief произведение аффинных матриц трансформации
+     * произведение матриц трансформации, нижние строки которых равны (0, 0, 0, 1):
+     * перемножаются только верхние блоки 3x4, а нижняя строка результата
+     * задаётся явно, поэтому умножений почти в два раза меньше, чем у
+     * произведения матриц общего вида
+     * @param a левая матрица
+     * @param b правая матрица
+     * @return произведение a * b
+     */
+    static Eigen::Matrix4d affineProduct(const Eigen::Matrix4d &a, const Eigen::Matrix4d &b) {
+        Eigen::Matrix4d m;
+        m.topLeftCorner<3, 4>().noalias() = a.topLeftCorner<3, 3>() * b.topLeftCorner<3, 4>();
+        m.topRightCorner<3, 1>() += a.topRightCorner<3, 1>();
+        m.row(3) << 0, 0, 0, 1;
+        return m;
+    }
+
+    /**
+     * @brief произведение аффинной матрицы трансформации на матрицу поворота
+     * произведение аффинной матрицы трансформации на матрицу поворота справа:
+     * перенос при этом не меняется
+     * @param a аффинная матрица трансформации
+     * @param rot матрица поворота 3x3
+     * @return произведение a * rot
+     */
+    static Eigen::Matrix4d affineRotProduct(const Eigen::Matrix4d &a, const Eigen::Matrix3d &rot) {
+        Eigen::Matrix4d m;
+        m.topLeftCorner<3, 3>().noalias() = a.topLeftCorner<3, 3>() * rot;
+        m.topRightCorner<3, 1>() = a.topRightCorner<3, 1>();
+        m.row(3) << 0, 0, 0, 1;
+        return m;
+    }
+
 }
\ No newline at end of file
@@ -34,6 +34,15 @@ namespace bmpf {
      */
     std::vector<int> sumStates(const std::vector<int> &a, const std::vector<int> &b);
 
+    /**
+     * сложить состояния, записав сумму в заранее созданный вектор
+     * (если его размер совпадает с размером состояний, память не выделяется)
+     * @param a первое состояние
+     * @param b второе состояние
+     * @param result сумма
+     */
+    void sumStates(const std::vector<int> &a, const std::vector<int> &b, std::vector<int> &result);
+
     /**
      * скалярно умножить первое состояние на второе
      * @param a первое состояние
@@ -79,14 +88,6 @@ namespace bmpf {
      */
     void errState(const char *caption, const std::vector<double> &state);
 
-    /**
-     * свернуть координаты coords в скаляр (size - размер СК)
-     * @param coords координаты
-     * @param size размер вдоль каждой оси
-     * @return свёртка
-     */
-    unsigned long convState(std::vector<int> &coords, int size);
-
     /**
      * квадрат расстояния между двумя состояниями (сумма квадратов разностей соответствующих координат)
      * @param a первое состояние
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bmpf {
+    /**
+     * @brief Пул потоков с перехватом задач
+     *
+     * Пул создаёт заданное число рабочих потоков один раз и держит их
+     * до своего уничтожения. У каждого потока своя очередь задач, новые
+     * задачи раскладываются по очередям по кругу. Поток берёт задачи из
+     * начала своей очереди, а когда она пуста - перехватывает задачи
+     * из конца чужих очередей. Если задач нет, поток засыпает на
+     * условной переменной.
+     *
+     * Для ожидания пакета задач используется `CountDownLatch`
+     * (см. `parallelFor`)
+     */
+    class ThreadPool {
+    public:
+        /**
+         * конструктор
+         * @param threadCnt количество рабочих потоков
+         */
+        explicit ThreadPool(unsigned int threadCnt);
+
+        /**
+         * деструктор, дожидается выполнения всех поставленных задач
+         * и завершает рабочие потоки
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * поставить задачу в очередь, задача не должна бросать исключений
+         * (исключения вызовов `parallelFor` перехватываются самим `parallelFor`)
+         * @param task задача
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * выполнить task(0), ..., task(taskCnt-1) в рабочих потоках пула
+         * и дождаться завершения всех вызовов; если вызовы бросили
+         * исключения, после завершения всех вызовов пробрасывается первое из них
+         * @param taskCnt количество вызовов
+         * @param task задача, принимающая номер вызова
+         */
+        void parallelFor(unsigned long taskCnt, const std::function<void(unsigned long)> &task);
+
+    private:
+        /**
+         * очередь задач рабочего потока
+         */
+        struct WorkerQueue {
+            /**
+             * мьютекс очереди
+             */
+            std::mutex mtx;
+            /**
+             * задачи
+             */
+            std::deque<std::function<void()>> tasks;
+        };
+
+        /**
+         * попытаться взять задачу: сначала из начала своей очереди,
+         * потом из конца чужих
+         * @param index номер рабочего потока
+         * @param task в эту переменную записывается задача
+         * @return флаг, удалось ли взять задачу
+         */
+        bool _tryPop(unsigned int index, std::function<void()> &task);
+
+        /**
+         * цикл рабочего потока
+         * @param index номер рабочего потока
+         */
+        void _workerLoop(unsigned int index);
+
+        /**
+         * очереди задач рабочих потоков
+         */
+        std::vector<std::unique_ptr<WorkerQueue>> _queues;
+        /**
+         * рабочие потоки
+         */
+        std::vector<std::thread> _workers;
+        /**
+         * мьютекс ожидания задач
+         */
+        std::mutex _sleepMtx;
+        /**
+         * условная переменная ожидания задач
+         */
+        std::condition_variable _sleepCv;
+        /**
+         * количество поставленных, но ещё не взятых задач
+         */
+        std::atomic<unsigned long> _pendingCnt{0};
+        /**
+         * номер очереди, в которую будет поставлена следующая задача
+         */
+        std::atomic<unsigned int> _nextQueue{0};
+        /**
+         * флаг, нужно ли завершить рабочие потоки
+         */
+        bool _stopped = false;
+
+    public:
+        /**
+         * получить количество рабочих потоков
+         * @return количество рабочих потоков
+         */
+        unsigned int getThreadCnt() const { return (unsigned int) _workers.size(); }
+    };
+}
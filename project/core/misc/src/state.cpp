@@ -143,6 +143,29 @@ std::vector<int> bmpf::sumStates(const std::vector<int> &a, const std::vector<in
     return result;
 }
 
+/**
+ * сложить состояния, записав сумму в заранее созданный вектор
+ * (если его размер совпадает с размером состояний, память не выделяется)
+ * @param a первое состояние
+ * @param b второе состояние
+ * @param result сумма
+ */
+void bmpf::sumStates(const std::vector<int> &a, const std::vector<int> &b, std::vector<int> &result) {
+    if (a.size() != b.size()) {
+        char buf[1024];
+        sprintf(buf,
+                "sumStates() ERROR: \n state A size is %zu, but state B size is %zu"
+                "\nthey must be equal",
+                a.size(), b.size()
+        );
+        throw std::invalid_argument(buf);
+    }
+    unsigned long size = a.size();
+    result.resize(size);
+    for (unsigned int i = 0; i < size; i++)
+        result[i] = a[i] + b[i];
+}
+
 /**
  * вычесть из первого состояния второе
  * @param a первое состояние
@@ -204,22 +227,6 @@ void bmpf::infoState(const char *caption, const std::vector<int> &state) {
     infoMsg(msg);
 }
 
-/**
- * свернуть координаты coords в скаляр (size - размер СК)
- * @param coords координаты
- * @param size размер вдоль каждой оси
- * @return свёртка
- */
-unsigned long bmpf::convState(std::vector<int> &coords, int size) {
-    unsigned long code = 0;
-    int m = 1;
-    for (int coord: coords) {
-        code += m * coord;
-        m *= size;
-    }
-    return code;
-}
-
 /**
  * квадрат расстояния между двумя состояниями (сумма квадратов разностей соответствующих координат)
  * @param a первое состояние
@@ -0,0 +1,146 @@
+#include "thread_pool.h"
+#include "count_down_latch.h"
+
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+using namespace bmpf;
+
+/**
+ * конструктор
+ * @param threadCnt количество рабочих потоков
+ */
+ThreadPool::ThreadPool(unsigned int threadCnt) {
+    if (threadCnt == 0)
+        throw std::invalid_argument("ThreadPool::ThreadPool() ERROR: \n thread count must be positive");
+
+    for (unsigned int i = 0; i < threadCnt; i++)
+        _queues.emplace_back(new WorkerQueue());
+
+    for (unsigned int i = 0; i < threadCnt; i++)
+        _workers.emplace_back(&ThreadPool::_workerLoop, this, i);
+}
+
+/**
+ * деструктор, дожидается выполнения всех поставленных задач
+ * и завершает рабочие потоки
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lck(_sleepMtx);
+        _stopped = true;
+    }
+    _sleepCv.notify_all();
+
+    for (auto &worker: _workers)
+        worker.join();
+}
+
+/**
+ * поставить задачу в очередь, задача не должна бросать исключений
+ * (исключения вызовов `parallelFor` перехватываются самим `parallelFor`)
+ * @param task задача
+ */
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        // счётчик меняется под мьютексом ожидания, чтобы
+        // уведомление не потерялось между проверкой и засыпанием потока;
+        // он увеличивается до постановки задачи в очередь, иначе рабочий
+        // поток может взять задачу и уменьшить счётчик раньше, чем тот
+        // будет увеличен
+        std::unique_lock<std::mutex> lck(_sleepMtx);
+        _pendingCnt++;
+    }
+    unsigned int index = _nextQueue.fetch_add(1) % (unsigned int) _queues.size();
+    {
+        std::unique_lock<std::mutex> lck(_queues[index]->mtx);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    _sleepCv.notify_one();
+}
+
+/**
+ * выполнить task(0), ..., task(taskCnt-1) в рабочих потоках пула
+ * и дождаться завершения всех вызовов; если вызовы бросили
+ * исключения, после завершения всех вызовов пробрасывается первое из них
+ * @param taskCnt количество вызовов
+ * @param task задача, принимающая номер вызова
+ */
+void ThreadPool::parallelFor(unsigned long taskCnt, const std::function<void(unsigned long)> &task) {
+    if (taskCnt == 0)
+        return;
+
+    CountDownLatch latch((int) taskCnt);
+    std::exception_ptr exception;
+    std::mutex exceptionMtx;
+    for (unsigned long i = 0; i < taskCnt; i++)
+        submit([&task, &latch, &exception, &exceptionMtx, i] {
+            // исключение не должно покидать рабочий поток: это вызовет
+            // std::terminate, а защёлка так и не дождётся вызова
+            try {
+                task(i);
+            } catch (...) {
+                std::unique_lock<std::mutex> lck(exceptionMtx);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+            latch.countDown();
+        });
+
+    latch.await();
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+/**
+ * попытаться взять задачу: сначала из начала своей очереди,
+ * потом из конца чужих
+ * @param index номер рабочего потока
+ * @param task в эту переменную записывается задача
+ * @return флаг, удалось ли взять задачу
+ */
+bool ThreadPool::_tryPop(unsigned int index, std::function<void()> &task) {
+    {
+        std::unique_lock<std::mutex> lck(_queues[index]->mtx);
+        if (!_queues[index]->tasks.empty()) {
+            task = std::move(_queues[index]->tasks.front());
+            _queues[index]->tasks.pop_front();
+            return true;
+        }
+    }
+
+    // перехватываем задачи у других потоков
+    for (unsigned int i = 1; i < _queues.size(); i++) {
+        WorkerQueue &queue = *_queues[(index + i) % _queues.size()];
+        std::unique_lock<std::mutex> lck(queue.mtx);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * цикл рабочего потока
+ * @param index номер рабочего потока
+ */
+void ThreadPool::_workerLoop(unsigned int index) {
+    std::function<void()> task;
+    while (true) {
+        if (_tryPop(index, task)) {
+            _pendingCnt--;
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lck(_sleepMtx);
+        _sleepCv.wait(lck, [this] { return _stopped || _pendingCnt > 0; });
+        if (_stopped && _pendingCnt == 0)
+            return;
+    }
+}
@@ -30,19 +30,50 @@ namespace bmpf {
          * Получить матрицу преобразования сочленения
          * @return матрица преобразования сочленения
          */
-        Eigen::Matrix4d getTransformMatrix() { return parentTransform * getRotMatrix4x4(axis, jointAngle); }
+        Eigen::Matrix4d getTransformMatrix() const { return getTransformMatrix(jointAngle); }
+
+        /**
+         * Получить матрицу преобразования сочленения при заданном угле поворота,
+         * сочленение при этом не меняется. Поворот не меняет перенос, поэтому
+         * перемножаются только блоки 3x3
+         * @param angle угол поворота
+         * @return матрица преобразования сочленения
+         */
+        Eigen::Matrix4d getTransformMatrix(double angle) const {
+            return affineRotProduct(parentTransform, getRotMatrix3x3(angle, axis));
+        }
+
+        /**
+         * Получить первую производную матрицы преобразования сочленения
+         * @return первая производную матрицы преобразования сочленения
+         */
+        Eigen::Matrix4d getDiffTransformMatrix() const { return getDiffTransformMatrix(jointAngle); }
 
         /**
          * Получить первую производную матрицы преобразования сочленения
+         * при заданном угле поворота
+         * @param angle угол поворота
          * @return первая производную матрицы преобразования сочленения
          */
-        Eigen::Matrix4d getDiffTransformMatrix() { return parentTransform * getDiffRotMatrix4x4(axis, jointAngle); }
+        Eigen::Matrix4d getDiffTransformMatrix(double angle) const {
+            return parentTransform * getDiffRotMatrix4x4(axis, angle);
+        }
+
+        /**
+         * Получить вторую производную матрицы преобразования сочленения
+         * @return вторая производную матрицы преобразования сочленения
+         */
+        Eigen::Matrix4d getDiff2TransformMatrix() const { return getDiff2TransformMatrix(jointAngle); }
 
         /**
          * Получить вторую производную матрицы преобразования сочленения
+         * при заданном угле поворота
+         * @param angle угол поворота
          * @return вторая производную матрицы преобразования сочленения
          */
-        Eigen::Matrix4d getDiff2TransformMatrix() { return parentTransform * getDiff2RotMatrix4x4(axis, jointAngle); }
+        Eigen::Matrix4d getDiff2TransformMatrix(double angle) const {
+            return parentTransform * getDiff2RotMatrix4x4(axis, angle);
+        }
 
         /**
          * получить ось вращения сочленения
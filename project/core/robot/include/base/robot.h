@@ -42,21 +42,83 @@ namespace bmpf {
          * @param state состояние
          * @return список осей вращения сочленений робота
          */
-        virtual std::vector<Eigen::Vector3d> getJointAxes(std::vector<double> state);
+        virtual std::vector<Eigen::Vector3d> getJointAxes(const std::vector<double> &state) const;
 
         /**
          * получить список матриц преобразований всех звеньев по состоянию
          * @param state состояние
          * @return список матриц преобразований
          */
-        virtual std::vector<Eigen::Matrix4d> getTransformMatrices(std::vector<double> state);
+        virtual std::vector<Eigen::Matrix4d> getTransformMatrices(const std::vector<double> &state) const;
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев в буфер
+         * записать матрицы преобразований всех звеньев по состоянию в буфер,
+         * предоставленный вызывающим кодом. Метод не меняет робота, поэтому его
+         * можно вызывать одновременно из нескольких потоков
+         * @param state состояние, должно содержать getJointCnt() координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         */
+        void fillTransformMatrices(const double *state, Eigen::Matrix4d *matrices) const;
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев и префиксные матрицы цепи
+         * записать матрицы преобразований всех звеньев по состоянию в буфер
+         * и сохранить префиксные матрицы цепи: i-я префиксная матрица - это
+         * преобразование из СК мира в СК i-го сочленения цепи с учётом его поворота.
+         * Префиксные матрицы позволяют потом инкрементально пересчитывать
+         * кинематику для близких состояний
+         * @param state состояние, должно содержать getJointCnt() координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         * @param prefixes префиксные матрицы цепи
+         */
+        void fillTransformMatrices(
+                const double *state, Eigen::Matrix4d *matrices, std::vector<Eigen::Matrix4d> &prefixes
+        ) const;
+
+        /**
+         * @brief инкрементально записать матрицы преобразований всех звеньев
+         * записать матрицы преобразований всех звеньев по состоянию в буфер,
+         * используя кинематику базового состояния: сочленения цепи до первой
+         * изменившейся координаты не пересчитываются, их матрицы копируются
+         * @param state состояние, должно содержать getJointCnt() координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         * @param baseState базовое состояние
+         * @param basePrefixes префиксные матрицы цепи базового состояния
+         * @param baseMatrices матрицы преобразований звеньев базового состояния
+         */
+        void fillTransformMatrices(
+                const double *state, Eigen::Matrix4d *matrices, const double *baseState,
+                const std::vector<Eigen::Matrix4d> &basePrefixes, const Eigen::Matrix4d *baseMatrices
+        ) const;
+
+        /**
+         * @brief пакетно записать матрицы преобразований всех звеньев
+         * записать матрицы преобразований всех звеньев для пакета состояний.
+         * Состояния передаются по координатам (structure of arrays): i-я координата
+         * s-го состояния лежит в states[i * stateStride + s]. Состояния обрабатываются
+         * блоками фиксированной ширины: синусы и косинусы углов и произведения
+         * аффинных матриц 3x4 считаются во внутренних циклах по состояниям блока,
+         * которые компилятор векторизует. Метод не меняет робота, поэтому его
+         * можно вызывать одновременно из нескольких потоков
+         * @param states координаты состояний
+         * @param stateCnt количество состояний
+         * @param stateStride расстояние между соседними координатами одного состояния
+         * @param matrices буфер, матрицы s-го состояния записываются
+         * подряд, начиная с matrices + s * matrixStride
+         * @param matrixStride расстояние между матрицами соседних состояний
+         */
+        void fillBatchTransformMatrices(
+                const double *states, unsigned long stateCnt, unsigned long stateStride,
+                Eigen::Matrix4d *matrices, unsigned long matrixStride
+        ) const;
 
         /**
          * получить матрицу преобразования из СК базы робота в СК рабочего инструмента по состоянию
          * @param state  состояние
          * @return матрица преобразования
          */
-        virtual Eigen::Matrix4d getEndEffectorTransformMatrix(std::vector<double> state);
+        virtual Eigen::Matrix4d getEndEffectorTransformMatrix(const std::vector<double> &state) const;
 
         /**
          * Получить частную производную по i-ой координате матрицы преобразования
@@ -66,7 +128,7 @@ namespace bmpf {
          * @param iVal индекс координаты, по которой берётся производная
          * @return частная производная по i-ой координате
          */
-        Eigen::Matrix4d getEndEffectorDiffTransformMatrix(std::vector<double> state, int iVal);
+        Eigen::Matrix4d getEndEffectorDiffTransformMatrix(const std::vector<double> &state, int iVal) const;
 
         /**
          * Получить частную производную по i-ой и j-ой координатам матрицы преобразования
@@ -77,14 +139,14 @@ namespace bmpf {
          * @param jVal индекс координаты, по которой второй раз берётся производная
          * @return частная производная по i-ой и j-ой координатам
          */
-        Eigen::Matrix4d getEndEffectorDiff2TransformMatrix(std::vector<double> state, int iVal, int jVal);
+        Eigen::Matrix4d getEndEffectorDiff2TransformMatrix(const std::vector<double> &state, int iVal, int jVal) const;
 
         /**
          * проверка допустимости углов поворота сочленения (рассчитывается по ограничениям сочленений)
          * @param state состояние
          * @return флаг, допустим ли соответствующий набор углов поворота (конфигурация)
          */
-        bool isStateEnabled(std::vector<double> state);
+        bool isStateEnabled(const std::vector<double> &state) const;
 
         /**
          * получить смещение из СК мира в СК робота
@@ -122,6 +184,12 @@ namespace bmpf {
          */
         const std::shared_ptr<Eigen::Matrix4d> &getWorldTransformMatrix() const { return _worldTransformMatrix; }
 
+        /**
+         * получить поворот из СК мира в СК робота без масштабирования
+         * @return матрица поворота из СК мира в СК робота
+         */
+        const Eigen::Matrix3d &getWorldRotationMatrix() const { return _worldRotationMatrix; }
+
         /**
          * получить кол-во сочленений робота
          * @return
@@ -159,6 +227,18 @@ namespace bmpf {
          */
         std::vector<std::shared_ptr<Link>> getLinks() const { return _links; }
 
+        /**
+         * получить список сочленений робота
+         * @return список сочленений робота
+         */
+        const std::vector<std::shared_ptr<Joint>> &getJoints() const { return _joints; }
+
+        /**
+         * получить список звеньев робота, не участвующих в иерархии
+         * @return список звеньев робота, не участвующих в иерархии
+         */
+        const std::vector<std::shared_ptr<Link>> &getNonHierarchicalLinks() const { return _nonHierarchicalLinks; }
+
         /**
          * получить путь к описанию робота
          * @return путь к описанию робота
@@ -200,7 +280,7 @@ namespace bmpf {
          * @param state состояние
          * @return положение рабочего инструмента
          */
-        std::vector<double> getEndEffectorPos(std::vector<double> state);
+        std::vector<double> getEndEffectorPos(const std::vector<double> &state) const;
 
         /**
          * получить частную производную положения энд-эффектора робота по i-ой координате
@@ -208,7 +288,7 @@ namespace bmpf {
          * @param iVal индекс координаты, по которой берётся производная
          * @return
          */
-        std::vector<double> getEndEffectorDiffPos(std::vector<double> state, int iVal);
+        std::vector<double> getEndEffectorDiffPos(const std::vector<double> &state, int iVal) const;
 
         /**
          * получить частную производную положения энд-эффектора робота по i-ой и j-ой координатам
@@ -217,14 +297,43 @@ namespace bmpf {
          * @param jVal индекс координаты, по которой второй раз берётся производная
          * @return
          */
-        std::vector<double> getEndEffectorDiff2Pos(std::vector<double> state, int iVal, int jVal);
+        std::vector<double> getEndEffectorDiff2Pos(const std::vector<double> &state, int iVal, int jVal) const;
+
+        /**
+         * @brief получить геометрический якобиан рабочего инструмента
+         * получить геометрический якобиан рабочего инструмента за один проход по цепи:
+         * для каждого сочленения с приводом запоминаются его ось z_i и начало его СК p_i
+         * в СК робота, после чего i-й столбец якобиана равен (z_i x (p - p_i), z_i),
+         * где p - положение рабочего инструмента. В отличие от getEndEffectorDiffPos()
+         * цепь не пересчитывается для каждой координаты. В СК мира строки положения
+         * переводятся матрицей перехода вместе с масштабированием, поэтому они равны
+         * частным производным положения, а строки угловой скорости - только поворотом
+         * @param state состояние
+         * @return якобиан: первые три строки - частные производные положения рабочего
+         * инструмента, последние три - его угловая скорость, столбцы соответствуют координатам
+         */
+        Eigen::Matrix<double, 6, Eigen::Dynamic> getEndEffectorJacobian(const std::vector<double> &state) const;
+
+        /**
+         * @brief получить гессиан положения рабочего инструмента
+         * получить вторые частные производные положения рабочего инструмента по
+         * геометрическому якобиану: при i <= j частная производная i-го столбца
+         * по j-ой координате (и j-го по i-ой) равна z_i x Jv_j, где Jv_j - первые
+         * три строки j-го столбца якобиана в СК робота; в СК мира гессиан
+         * переводится матрицей перехода вместе с масштабированием
+         * @param state состояние
+         * @return три матрицы (для x, y и z) размера getJointCnt() x getJointCnt(),
+         * элемент (i, j) k-ой матрицы равен второй частной производной k-ой
+         * координаты положения по i-ой и j-ой координатам состояния
+         */
+        std::vector<Eigen::MatrixXd> getEndEffectorPosHessian(const std::vector<double> &state) const;
 
         /**
          * получить положение и ориентацию(задана параметрами Родриго-Гамильтона)
          * @param state состояние
          * @return положение и ориентацию(задана параметрами Родриго-Гамильтона)
          */
-        std::vector<double> getEndEffectorRGVector(std::vector<double> state);
+        std::vector<double> getEndEffectorRGVector(const std::vector<double> &state) const;
 
         /**
          *  получить частную производную положения и ориентации(задана параметрами
@@ -233,7 +342,7 @@ namespace bmpf {
          * @param iVal индекс координаты, по которой берётся производная
          * @return
          */
-        std::vector<double> getEndEffectorDiffRGVector(std::vector<double> state, int iVal);
+        std::vector<double> getEndEffectorDiffRGVector(const std::vector<double> &state, int iVal) const;
 
         /**
          * получить частную производную положения и ориентации(задана параметрами
@@ -243,21 +352,21 @@ namespace bmpf {
          * @param jVal индекс координаты, по которой второй раз берётся производная
          * @return
          */
-        std::vector<double> getEndEffectorDiff2RGVector(std::vector<double> state, int iVal, int jVal);
+        std::vector<double> getEndEffectorDiff2RGVector(const std::vector<double> &state, int iVal, int jVal) const;
 
         /**
          * получить положения всех звеньев
          * @param state  состояние
          * @return положения всех звеньев
          */
-        std::vector<double> getAllLinkPositions(std::vector<double> state);
+        std::vector<double> getAllLinkPositions(const std::vector<double> &state) const;
 
         /**
          * получить список положений(x,y,z) и ориентаций (параметры Родриго-Гамильтона) всех звеньев
          * @param state состояние
          * @return  положения всех звеньев
          */
-        std::vector<double> getAllLinkRGVectors(std::vector<double> state);
+        std::vector<double> getAllLinkRGVectors(const std::vector<double> &state) const;
 
         /**
          * получить список координат центров масс в СК базы
@@ -265,7 +374,7 @@ namespace bmpf {
          * @param state  состояние
          * @return  список координат центров масс
          */
-        std::vector<double> getMassCenterAbsolutePositions(std::vector<double> state);
+        std::vector<double> getMassCenterAbsolutePositions(const std::vector<double> &state);
 
         /**
          * получить список координат центров масс в СК соответствующих
@@ -292,6 +401,47 @@ namespace bmpf {
          */
         void _fillWorldTransformMatrix();
 
+        /**
+         * проверить, что состояние содержит координаты всех сочленений робота
+         * @param state состояние
+         */
+        void _checkStateSize(const std::vector<double> &state) const;
+
+        /**
+         * получить оси и начала СК сочленений с приводом в СК робота
+         * и положение рабочего инструмента за один проход по цепи
+         * @param state состояние
+         * @param axes в i-й столбец записывается ось i-го сочленения с приводом
+         * @param origins в i-й столбец записывается начало СК i-го сочленения с приводом
+         * @return положение рабочего инструмента
+         */
+        Eigen::Vector3d _getJointFrames(const double *state, Eigen::Matrix3Xd &axes, Eigen::Matrix3Xd &origins) const;
+
+        /**
+         * получить геометрический якобиан рабочего инструмента в СК робота
+         * (см. getEndEffectorJacobian())
+         * @param state состояние
+         * @return якобиан в СК робота
+         */
+        Eigen::Matrix<double, 6, Eigen::Dynamic> _getLocalJacobian(const double *state) const;
+
+        /**
+         * пересчитать матрицы преобразований звеньев цепи, начиная с сочленения firstJoint
+         * @param state состояние
+         * @param firstJoint индекс первого пересчитываемого сочленения цепи
+         * @param jointPos индекс координаты состояния, соответствующей сочленению firstJoint
+         * @param linkPos индекс звена, соответствующего сочленению firstJoint
+         * @param transformMatrix префиксная матрица сочленения, предшествующего firstJoint
+         * @param matrices буфер матриц преобразований звеньев
+         * @param prefixes буфер префиксных матриц цепи, если равен nullptr, то
+         * префиксные матрицы не сохраняются
+         * @return индекс звена, следующего за последним звеном цепи
+         */
+        unsigned long _fillChainMatrices(
+                const double *state, unsigned long firstJoint, unsigned long jointPos, unsigned long linkPos,
+                Eigen::Matrix4d transformMatrix, Eigen::Matrix4d *matrices, Eigen::Matrix4d *prefixes
+        ) const;
+
         /**
          * перебор матриц преобразования из СК мира в СК соответствующего звена,
          * при состоянии робота равном state
@@ -299,7 +449,7 @@ namespace bmpf {
          * @param consumer обработчик для каждой матрицы
          */
         template<typename F>
-        void _forEachJoint(std::vector<double> state, const F &consumer);
+        void _forEachJoint(const double *state, const F &consumer) const;
 
         /**
          * перебор матриц преобразования из СК мира в СК соответствующего звена,
@@ -310,7 +460,7 @@ namespace bmpf {
          * @param consumer обработчик для каждой матрицы
          */
         template<typename F>
-        void _forEachDiffJoint(std::vector<double> state, int iVal, const F &consumer);
+        void _forEachDiffJoint(const double *state, int iVal, const F &consumer) const;
 
         /**
          * перебор матриц преобразования из СК мира в СК соответствующего звена,
@@ -323,7 +473,7 @@ namespace bmpf {
          * @param consumer обработчик для каждой матрицы
          */
         template<typename F>
-        void _forEachDiff2Joint(std::vector<double> state, int iVal, int jVal, const F &consumer);
+        void _forEachDiff2Joint(const double *state, int iVal, int jVal, const F &consumer) const;
 
         /**
          * Сочленения робота
@@ -363,6 +513,10 @@ namespace bmpf {
          * матрица перехода из СК мира в СК робота
          */
         std::shared_ptr<Eigen::Matrix4d> _worldTransformMatrix;
+        /**
+         * поворот из СК мира в СК робота без масштабирования
+         */
+        Eigen::Matrix3d _worldRotationMatrix;
 
     };
 }
\ No newline at end of file
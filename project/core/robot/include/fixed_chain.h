@@ -0,0 +1,552 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <cstdio>
+#include <stdexcept>
+#include <Eigen/Dense>
+
+#include "base/robot.h"
+
+namespace bmpf {
+
+    /**
+     * @brief Базовый класс кинематических цепей с фиксированным числом сочленений
+     * Базовый класс нужен, чтобы сцена могла хранить цепи разной длины
+     * в одном списке: виртуальный вызов делается один раз на робота,
+     * сама кинематика внутри цепи обходится без динамических структур
+     */
+    class BaseFixedChain {
+    public:
+        /**
+         * Деструктор по умолчанию
+         */
+        virtual ~BaseFixedChain() = default;
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев в буфер
+         * записать матрицы преобразований всех звеньев по состоянию в буфер
+         * в том же порядке, что и BaseRobot::fillTransformMatrices()
+         * @param state состояние, должно содержать getJointCnt() координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         */
+        virtual void fillTransformMatrices(const double *state, Eigen::Matrix4d *matrices) const = 0;
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев и префиксные матрицы цепи
+         * записать матрицы преобразований всех звеньев по состоянию в буфер
+         * и сохранить префиксные матрицы цепи: k-я префиксная матрица - это
+         * преобразование из СК мира в СК k-го сочленения с приводом с учётом
+         * его поворота. Префиксные матрицы цепи отличаются от префиксных матриц
+         * BaseRobot, поэтому кэш, построенный цепью, читается только цепью
+         * @param state состояние, должно содержать getJointCnt() координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         * @param prefixes префиксные матрицы цепи
+         */
+        virtual void fillTransformMatrices(
+                const double *state, Eigen::Matrix4d *matrices, std::vector<Eigen::Matrix4d> &prefixes
+        ) const = 0;
+
+        /**
+         * @brief инкрементально записать матрицы преобразований всех звеньев
+         * записать матрицы преобразований всех звеньев по состоянию в буфер,
+         * используя кинематику базового состояния: сочленения до первой
+         * изменившейся координаты не пересчитываются, матрицы зависящих
+         * только от них звеньев копируются
+         * @param state состояние, должно содержать getJointCnt() координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         * @param baseState базовое состояние
+         * @param basePrefixes префиксные матрицы цепи базового состояния
+         * @param baseMatrices матрицы преобразований звеньев базового состояния
+         */
+        virtual void fillTransformMatrices(
+                const double *state, Eigen::Matrix4d *matrices, const double *baseState,
+                const std::vector<Eigen::Matrix4d> &basePrefixes, const Eigen::Matrix4d *baseMatrices
+        ) const = 0;
+
+        /**
+         * @brief пакетно записать матрицы преобразований всех звеньев
+         * записать матрицы преобразований всех звеньев для пакета состояний,
+         * расположение состояний и матриц такое же, как в
+         * BaseRobot::fillBatchTransformMatrices()
+         * @param states координаты состояний
+         * @param stateCnt количество состояний
+         * @param stateStride расстояние между соседними координатами одного состояния
+         * @param matrices буфер, матрицы s-го состояния записываются
+         * подряд, начиная с matrices + s * matrixStride
+         * @param matrixStride расстояние между матрицами соседних состояний
+         */
+        virtual void fillBatchTransformMatrices(
+                const double *states, unsigned long stateCnt, unsigned long stateStride,
+                Eigen::Matrix4d *matrices, unsigned long matrixStride
+        ) const = 0;
+
+        /**
+         * @brief получить геометрический якобиан рабочего инструмента
+         * получить геометрический якобиан рабочего инструмента
+         * (см. BaseRobot::getEndEffectorJacobian())
+         * @param state состояние, должно содержать getJointCnt() координат
+         * @return якобиан размера 6 x getJointCnt()
+         */
+        virtual Eigen::Matrix<double, 6, Eigen::Dynamic> getEndEffectorJacobian(const double *state) const = 0;
+
+        /**
+         * получить количество сочленений с приводом
+         * @return количество сочленений с приводом
+         */
+        virtual unsigned long getJointCnt() const = 0;
+
+        /**
+         * получить количество звеньев
+         * @return количество звеньев
+         */
+        virtual unsigned long getLinkCnt() const = 0;
+
+        /**
+         * @brief проверить, что цепь соответствует роботу
+         * проверить, что цепь построена по текущей матрице перехода из СК мира
+         * в СК робота: при изменении положения робота матрица пересоздаётся,
+         * а цепь хранит ссылку на прежнюю, поэтому сравнения указателей достаточно
+         * @param robot робот
+         * @return флаг, соответствует ли цепь роботу
+         */
+        bool isActual(const BaseRobot &robot) const {
+            return robot.getWorldTransformMatrix() == _worldTransformMatrix;
+        }
+
+    protected:
+        /**
+         * матрица перехода из СК мира в СК робота, по которой построена цепь
+         */
+        std::shared_ptr<Eigen::Matrix4d> _worldTransformMatrix;
+    };
+
+    /**
+     * @brief Кинематическая цепь с фиксированным числом сочленений
+     * Кинематическая цепь из N сочленений с приводом, построенная по уже
+     * загруженному роботу (URDF или DH). При построении все постоянные
+     * множители (матрица перехода из СК мира, фиксированные сочленения,
+     * матрицы сочленений до поворота и матрицы звеньев) перемножаются
+     * заранее, поэтому прямая кинематика - это ровно N произведений
+     * аффинных матриц в цикле с известным при компиляции числом итераций,
+     * который компилятор разворачивает. Состояния хранятся в std::array.
+     * Цепь - это снимок робота: если робот поменяется, цепь нужно построить заново
+     * @tparam N количество сочленений с приводом
+     */
+    template<unsigned long N>
+    class FixedChain : public BaseFixedChain {
+    public:
+        static_assert(N > 0, "FixedChain must contain at least one joint");
+
+        /**
+         * количество сочленений с приводом
+         */
+        static constexpr unsigned long JOINT_CNT = N;
+
+        /**
+         * состояние цепи
+         */
+        typedef std::array<double, N> State;
+
+        /**
+         * геометрический якобиан рабочего инструмента
+         */
+        typedef Eigen::Matrix<double, 6, (int) N> Jacobian;
+
+        /**
+         * Конструктор
+         * @param robot робот, у которого должно быть ровно N сочленений с приводом
+         */
+        explicit FixedChain(const BaseRobot &robot);
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев в буфер
+         * записать матрицы преобразований всех звеньев по состоянию в буфер
+         * в том же порядке, что и BaseRobot::fillTransformMatrices()
+         * @param state состояние, должно содержать N координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         */
+        void fillTransformMatrices(const double *state, Eigen::Matrix4d *matrices) const override;
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев и префиксные матрицы цепи
+         * (см. BaseFixedChain::fillTransformMatrices())
+         * @param state состояние, должно содержать N координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         * @param prefixes префиксные матрицы цепи, N матриц
+         */
+        void fillTransformMatrices(
+                const double *state, Eigen::Matrix4d *matrices, std::vector<Eigen::Matrix4d> &prefixes
+        ) const override;
+
+        /**
+         * @brief инкрементально записать матрицы преобразований всех звеньев
+         * (см. BaseFixedChain::fillTransformMatrices())
+         * @param state состояние, должно содержать N координат
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         * @param baseState базовое состояние
+         * @param basePrefixes префиксные матрицы цепи базового состояния
+         * @param baseMatrices матрицы преобразований звеньев базового состояния
+         */
+        void fillTransformMatrices(
+                const double *state, Eigen::Matrix4d *matrices, const double *baseState,
+                const std::vector<Eigen::Matrix4d> &basePrefixes, const Eigen::Matrix4d *baseMatrices
+        ) const override;
+
+        /**
+         * @brief пакетно записать матрицы преобразований всех звеньев
+         * (см. BaseFixedChain::fillBatchTransformMatrices())
+         * @param states координаты состояний
+         * @param stateCnt количество состояний
+         * @param stateStride расстояние между соседними координатами одного состояния
+         * @param matrices буфер, матрицы s-го состояния записываются
+         * подряд, начиная с matrices + s * matrixStride
+         * @param matrixStride расстояние между матрицами соседних состояний
+         */
+        void fillBatchTransformMatrices(
+                const double *states, unsigned long stateCnt, unsigned long stateStride,
+                Eigen::Matrix4d *matrices, unsigned long matrixStride
+        ) const override;
+
+        /**
+         * @brief получить геометрический якобиан рабочего инструмента
+         * (см. BaseFixedChain::getEndEffectorJacobian())
+         * @param state состояние, должно содержать N координат
+         * @return якобиан размера 6 x N
+         */
+        Eigen::Matrix<double, 6, Eigen::Dynamic> getEndEffectorJacobian(const double *state) const override {
+            State fixedState;
+            std::copy(state, state + N, fixedState.begin());
+            return getEndEffectorJacobian(fixedState);
+        }
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев в буфер
+         * @param state состояние
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         */
+        void fillTransformMatrices(const State &state, Eigen::Matrix4d *matrices) const {
+            fillTransformMatrices(state.data(), matrices);
+        }
+
+        /**
+         * получить матрицу преобразования из СК мира в СК рабочего инструмента
+         * @param state состояние
+         * @return матрица преобразования
+         */
+        Eigen::Matrix4d getEndEffectorTransformMatrix(const State &state) const;
+
+        /**
+         * @brief получить геометрический якобиан рабочего инструмента
+         * получить геометрический якобиан рабочего инструмента
+         * (см. BaseRobot::getEndEffectorJacobian())
+         * @param state состояние
+         * @return якобиан: первые три строки - частные производные положения
+         * рабочего инструмента, последние три - его угловая скорость
+         */
+        Jacobian getEndEffectorJacobian(const State &state) const;
+
+    private:
+        /**
+         * посчитать префиксные матрицы сочленений: k-я матрица - это
+         * преобразование из СК мира в СК k-го сочленения с учётом его поворота
+         * @param state состояние
+         * @param prefixes буфер из N префиксных матриц
+         * @param firstJoint номер первого пересчитываемого сочленения,
+         * префиксная матрица предыдущего сочленения должна быть уже записана
+         */
+        void _fillPrefixes(const double *state, Eigen::Matrix4d *prefixes, unsigned long firstJoint = 0) const;
+
+        /**
+         * записать матрицы звеньев по префиксным матрицам
+         * @param prefixes префиксные матрицы
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         */
+        void _fillLinkMatrices(const Eigen::Matrix4d *prefixes, Eigen::Matrix4d *matrices) const {
+            for (unsigned long i = 0; i < _linkJoints.size(); i++)
+                matrices[i] = _getLinkMatrix(i, prefixes);
+        }
+
+        /**
+         * получить матрицу звена по префиксным матрицам
+         * @param linkNum номер звена
+         * @param prefixes префиксные матрицы
+         * @return матрица преобразования звена
+         */
+        Eigen::Matrix4d _getLinkMatrix(unsigned long linkNum, const Eigen::Matrix4d *prefixes) const {
+            int jointNum = _linkJoints[linkNum];
+            if (jointNum < 0)
+                return _linkTransforms[linkNum];
+            return affineProduct(prefixes[jointNum], _linkTransforms[linkNum]);
+        }
+
+        /**
+         * постоянные матрицы сочленений: произведение всех постоянных
+         * множителей от предыдущего сочленения с приводом до поворота k-го сочленения
+         */
+        std::array<Eigen::Matrix4d, N> _jointTransforms;
+        /**
+         * оси вращения сочленений
+         */
+        std::array<Eigen::Vector3d, N> _axes;
+        /**
+         * номера сочленений с приводом, после которых стоят звенья,
+         * -1 - звено не зависит от состояния
+         */
+        std::vector<int> _linkJoints;
+        /**
+         * постоянные матрицы звеньев: произведение постоянных множителей
+         * от последнего перед звеном сочленения с приводом до СК звена
+         * (для звеньев, не зависящих от состояния, - полная матрица звена)
+         */
+        std::vector<Eigen::Matrix4d> _linkTransforms;
+        /**
+         * номер звена рабочего инструмента (последнего звена иерархии)
+         */
+        unsigned long _endEffectorLink;
+        /**
+         * поворот и масштабирование из СК мира в СК робота
+         */
+        Eigen::Matrix3d _worldMatrix;
+        /**
+         * обратная матрица к `_worldMatrix`
+         */
+        Eigen::Matrix3d _worldMatrixInverse;
+        /**
+         * поворот из СК мира в СК робота без масштабирования
+         */
+        Eigen::Matrix3d _worldRotationMatrix;
+
+    public:
+        /**
+         * получить количество сочленений с приводом
+         * @return количество сочленений с приводом
+         */
+        unsigned long getJointCnt() const override { return N; }
+
+        /**
+         * получить количество звеньев
+         * @return количество звеньев
+         */
+        unsigned long getLinkCnt() const override { return _linkJoints.size(); }
+    };
+
+    /**
+     * Конструктор
+     * @param robot робот, у которого должно быть ровно N сочленений с приводом
+     */
+    template<unsigned long N>
+    FixedChain<N>::FixedChain(const BaseRobot &robot) {
+        if (robot.getJointCnt() != N) {
+            char buf[1024];
+            sprintf(buf,
+                    "FixedChain::FixedChain() ERROR: \n robot joint count is %lu, but chain joint count is %lu",
+                    robot.getJointCnt(), N
+            );
+            throw std::invalid_argument(buf);
+        }
+
+        _worldTransformMatrix = robot.getWorldTransformMatrix();
+        _worldMatrix = _worldTransformMatrix->topLeftCorner<3, 3>();
+        _worldMatrixInverse = _worldMatrix.inverse();
+        _worldRotationMatrix = robot.getWorldRotationMatrix();
+
+        // произведение постоянных множителей с последнего сочленения с приводом
+        Eigen::Matrix4d pending = *_worldTransformMatrix;
+        int jointNum = -1;
+        for (const auto &jd: robot.getJoints()) {
+            if (jd->isFixed) {
+                pending = affineProduct(pending, jd->getTransformMatrix());
+            } else {
+                jointNum++;
+                _jointTransforms[jointNum] = affineProduct(pending, jd->parentTransform);
+                _axes[jointNum] = jd->axis;
+                pending = Eigen::Matrix4d::Identity();
+            }
+            if (!jd->isVirtual) {
+                _linkJoints.push_back(jointNum);
+                _linkTransforms.push_back(affineProduct(pending, jd->linkTransform));
+            }
+        }
+
+        if (_linkJoints.empty())
+            throw std::invalid_argument("FixedChain::FixedChain() ERROR: \n robot has no hierarchical links");
+        _endEffectorLink = _linkJoints.size() - 1;
+
+        for (const auto &link: robot.getNonHierarchicalLinks()) {
+            _linkJoints.push_back(-1);
+            _linkTransforms.push_back(affineProduct(*_worldTransformMatrix, *link->linkTransformMatrix));
+        }
+    }
+
+    /**
+     * посчитать префиксные матрицы сочленений: k-я матрица - это
+     * преобразование из СК мира в СК k-го сочленения с учётом его поворота
+     * @param state состояние
+     * @param prefixes буфер из N префиксных матриц
+     * @param firstJoint номер первого пересчитываемого сочленения,
+     * префиксная матрица предыдущего сочленения должна быть уже записана
+     */
+    template<unsigned long N>
+    void FixedChain<N>::_fillPrefixes(const double *state, Eigen::Matrix4d *prefixes, unsigned long firstJoint) const {
+        if (firstJoint == 0) {
+            prefixes[0] = affineRotProduct(_jointTransforms[0], getRotMatrix3x3(state[0], _axes[0]));
+            firstJoint = 1;
+        }
+        for (unsigned long k = firstJoint; k < N; k++)
+            prefixes[k] = affineRotProduct(
+                    affineProduct(prefixes[k - 1], _jointTransforms[k]), getRotMatrix3x3(state[k], _axes[k])
+            );
+    }
+
+    /**
+     * @brief записать матрицы преобразований всех звеньев в буфер
+     * записать матрицы преобразований всех звеньев по состоянию в буфер
+     * в том же порядке, что и BaseRobot::fillTransformMatrices()
+     * @param state состояние, должно содержать N координат
+     * @param matrices буфер, в который записывается getLinkCnt() матриц
+     */
+    template<unsigned long N>
+    void FixedChain<N>::fillTransformMatrices(const double *state, Eigen::Matrix4d *matrices) const {
+        std::array<Eigen::Matrix4d, N> prefixes;
+        _fillPrefixes(state, prefixes.data());
+        _fillLinkMatrices(prefixes.data(), matrices);
+    }
+
+    /**
+     * @brief записать матрицы преобразований всех звеньев и префиксные матрицы цепи
+     * (см. BaseFixedChain::fillTransformMatrices())
+     * @param state состояние, должно содержать N координат
+     * @param matrices буфер, в который записывается getLinkCnt() матриц
+     * @param prefixes префиксные матрицы цепи, N матриц
+     */
+    template<unsigned long N>
+    void FixedChain<N>::fillTransformMatrices(
+            const double *state, Eigen::Matrix4d *matrices, std::vector<Eigen::Matrix4d> &prefixes
+    ) const {
+        prefixes.resize(N);
+        _fillPrefixes(state, prefixes.data());
+        _fillLinkMatrices(prefixes.data(), matrices);
+    }
+
+    /**
+     * @brief инкрементально записать матрицы преобразований всех звеньев
+     * (см. BaseFixedChain::fillTransformMatrices())
+     * @param state состояние, должно содержать N координат
+     * @param matrices буфер, в который записывается getLinkCnt() матриц
+     * @param baseState базовое состояние
+     * @param basePrefixes префиксные матрицы цепи базового состояния
+     * @param baseMatrices матрицы преобразований звеньев базового состояния
+     */
+    template<unsigned long N>
+    void FixedChain<N>::fillTransformMatrices(
+            const double *state, Eigen::Matrix4d *matrices, const double *baseState,
+            const std::vector<Eigen::Matrix4d> &basePrefixes, const Eigen::Matrix4d *baseMatrices
+    ) const {
+        if (basePrefixes.size() != N) {
+            char buf[1024];
+            sprintf(buf,
+                    "FixedChain::fillTransformMatrices() ERROR: \n base prefix count is %zu, but chain joint count is %lu",
+                    basePrefixes.size(), N
+            );
+            throw std::invalid_argument(buf);
+        }
+
+        // первое сочленение, координата которого изменилась
+        unsigned long firstJoint = 0;
+        while (firstJoint < N && state[firstJoint] == baseState[firstJoint])
+            firstJoint++;
+
+        std::array<Eigen::Matrix4d, N> prefixes;
+        if (firstJoint > 0)
+            prefixes[firstJoint - 1] = basePrefixes[firstJoint - 1];
+        if (firstJoint < N)
+            _fillPrefixes(state, prefixes.data(), firstJoint);
+
+        // звенья до изменившегося сочленения и звенья вне иерархии не двигаются
+        for (unsigned long i = 0; i < _linkJoints.size(); i++)
+            matrices[i] = _linkJoints[i] < (int) firstJoint ? baseMatrices[i] : _getLinkMatrix(i, prefixes.data());
+    }
+
+    /**
+     * @brief пакетно записать матрицы преобразований всех звеньев
+     * (см. BaseFixedChain::fillBatchTransformMatrices())
+     * @param states координаты состояний
+     * @param stateCnt количество состояний
+     * @param stateStride расстояние между соседними координатами одного состояния
+     * @param matrices буфер, матрицы s-го состояния записываются
+     * подряд, начиная с matrices + s * matrixStride
+     * @param matrixStride расстояние между матрицами соседних состояний
+     */
+    template<unsigned long N>
+    void FixedChain<N>::fillBatchTransformMatrices(
+            const double *states, unsigned long stateCnt, unsigned long stateStride,
+            Eigen::Matrix4d *matrices, unsigned long matrixStride
+    ) const {
+        State state;
+        for (unsigned long s = 0; s < stateCnt; s++) {
+            for (unsigned long k = 0; k < N; k++)
+                state[k] = states[k * stateStride + s];
+            fillTransformMatrices(state.data(), matrices + s * matrixStride);
+        }
+    }
+
+    /**
+     * получить матрицу преобразования из СК мира в СК рабочего инструмента
+     * @param state состояние
+     * @return матрица преобразования
+     */
+    template<unsigned long N>
+    Eigen::Matrix4d FixedChain<N>::getEndEffectorTransformMatrix(const State &state) const {
+        std::array<Eigen::Matrix4d, N> prefixes;
+        _fillPrefixes(state.data(), prefixes.data());
+        return _getLinkMatrix(_endEffectorLink, prefixes.data());
+    }
+
+    /**
+     * @brief получить геометрический якобиан рабочего инструмента
+     * получить геометрический якобиан рабочего инструмента
+     * (см. BaseRobot::getEndEffectorJacobian())
+     * @param state состояние
+     * @return якобиан: первые три строки - частные производные положения
+     * рабочего инструмента, последние три - его угловая скорость
+     */
+    template<unsigned long N>
+    typename FixedChain<N>::Jacobian FixedChain<N>::getEndEffectorJacobian(const State &state) const {
+        std::array<Eigen::Matrix4d, N> prefixes;
+        _fillPrefixes(state.data(), prefixes.data());
+        Eigen::Vector3d endEffectorPos = _getLinkMatrix(_endEffectorLink, prefixes.data()).template topRightCorner<3, 1>();
+
+        Jacobian jacobian;
+        for (unsigned long k = 0; k < N; k++) {
+            // поворот вокруг оси не меняет ни её, ни начало СК сочленения;
+            // префиксные матрицы включают масштабирование из СК мира, поэтому
+            // ось и плечо возвращаются в СК робота, где цепь состоит из движений
+            Eigen::Vector3d axis = _worldMatrixInverse * (prefixes[k].template topLeftCorner<3, 3>() * _axes[k]);
+            Eigen::Vector3d arm = _worldMatrixInverse * (endEffectorPos - prefixes[k].template topRightCorner<3, 1>());
+            jacobian.template block<3, 1>(0, k) = _worldMatrix * axis.cross(arm);
+            jacobian.template block<3, 1>(3, k) = _worldRotationMatrix * axis;
+        }
+        return jacobian;
+    }
+
+    /**
+     * @brief построить цепь с фиксированным числом сочленений для робота
+     * построить цепь с фиксированным числом сочленений, если для количества
+     * сочленений робота есть специализация (6 и 7 сочленений)
+     * @param robot робот
+     * @return цепь или nullptr, если специализации нет и нужно
+     * пользоваться кинематикой самого робота
+     */
+    inline std::shared_ptr<BaseFixedChain> createFixedChain(const BaseRobot &robot) {
+        switch (robot.getJointCnt()) {
+            case 6:
+                return std::make_shared<FixedChain<6>>(robot);
+            case 7:
+                return std::make_shared<FixedChain<7>>(robot);
+            default:
+                return nullptr;
+        }
+    }
+}
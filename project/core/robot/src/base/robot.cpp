@@ -1,7 +1,150 @@
 #include "base/robot.h"
 
+#include <algorithm>
+
 using namespace bmpf;
 
+namespace {
+    /**
+     * количество состояний в одном блоке пакетной кинематики
+     */
+    const unsigned long FK_BATCH_LANES = 8;
+
+    /**
+     * аффинная матрица 3x4 блока состояний: элемент (r, c) l-го состояния
+     * лежит в m[r * 4 + c][l], нижняя строка (0, 0, 0, 1) не хранится
+     */
+    typedef double BatchAffine[12][FK_BATCH_LANES];
+
+    /**
+     * @brief коэффициенты сочленения для пакетной кинематики
+     * вращательная часть матрицы преобразования сочленения при угле a
+     * равна k0 + cos(a) * kc + sin(a) * ks, перенос от угла не зависит
+     */
+    struct BatchJoint {
+        /**
+         * постоянная часть вращения
+         */
+        double k0[9];
+        /**
+         * коэффициенты при косинусе угла
+         */
+        double kc[9];
+        /**
+         * коэффициенты при синусе угла
+         */
+        double ks[9];
+        /**
+         * перенос
+         */
+        double t[3];
+    };
+
+    /**
+     * построить коэффициенты сочленения: по формуле Родрига
+     * R(a) = cos(a) * E + (1 - cos(a)) * axis * axis^T + sin(a) * [axis]x,
+     * матрица сочленения равна parentTransform * R(a)
+     * @param joint сочленение
+     * @return коэффициенты сочленения
+     */
+    BatchJoint getBatchJoint(const Joint &joint) {
+        Eigen::Matrix3d p = joint.parentTransform.topLeftCorner<3, 3>();
+        Eigen::Vector3d a = joint.axis;
+        Eigen::Matrix3d cross;
+        cross << 0, -a(2), a(1),
+                a(2), 0, -a(0),
+                -a(1), a(0), 0;
+
+        Eigen::Matrix3d k0 = p * a * a.transpose();
+        Eigen::Matrix3d kc = p - k0;
+        Eigen::Matrix3d ks = p * cross;
+
+        BatchJoint batchJoint{};
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                batchJoint.k0[r * 3 + c] = k0(r, c);
+                batchJoint.kc[r * 3 + c] = kc(r, c);
+                batchJoint.ks[r * 3 + c] = ks(r, c);
+            }
+            batchJoint.t[r] = joint.parentTransform(r, 3);
+        }
+        return batchJoint;
+    }
+
+    /**
+     * заполнить аффинную матрицу блока одной и той же матрицей
+     * @param m матрица
+     * @param out аффинная матрица блока
+     */
+    void broadcastAffine(const Eigen::Matrix4d &m, BatchAffine &out) {
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 4; c++)
+                for (unsigned long l = 0; l < FK_BATCH_LANES; l++)
+                    out[r * 4 + c][l] = m(r, c);
+    }
+
+    /**
+     * умножить аффинную матрицу блока справа на постоянную матрицу: out = a * m
+     * @param a аффинная матрица блока
+     * @param m постоянная матрица
+     * @param out аффинная матрица блока, в которую записывается результат
+     */
+    void mulAffine(const BatchAffine &a, const Eigen::Matrix4d &m, BatchAffine &out) {
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 4; c++) {
+                double m0 = m(0, c), m1 = m(1, c), m2 = m(2, c);
+                double t = c == 3 ? 1 : 0;
+                for (unsigned long l = 0; l < FK_BATCH_LANES; l++)
+                    out[r * 4 + c][l] = a[r * 4][l] * m0 + a[r * 4 + 1][l] * m1 +
+                                        a[r * 4 + 2][l] * m2 + a[r * 4 + 3][l] * t;
+            }
+    }
+
+    /**
+     * умножить аффинную матрицу блока справа на матрицу сочленения: out = a * J(angle)
+     * @param a аффинная матрица блока
+     * @param joint коэффициенты сочленения
+     * @param cosA косинусы углов состояний блока
+     * @param sinA синусы углов состояний блока
+     * @param out аффинная матрица блока, в которую записывается результат
+     */
+    void mulJoint(const BatchAffine &a, const BatchJoint &joint,
+                  const double *cosA, const double *sinA, BatchAffine &out) {
+        double j[9][FK_BATCH_LANES];
+        for (int k = 0; k < 9; k++)
+            for (unsigned long l = 0; l < FK_BATCH_LANES; l++)
+                j[k][l] = joint.k0[k] + cosA[l] * joint.kc[k] + sinA[l] * joint.ks[k];
+
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++)
+                for (unsigned long l = 0; l < FK_BATCH_LANES; l++)
+                    out[r * 4 + c][l] = a[r * 4][l] * j[c][l] + a[r * 4 + 1][l] * j[3 + c][l] +
+                                        a[r * 4 + 2][l] * j[6 + c][l];
+            for (unsigned long l = 0; l < FK_BATCH_LANES; l++)
+                out[r * 4 + 3][l] = a[r * 4][l] * joint.t[0] + a[r * 4 + 1][l] * joint.t[1] +
+                                    a[r * 4 + 2][l] * joint.t[2] + a[r * 4 + 3][l];
+        }
+    }
+
+    /**
+     * записать аффинную матрицу блока в матрицы 4x4 первых laneCnt состояний
+     * @param a аффинная матрица блока
+     * @param laneCnt количество состояний
+     * @param matrices указатель на матрицу первого состояния
+     * @param matrixStride расстояние между матрицами соседних состояний
+     */
+    void storeAffine(const BatchAffine &a, unsigned long laneCnt,
+                     Eigen::Matrix4d *matrices, unsigned long matrixStride) {
+        for (unsigned long l = 0; l < laneCnt; l++) {
+            Eigen::Matrix4d &m = matrices[l * matrixStride];
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 4; c++)
+                    m(r, c) = a[r * 4 + c][l];
+            m.row(3) << 0, 0, 0, 1;
+        }
+    }
+}
+
 /**
  * Конструктор
  */
@@ -17,7 +160,7 @@ BaseRobot::BaseRobot() {
  * @param state состояние
  * @return флаг, допустим ли соответствующий набор углов поворота (конфигурация)
  */
-bool BaseRobot::isStateEnabled(std::vector<double> state) {
+bool BaseRobot::isStateEnabled(const std::vector<double> &state) const {
     if (state.size() != _jointParams.size()) {
         char buf[1024];
         sprintf(buf,
@@ -64,20 +207,21 @@ std::vector<std::string> BaseRobot::getModelPaths() const {
  * @param consumer обработчик для каждой матрицы
  */
 template<typename F>
-void BaseRobot::_forEachJoint(std::vector<double> state, const F &consumer) {
+void BaseRobot::_forEachJoint(const double *state, const F &consumer) const {
     Eigen::Matrix4d transformMatrix = *getWorldTransformMatrix();
-    std::vector<Eigen::Matrix4d> matrices;
     unsigned int jointPos = 0;
 
     for (unsigned long i = 0; i < _joints.size(); i++) {
-        auto jd = _joints.at(i);
+        const auto &jd = _joints.at(i);
+        // угол поворота берётся из состояния, сочленение не меняется
+        double angle = jd->jointAngle;
         if (!jd->isFixed) {
-            jd->jointAngle = state.at(jointPos);
+            angle = state[jointPos];
             jointPos++;
         }
-        transformMatrix = transformMatrix * jd->getTransformMatrix();
+        transformMatrix = affineProduct(transformMatrix, jd->getTransformMatrix(angle));
         if (!_joints.at(i)->isVirtual)
-            consumer(i, _joints.at(i), transformMatrix * jd->linkTransform);
+            consumer(i, _joints.at(i), affineProduct(transformMatrix, jd->linkTransform));
     }
 }
 
@@ -90,21 +234,24 @@ void BaseRobot::_forEachJoint(std::vector<double> state, const F &consumer) {
  * @param consumer обработчик для каждой матрицы
  */
 template<typename F>
-void BaseRobot::_forEachDiffJoint(std::vector<double> state, int iVal, const F &consumer) {
+void BaseRobot::_forEachDiffJoint(const double *state, int iVal, const F &consumer) const {
     Eigen::Matrix4d transformMatrix = *getWorldTransformMatrix();
-    std::vector<Eigen::Matrix4d> matrices;
     unsigned int jointPos = 0;
 
     for (unsigned long i = 0; i < _joints.size(); i++) {
-        auto jd = _joints.at(i);
+        const auto &jd = _joints.at(i);
+        // номер координаты сочленения, у фиксированных сочленений координаты нет
+        int coord = -1;
+        double angle = jd->jointAngle;
         if (!jd->isFixed) {
-            jd->jointAngle = state.at(jointPos);
+            coord = (int) jointPos;
+            angle = state[jointPos];
             jointPos++;
         }
-        if (jointPos - 1 == iVal)
-            transformMatrix = transformMatrix * jd->getDiffTransformMatrix();
+        if (coord == iVal)
+            transformMatrix = transformMatrix * jd->getDiffTransformMatrix(angle);
         else
-            transformMatrix = transformMatrix * jd->getTransformMatrix();
+            transformMatrix = transformMatrix * jd->getTransformMatrix(angle);
         if (!_joints.at(i)->isVirtual)
             consumer(i, _joints.at(i), transformMatrix * jd->linkTransform);
     }
@@ -121,23 +268,26 @@ void BaseRobot::_forEachDiffJoint(std::vector<double> state, int iVal, const F &
  * @param consumer обработчик для каждой матрицы
  */
 template<typename F>
-void BaseRobot::_forEachDiff2Joint(std::vector<double> state, int iVal, int jVal, const F &consumer) {
+void BaseRobot::_forEachDiff2Joint(const double *state, int iVal, int jVal, const F &consumer) const {
     Eigen::Matrix4d transformMatrix = *getWorldTransformMatrix();
-    std::vector<Eigen::Matrix4d> matrices;
     unsigned int jointPos = 0;
 
     for (unsigned long i = 0; i < _joints.size(); i++) {
-        auto jd = _joints.at(i);
+        const auto &jd = _joints.at(i);
+        // номер координаты сочленения, у фиксированных сочленений координаты нет
+        int coord = -1;
+        double angle = jd->jointAngle;
         if (!jd->isFixed) {
-            jd->jointAngle = state.at(jointPos);
+            coord = (int) jointPos;
+            angle = state[jointPos];
             jointPos++;
         }
-        if (jVal != iVal && (jointPos - 1 == iVal || jointPos - 1 == jVal))
-            transformMatrix = transformMatrix * jd->getDiffTransformMatrix();
-        else if (jVal == iVal && jointPos - 1 == iVal)
-            transformMatrix = transformMatrix * jd->getDiff2TransformMatrix();
+        if (jVal != iVal && (coord == iVal || coord == jVal))
+            transformMatrix = transformMatrix * jd->getDiffTransformMatrix(angle);
+        else if (jVal == iVal && coord == iVal)
+            transformMatrix = transformMatrix * jd->getDiff2TransformMatrix(angle);
         else
-            transformMatrix = transformMatrix * jd->getTransformMatrix();
+            transformMatrix = transformMatrix * jd->getTransformMatrix(angle);
 
         if (!_joints.at(i)->isVirtual)
             consumer(i, _joints.at(i), transformMatrix * jd->linkTransform);
@@ -149,29 +299,186 @@ void BaseRobot::_forEachDiff2Joint(std::vector<double> state, int iVal, int jVal
  * @param state состояние
  * @return список матриц преобразований
  */
-std::vector<Eigen::Matrix4d> BaseRobot::getTransformMatrices(std::vector<double> state) {
+std::vector<Eigen::Matrix4d> BaseRobot::getTransformMatrices(const std::vector<double> &state) const {
+    _checkStateSize(state);
+
     std::vector<Eigen::Matrix4d> matrices;
 
-    _forEachJoint(std::move(state),
+    _forEachJoint(state.data(),
                   [&matrices](int jointNum, const std::shared_ptr<Joint> &joint, const Eigen::Matrix4d &tf) {
                       matrices.emplace_back(tf);
                   });
 
     for (const auto &link: _nonHierarchicalLinks)
-        matrices.emplace_back((*getWorldTransformMatrix()) * (*link->linkTransformMatrix));
+        matrices.emplace_back(affineProduct(*getWorldTransformMatrix(), *link->linkTransformMatrix));
 
     return matrices;
 }
 
+/**
+ * @brief записать матрицы преобразований всех звеньев в буфер
+ * записать матрицы преобразований всех звеньев по состоянию в буфер,
+ * предоставленный вызывающим кодом. Метод не меняет робота, поэтому его
+ * можно вызывать одновременно из нескольких потоков
+ * @param state состояние, должно содержать getJointCnt() координат
+ * @param matrices буфер, в который записывается getLinkCnt() матриц
+ */
+void BaseRobot::fillTransformMatrices(const double *state, Eigen::Matrix4d *matrices) const {
+    unsigned long pos = 0;
+
+    _forEachJoint(state,
+                  [matrices, &pos](int jointNum, const std::shared_ptr<Joint> &joint, const Eigen::Matrix4d &tf) {
+                      matrices[pos++] = tf;
+                  });
+
+    for (const auto &link: _nonHierarchicalLinks)
+        matrices[pos++] = affineProduct(*getWorldTransformMatrix(), *link->linkTransformMatrix);
+}
+
+/**
+ * @brief записать матрицы преобразований всех звеньев и префиксные матрицы цепи
+ * записать матрицы преобразований всех звеньев по состоянию в буфер
+ * и сохранить префиксные матрицы цепи: i-я префиксная матрица - это
+ * преобразование из СК мира в СК i-го сочленения цепи с учётом его поворота.
+ * Префиксные матрицы позволяют потом инкрементально пересчитывать
+ * кинематику для близких состояний
+ * @param state состояние, должно содержать getJointCnt() координат
+ * @param matrices буфер, в который записывается getLinkCnt() матриц
+ * @param prefixes префиксные матрицы цепи
+ */
+void BaseRobot::fillTransformMatrices(
+        const double *state, Eigen::Matrix4d *matrices, std::vector<Eigen::Matrix4d> &prefixes
+) const {
+    prefixes.resize(_joints.size());
+    unsigned long pos = _fillChainMatrices(state, 0, 0, 0, *getWorldTransformMatrix(), matrices, prefixes.data());
+
+    for (const auto &link: _nonHierarchicalLinks)
+        matrices[pos++] = affineProduct(*getWorldTransformMatrix(), *link->linkTransformMatrix);
+}
+
+/**
+ * @brief инкрементально записать матрицы преобразований всех звеньев
+ * записать матрицы преобразований всех звеньев по состоянию в буфер,
+ * используя кинематику базового состояния: сочленения цепи до первой
+ * изменившейся координаты не пересчитываются, их матрицы копируются
+ * @param state состояние, должно содержать getJointCnt() координат
+ * @param matrices буфер, в который записывается getLinkCnt() матриц
+ * @param baseState базовое состояние
+ * @param basePrefixes префиксные матрицы цепи базового состояния
+ * @param baseMatrices матрицы преобразований звеньев базового состояния
+ */
+void BaseRobot::fillTransformMatrices(
+        const double *state, Eigen::Matrix4d *matrices, const double *baseState,
+        const std::vector<Eigen::Matrix4d> &basePrefixes, const Eigen::Matrix4d *baseMatrices
+) const {
+    // ищем первое сочленение цепи, координата которого изменилась
+    unsigned long firstJoint = 0;
+    unsigned long jointPos = 0;
+    unsigned long linkPos = 0;
+    for (; firstJoint < _joints.size(); firstJoint++) {
+        const auto &jd = _joints[firstJoint];
+        if (!jd->isFixed) {
+            if (state[jointPos] != baseState[jointPos])
+                break;
+            jointPos++;
+        }
+        if (!jd->isVirtual)
+            linkPos++;
+    }
+
+    // звенья до изменившегося сочленения не двигаются
+    std::copy(baseMatrices, baseMatrices + linkPos, matrices);
+
+    if (firstJoint < _joints.size())
+        linkPos = _fillChainMatrices(
+                state, firstJoint, jointPos, linkPos,
+                firstJoint == 0 ? *getWorldTransformMatrix() : basePrefixes[firstJoint - 1],
+                matrices, nullptr
+        );
+
+    // звенья вне иерархии от состояния не зависят
+    std::copy(baseMatrices + linkPos, baseMatrices + _links.size(), matrices + linkPos);
+}
+
+/**
+ * @brief пакетно записать матрицы преобразований всех звеньев
+ * записать матрицы преобразований всех звеньев для пакета состояний.
+ * Состояния передаются по координатам (structure of arrays): i-я координата
+ * s-го состояния лежит в states[i * stateStride + s]. Состояния обрабатываются
+ * блоками фиксированной ширины: синусы и косинусы углов и произведения
+ * аффинных матриц 3x4 считаются во внутренних циклах по состояниям блока,
+ * которые компилятор векторизует. Метод не меняет робота, поэтому его
+ * можно вызывать одновременно из нескольких потоков
+ * @param states координаты состояний
+ * @param stateCnt количество состояний
+ * @param stateStride расстояние между соседними координатами одного состояния
+ * @param matrices буфер, матрицы s-го состояния записываются
+ * подряд, начиная с matrices + s * matrixStride
+ * @param matrixStride расстояние между матрицами соседних состояний
+ */
+void BaseRobot::fillBatchTransformMatrices(
+        const double *states, unsigned long stateCnt, unsigned long stateStride,
+        Eigen::Matrix4d *matrices, unsigned long matrixStride
+) const {
+    // коэффициенты сочленений не зависят от состояний, поэтому считаются один раз
+    std::vector<BatchJoint> batchJoints;
+    batchJoints.reserve(_joints.size());
+    for (const auto &jd: _joints)
+        batchJoints.emplace_back(getBatchJoint(*jd));
+
+    BatchAffine transform, product;
+    double cosA[FK_BATCH_LANES], sinA[FK_BATCH_LANES];
+    for (unsigned long first = 0; first < stateCnt; first += FK_BATCH_LANES) {
+        unsigned long laneCnt = std::min(FK_BATCH_LANES, stateCnt - first);
+        Eigen::Matrix4d *blockMatrices = matrices + first * matrixStride;
+
+        broadcastAffine(*getWorldTransformMatrix(), transform);
+        unsigned long jointPos = 0;
+        unsigned long linkPos = 0;
+        for (unsigned long i = 0; i < _joints.size(); i++) {
+            const auto &jd = _joints[i];
+            if (jd->isFixed) {
+                mulAffine(transform, jd->getTransformMatrix(), product);
+            } else {
+                // неполный блок дополняем нулевыми углами
+                const double *angles = states + jointPos * stateStride + first;
+                for (unsigned long l = 0; l < FK_BATCH_LANES; l++) {
+                    double angle = l < laneCnt ? angles[l] : 0;
+                    cosA[l] = cos(angle);
+                    sinA[l] = sin(angle);
+                }
+                mulJoint(transform, batchJoints[i], cosA, sinA, product);
+                jointPos++;
+            }
+            std::copy(&product[0][0], &product[0][0] + 12 * FK_BATCH_LANES, &transform[0][0]);
+
+            if (!jd->isVirtual) {
+                mulAffine(transform, jd->linkTransform, product);
+                storeAffine(product, laneCnt, blockMatrices + linkPos, matrixStride);
+                linkPos++;
+            }
+        }
+
+        for (const auto &link: _nonHierarchicalLinks) {
+            Eigen::Matrix4d m = affineProduct(*getWorldTransformMatrix(), *link->linkTransformMatrix);
+            for (unsigned long l = 0; l < laneCnt; l++)
+                blockMatrices[l * matrixStride + linkPos] = m;
+            linkPos++;
+        }
+    }
+}
+
 /**
  * получить список осей вращения сочленений робота в СК мира по состоянию
  * @param state состояние
  * @return список осей вращения сочленений робота
  */
-std::vector<Eigen::Vector3d> BaseRobot::getJointAxes(std::vector<double> state) {
+std::vector<Eigen::Vector3d> BaseRobot::getJointAxes(const std::vector<double> &state) const {
+    _checkStateSize(state);
+
     std::vector<Eigen::Vector3d> axes;
 
-    _forEachJoint(std::move(state),
+    _forEachJoint(state.data(),
                   [&axes](int jointNum, const std::shared_ptr<Joint> &joint, const Eigen::Matrix4d &tf) {
                       Eigen::Vector3d jointAxis = joint->getAxis();
                       Eigen::Vector4d axis = tf * Eigen::Vector4d({jointAxis(0), jointAxis(1), jointAxis(2), 0});
@@ -186,13 +493,14 @@ std::vector<Eigen::Vector3d> BaseRobot::getJointAxes(std::vector<double> state)
  * @param state  состояние
  * @return матрица преобразования
  */
-Eigen::Matrix4d BaseRobot::getEndEffectorTransformMatrix(std::vector<double> state) {
+Eigen::Matrix4d BaseRobot::getEndEffectorTransformMatrix(const std::vector<double> &state) const {
+    _checkStateSize(state);
     if (_jointParams.empty())
         return Eigen::Matrix4d::Identity();
 
     Eigen::Matrix4d transformMatrix = *getWorldTransformMatrix();
 
-    _forEachJoint(std::move(state),
+    _forEachJoint(state.data(),
                   [&transformMatrix](int jointNum, const std::shared_ptr<Joint> &joint, const Eigen::Matrix4d &tf) {
                       transformMatrix = tf;
                   });
@@ -208,13 +516,14 @@ Eigen::Matrix4d BaseRobot::getEndEffectorTransformMatrix(std::vector<double> sta
  * @param iVal индекс координаты, по которой берётся производная
  * @return частная производная по i-ой координате
  */
-Eigen::Matrix4d BaseRobot::getEndEffectorDiffTransformMatrix(std::vector<double> state, int iVal) {
+Eigen::Matrix4d BaseRobot::getEndEffectorDiffTransformMatrix(const std::vector<double> &state, int iVal) const {
+    _checkStateSize(state);
     if (_jointParams.empty())
         return Eigen::Matrix4d::Identity();
 
     Eigen::Matrix4d transformMatrix = *getWorldTransformMatrix();
 
-    _forEachDiffJoint(std::move(state), iVal,
+    _forEachDiffJoint(state.data(), iVal,
                       [&transformMatrix](int jointNum, const std::shared_ptr<Joint> &joint, const Eigen::Matrix4d &tf) {
                           transformMatrix = tf;
                       });
@@ -230,13 +539,15 @@ Eigen::Matrix4d BaseRobot::getEndEffectorDiffTransformMatrix(std::vector<double>
  * @param jVal индекс координаты, по которой второй раз берётся производная
  * @return частная производная по i-ой и j-ой координатам
  */
-Eigen::Matrix4d BaseRobot::getEndEffectorDiff2TransformMatrix(std::vector<double> state, int iVal, int jVal) {
+Eigen::Matrix4d
+BaseRobot::getEndEffectorDiff2TransformMatrix(const std::vector<double> &state, int iVal, int jVal) const {
+    _checkStateSize(state);
     if (_jointParams.empty())
         return Eigen::Matrix4d::Identity();
 
     Eigen::Matrix4d transformMatrix = *getWorldTransformMatrix();
 
-    _forEachDiff2Joint(std::move(state), iVal, jVal,
+    _forEachDiff2Joint(state.data(), iVal, jVal,
                        [&transformMatrix](int jointNum, const std::shared_ptr<Joint> &joint,
                                           const Eigen::Matrix4d &tf) {
                            transformMatrix = tf;
@@ -321,14 +632,97 @@ void BaseRobot::setWorldTransformVector(const std::vector<double> &vec) {
     _fillWorldTransformMatrix();
 }
 
+/**
+ * получить оси и начала СК сочленений с приводом в СК робота
+ * и положение рабочего инструмента за один проход по цепи
+ * @param state состояние
+ * @param axes в i-й столбец записывается ось i-го сочленения с приводом
+ * @param origins в i-й столбец записывается начало СК i-го сочленения с приводом
+ * @return положение рабочего инструмента
+ */
+Eigen::Vector3d BaseRobot::_getJointFrames(
+        const double *state, Eigen::Matrix3Xd &axes, Eigen::Matrix3Xd &origins
+) const {
+    // матрица перехода из СК мира может масштабировать оси, поэтому
+    // цепь считается в СК робота, где все преобразования - движения
+    Eigen::Matrix4d transformMatrix = Eigen::Matrix4d::Identity();
+    Eigen::Vector3d endEffectorPos = Eigen::Vector3d::Zero();
+    unsigned long jointPos = 0;
+
+    for (const auto &jd: _joints) {
+        double angle = jd->jointAngle;
+        if (!jd->isFixed)
+            angle = state[jointPos];
+        transformMatrix = affineProduct(transformMatrix, jd->getTransformMatrix(angle));
+        if (!jd->isFixed) {
+            // поворот вокруг оси не меняет ни её, ни начало СК сочленения
+            axes.col(jointPos) = transformMatrix.topLeftCorner<3, 3>() * jd->axis;
+            origins.col(jointPos) = transformMatrix.topRightCorner<3, 1>();
+            jointPos++;
+        }
+        if (!jd->isVirtual)
+            endEffectorPos = affineProduct(transformMatrix, jd->linkTransform).topRightCorner<3, 1>();
+    }
+    return endEffectorPos;
+}
+
+/**
+ * пересчитать матрицы преобразований звеньев цепи, начиная с сочленения firstJoint
+ * @param state состояние
+ * @param firstJoint индекс первого пересчитываемого сочленения цепи
+ * @param jointPos индекс координаты состояния, соответствующей сочленению firstJoint
+ * @param linkPos индекс звена, соответствующего сочленению firstJoint
+ * @param transformMatrix префиксная матрица сочленения, предшествующего firstJoint
+ * @param matrices буфер матриц преобразований звеньев
+ * @param prefixes буфер префиксных матриц цепи, если равен nullptr, то
+ * префиксные матрицы не сохраняются
+ * @return индекс звена, следующего за последним звеном цепи
+ */
+unsigned long BaseRobot::_fillChainMatrices(
+        const double *state, unsigned long firstJoint, unsigned long jointPos, unsigned long linkPos,
+        Eigen::Matrix4d transformMatrix, Eigen::Matrix4d *matrices, Eigen::Matrix4d *prefixes
+) const {
+    for (unsigned long i = firstJoint; i < _joints.size(); i++) {
+        const auto &jd = _joints[i];
+        double angle = jd->jointAngle;
+        if (!jd->isFixed) {
+            angle = state[jointPos];
+            jointPos++;
+        }
+        transformMatrix = affineProduct(transformMatrix, jd->getTransformMatrix(angle));
+        if (prefixes)
+            prefixes[i] = transformMatrix;
+        if (!jd->isVirtual)
+            matrices[linkPos++] = affineProduct(transformMatrix, jd->linkTransform);
+    }
+    return linkPos;
+}
+
+/**
+ * проверить, что состояние содержит координаты всех сочленений робота
+ * @param state состояние
+ */
+void BaseRobot::_checkStateSize(const std::vector<double> &state) const {
+    if (state.size() < _jointParams.size()) {
+        char buf[1024];
+        sprintf(buf,
+                "BaseRobot::_checkStateSize() ERROR: \n state size is %zu, but _jointParams size is %zu",
+                state.size(), _jointParams.size()
+        );
+        throw std::invalid_argument(buf);
+    }
+}
+
 /**
  * Заполнить матрицу перехода из СК мира в СК робота
  */
 void BaseRobot::_fillWorldTransformMatrix() {
+    Eigen::Matrix4d rotationMatrix = getRotationMatrix(getWorldRotation());
     _worldTransformMatrix = std::make_shared<Eigen::Matrix4d>(
-            getRotationMatrix(getWorldRotation()) * getTranslationMatrix(getWorldTranslation()) *
+            rotationMatrix * getTranslationMatrix(getWorldTranslation()) *
             getScaleMatrix(getWorldScale())
     );
+    _worldRotationMatrix = rotationMatrix.topLeftCorner<3, 3>();
 }
 
 /**
@@ -336,8 +730,8 @@ void BaseRobot::_fillWorldTransformMatrix() {
  * @param state состояние
  * @return положение рабочего инструмента
  */
-std::vector<double> BaseRobot::getEndEffectorPos(std::vector<double> state) {
-    auto tf = getEndEffectorTransformMatrix(std::move(state));
+std::vector<double> BaseRobot::getEndEffectorPos(const std::vector<double> &state) const {
+    auto tf = getEndEffectorTransformMatrix(state);
     return getPosition(tf);
 }
 
@@ -347,8 +741,8 @@ std::vector<double> BaseRobot::getEndEffectorPos(std::vector<double> state) {
  * @param iVal индекс координаты, по которой берётся производная
  * @return
  */
-std::vector<double> BaseRobot::getEndEffectorDiffPos(std::vector<double> state, int iVal) {
-    auto tf = getEndEffectorDiffTransformMatrix(std::move(state), iVal);
+std::vector<double> BaseRobot::getEndEffectorDiffPos(const std::vector<double> &state, int iVal) const {
+    auto tf = getEndEffectorDiffTransformMatrix(state, iVal);
     return getPosition(tf);
 }
 
@@ -359,18 +753,92 @@ std::vector<double> BaseRobot::getEndEffectorDiffPos(std::vector<double> state,
  * @param jVal индекс координаты, по которой второй раз берётся производная
  * @return
  */
-std::vector<double> BaseRobot::getEndEffectorDiff2Pos(std::vector<double> state, int iVal, int jVal) {
-    auto tf = getEndEffectorDiff2TransformMatrix(std::move(state), iVal, jVal);
+std::vector<double> BaseRobot::getEndEffectorDiff2Pos(const std::vector<double> &state, int iVal, int jVal) const {
+    auto tf = getEndEffectorDiff2TransformMatrix(state, iVal, jVal);
     return getPosition(tf);
 }
 
+/**
+ * получить геометрический якобиан рабочего инструмента в СК робота
+ * (см. getEndEffectorJacobian())
+ * @param state состояние
+ * @return якобиан в СК робота
+ */
+Eigen::Matrix<double, 6, Eigen::Dynamic> BaseRobot::_getLocalJacobian(const double *state) const {
+    Eigen::Matrix3Xd axes(3, _jointParams.size());
+    Eigen::Matrix3Xd origins(3, _jointParams.size());
+    Eigen::Vector3d endEffectorPos = _getJointFrames(state, axes, origins);
+
+    Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian(6, _jointParams.size());
+    for (unsigned long i = 0; i < _jointParams.size(); i++) {
+        Eigen::Vector3d axis = axes.col(i);
+        jacobian.block<3, 1>(0, i) = axis.cross(endEffectorPos - origins.col(i));
+        jacobian.block<3, 1>(3, i) = axis;
+    }
+    return jacobian;
+}
+
+/**
+ * @brief получить геометрический якобиан рабочего инструмента
+ * получить геометрический якобиан рабочего инструмента за один проход по цепи:
+ * для каждого сочленения с приводом запоминаются его ось z_i и начало его СК p_i
+ * в СК робота, после чего i-й столбец якобиана равен (z_i x (p - p_i), z_i),
+ * где p - положение рабочего инструмента. В отличие от getEndEffectorDiffPos()
+ * цепь не пересчитывается для каждой координаты. В СК мира строки положения
+ * переводятся матрицей перехода вместе с масштабированием, поэтому они равны
+ * частным производным положения, а строки угловой скорости - только поворотом
+ * @param state состояние
+ * @return якобиан: первые три строки - частные производные положения рабочего
+ * инструмента, последние три - его угловая скорость, столбцы соответствуют координатам
+ */
+Eigen::Matrix<double, 6, Eigen::Dynamic> BaseRobot::getEndEffectorJacobian(const std::vector<double> &state) const {
+    _checkStateSize(state);
+
+    Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian = _getLocalJacobian(state.data());
+    jacobian.topRows<3>() = getWorldTransformMatrix()->topLeftCorner<3, 3>() * jacobian.topRows<3>();
+    jacobian.bottomRows<3>() = _worldRotationMatrix * jacobian.bottomRows<3>();
+    return jacobian;
+}
+
+/**
+ * @brief получить гессиан положения рабочего инструмента
+ * получить вторые частные производные положения рабочего инструмента по
+ * геометрическому якобиану: при i <= j частная производная i-го столбца
+ * по j-ой координате (и j-го по i-ой) равна z_i x Jv_j, где Jv_j - первые
+ * три строки j-го столбца якобиана в СК робота; в СК мира гессиан
+ * переводится матрицей перехода вместе с масштабированием
+ * @param state состояние
+ * @return три матрицы (для x, y и z) размера getJointCnt() x getJointCnt(),
+ * элемент (i, j) k-ой матрицы равен второй частной производной k-ой
+ * координаты положения по i-ой и j-ой координатам состояния
+ */
+std::vector<Eigen::MatrixXd> BaseRobot::getEndEffectorPosHessian(const std::vector<double> &state) const {
+    _checkStateSize(state);
+
+    Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian = _getLocalJacobian(state.data());
+    Eigen::Matrix3d worldMatrix = getWorldTransformMatrix()->topLeftCorner<3, 3>();
+
+    unsigned long jointCnt = _jointParams.size();
+    std::vector<Eigen::MatrixXd> hessian(3, Eigen::MatrixXd(jointCnt, jointCnt));
+    for (unsigned long i = 0; i < jointCnt; i++)
+        for (unsigned long j = i; j < jointCnt; j++) {
+            Eigen::Vector3d axis = jacobian.block<3, 1>(3, i);
+            Eigen::Vector3d diff = worldMatrix * axis.cross(jacobian.block<3, 1>(0, j));
+            for (int k = 0; k < 3; k++) {
+                hessian[k](i, j) = diff(k);
+                hessian[k](j, i) = diff(k);
+            }
+        }
+    return hessian;
+}
+
 /**
  * получить положение и ориентацию(задана параметрами Родриго-Гамильтона)
  * @param state состояние
  * @return положение и ориентацию(задана параметрами Родриго-Гамильтона)
  */
-std::vector<double> BaseRobot::getEndEffectorRGVector(std::vector<double> state) {
-    auto tf = getEndEffectorTransformMatrix(std::move(state));
+std::vector<double> BaseRobot::getEndEffectorRGVector(const std::vector<double> &state) const {
+    auto tf = getEndEffectorTransformMatrix(state);
     return getRGVector(tf);
 }
 
@@ -381,8 +849,8 @@ std::vector<double> BaseRobot::getEndEffectorRGVector(std::vector<double> state)
  * @param iVal индекс координаты, по которой берётся производная
  * @return
  */
-std::vector<double> BaseRobot::getEndEffectorDiffRGVector(std::vector<double> state, int iVal) {
-    auto tf = getEndEffectorDiffTransformMatrix(std::move(state), iVal);
+std::vector<double> BaseRobot::getEndEffectorDiffRGVector(const std::vector<double> &state, int iVal) const {
+    auto tf = getEndEffectorDiffTransformMatrix(state, iVal);
     return getRGVector(tf);
 }
 
@@ -394,8 +862,9 @@ std::vector<double> BaseRobot::getEndEffectorDiffRGVector(std::vector<double> st
  * @param jVal индекс координаты, по которой второй раз берётся производная
  * @return
  */
-std::vector<double> BaseRobot::getEndEffectorDiff2RGVector(std::vector<double> state, int iVal, int jVal) {
-    auto tf = getEndEffectorDiff2TransformMatrix(std::move(state), iVal, jVal);
+std::vector<double>
+BaseRobot::getEndEffectorDiff2RGVector(const std::vector<double> &state, int iVal, int jVal) const {
+    auto tf = getEndEffectorDiff2TransformMatrix(state, iVal, jVal);
     return getRGVector(tf);
 }
 
@@ -404,8 +873,8 @@ std::vector<double> BaseRobot::getEndEffectorDiff2RGVector(std::vector<double> s
  * @param state  состояние
  * @return положения всех звеньев
  */
-std::vector<double> BaseRobot::getAllLinkPositions(std::vector<double> state) {
-    auto tfs = getTransformMatrices(std::move(state));
+std::vector<double> BaseRobot::getAllLinkPositions(const std::vector<double> &state) const {
+    auto tfs = getTransformMatrices(state);
     std::vector<double> allPoses;
     for (auto &tf: tfs) {
         auto pos = getPosition(tf);
@@ -419,8 +888,8 @@ std::vector<double> BaseRobot::getAllLinkPositions(std::vector<double> state) {
  * @param state состояние
  * @return  положения всех звеньев
  */
-std::vector<double> BaseRobot::getAllLinkRGVectors(std::vector<double> state) {
-    auto tfs = getTransformMatrices(std::move(state));
+std::vector<double> BaseRobot::getAllLinkRGVectors(const std::vector<double> &state) const {
+    auto tfs = getTransformMatrices(state);
     std::vector<double> allPoses;
     for (auto &tf: tfs) {
         auto pos = getRGVector(tf);
@@ -448,10 +917,10 @@ std::vector<double> BaseRobot::getMassCenterLocalPositions() {
  * @param state  состояние
  * @return  список координат центров масс
  */
-std::vector<double> BaseRobot::getMassCenterAbsolutePositions(std::vector<double> state) {
+std::vector<double> BaseRobot::getMassCenterAbsolutePositions(const std::vector<double> &state) {
     std::vector<double> cmposes;
     // получаем матрицы преобразования звеньев
-    auto tfs = getTransformMatrices(std::move(state));
+    auto tfs = getTransformMatrices(state);
     // получаем координаты центров масс в СК соответствующего звена
     auto mcs = getMassCenterLocalPositions();
     // перебираем звенья и переводим координаты центров масс
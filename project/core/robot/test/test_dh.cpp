@@ -1,11 +1,274 @@
 #include <base/robot.h>
 #include <urdf_robot.h>
 #include <dh_robot.h>
+#include <fixed_chain.h>
 #include "state.h"
+#include <thread>
 
 
 const int TEST_CNT = 50;
 
+/**
+ * прямая кинематика из нескольких потоков должна совпадать с однопоточной
+ * @param robot робот
+ */
+void testConcurrentFK(const std::shared_ptr<bmpf::BaseRobot> &robot) {
+    std::vector<std::vector<double>> states;
+    std::vector<std::vector<Eigen::Matrix4d>> expected;
+    for (int i = 0; i < TEST_CNT; i++) {
+        states.emplace_back(robot->getRandomState());
+        expected.emplace_back(robot->getTransformMatrices(states.back()));
+    }
+
+    std::vector<char> results(4, 1);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < results.size(); t++)
+        threads.emplace_back([&, t] {
+            std::vector<Eigen::Matrix4d> matrices(robot->getLinkCnt());
+            for (int k = 0; k < 100; k++)
+                for (unsigned long i = 0; i < states.size(); i++) {
+                    robot->fillTransformMatrices(states[i].data(), matrices.data());
+                    for (unsigned long j = 0; j < matrices.size(); j++)
+                        if (!matrices[j].isApprox(expected[i][j]))
+                            results[t] = 0;
+                }
+        });
+    for (auto &thread: threads)
+        thread.join();
+
+    for (char result: results)
+        assert(result);
+}
+
+/**
+ * инкрементальная прямая кинематика после изменения одной координаты
+ * должна совпадать с полной
+ * @param robot робот
+ */
+void testIncrementalFK(const std::shared_ptr<bmpf::BaseRobot> &robot) {
+    std::vector<Eigen::Matrix4d> baseMatrices(robot->getLinkCnt());
+    std::vector<Eigen::Matrix4d> prefixes;
+    std::vector<Eigen::Matrix4d> matrices(robot->getLinkCnt());
+    for (int i = 0; i < TEST_CNT; i++) {
+        std::vector<double> baseState = robot->getRandomState();
+        robot->fillTransformMatrices(baseState.data(), baseMatrices.data(), prefixes);
+
+        // без изменений матрицы должны скопироваться
+        robot->fillTransformMatrices(baseState.data(), matrices.data(), baseState.data(), prefixes,
+                                     baseMatrices.data());
+        for (unsigned long j = 0; j < matrices.size(); j++)
+            assert(matrices[j].isApprox(baseMatrices[j]));
+
+        for (unsigned long k = 0; k < baseState.size(); k++) {
+            std::vector<double> state = baseState;
+            state[k] += 0.1;
+            robot->fillTransformMatrices(state.data(), matrices.data(), baseState.data(), prefixes,
+                                         baseMatrices.data());
+            std::vector<Eigen::Matrix4d> expected = robot->getTransformMatrices(state);
+            for (unsigned long j = 0; j < matrices.size(); j++)
+                assert(matrices[j].isApprox(expected[j]));
+        }
+    }
+}
+
+/**
+ * пакетная прямая кинематика должна совпадать с покомпонентной,
+ * в том числе для неполного последнего блока
+ * @param robot робот
+ */
+void testBatchFK(const std::shared_ptr<bmpf::BaseRobot> &robot) {
+    const unsigned long stateCnt = 19;
+    unsigned long jointCnt = robot->getJointCnt();
+    unsigned long linkCnt = robot->getLinkCnt();
+
+    std::vector<std::vector<double>> states;
+    std::vector<double> batchStates(stateCnt * jointCnt);
+    for (unsigned long s = 0; s < stateCnt; s++) {
+        states.emplace_back(robot->getRandomState());
+        for (unsigned long k = 0; k < jointCnt; k++)
+            batchStates[k * stateCnt + s] = states.back()[k];
+    }
+
+    std::vector<Eigen::Matrix4d> matrices(stateCnt * linkCnt);
+    robot->fillBatchTransformMatrices(batchStates.data(), stateCnt, stateCnt, matrices.data(), linkCnt);
+
+    for (unsigned long s = 0; s < stateCnt; s++) {
+        std::vector<Eigen::Matrix4d> expected = robot->getTransformMatrices(states[s]);
+        for (unsigned long j = 0; j < linkCnt; j++)
+            assert(matrices[s * linkCnt + j].isApprox(expected[j]));
+    }
+}
+
+/**
+ * получить положение рабочего инструмента
+ * @param robot робот
+ * @param state состояние
+ * @return положение рабочего инструмента
+ */
+Eigen::Vector3d getEndEffectorPos(const std::shared_ptr<bmpf::BaseRobot> &robot, const std::vector<double> &state) {
+    return robot->getEndEffectorTransformMatrix(state).topRightCorner<3, 1>();
+}
+
+/**
+ * якобиан и гессиан положения рабочего инструмента должны совпадать
+ * с конечными разностями положения и якобиана
+ * @param robot робот
+ */
+void testJacobian(const std::shared_ptr<bmpf::BaseRobot> &robot) {
+    const double eps = 1e-6;
+    for (int t = 0; t < TEST_CNT; t++) {
+        std::vector<double> state = robot->getRandomState();
+        Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian = robot->getEndEffectorJacobian(state);
+        std::vector<Eigen::MatrixXd> hessian = robot->getEndEffectorPosHessian(state);
+        assert(jacobian.cols() == (long) robot->getJointCnt());
+
+        Eigen::Matrix3d rot = robot->getEndEffectorTransformMatrix(state).topLeftCorner<3, 3>();
+        for (unsigned long i = 0; i < robot->getJointCnt(); i++) {
+            std::vector<double> nextState = state;
+            nextState[i] += eps;
+            std::vector<double> prevState = state;
+            prevState[i] -= eps;
+
+            // линейная скорость по центральной разности положений
+            Eigen::Vector3d diff = (getEndEffectorPos(robot, nextState) - getEndEffectorPos(robot, prevState)) / (2 * eps);
+            for (int k = 0; k < 3; k++)
+                assert(std::abs(jacobian(k, i) - diff(k)) < 1e-5);
+
+            // угловая скорость по конечной разности матриц поворота
+            Eigen::Matrix3d nextRot = robot->getEndEffectorTransformMatrix(nextState).topLeftCorner<3, 3>();
+            Eigen::Matrix3d omega = (nextRot - rot) * rot.transpose() / eps;
+            assert(std::abs(omega(2, 1) - jacobian(3, i)) < 1e-4);
+            assert(std::abs(omega(0, 2) - jacobian(4, i)) < 1e-4);
+            assert(std::abs(omega(1, 0) - jacobian(5, i)) < 1e-4);
+
+            // i-я строка гессиана - центральная разность якобиана по i-й координате
+            Eigen::MatrixXd diff2 = (robot->getEndEffectorJacobian(nextState) -
+                                     robot->getEndEffectorJacobian(prevState)) / (2 * eps);
+            for (unsigned long j = 0; j < robot->getJointCnt(); j++)
+                for (int k = 0; k < 3; k++)
+                    assert(std::abs(hessian[k](i, j) - diff2(k, j)) < 1e-5);
+        }
+    }
+}
+
+/**
+ * частные производные, полученные пересчётом цепи, должны совпадать
+ * с якобианом и гессианом положения рабочего инструмента
+ * @param robot робот
+ */
+void testDiffPos(const std::shared_ptr<bmpf::BaseRobot> &robot) {
+    for (int t = 0; t < TEST_CNT; t++) {
+        std::vector<double> state = robot->getRandomState();
+        Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian = robot->getEndEffectorJacobian(state);
+        std::vector<Eigen::MatrixXd> hessian = robot->getEndEffectorPosHessian(state);
+
+        for (unsigned long i = 0; i < robot->getJointCnt(); i++) {
+            std::vector<double> diff = robot->getEndEffectorDiffPos(state, (int) i);
+            for (int k = 0; k < 3; k++)
+                assert(std::abs(jacobian(k, i) - diff[k]) < 1e-6);
+
+            for (unsigned long j = 0; j < robot->getJointCnt(); j++) {
+                std::vector<double> diff2 = robot->getEndEffectorDiff2Pos(state, (int) i, (int) j);
+                for (int k = 0; k < 3; k++)
+                    assert(std::abs(hessian[k](i, j) - diff2[k]) < 1e-6);
+            }
+        }
+    }
+}
+
+/**
+ * Проверка цепи с фиксированным числом сочленений: матрицы звеньев
+ * и якобиан должны совпадать с расчётом по роботу
+ * @param robot робот с шестью сочленениями
+ */
+void testFixedChain(const std::shared_ptr<bmpf::BaseRobot> &robot) {
+    assert(robot->getJointCnt() == 6);
+    assert(bmpf::createFixedChain(*robot));
+
+    bmpf::FixedChain<6> chain(*robot);
+    assert(chain.getLinkCnt() == robot->getLinkCnt());
+    assert(chain.isActual(*robot));
+
+    std::vector<Eigen::Matrix4d> matrices(chain.getLinkCnt());
+    for (int t = 0; t < TEST_CNT; t++) {
+        std::vector<double> state = robot->getRandomState();
+        bmpf::FixedChain<6>::State fixedState;
+        std::copy(state.begin(), state.end(), fixedState.begin());
+
+        chain.fillTransformMatrices(fixedState, matrices.data());
+        std::vector<Eigen::Matrix4d> expected = robot->getTransformMatrices(state);
+        for (unsigned long i = 0; i < expected.size(); i++)
+            assert((matrices[i] - expected[i]).norm() < 1e-9);
+
+        assert((chain.getEndEffectorTransformMatrix(fixedState) -
+                robot->getEndEffectorTransformMatrix(state)).norm() < 1e-9);
+        assert((chain.getEndEffectorJacobian(fixedState) -
+                robot->getEndEffectorJacobian(state)).norm() < 1e-9);
+        assert((chain.getEndEffectorJacobian(state.data()) -
+                robot->getEndEffectorJacobian(state)).norm() < 1e-9);
+    }
+
+    // инкрементальный расчёт по кэшу цепи совпадает с полным
+    std::vector<double> baseState = robot->getRandomState();
+    std::vector<Eigen::Matrix4d> baseMatrices(chain.getLinkCnt());
+    std::vector<Eigen::Matrix4d> basePrefixes;
+    chain.fillTransformMatrices(baseState.data(), baseMatrices.data(), basePrefixes);
+    assert(basePrefixes.size() == 6);
+    for (int t = 0; t < TEST_CNT; t++) {
+        std::vector<double> state = baseState;
+        for (unsigned long k = t % 7; k < state.size(); k++)
+            state[k] += 0.1;
+
+        chain.fillTransformMatrices(state.data(), matrices.data(), baseState.data(), basePrefixes, baseMatrices.data());
+        std::vector<Eigen::Matrix4d> expected = robot->getTransformMatrices(state);
+        for (unsigned long i = 0; i < expected.size(); i++)
+            assert((matrices[i] - expected[i]).norm() < 1e-9);
+    }
+
+    // пакетный расчёт цепи совпадает с пакетным расчётом робота
+    const unsigned long stateCnt = 13;
+    std::vector<double> states(6 * stateCnt);
+    for (unsigned long s = 0; s < stateCnt; s++) {
+        std::vector<double> state = robot->getRandomState();
+        for (unsigned long k = 0; k < 6; k++)
+            states[k * stateCnt + s] = state[k];
+    }
+    std::vector<Eigen::Matrix4d> batchMatrices(stateCnt * chain.getLinkCnt());
+    std::vector<Eigen::Matrix4d> expectedBatchMatrices(stateCnt * chain.getLinkCnt());
+    chain.fillBatchTransformMatrices(states.data(), stateCnt, stateCnt, batchMatrices.data(), chain.getLinkCnt());
+    robot->fillBatchTransformMatrices(
+            states.data(), stateCnt, stateCnt, expectedBatchMatrices.data(), chain.getLinkCnt()
+    );
+    for (unsigned long i = 0; i < batchMatrices.size(); i++)
+        assert((batchMatrices[i] - expectedBatchMatrices[i]).norm() < 1e-9);
+}
+
+/**
+ * при масштабировании из СК мира строки положения якобиана и гессиан
+ * должны совпадать с частными производными, полученными пересчётом цепи,
+ * а строки угловой скорости не должны зависеть от масштабирования
+ * @param path путь к описанию робота
+ */
+void testScaledJacobian(const std::string &path) {
+    std::shared_ptr<bmpf::BaseRobot> robot = std::make_shared<bmpf::DHRobot>();
+    robot->loadFromFile(path);
+    robot->setWorldTransformVector({0.3, -0.2, 0.1, 0.4, -0.7, 1.1, 1.5, 0.7, 1.2});
+
+    std::shared_ptr<bmpf::BaseRobot> unscaledRobot = std::make_shared<bmpf::DHRobot>();
+    unscaledRobot->loadFromFile(path);
+    unscaledRobot->setWorldTransformVector({0.3, -0.2, 0.1, 0.4, -0.7, 1.1, 1, 1, 1});
+
+    testDiffPos(robot);
+    testFixedChain(robot);
+
+    for (int t = 0; t < TEST_CNT; t++) {
+        std::vector<double> state = robot->getRandomState();
+        Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian = robot->getEndEffectorJacobian(state);
+        Eigen::Matrix<double, 6, Eigen::Dynamic> unscaledJacobian = unscaledRobot->getEndEffectorJacobian(state);
+        assert((jacobian.bottomRows<3>() - unscaledJacobian.bottomRows<3>()).norm() < 1e-9);
+    }
+}
+
 int main() {
 
     srand(time(nullptr));
@@ -24,5 +287,14 @@ int main() {
         for (int j = 0; j < 21; j++)
             assert(std::abs(dhPoses[j] - urdfPoses[j]) < 0.01);
     }
+
+    testConcurrentFK(dh);
+    testIncrementalFK(dh);
+    testBatchFK(dh);
+    testJacobian(dh);
+    testDiffPos(dh);
+    testFixedChain(dh);
+    testScaledJacobian("../../../../config/dh/kuka_six.json");
+
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base/robot.h"
+#include "fixed_chain.h"
 
 #include <Eigen/Dense>
 #include <vector>
@@ -10,6 +11,30 @@
 
 namespace bmpf {
 
+    /**
+     * @brief кэш прямой кинематики состояния сцены
+     * кэш прямой кинематики состояния сцены: матрицы преобразований
+     * всех звеньев и префиксные матрицы цепей роботов. По нему
+     * кинематика близких состояний считается инкрементально.
+     * Для роботов с цепью фиксированной длины (см. `FixedChain`) в кэше
+     * лежат префиксные матрицы цепи, поэтому после изменения положения
+     * робота кэш нужно построить заново
+     */
+    struct FKCache {
+        /**
+         * состояние сцены, для которого построен кэш
+         */
+        std::vector<double> state;
+        /**
+         * матрицы преобразований всех звеньев сцены
+         */
+        std::vector<Eigen::Matrix4d> matrices;
+        /**
+         * префиксные матрицы цепей, по одному списку на каждого робота сцены
+         */
+        std::vector<std::vector<Eigen::Matrix4d>> prefixes;
+    };
+
     /**
      * Класс сцены
      */
@@ -114,13 +139,66 @@ namespace bmpf {
          */
         std::vector<std::shared_ptr<bmpf::Link>> getLinks() const { return _links; }
 
+        /**
+         * получить количество звеньев всех роботов сцены
+         * @return количество звеньев всех роботов сцены
+         */
+        unsigned long getLinkCnt() const { return _links.size(); }
+
         /**
          * @brief получить список матриц преобразований всех звеньев
          * получить список матриц преобразований всех звеньев по состоянию сцены
          * @param state состояние
          * @return список матриц преобразований
          */
-        std::vector<Eigen::Matrix4d> getTransformMatrices(const std::vector<double> &state);
+        std::vector<Eigen::Matrix4d> getTransformMatrices(const std::vector<double> &state) const;
+
+        /**
+         * @brief записать матрицы преобразований всех звеньев в буфер
+         * записать матрицы преобразований всех звеньев по состоянию сцены в буфер,
+         * предоставленный вызывающим кодом. Метод не меняет сцену, поэтому одну
+         * сцену могут одновременно использовать несколько потоков
+         * @param state состояние сцены
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         */
+        void fillTransformMatrices(const std::vector<double> &state, Eigen::Matrix4d *matrices) const;
+
+        /**
+         * @brief построить кэш прямой кинематики состояния
+         * @param state состояние сцены
+         * @param cache кэш, в который записывается кинематика состояния
+         */
+        void fillFKCache(const std::vector<double> &state, FKCache &cache) const;
+
+        /**
+         * @brief инкрементально записать матрицы преобразований всех звеньев сцены
+         * записать матрицы преобразований всех звеньев сцены по состоянию в буфер,
+         * используя кэш кинематики базового состояния: у каждого робота пересчитываются
+         * только сочленения, начиная с первой изменившейся координаты, матрицы
+         * роботов с неизменным состоянием копируются из кэша. Кэш только читается,
+         * поэтому метод можно вызывать из нескольких потоков одновременно
+         * @param state состояние сцены
+         * @param matrices буфер, в который записывается getLinkCnt() матриц
+         * @param cache кэш кинематики базового состояния
+         */
+        void fillTransformMatrices(
+                const std::vector<double> &state, Eigen::Matrix4d *matrices, const FKCache &cache
+        ) const;
+
+        /**
+         * @brief пакетно записать матрицы преобразований всех звеньев сцены
+         * записать матрицы преобразований всех звеньев сцены для пакета состояний
+         * (см. BaseRobot::fillBatchTransformMatrices). Состояния передаются по
+         * координатам: i-я координата s-го состояния лежит в states[i * stateCnt + s].
+         * Матрицы s-го состояния записываются подряд, начиная с matrices + s * getLinkCnt(),
+         * в таком виде буфер можно сразу передать в пакетную проверку коллайдера
+         * @param states координаты состояний
+         * @param stateCnt количество состояний
+         * @param matrices буфер, в который записывается stateCnt * getLinkCnt() матриц
+         */
+        void fillBatchTransformMatrices(
+                const std::vector<double> &states, unsigned long stateCnt, Eigen::Matrix4d *matrices
+        ) const;
 
         /**
          * @brief получить список положений (x,y,z) рабочих инструментов всех роботов
@@ -128,7 +206,7 @@ namespace bmpf {
          * @param state состояние сцены
          * @return список положений
          */
-        std::vector<double> getEndEffectorPositions(const std::vector<double> &state);
+        std::vector<double> getEndEffectorPositions(const std::vector<double> &state) const;
 
         /**
          * Получить частную производную положений рабочих инструментов роботов по i-ой координате
@@ -136,7 +214,7 @@ namespace bmpf {
          * @param iVal индекс координаты, по которой берётся производная
          * @return  частная производная положений рабочих инструментов
          */
-        std::vector<double> getEndEffectorDiffPositions(const std::vector<double>& state, int iVal);
+        std::vector<double> getEndEffectorDiffPositions(const std::vector<double> &state, int iVal) const;
 
         /**
          * получить частную производную положений рабочих инструментов роботов по i-ой и j-ой координатам
@@ -145,14 +223,41 @@ namespace bmpf {
          * @param jVal индекс координаты, по которой второй раз берётся производная
          * @return  частная производная положений рабочих инструментов
          */
-        std::vector<double> getEndEffectorDiff2Positions(const std::vector<double>& state, int iVal, int jVal);
+        std::vector<double> getEndEffectorDiff2Positions(const std::vector<double> &state, int iVal, int jVal) const;
+
+        /**
+         * @brief получить геометрический якобиан рабочих инструментов роботов
+         * получить геометрический якобиан рабочих инструментов всех роботов с
+         * сочленениями (см. BaseRobot::getEndEffectorJacobian()), каждому роботу
+         * соответствует блок из шести строк в том же порядке, что и в
+         * getEndEffectorPositions(), столбцы соответствуют координатам сцены.
+         * Робот не зависит от координат других роботов, поэтому вне диагональных
+         * блоков стоят нули
+         * @param state состояние сцены
+         * @return якобиан размера 6 * getActiveRobotCnt() x getJointCnt(),
+         * число строк зависит от количества роботов, поэтому матрица динамическая
+         */
+        Eigen::MatrixXd getEndEffectorJacobian(const std::vector<double> &state) const;
+
+        /**
+         * @brief получить геометрический якобиан рабочего инструмента робота
+         * получить геометрический якобиан рабочего инструмента робота с
+         * сочленениями (см. BaseRobot::getEndEffectorJacobian()), столбцы
+         * соответствуют координатам этого робота
+         * @param state состояние сцены
+         * @param robotNum номер робота в списке роботов
+         * @return якобиан размера 6 x кол-во сочленений робота
+         */
+        Eigen::Matrix<double, 6, Eigen::Dynamic> getEndEffectorJacobian(
+                const std::vector<double> &state, unsigned long robotNum
+        ) const;
 
         /**
          * получить матрицы преобразования из СК базы робота в СК рабочего инструмента для каждого робота сцены
          * @param state  состояние сцены
          * @return матрицы преобразования
          */
-        std::vector<Eigen::Matrix4d> getEndEffectorTransformMatrices(const std::vector<double>& state);
+        std::vector<Eigen::Matrix4d> getEndEffectorTransformMatrices(const std::vector<double> &state) const;
 
         /**
          * получить частные производные матриц преобразования из СК базы робота в СК рабочего инструмента
@@ -161,7 +266,7 @@ namespace bmpf {
          * @param iVal индекс координаты, по которой берётся производная
          * @return частные производные матриц преобразования
          */
-        std::vector<Eigen::Matrix4d> getEndEffectorDiffTransformMatrices(const std::vector<double>& state, int iVal);
+        std::vector<Eigen::Matrix4d> getEndEffectorDiffTransformMatrices(const std::vector<double> &state, int iVal) const;
 
         /**
          * получить частные производные матриц преобразования из СК базы робота в СК рабочего инструмента для каждого робота сцены
@@ -172,14 +277,14 @@ namespace bmpf {
          * @return частные производные матриц преобразования
          */
         std::vector<Eigen::Matrix4d>
-        getEndEffectorDiff2TransformMatrices(const std::vector<double>& state, int iVal, int jVal);
+        getEndEffectorDiff2TransformMatrices(const std::vector<double> &state, int iVal, int jVal) const;
 
         /**
          * получить список положений и ориентаций рабочего инструмента (заданы параметрами Родриго-Гамильтона)
          * @param state  состояние сцены
          * @return список положений и ориентаций
          */
-        std::vector<double> getEndEffectorRGVectors(const std::vector<double> &state);
+        std::vector<double> getEndEffectorRGVectors(const std::vector<double> &state) const;
 
         /**
          * получить частную производную положения и ориентации рабочего инструмента
@@ -188,7 +293,7 @@ namespace bmpf {
          * @param iVal индекс координаты, по которой берётся производная
          * @return частная производная
          */
-        std::vector<double> getEndEffectorDiffRGVector(const std::vector<double> &state, int iVal);
+        std::vector<double> getEndEffectorDiffRGVector(const std::vector<double> &state, int iVal) const;
 
         /**
          *  получить частную производную положения и ориентации рабочего инструмента
@@ -198,14 +303,14 @@ namespace bmpf {
          * @param jVal индекс координаты, по которой второй раз берётся производная
          * @return частная производная
          */
-        std::vector<double> getEndEffectorDiff2RGVector(const std::vector<double> &state, int iVal, int jVal);
+        std::vector<double> getEndEffectorDiff2RGVector(const std::vector<double> &state, int iVal, int jVal) const;
 
         /**
          * получить список положений звеньев всех роботов по состоянию сцены (x,y,z)
          * @param state  состояние сцены
          * @return список положений звеньев
          */
-        std::vector<double> getAllLinkPositions(const std::vector<double> &state);
+        std::vector<double> getAllLinkPositions(const std::vector<double> &state) const;
 
         /**
          * получить список положений (x,y,z) и ориентаций (параметры Родриго-Гамильтона)
@@ -213,14 +318,14 @@ namespace bmpf {
          * @param state состояние сцены
          * @return список положений и ориентаций
          */
-        std::vector<double> getAllLinkRGVectors(const std::vector<double> &state);
+        std::vector<double> getAllLinkRGVectors(const std::vector<double> &state) const;
 
         /**
          * проверка, допустимо ли состояние сцены (по допустимым диапазонам звеньев)
          * @param  state состояние сцены
          * @return флаг, допустимо ли состояние сцены
          */
-        bool isStateEnabled(const std::vector<double> &state);
+        bool isStateEnabled(const std::vector<double> &state) const;
 
         /**
          * проверка, допустимо ли состояние сцены для конкретного робота
@@ -229,7 +334,7 @@ namespace bmpf {
          * @param robotNum номер робота в списке роботов
          * @return  флаг, допустимо ли состояние сцены
          */
-        bool isStateEnabled(std::vector<double> state, unsigned long robotNum);
+        bool isStateEnabled(const std::vector<double> &state, unsigned long robotNum) const;
 
         /**
          * получить случайное состояние сцены
@@ -261,7 +366,7 @@ namespace bmpf {
          * @param objectNum номер робота в списке роботов
          * @return состояние робота
          */
-        std::vector<double> getSingleObjectState(const std::vector<double> &state, unsigned long objectNum);
+        std::vector<double> getSingleObjectState(const std::vector<double> &state, unsigned long objectNum) const;
 
         /**
          * получить смещения для каждого из роботов
@@ -379,6 +484,23 @@ namespace bmpf {
          */
         void _initObjects();
 
+        /**
+         * построить заново цепи с фиксированным числом сочленений для
+         * всех роботов сцены, нужно вызывать после изменения положений роботов
+         */
+        void _updateFixedChains();
+
+        /**
+         * получить цепь с фиксированным числом сочленений робота, если
+         * она есть и построена по текущему положению робота
+         * @param robotNum номер робота в списке роботов
+         * @return цепь или nullptr, если считать нужно по самому роботу
+         */
+        const bmpf::BaseFixedChain *_getFixedChain(unsigned long robotNum) const {
+            const auto &fixedChain = _fixedChains[robotNum];
+            return fixedChain && fixedChain->isActual(*_objects[robotNum]) ? fixedChain.get() : nullptr;
+        }
+
     private:
         /**
          * максимальные по модулю значения скорости каждой из координат
@@ -419,6 +541,11 @@ namespace bmpf {
          * (у сцены, созданной от ссылки на робота, остаётся пустым)
          */
         std::vector<std::shared_ptr<Scene>> _singleRobotScenes;
+        /**
+         * цепи с фиксированным числом сочленений для роботов сцены
+         * (nullptr, если для робота нет специализации)
+         */
+        std::vector<std::shared_ptr<bmpf::BaseFixedChain>> _fixedChains;
         /**
          * список флагов, имеет ли тот или иной объект звенья
          */
@@ -14,6 +14,10 @@ using namespace bmpf;
  */
 Scene::Scene(const std::vector<std::shared_ptr<bmpf::BaseRobot>> &robot) {
     _objects.insert(std::end(_objects), std::begin(robot), std::end(robot));
+    // списки индексов здесь не заполняются: по ним _initObjects() строит
+    // сцены отдельных роботов, которые сами создаются этим конструктором
+    for (const auto &object: _objects)
+        _areObjectsJointed.emplace_back(object->getJointCnt() != 0);
     _initObjects();
 }
 
@@ -98,6 +102,7 @@ unsigned long Scene::addObject(std::string path) {
 unsigned long Scene::addObject(std::string path, std::vector<double> &transformVector) {
     unsigned long objectNum = addObject(std::move(path));
     _objects.at(objectNum)->setWorldTransformVector(transformVector);
+    _updateFixedChains();
     return objectNum;
 }
 
@@ -137,6 +142,17 @@ void Scene::_initObjects() {
         }
     }
     _jointCnt = _jointParams.size();
+    _updateFixedChains();
+}
+
+/**
+ * построить заново цепи с фиксированным числом сочленений для
+ * всех роботов сцены, нужно вызывать после изменения положений роботов
+ */
+void Scene::_updateFixedChains() {
+    _fixedChains.clear();
+    for (const auto &object: _objects)
+        _fixedChains.push_back(createFixedChain(*object));
 }
 
 /**
@@ -237,7 +253,7 @@ void Scene::loadFromFile(const std::string &path) {
  * @param objectNum номер робота в списке роботов
  * @return состояние робота
  */
-std::vector<double> Scene::getSingleObjectState(const std::vector<double> &state, unsigned long objectNum) {
+std::vector<double> Scene::getSingleObjectState(const std::vector<double> &state, unsigned long objectNum) const {
     std::pair<long, long> range = _jointIndexRanges.at(objectNum);
     std::vector<double> singleObjectState(
             std::begin(state) + range.first, std::begin(state) + range.second + 1
@@ -251,7 +267,7 @@ std::vector<double> Scene::getSingleObjectState(const std::vector<double> &state
  * @param state состояние
  * @return список матриц преобразований
  */
-std::vector<Eigen::Matrix4d> Scene::getTransformMatrices(const std::vector<double> &state) {
+std::vector<Eigen::Matrix4d> Scene::getTransformMatrices(const std::vector<double> &state) const {
     if (state.empty()) {
         char buf[1024];
         sprintf(buf,
@@ -260,13 +276,150 @@ std::vector<Eigen::Matrix4d> Scene::getTransformMatrices(const std::vector<doubl
         throw std::invalid_argument(buf);
     }
 
-    std::vector<Eigen::Matrix4d> matrices;
+    std::vector<Eigen::Matrix4d> matrices(getLinkCnt());
+    fillTransformMatrices(state, matrices.data());
+    return matrices;
+}
+
+/**
+ * @brief записать матрицы преобразований всех звеньев в буфер
+ * записать матрицы преобразований всех звеньев по состоянию сцены в буфер,
+ * предоставленный вызывающим кодом. Метод не меняет сцену, поэтому одну
+ * сцену могут одновременно использовать несколько потоков
+ * @param state состояние сцены
+ * @param matrices буфер, в который записывается getLinkCnt() матриц
+ */
+void Scene::fillTransformMatrices(const std::vector<double> &state, Eigen::Matrix4d *matrices) const {
+    if (state.size() != _jointCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "Scene::fillTransformMatrices() ERROR: \n state size is %zu, but joint count is %u",
+                state.size(), _jointCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+
     for (unsigned long i = 0; i < _objects.size(); i++) {
-        std::vector<double> localState = getSingleObjectState(state, i);
-        std::vector<Eigen::Matrix4d> localMatrices = _objects.at(i)->getTransformMatrices(localState);
-        matrices.insert(std::end(matrices), std::begin(localMatrices), std::end(localMatrices));
+        // если для робота есть цепь с фиксированным числом сочленений, считаем по ней
+        if (const BaseFixedChain *fixedChain = _getFixedChain(i))
+            fixedChain->fillTransformMatrices(state.data() + _jointIndexRanges[i].first, matrices);
+        else
+            _objects[i]->fillTransformMatrices(state.data() + _jointIndexRanges[i].first, matrices);
+        matrices += _objects[i]->getLinkCnt();
+    }
+}
+
+/**
+ * @brief построить кэш прямой кинематики состояния
+ * @param state состояние сцены
+ * @param cache кэш, в который записывается кинематика состояния
+ */
+void Scene::fillFKCache(const std::vector<double> &state, FKCache &cache) const {
+    if (state.size() != _jointCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "Scene::fillFKCache() ERROR: \n state size is %zu, but joint count is %u",
+                state.size(), _jointCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    cache.state = state;
+    cache.matrices.resize(getLinkCnt());
+    cache.prefixes.resize(_objects.size());
+
+    Eigen::Matrix4d *matrices = cache.matrices.data();
+    for (unsigned long i = 0; i < _objects.size(); i++) {
+        // префиксные матрицы цепи и робота различаются, поэтому кэш
+        // читается тем же способом, которым построен (см. _getFixedChain)
+        if (const BaseFixedChain *fixedChain = _getFixedChain(i))
+            fixedChain->fillTransformMatrices(state.data() + _jointIndexRanges[i].first, matrices, cache.prefixes[i]);
+        else
+            _objects[i]->fillTransformMatrices(
+                    state.data() + _jointIndexRanges[i].first, matrices, cache.prefixes[i]
+            );
+        matrices += _objects[i]->getLinkCnt();
+    }
+}
+
+/**
+ * @brief инкрементально записать матрицы преобразований всех звеньев сцены
+ * записать матрицы преобразований всех звеньев сцены по состоянию в буфер,
+ * используя кэш кинематики базового состояния: у каждого робота пересчитываются
+ * только сочленения, начиная с первой изменившейся координаты, матрицы
+ * роботов с неизменным состоянием копируются из кэша. Кэш только читается,
+ * поэтому метод можно вызывать из нескольких потоков одновременно
+ * @param state состояние сцены
+ * @param matrices буфер, в который записывается getLinkCnt() матриц
+ * @param cache кэш кинематики базового состояния
+ */
+void Scene::fillTransformMatrices(
+        const std::vector<double> &state, Eigen::Matrix4d *matrices, const FKCache &cache
+) const {
+    if (state.size() != _jointCnt || cache.state.size() != _jointCnt ||
+        cache.matrices.size() != getLinkCnt() || cache.prefixes.size() != _objects.size()) {
+        char buf[1024];
+        sprintf(buf,
+                "Scene::fillTransformMatrices() ERROR: \n state size is %zu, cache state size is %zu, "
+                "but joint count is %u",
+                state.size(), cache.state.size(), _jointCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    const Eigen::Matrix4d *baseMatrices = cache.matrices.data();
+    for (unsigned long i = 0; i < _objects.size(); i++) {
+        unsigned long offset = _jointIndexRanges[i].first;
+        if (const BaseFixedChain *fixedChain = _getFixedChain(i))
+            fixedChain->fillTransformMatrices(
+                    state.data() + offset, matrices, cache.state.data() + offset, cache.prefixes[i], baseMatrices
+            );
+        else
+            _objects[i]->fillTransformMatrices(
+                    state.data() + offset, matrices, cache.state.data() + offset, cache.prefixes[i], baseMatrices
+            );
+        matrices += _objects[i]->getLinkCnt();
+        baseMatrices += _objects[i]->getLinkCnt();
+    }
+}
+
+/**
+ * @brief пакетно записать матрицы преобразований всех звеньев сцены
+ * записать матрицы преобразований всех звеньев сцены для пакета состояний
+ * (см. BaseRobot::fillBatchTransformMatrices). Состояния передаются по
+ * координатам: i-я координата s-го состояния лежит в states[i * stateCnt + s].
+ * Матрицы s-го состояния записываются подряд, начиная с matrices + s * getLinkCnt(),
+ * в таком виде буфер можно сразу передать в пакетную проверку коллайдера
+ * @param states координаты состояний
+ * @param stateCnt количество состояний
+ * @param matrices буфер, в который записывается stateCnt * getLinkCnt() матриц
+ */
+void Scene::fillBatchTransformMatrices(
+        const std::vector<double> &states, unsigned long stateCnt, Eigen::Matrix4d *matrices
+) const {
+    if (states.size() != stateCnt * _jointCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "Scene::fillBatchTransformMatrices() ERROR: \n states size is %zu, but stateCnt is %lu"
+                " and joint count is %u\nstates size must be equal to their product",
+                states.size(), stateCnt, _jointCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    for (unsigned long i = 0; i < _objects.size(); i++) {
+        if (const BaseFixedChain *fixedChain = _getFixedChain(i))
+            fixedChain->fillBatchTransformMatrices(
+                    states.data() + _jointIndexRanges[i].first * stateCnt, stateCnt, stateCnt,
+                    matrices, getLinkCnt()
+            );
+        else
+            _objects[i]->fillBatchTransformMatrices(
+                    states.data() + _jointIndexRanges[i].first * stateCnt, stateCnt, stateCnt,
+                    matrices, getLinkCnt()
+            );
+        matrices += _objects[i]->getLinkCnt();
     }
-    return matrices;
 }
 
 /**
@@ -274,7 +427,7 @@ std::vector<Eigen::Matrix4d> Scene::getTransformMatrices(const std::vector<doubl
  * @param state  состояние сцены
  * @return матрицы преобразования
  */
-std::vector<Eigen::Matrix4d> Scene::getEndEffectorTransformMatrices(const std::vector<double> &state) {
+std::vector<Eigen::Matrix4d> Scene::getEndEffectorTransformMatrices(const std::vector<double> &state) const {
     std::vector<Eigen::Matrix4d> matrices;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -292,7 +445,8 @@ std::vector<Eigen::Matrix4d> Scene::getEndEffectorTransformMatrices(const std::v
  * @param iVal индекс координаты, по которой берётся производная
  * @return частные производные матриц преобразования
  */
-std::vector<Eigen::Matrix4d> Scene::getEndEffectorDiffTransformMatrices(const std::vector<double> &state, int iVal) {
+std::vector<Eigen::Matrix4d>
+Scene::getEndEffectorDiffTransformMatrices(const std::vector<double> &state, int iVal) const {
     std::vector<Eigen::Matrix4d> matrices;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -312,7 +466,7 @@ std::vector<Eigen::Matrix4d> Scene::getEndEffectorDiffTransformMatrices(const st
  * @return частные производные матриц преобразования
  */
 std::vector<Eigen::Matrix4d>
-Scene::getEndEffectorDiff2TransformMatrices(const std::vector<double> &state, int iVal, int jVal) {
+Scene::getEndEffectorDiff2TransformMatrices(const std::vector<double> &state, int iVal, int jVal) const {
     std::vector<Eigen::Matrix4d> matrices;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -329,7 +483,7 @@ Scene::getEndEffectorDiff2TransformMatrices(const std::vector<double> &state, in
  * @param state состояние сцены
  * @return список положений
  */
-std::vector<double> Scene::getEndEffectorPositions(const std::vector<double> &state) {
+std::vector<double> Scene::getEndEffectorPositions(const std::vector<double> &state) const {
     std::vector<double> positions;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -347,7 +501,7 @@ std::vector<double> Scene::getEndEffectorPositions(const std::vector<double> &st
  * @param iVal индекс координаты, по которой берётся производная
  * @return  частная производная положений рабочих инструментов
  */
-std::vector<double> Scene::getEndEffectorDiffPositions(const std::vector<double> &state, int iVal) {
+std::vector<double> Scene::getEndEffectorDiffPositions(const std::vector<double> &state, int iVal) const {
     std::vector<double> positions;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -371,7 +525,7 @@ std::vector<double> Scene::getEndEffectorDiffPositions(const std::vector<double>
  * @param jVal индекс координаты, по которой второй раз берётся производная
  * @return  частная производная положений рабочих инструментов
  */
-std::vector<double> Scene::getEndEffectorDiff2Positions(const std::vector<double> &state, int iVal, int jVal) {
+std::vector<double> Scene::getEndEffectorDiff2Positions(const std::vector<double> &state, int iVal, int jVal) const {
     std::vector<double> positions;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -394,12 +548,71 @@ std::vector<double> Scene::getEndEffectorDiff2Positions(const std::vector<double
 }
 
 
+/**
+ * @brief получить геометрический якобиан рабочих инструментов роботов
+ * получить геометрический якобиан рабочих инструментов всех роботов с
+ * сочленениями (см. BaseRobot::getEndEffectorJacobian()), каждому роботу
+ * соответствует блок из шести строк в том же порядке, что и в
+ * getEndEffectorPositions(), столбцы соответствуют координатам сцены.
+ * Робот не зависит от координат других роботов, поэтому вне диагональных
+ * блоков стоят нули
+ * @param state состояние сцены
+ * @return якобиан размера 6 * getActiveRobotCnt() x getJointCnt()
+ */
+Eigen::MatrixXd Scene::getEndEffectorJacobian(const std::vector<double> &state) const {
+    if (state.size() != _jointCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "Scene::getEndEffectorJacobian() ERROR: \n state size is %zu, but joint count is %u",
+                state.size(), _jointCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    Eigen::MatrixXd jacobian = Eigen::MatrixXd::Zero(6 * getActiveRobotCnt(), _jointCnt);
+    long row = 0;
+    for (unsigned long i = 0; i < _objects.size(); i++)
+        if (_objects.at(i)->getJointCnt() > 0) {
+            jacobian.block(row, _jointIndexRanges.at(i).first, 6, (long) _objects.at(i)->getJointCnt()) =
+                    getEndEffectorJacobian(state, i);
+            row += 6;
+        }
+    return jacobian;
+}
+
+/**
+ * @brief получить геометрический якобиан рабочего инструмента робота
+ * получить геометрический якобиан рабочего инструмента робота с
+ * сочленениями (см. BaseRobot::getEndEffectorJacobian()), столбцы
+ * соответствуют координатам этого робота
+ * @param state состояние сцены
+ * @param robotNum номер робота в списке роботов
+ * @return якобиан размера 6 x кол-во сочленений робота
+ */
+Eigen::Matrix<double, 6, Eigen::Dynamic> Scene::getEndEffectorJacobian(
+        const std::vector<double> &state, unsigned long robotNum
+) const {
+    if (state.size() != _jointCnt || robotNum >= _objects.size()) {
+        char buf[1024];
+        sprintf(buf,
+                "Scene::getEndEffectorJacobian() ERROR: \n state size is %zu, robotNum is %lu,"
+                " but joint count is %u and robot count is %zu",
+                state.size(), robotNum, _jointCnt, _objects.size()
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    if (const BaseFixedChain *fixedChain = _getFixedChain(robotNum))
+        return fixedChain->getEndEffectorJacobian(state.data() + _jointIndexRanges[robotNum].first);
+    return _objects.at(robotNum)->getEndEffectorJacobian(getSingleObjectState(state, robotNum));
+}
+
 /**
  * получить список положений и ориентаций рабочего инструмента (заданы параметрами Родриго-Гамильтона)
  * @param state  состояние сцены
  * @return список положений и ориентаций
  */
-std::vector<double> Scene::getEndEffectorRGVectors(const std::vector<double> &state) {
+std::vector<double> Scene::getEndEffectorRGVectors(const std::vector<double> &state) const {
     std::vector<double> rgVectors;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -417,7 +630,7 @@ std::vector<double> Scene::getEndEffectorRGVectors(const std::vector<double> &st
  * @param iVal индекс координаты, по которой берётся производная
  * @return частная производная
  */
-std::vector<double> Scene::getEndEffectorDiffRGVector(const std::vector<double> &state, int iVal) {
+std::vector<double> Scene::getEndEffectorDiffRGVector(const std::vector<double> &state, int iVal) const {
     std::vector<double> rgVectors;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -436,7 +649,7 @@ std::vector<double> Scene::getEndEffectorDiffRGVector(const std::vector<double>
  * @param jVal индекс координаты, по которой второй раз берётся производная
  * @return частная производная
  */
-std::vector<double> Scene::getEndEffectorDiff2RGVector(const std::vector<double> &state, int iVal, int jVal) {
+std::vector<double> Scene::getEndEffectorDiff2RGVector(const std::vector<double> &state, int iVal, int jVal) const {
     std::vector<double> rgVectors;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -452,7 +665,7 @@ std::vector<double> Scene::getEndEffectorDiff2RGVector(const std::vector<double>
  * @param state  состояние сцены
  * @return список положений звеньев
  */
-std::vector<double> Scene::getAllLinkPositions(const std::vector<double> &state) {
+std::vector<double> Scene::getAllLinkPositions(const std::vector<double> &state) const {
     std::vector<double> poses;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -469,7 +682,7 @@ std::vector<double> Scene::getAllLinkPositions(const std::vector<double> &state)
  * @param state состояние сцены
  * @return список положений и ориентаций
  */
-std::vector<double> Scene::getAllLinkRGVectors(const std::vector<double> &state) {
+std::vector<double> Scene::getAllLinkRGVectors(const std::vector<double> &state) const {
     std::vector<double> poses;
     for (unsigned long i = 0; i < _objects.size(); i++)
         if (_objects.at(i)->getJointCnt() > 0) {
@@ -487,8 +700,8 @@ std::vector<double> Scene::getAllLinkRGVectors(const std::vector<double> &state)
  * @param robotNum номер робота в списке роботов
  * @return  флаг, допустимо ли состояние сцены
  */
-bool Scene::isStateEnabled(std::vector<double> state, unsigned long robotNum) {
-    return _objects.at(robotNum)->isStateEnabled(std::move(state));
+bool Scene::isStateEnabled(const std::vector<double> &state, unsigned long robotNum) const {
+    return _objects.at(robotNum)->isStateEnabled(state);
 }
 
 /**
@@ -496,7 +709,7 @@ bool Scene::isStateEnabled(std::vector<double> state, unsigned long robotNum) {
  * @param  state состояние сцены
  * @return флаг, допустимо ли состояние сцены
  */
-bool Scene::isStateEnabled(const std::vector<double> &state) {
+bool Scene::isStateEnabled(const std::vector<double> &state) const {
     if (state.size() != _jointParams.size()) {
         char buf[1024];
         sprintf(buf,
@@ -599,6 +812,7 @@ void Scene::setGroupedTranslation(std::vector<std::vector<double>> groupedTransl
 
     for (unsigned int i = 0; i < groupedTranslation.size(); i++)
         _objects.at(i)->setWorldTranslation(groupedTranslation.at(i));
+    _updateFixedChains();
 }
 
 /**
@@ -617,6 +831,7 @@ void Scene::setGroupedRotation(std::vector<std::vector<double>> groupedRotation)
 
     for (unsigned int i = 0; i < groupedRotation.size(); i++)
         _objects.at(i)->setWorldRotation(groupedRotation.at(i));
+    _updateFixedChains();
 }
 
 /**
@@ -634,6 +849,7 @@ void Scene::setGroupedScale(std::vector<std::vector<double>> groupedScale) {
     }
     for (unsigned int i = 0; i < groupedScale.size(); i++)
         _objects.at(i)->setWorldScale(groupedScale.at(i));
+    _updateFixedChains();
 }
 
 /**
@@ -651,5 +867,6 @@ void Scene::setGroupedTransformVector(std::vector<std::vector<double>> transform
     }
     for (unsigned int i = 0; i < transformVectors.size(); i++)
         _objects.at(i)->setWorldTransformVector(transformVectors.at(i));
+    _updateFixedChains();
 }
 
@@ -0,0 +1,72 @@
+#include <scene.h>
+#include <log.h>
+#include <chrono>
+
+/**
+ * количество случайных состояний
+ */
+const unsigned long STATE_CNT = 100000;
+/**
+ * количество состояний в одном пакете
+ */
+const unsigned long BATCH_SIZE = 256;
+
+/**
+ * Замер времени прямой кинематики сцены: покомпонентный расчёт
+ * Scene::getTransformMatrices() против пакетного
+ * Scene::fillBatchTransformMatrices()
+ */
+int main() {
+    bmpf::infoMsg("batch forward kinematics benchmark");
+
+    std::shared_ptr<bmpf::Scene> scene = std::make_shared<bmpf::Scene>();
+    scene->loadFromFile("../../../../config/murdf/4robots.json");
+
+    unsigned long jointCnt = scene->getJointCnt();
+    unsigned long linkCnt = scene->getLinkCnt();
+
+    std::vector<std::vector<double>> states;
+    for (unsigned long i = 0; i < STATE_CNT; i++)
+        states.emplace_back(scene->getRandomState());
+
+    // контрольная сумма, чтобы компилятор не выбросил вычисления
+    double checkSum = 0;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (const auto &state: states) {
+        std::vector<Eigen::Matrix4d> matrices = scene->getTransformMatrices(state);
+        checkSum += matrices.back()(0, 3);
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double singleTime = (double) std::chrono::duration_cast<std::chrono::microseconds>(
+            endTime - startTime).count() / 1000;
+
+    // состояния пакета раскладываются по координатам
+    std::vector<double> batchStates(BATCH_SIZE * jointCnt);
+    std::vector<Eigen::Matrix4d> batchMatrices(BATCH_SIZE * linkCnt);
+    double batchCheckSum = 0;
+
+    startTime = std::chrono::high_resolution_clock::now();
+    for (unsigned long first = 0; first < STATE_CNT; first += BATCH_SIZE) {
+        unsigned long stateCnt = std::min(BATCH_SIZE, STATE_CNT - first);
+        batchStates.resize(stateCnt * jointCnt);
+        for (unsigned long i = 0; i < stateCnt; i++)
+            for (unsigned long j = 0; j < jointCnt; j++)
+                batchStates[j * stateCnt + i] = states[first + i][j];
+
+        scene->fillBatchTransformMatrices(batchStates, stateCnt, batchMatrices.data());
+        for (unsigned long i = 0; i < stateCnt; i++)
+            batchCheckSum += batchMatrices[(i + 1) * linkCnt - 1](0, 3);
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    double batchTime = (double) std::chrono::duration_cast<std::chrono::microseconds>(
+            endTime - startTime).count() / 1000;
+
+    bmpf::infoMsg("states: ", STATE_CNT, " links: ", linkCnt);
+    bmpf::infoMsg("getTransformMatrices: ", singleTime, " ms");
+    bmpf::infoMsg("fillBatchTransformMatrices: ", batchTime, " ms speedup: ",
+                  batchTime > 0 ? singleTime / batchTime : 0);
+    bmpf::infoMsg("check sums: ", checkSum, " ", batchCheckSum);
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <scene.h>
+#include <log.h>
+#include <chrono>
+#include <base/path_finder.h>
+#include <incremental_path_finder.h>
+
+/**
+ * задачи планирования для сцены с одним роботом
+ */
+const std::vector<std::pair<std::vector<double>, std::vector<double>>> TASKS{
+        {
+                {-2.967, -0.855, 0.314, -1.937, -1.676, -3.665},
+                {1.187, -0.035, -1.131, 0.000, 0.419, 3.665}
+        },
+        {
+                {0.424, -1.120, -0.451, 0.686, 1.911, 2.587},
+                {0.953, -0.871, 1.649, 0.838, 0.009, -3.227}
+        },
+        {
+                {-1.344, -0.959, 0.970, -0.756, -1.359, -0.948},
+                {0.026, -0.979, 1.400, -0.713, 0.068, 2.742}
+        },
+};
+
+/**
+ * получить время в секундах, прошедшее с момента startTime
+ * @param startTime момент начала замера
+ * @return время в секундах
+ */
+double getSeconds(const std::chrono::high_resolution_clock::time_point &startTime) {
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return (double) std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000000;
+}
+
+/**
+ * Замер времени перепланирования планировщиком D* Lite после того,
+ * как на найденный путь ставится препятствие: исправление графа
+ * поиска против поиска с нуля на той же сцене
+ */
+int main() {
+    bmpf::infoMsg("incremental path finder benchmark");
+
+    std::shared_ptr<bmpf::Scene> scene = std::make_shared<bmpf::Scene>();
+    scene->loadFromFile("../../../../config/murdf/demo_scene.json");
+
+    auto pathFinder = std::make_shared<bmpf::IncrementalPathFinder>(scene, false, 20, 1000000, 1);
+
+    double sumRepairTime = 0;
+    double sumFullTime = 0;
+    for (const auto &task: TASKS) {
+        int errorCode = -1;
+        std::vector<std::vector<double>> path = pathFinder->findPath(task.first, task.second, errorCode);
+        if (errorCode != bmpf::PathFinder::NO_ERROR || path.size() < 3) {
+            bmpf::errMsg("error code: ", errorCode);
+            continue;
+        }
+
+        // препятствие ставится в положение рабочего инструмента в середине пути
+        std::vector<double> position = scene->getEndEffectorPositions(path[path.size() / 2]);
+        std::vector<double> transformVector{position[0], position[1], position[2], 0, 0, 0, 1, 1, 1};
+        unsigned long objectNum = scene->addObject("../../../../config/urdf/sphere.urdf", transformVector);
+
+        // обновление графа входит в замер перепланирования
+        auto startTime = std::chrono::high_resolution_clock::now();
+        pathFinder->updateCollider();
+        pathFinder->updateRegion(pathFinder->getObjectBoxCoords(objectNum), true, false);
+        pathFinder->findPath(task.first, task.second, errorCode);
+        double repairTime = getSeconds(startTime);
+        if (errorCode != bmpf::PathFinder::NO_ERROR)
+            bmpf::errMsg("repair error code: ", errorCode);
+        unsigned int repairExpandCnt = pathFinder->getExpandCnt();
+        double repairLength = pathFinder->getPathLength();
+
+        pathFinder->resetGraph();
+        startTime = std::chrono::high_resolution_clock::now();
+        pathFinder->findPath(task.first, task.second, errorCode);
+        double fullTime = getSeconds(startTime);
+        if (errorCode != bmpf::PathFinder::NO_ERROR)
+            bmpf::errMsg("full search error code: ", errorCode);
+
+        bmpf::infoMsg("repair: ", repairTime, " s, ", repairExpandCnt, " cells, length ", repairLength,
+                      " full search: ", fullTime, " s, ", pathFinder->getExpandCnt(), " cells, length ",
+                      pathFinder->getPathLength());
+
+        sumRepairTime += repairTime;
+        sumFullTime += fullTime;
+        pathFinder->deleteObjectFromScene((long) objectNum);
+    }
+
+    bmpf::infoMsg("repair: ", sumRepairTime, " s full search: ", sumFullTime, " s speedup: ",
+                  sumRepairTime > 0 ? sumFullTime / sumRepairTime : 0);
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <scene.h>
+#include <log.h>
+#include <thread>
+#include <chrono>
+#include <base/path_finder.h>
+#include <one_direction_sync_path_finder.h>
+
+/**
+ * задачи планирования для сцены из четырёх роботов
+ */
+const std::vector<std::pair<std::vector<double>, std::vector<double>>> TASKS{
+        {
+                {-2.372, -2.251, 1.977, 0.031, 1.885, 5.093, -2.043, -0.717, -0.893, 0.307, 0.687, -0.148,
+                        0.723, 0.667, -1.421, -2.498, 1.934, -4.705, -2.144, -2.477, 1.529, 0.919, 1.333, 2.003},
+                {0.262, -3.238, 1.314, 2.603, -0.827, -3.604, -1.641, -0.440, 1.958, 1.606, 1.474, -4.645,
+                        -2.421, -0.583, 0.134, -0.834, 2.049, -4.375, -2.353, -2.529, 0.148, -0.707, 0.145, -2.702}
+        },
+        {
+                {-1.696, 0.453, -1.582, -0.569, 0.827, -2.817, -2.769, 0.360, 1.462, 1.441, -1.827, 5.589,
+                        -2.054, -1.892, -0.302, -1.915, 1.601, 5.947, 1.238, -0.023, -0.341, 0.757, 0.534, 0.494},
+                {0.759, -2.957, 0.393, 3.176, 0.857, -4.351, 0.192, -2.326, 0.592, -0.243, 0.344, -3.707,
+                        -0.772, -0.119, -1.855, -1.959, -1.745, -2.263, 1.309, -0.623, 0.860, -2.320, 1.961, 1.648}
+        },
+        {
+                {0.424, -1.120, -0.451, 0.686, 1.911, 2.587, -2.711, -1.546, 0.809, 1.582, -0.477, 3.787,
+                        -1.726, -2.643, -0.098, -0.535, 0.694, -1.908, 2.335, -2.895, -0.173, -0.286, -1.405, -6.011},
+                {0.953, -0.871, 1.649, 0.838, 0.009, -3.227, -2.690, -3.014, 1.621, -0.725, 0.753, 2.779,
+                        -2.377, -0.351, -1.328, 1.305, -0.134, 0.552, 0.072, -0.539, 1.322, 2.754, -1.700, -1.526}
+        },
+};
+
+/**
+ * Замер времени поиска пути многопоточным планировщиком
+ * в зависимости от количества потоков
+ */
+int main() {
+    bmpf::infoMsg("sync path finder benchmark");
+
+    std::shared_ptr<bmpf::Scene> scene = std::make_shared<bmpf::Scene>();
+    scene->loadFromFile("../../../../config/murdf/4robots.json");
+
+    unsigned int maxThreadCnt = std::max(1u, std::thread::hardware_concurrency());
+
+    double baseTime = 0;
+    for (unsigned int threadCnt = 1; threadCnt <= maxThreadCnt; threadCnt *= 2) {
+        auto pathFinder = std::make_shared<bmpf::OneDirectionSyncPathFinder>(
+                scene, false, 1000, 10, 3000, 5, 1, (int) threadCnt
+        );
+
+        unsigned long nodeCnt = 0;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (const auto &task: TASKS) {
+            int errorCode = -1;
+            pathFinder->findPath(task.first, task.second, errorCode);
+            if (errorCode != bmpf::PathFinder::NO_ERROR)
+                bmpf::errMsg("error code: ", errorCode);
+            nodeCnt += pathFinder->getAllProcessedStates().size();
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+
+        double time = (double) std::chrono::duration_cast<std::chrono::milliseconds>(
+                endTime - startTime).count() / 1000;
+        if (threadCnt == 1)
+            baseTime = time;
+
+        bmpf::infoMsg("threads: ", threadCnt, " time: ", time, " s nodes: ", nodeCnt,
+                      " speedup: ", time > 0 ? baseTime / time : 0);
+    }
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "scene.h"
+#include "base/path_node.h"
+#include "one_direction_path_finder.h"
+
+namespace bmpf {
+    /**
+     * @brief Планировщик, улучшающий путь в течение заданного времени (ARA*)
+     *
+     * Планировщик со смещениями вдоль одной из координат, который сначала
+     * быстро находит путь взвешенным A* с большим весом эвристики, а потом,
+     * пока не истекло отведённое время, уменьшает вес на `weightStep` и
+     * продолжает поиск, переиспользуя уже найденные ноды (Anytime Repairing A*).
+     *
+     * Итерация заканчивается, когда приоритет лучшей ноды открытого множества
+     * не меньше стоимости найденного пути до цели, в этот момент путь не более
+     * чем в w раз длиннее кратчайшего. Перед следующей итерацией в открытое
+     * множество возвращаются ноды, стоимость которых уменьшилась уже после
+     * закрытия их координат, приоритеты всех открытых нод пересчитываются
+     * с новым весом, а множество закрытых нод очищается.
+     *
+     * Каждый улучшенный путь сохраняется, их можно получить методом
+     * `getImprovedPaths()`. Поиск заканчивается, когда вес дошёл до 1 или
+     * истекло время; результатом служит лучший из найденных путей
+     */
+    class AnytimePathFinder : public OneDirectionPathFinder {
+    public:
+        /**
+         * конструктор
+         * @param scene сцена
+         * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+         * @param maxOpenSetSize максимальный размер открытого множества
+         * @param gridSize размер сетки планирования
+         * @param maxNodeCnt максимальное кол-во нод в закрытом множестве
+         * @param timeLimit время на улучшение пути, сек; первый путь ищется без ограничения времени
+         * @param initialWeight вес эвристики на первой итерации
+         * @param weightStep на сколько уменьшается вес эвристики после каждой итерации
+         * @param kG коэффициент разницы в углах поворота сочленений робота
+         * @param kD коэффициент разницы в положениях звеньев робота
+         * @param threadCnt количество потоков планировщика
+         * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+         * только при извлечении из открытого множества
+         */
+        AnytimePathFinder(const std::shared_ptr<bmpf::Scene> &scene,
+                          bool showTrace,
+                          unsigned int maxOpenSetSize,
+                          int gridSize,
+                          unsigned int maxNodeCnt,
+                          double timeLimit,
+                          double initialWeight = 3,
+                          double weightStep = 0.5,
+                          unsigned int kG = 1,
+                          unsigned int kD = 0,
+                          int threadCnt = 1,
+                          bool lazyCheck = false
+        );
+
+        /**
+         * такт поиска
+         * @param state текущее состояние планировщика
+         * @return возвращает true, если планирование закончено
+         */
+        bool findTick(std::vector<double> &state) override;
+
+        /**
+         * подготовка к планированию
+         * @param startState начальное состояние
+         * @param endState конечное состояние
+         */
+        void prepare(const std::vector<double> &startState, const std::vector<double> &endState) override;
+
+        /**
+         * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+         * @param startCoords начальные координаты
+         * @param endCoords конечные координаты
+         */
+        void prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) override;
+
+    protected:
+
+        /**
+         * проверка соседней ноды: координаты не должны быть отброшены
+         * в ленивом режиме, а стоимость пути до них должна быть меньше
+         * лучшей известной (в том числе для уже закрытых координат)
+         * @param newKey ключ координат
+         * @param sum приоритет
+         * @param cost стоимость пути от стартовой ноды
+         * @return флаг, может ли нода быть создана, если её координаты доступны
+         */
+        bool _isNeighborNew(const GridKey &newKey, double sum, double cost) override;
+
+        /**
+         * добавить созданную соседнюю ноду в открытое множество, а если её
+         * координаты уже закрыты на этой итерации - в список несогласованных нод
+         * @param node индекс ноды
+         */
+        void _openNode(unsigned int node) override;
+
+        /**
+         * сбросить состояние поиска перед подготовкой
+         */
+        void _resetSearch();
+
+        /**
+         * сохранить путь до лучшей ноды цели, если он короче последнего сохранённого
+         */
+        void _publishPath();
+
+        /**
+         * уменьшить вес эвристики и подготовить открытое множество к следующей итерации
+         */
+        void _startNextIteration();
+
+        /**
+         * закончить поиск с лучшим найденным путём
+         * @return всегда true
+         */
+        bool _finish();
+
+        /**
+         * проверка, истекло ли время на улучшение пути
+         * @return флаг, истекло ли время
+         */
+        bool _isTimeOver() const;
+
+        /**
+         * время на улучшение пути, сек
+         */
+        double _timeLimit;
+        /**
+         * вес эвристики на первой итерации
+         */
+        double _initialWeight;
+        /**
+         * на сколько уменьшается вес эвристики после каждой итерации
+         */
+        double _weightStep;
+        /**
+         * время начала поиска
+         */
+        std::chrono::steady_clock::time_point _searchStartTime;
+        /**
+         * лучшая известная нода для каждого ключа координат
+         */
+        std::unordered_map<GridKey, unsigned int, GridKeyHash> _bestNodes;
+        /**
+         * ноды, стоимость которых уменьшилась после закрытия их координат
+         */
+        std::vector<unsigned int> _inconsNodes;
+        /**
+         * лучшая найденная нода цели
+         */
+        unsigned int _goalNode = PathNodeArena::NO_NODE;
+        /**
+         * найденные пути в порядке улучшения
+         */
+        std::vector<std::vector<std::vector<double>>> _improvedPaths;
+        /**
+         * стоимости найденных путей
+         */
+        std::vector<double> _improvedPathCosts;
+        /**
+         * веса эвристики, с которыми найдены пути
+         */
+        std::vector<double> _improvedPathWeights;
+
+    public:
+
+        /**
+         * получить найденные пути в порядке улучшения (последний - лучший)
+         * @return найденные пути
+         */
+        const std::vector<std::vector<std::vector<double>>> &getImprovedPaths() const { return _improvedPaths; }
+
+        /**
+         * получить стоимости найденных путей
+         * @return стоимости найденных путей
+         */
+        const std::vector<double> &getImprovedPathCosts() const { return _improvedPathCosts; }
+
+        /**
+         * получить веса эвристики, с которыми найдены пути; путь, найденный
+         * на завершённой итерации с весом w, не более чем в w раз длиннее
+         * кратчайшего (если открытое множество не усекалось)
+         * @return веса эвристики
+         */
+        const std::vector<double> &getImprovedPathWeights() const { return _improvedPathWeights; }
+
+        /**
+         * получить время на улучшение пути
+         * @return время на улучшение пути, сек
+         */
+        double getTimeLimit() const { return _timeLimit; }
+
+        /**
+         * задать время на улучшение пути
+         * @param timeLimit время на улучшение пути, сек
+         */
+        void setTimeLimit(double timeLimit) { _timeLimit = timeLimit; }
+    };
+}
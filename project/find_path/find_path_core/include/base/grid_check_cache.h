@@ -0,0 +1,95 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "grid_key.h"
+
+namespace bmpf {
+    /**
+     * @brief Кэш результатов проверки ячеек на коллизии для вложенных сеток
+     *
+     * Сетки с размерами, отличающимися в целое число раз, вложены друг
+     * в друга: ячейка с координатами `coords` сетки, которая в `scale` раз
+     * грубее самой мелкой, соответствует тому же состоянию, что и ячейка
+     * `coords * scale` самой мелкой сетки. Поэтому результаты проверок
+     * хранятся по ключам координат самой мелкой сетки и используются
+     * планировщиками всех уровней
+     */
+    class GridCheckCache {
+    public:
+        /**
+         * конструктор
+         * @param dim размерность координат
+         * @param gridSize размер самой мелкой сетки
+         */
+        GridCheckCache(unsigned long dim, int gridSize) : _keyCoder(dim, gridSize) {}
+
+        /**
+         * найти сохранённый результат проверки
+         * @param coords координаты
+         * @param scale во сколько раз сетка координат грубее самой мелкой
+         * @param enabled в эту переменную записывается результат проверки
+         * @return флаг, найден ли результат
+         */
+        bool find(const std::vector<int> &coords, int scale, bool &enabled);
+
+        /**
+         * сохранить результат проверки
+         * @param coords координаты
+         * @param scale во сколько раз сетка координат грубее самой мелкой
+         * @param enabled флаг, доступны ли координаты
+         */
+        void save(const std::vector<int> &coords, int scale, bool enabled);
+
+        /**
+         * очистить кэш и счётчики
+         */
+        void clear();
+
+    protected:
+        /**
+         * получить ключ ячейки самой мелкой сетки
+         * @param coords координаты
+         * @param scale во сколько раз сетка координат грубее самой мелкой
+         * @return ключ ячейки самой мелкой сетки
+         */
+        GridKey _getKey(const std::vector<int> &coords, int scale) const;
+
+        /**
+         * кодировщик ключей самой мелкой сетки
+         */
+        GridKeyCoder _keyCoder;
+        /**
+         * результаты проверок
+         */
+        std::unordered_map<GridKey, bool, GridKeyHash> _results;
+        /**
+         * кол-во найденных результатов
+         */
+        unsigned long _hitCnt = 0;
+        /**
+         * кол-во запросов, для которых результат не найден
+         */
+        unsigned long _missCnt = 0;
+
+    public:
+        /**
+         * получить кол-во найденных результатов
+         * @return кол-во найденных результатов
+         */
+        unsigned long getHitCnt() const { return _hitCnt; }
+
+        /**
+         * получить кол-во запросов, для которых результат не найден
+         * @return кол-во запросов, для которых результат не найден
+         */
+        unsigned long getMissCnt() const { return _missCnt; }
+
+        /**
+         * получить кол-во сохранённых результатов
+         * @return кол-во сохранённых результатов
+         */
+        unsigned long getSize() const { return _results.size(); }
+    };
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace bmpf {
+
+    /**
+     * @brief Ключ ячейки сетки планирования
+     *
+     * Упакованные в 256 бит целочисленные координаты ячейки сетки
+     * планирования. Упаковку выполняет `GridKeyCoder`, который
+     * гарантирует, что разные координаты дают разные ключи
+     */
+    struct GridKey {
+        /**
+         * количество 64-битных слов ключа
+         */
+        static const unsigned int WORD_CNT = 4;
+
+        /**
+         * слова ключа
+         */
+        uint64_t words[WORD_CNT];
+
+        /**
+         * оператор сравнения
+         * @param other другой ключ
+         * @return флаг, равны ли ключи
+         */
+        bool operator==(const GridKey &other) const {
+            for (unsigned int i = 0; i < WORD_CNT; i++)
+                if (words[i] != other.words[i])
+                    return false;
+            return true;
+        }
+
+        /**
+         * оператор сравнения
+         * @param other другой ключ
+         * @return флаг, различаются ли ключи
+         */
+        bool operator!=(const GridKey &other) const { return !(*this == other); }
+    };
+
+    /**
+     * Хэш ключа ячейки сетки планирования
+     */
+    struct GridKeyHash {
+        /**
+         * получить хэш ключа
+         * @param key ключ
+         * @return хэш ключа
+         */
+        std::size_t operator()(const GridKey &key) const {
+            uint64_t hash = 0;
+            for (uint64_t word: key.words) {
+                // перемешивание splitmix64
+                word += 0x9e3779b97f4a7c15ULL + hash;
+                word = (word ^ (word >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                word = (word ^ (word >> 27)) * 0x94d049bb133111ebULL;
+                hash = word ^ (word >> 31);
+            }
+            return (std::size_t) hash;
+        }
+    };
+
+    /**
+     * @brief Упаковщик координат сетки планирования в ключи
+     *
+     * Каждая координата из диапазона [-1, gridSize] (соседи крайних ячеек
+     * тоже должны кодироваться, т.к. их ищут в множествах до проверки
+     * границ) занимает фиксированное число бит, поле координаты не
+     * пересекает границу слова. В отличие от свёртки вида
+     * sum(coords[i]*gridSize^i) такой ключ не переполняется на сценах
+     * из нескольких роботов, а если координаты не помещаются в 256 бит,
+     * то конструктор бросает исключение
+     */
+    class GridKeyCoder {
+    public:
+        /**
+         * конструктор пустого упаковщика (размерность 0)
+         */
+        GridKeyCoder() = default;
+
+        /**
+         * конструктор
+         * @param dim размерность координат
+         * @param gridSize размер сетки планирования
+         */
+        GridKeyCoder(unsigned long dim, int gridSize);
+
+        /**
+         * упаковать координаты в ключ
+         * @param coords координаты
+         * @return ключ
+         */
+        GridKey encode(const std::vector<int> &coords) const;
+
+        /**
+         * распаковать ключ в координаты
+         * @param key ключ
+         * @param coords координаты, вектор переиспользуется, если его размер
+         * совпадает с размерностью упаковщика
+         */
+        void decode(const GridKey &key, std::vector<int> &coords) const;
+
+        /**
+         * получить координату из ключа
+         * @param key ключ
+         * @param index номер координаты
+         * @return координата
+         */
+        int getCoord(const GridKey &key, unsigned long index) const {
+            return (int) ((key.words[index / _coordsPerWord] >> ((index % _coordsPerWord) * _bitCnt)) & _mask) - 1;
+        }
+
+    private:
+        /**
+         * размерность координат
+         */
+        unsigned long _dim = 0;
+        /**
+         * размер сетки планирования
+         */
+        int _gridSize = 0;
+        /**
+         * количество бит на одну координату
+         */
+        unsigned int _bitCnt = 1;
+        /**
+         * количество координат в одном слове ключа
+         */
+        unsigned int _coordsPerWord = 64;
+        /**
+         * маска поля одной координаты
+         */
+        uint64_t _mask = 1;
+
+    public:
+        /**
+         * получить размерность координат
+         * @return размерность координат
+         */
+        unsigned long getDim() const { return _dim; }
+
+        /**
+         * получить количество бит на одну координату
+         * @return количество бит на одну координату
+         */
+        unsigned int getBitCnt() const { return _bitCnt; }
+
+        /**
+         * получить максимальную размерность координат для заданного размера сетки
+         * @param gridSize размер сетки планирования
+         * @return максимальная размерность координат
+         */
+        static unsigned long getMaxDim(int gridSize);
+    };
+}
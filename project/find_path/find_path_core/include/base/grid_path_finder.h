@@ -9,6 +9,7 @@
 #include "path_finder.h"
 #include "log.h"
 #include "state.h"
+#include "grid_key.h"
 
 #include <iostream>
 
@@ -67,7 +68,15 @@ namespace bmpf {
          * @param coords координаты
          * @return состояние
          */
-        std::vector<double> coordsToState(std::vector<int> &coords) const;
+        std::vector<double> coordsToState(const std::vector<int> &coords) const;
+
+        /**
+         * преобразование целочисленных координат в вещественное состояние
+         * без выделения памяти, если размер буфера уже подходит
+         * @param coords координаты
+         * @param state в эту переменную записывается состояние
+         */
+        void coordsToState(const std::vector<int> &coords, std::vector<double> &state) const;
 
         /**
          * преобразование целочисленных координат в вещественное состояние
@@ -82,7 +91,14 @@ namespace bmpf {
          * @param coords координаты
          * @return флаг, доступны ли целочисленных координаты
          */
-        bool checkCoords(std::vector<int> coords);
+        bool checkCoords(const std::vector<int> &coords);
+
+        /**
+         * Проверка, лежат ли целочисленные координаты внутри сетки планирования
+         * @param coords координаты
+         * @return флаг, лежат ли координаты внутри сетки
+         */
+        bool isCoordsInGrid(const std::vector<int> &coords) const;
 
         /**
          * поиск пути из состояния `startCoords` в состояние `endCoords`,
@@ -197,6 +213,12 @@ namespace bmpf {
          * флаг, выполнялось ли последнее планирование по координатам
          */
         bool _coordsUsed = false;
+        /**
+         * упаковщик координат сетки планирования в ключи,
+         * создаётся заново при каждой подготовке к планированию,
+         * т.к. количество сочленений сцены может меняться
+         */
+        GridKeyCoder _keyCoder;
         /**
          * построенный путь (по координатам сетки планирования)
          * для удобства сопоставления с путём в конфигурационном
@@ -206,12 +228,24 @@ namespace bmpf {
 
     public:
 
+        /**
+         * получить размер сетки планирования
+         * @return размер сетки планирования
+         */
+        int getGridSize() const { return _gridSize; }
+
         /**
          * получить построенный по координатам сетки планирования путь
          * @return построенный по координатам сетки планирования путь
          */
         const std::vector<std::vector<int>> &getBuildedGridPath() const { return _buildedGridPath; }
 
+        /**
+         * получить упаковщик координат сетки планирования в ключи
+         * @return упаковщик координат сетки планирования в ключи
+         */
+        const GridKeyCoder &getKeyCoder() const { return _keyCoder; }
+
         /**
          * получить состояние сцены, соответствующее стартовым координатам планирования на сетке
          * @return состояние сцены, соответствующее стартовым координатам планирования на сетке
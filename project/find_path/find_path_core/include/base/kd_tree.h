@@ -0,0 +1,119 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+namespace bmpf {
+
+    /**
+     * @brief k-d дерево точек пространства состояний
+     *
+     * Дерево строится инкрементально: каждая новая точка спускается от корня,
+     * на глубине d сравниваясь с узлами по координате d mod dim, и становится
+     * листом. Поиск ближайшей (в евклидовой метрике) точки отбрасывает
+     * поддеревья, которые лежат дальше лучшей найденной точки. Точки,
+     * добавляемые в случайном порядке (например, при построении дерева RRT),
+     * дают дерево глубины O(log n) в среднем.
+     *
+     * Точки адресуются индексами в порядке добавления
+     */
+    class KDTree {
+    public:
+        /**
+         * индекс, обозначающий отсутствие точки
+         */
+        static const unsigned int NO_POINT = std::numeric_limits<unsigned int>::max();
+
+        /**
+         * конструктор
+         * @param dim размерность точек
+         */
+        explicit KDTree(unsigned long dim = 0) : _dim(dim) {}
+
+        /**
+         * сбросить дерево
+         * @param dim размерность точек
+         */
+        void reset(unsigned long dim);
+
+        /**
+         * добавить точку
+         * @param point точка
+         * @return индекс точки
+         */
+        unsigned int add(const std::vector<double> &point);
+
+        /**
+         * найти ближайшую точку
+         * @param point точка, для которой ищется ближайшая
+         * @return индекс ближайшей точки, NO_POINT, если дерево пустое
+         */
+        unsigned int nearest(const std::vector<double> &point) const;
+
+        /**
+         * найти несколько ближайших точек
+         * @param point точка, для которой ищутся ближайшие
+         * @param cnt максимальное кол-во точек
+         * @return индексы точек в порядке возрастания расстояния
+         */
+        std::vector<unsigned int> nearest(const std::vector<double> &point, unsigned long cnt) const;
+
+        /**
+         * получить точку
+         * @param index индекс точки
+         * @return точка
+         */
+        std::vector<double> getPoint(unsigned int index) const {
+            return {_points.begin() + index * _dim, _points.begin() + (index + 1) * _dim};
+        }
+
+    protected:
+        /**
+         * квадрат расстояния от точки до точки дерева
+         * @param point точка
+         * @param index индекс точки дерева
+         * @return квадрат расстояния
+         */
+        double _getSqrDistance(const std::vector<double> &point, unsigned int index) const;
+
+        /**
+         * размерность точек
+         */
+        unsigned long _dim;
+        /**
+         * координаты точек, записанные подряд
+         */
+        std::vector<double> _points;
+        /**
+         * индексы левых потомков (меньше по координате разбиения)
+         */
+        std::vector<unsigned int> _left;
+        /**
+         * индексы правых потомков (не меньше по координате разбиения)
+         */
+        std::vector<unsigned int> _right;
+        /**
+         * глубины точек
+         */
+        std::vector<unsigned int> _depths;
+
+    public:
+        /**
+         * получить количество точек
+         * @return количество точек
+         */
+        unsigned long size() const { return _left.size(); }
+
+        /**
+         * получить флаг, пустое ли дерево
+         * @return флаг, пустое ли дерево
+         */
+        bool empty() const { return _left.empty(); }
+
+        /**
+         * получить размерность точек
+         * @return размерность точек
+         */
+        unsigned long getDim() const { return _dim; }
+    };
+}
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <set>
+#include <unordered_map>
+#include <limits>
 #include "path_node.h"
+#include "open_set.h"
 #include "scene.h"
 #include "grid_path_finder.h"
 
@@ -22,6 +25,23 @@ namespace bmpf {
      * используется две величины: ошибка по углам поворота робота и ошибка
      * по положениям звеньев. Им соответствуют коэффициенты kG и kD
      *
+     * Той же метрикой измеряется стоимость каждого шага, поэтому у каждой
+     * ноды хранится стоимость g пути от стартовой ноды, а приоритет ноды
+     * в открытом множестве равен g + w * h, где h - эвристика расстояния до
+     * цели, w - вес эвристики (`setHeuristicWeight()`). При w = 1 это A*,
+     * при w > 1 - взвешенный A*, найденный путь которого не более чем в w
+     * раз длиннее кратчайшего. По умолчанию вес бесконечный, и приоритет
+     * равен h, т.е. поиск жадный: он быстро находит путь, но путь этот
+     * обычно далёк от кратчайшего
+     *
+     * В ленивом режиме (флаг `lazyCheck` конструктора) соседи попадают в
+     * открытое множество без проверки на коллизии, а проверяется только нода,
+     * извлечённая из открытого множества для раскрытия. Недоступная нода
+     * отбрасывается, и поиск продолжается со следующей. Большая часть
+     * порождённых соседей так и не раскрывается, поэтому проверок становится
+     * меньше; их число можно узнать методами `getLazyCheckCnt()` и
+     * `getSavedCheckCnt()`
+     *
      * Получается, что в данном планировщике одно и тоже
      * пространство конфигураций описывается двумя пространствами:
      * вещественным пространством состояний и целочисленным пространством
@@ -39,11 +59,6 @@ namespace bmpf {
      */
     class NodeGridPathFinder : public GridPathFinder {
     public:
-        /**
-         * Ошибка планирования: достигнут предельный размер открытого множества
-         */
-        static const int ERROR_REACHED_MAX_NODE_CNT = 4;
-
         /**
          * конструктор
          * @param scene сцена
@@ -54,6 +69,8 @@ namespace bmpf {
          * @param kG коэффициент разницы в углах поворота сочленений робота
          * @param kD коэффициент разницы в положениях звеньев робота
          * @param threadCnt количество потоков планировщика
+         * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+         * только при извлечении из открытого множества
          */
         NodeGridPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
                            bool showTrace,
@@ -61,9 +78,10 @@ namespace bmpf {
                            unsigned int maxNodeCnt,
                            unsigned int kG = 1,
                            unsigned int kD = 0,
-                           int threadCnt = 1
+                           int threadCnt = 1,
+                           bool lazyCheck = false
         ) : GridPathFinder(scene, showTrace, gridSize, threadCnt),
-            _maxNodeCnt(maxNodeCnt), _kG(kG), _kD(kD) {}
+            _maxNodeCnt(maxNodeCnt), _kG(kG), _kD(kD), _openSet(_nodes), _lazyCheck(lazyCheck) {}
 
         /**
          * возвращает координаты всех перебранных точек пространства планирования
@@ -82,26 +100,41 @@ namespace bmpf {
         /**
          * для всех соседей текущей ноды метод должен добавить только
          * подходящих в множество _openSet, если один из соседей
-         * имеет целевые указания (т.е. найден путь), то возвращаем указатель на эту ноду,
-         * в противном случае должен быть возвращён nullptr
-         * @param currentNode текущая нода
+         * имеет целевые указания (т.е. найден путь), то возвращаем индекс этой ноды,
+         * в противном случае должен быть возвращён PathNodeArena::NO_NODE
+         * @param currentNode индекс текущей ноды
          * @param endCoords целевые координаты
-         * @return найденная нода или null
+         * @return индекс найденной ноды или PathNodeArena::NO_NODE
+         */
+        virtual unsigned int _forEachNeighbor(unsigned int currentNode, std::vector<int> &endCoords) = 0;
+
+        /**
+         * проверка, можно ли создать соседнюю ноду: координаты не должны быть
+         * обработаны, в открытом множестве не должно быть ноды с такими
+         * координатами и не худшей метрикой, а сами координаты должны быть
+         * доступны. Метод не меняет состояние планировщика, поэтому его
+         * можно вызывать из нескольких потоков одновременно
+         * @param newCoords координаты
+         * @param newKey ключ координат
+         * @param sum приоритет
+         * @param cost стоимость пути от стартовой ноды
+         * @return флаг, можно ли создать ноду
          */
-        virtual std::shared_ptr<PathNode> _forEachNeighbor(
-                std::shared_ptr<PathNode> currentNode, std::vector<int> &endCoords
-        ) = 0;
+        bool checkNeighbor(const std::vector<int> &newCoords, const GridKey &newKey, double sum, double cost);
 
         /**
-         * вспомогательный метод, возвращающий указатель на новую ноду только,
-         * если её можно создать
+         * вспомогательный метод, создающий новую ноду только,
+         * если её можно создать; стоимость ноды считается
+         * по стоимости предка
          * @param newCoords координаты
-         * @param parentNode указатель на предка
-         * @param sum значение метрики
-         * @return указатель на новую ноду
+         * @param newKey ключ координат
+         * @param parentNode индекс предка
+         * @param sum приоритет
+         * @return индекс новой ноды или PathNodeArena::NO_NODE
          */
-        std::shared_ptr<PathNode>
-        tryToGetNeighborPtr(std::vector<int> newCoords, const std::shared_ptr<PathNode> &parentNode, double sum);
+        unsigned int tryToGetNeighbor(
+                const std::vector<int> &newCoords, const GridKey &newKey, unsigned int parentNode, double sum
+        );
 
         /**
          * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
@@ -131,7 +164,7 @@ namespace bmpf {
         /**
          * перейти к следующей ноде из открытого списка
          */
-        void nextNode() { _openSet.erase(_openSet.begin()); }
+        void nextNode() { _openSet.pop(); }
 
         /**
          * получить расстояние между звеньями (по координатам планировщика)
@@ -139,7 +172,7 @@ namespace bmpf {
          * @param b координаты второй точки
          * @return
          */
-        double _findLinkDistance(std::vector<int> &a, std::vector<int> &b);
+        double _findLinkDistance(const std::vector<int> &a, const std::vector<int> &b);
 
     protected:
 
@@ -147,29 +180,118 @@ namespace bmpf {
          * переместить ноду из открытого множества открытых в множество закрытых
          * @param node нода
          */
-        void _moveNodeFromOpenedToClosed(const std::shared_ptr<PathNode> &node);
+        void _moveNodeFromOpenedToClosed(unsigned int node);
 
         /**
          * поиск координат в списке закрытых нод
-         * @param coords координаты
+         * @param key ключ координат
          * @return флаг, содержатся ли координаты в закрытом списке
          */
-        bool _findCoordsInClosedList(std::vector<int> &coords);
+        bool _findCoordsInClosedList(const GridKey &key);
 
         /**
          * поиск координат в списке открытых нод
-         * @param coords
+         * @param key ключ координат
          * @return флаг, содержатся ли координаты в открытом списке
          */
-        bool _findCoordsInOpenedList(std::vector<int> &coords);
+        bool _findCoordsInOpenedList(const GridKey &key);
 
         /**
-         * Получить метрику ноды
+         * Получить эвристику ноды (оценку стоимости пути до цели)
          * @param curCoords текущие координаты
          * @param endCoords целевые координаты
-         * @return метрика ноды
+         * @return эвристика ноды
+         */
+        double _getPathNodeWeight(const std::vector<int> &curCoords, const std::vector<int> &endCoords);
+
+        /**
+         * получить стоимость перехода между координатами
+         * (в той же метрике, что и эвристика)
+         * @param a координаты первой точки
+         * @param b координаты второй точки
+         * @return стоимость перехода
+         */
+        double _getStepCost(const std::vector<int> &a, const std::vector<int> &b);
+
+        /**
+         * получить приоритет ноды в открытом множестве
+         * @param cost стоимость пути от стартовой ноды
+         * @param heuristic эвристика
+         * @return приоритет ноды
+         */
+        double _getPriority(double cost, double heuristic) const {
+            if (_heuristicWeight == std::numeric_limits<double>::infinity())
+                return heuristic;
+            return cost + _heuristicWeight * heuristic;
+        }
+
+        /**
+         * проверка соседней ноды по множествам планировщика: координаты не
+         * должны быть обработаны, а в открытом множестве не должно быть ноды
+         * с такими координатами и не худшей метрикой
+         * @param newKey ключ координат
+         * @param sum приоритет
+         * @param cost стоимость пути от стартовой ноды
+         * @return флаг, может ли нода быть создана, если её координаты доступны
+         */
+        virtual bool _isNeighborNew(const GridKey &newKey, double sum, double cost);
+
+        /**
+         * добавить созданную соседнюю ноду в открытое множество
+         * @param node индекс ноды
+         */
+        virtual void _openNode(unsigned int node) { _openSet.push(node); }
+
+        /**
+         * найти результат проверки координат на коллизии, сохранённый ранее;
+         * по умолчанию результаты не сохраняются
+         * @param coords координаты
+         * @param enabled в эту переменную записывается результат проверки
+         * @return флаг, найден ли результат
+         */
+        virtual bool _findCheckResult(const std::vector<int> &/*coords*/, bool &/*enabled*/) { return false; }
+
+        /**
+         * сохранить результат проверки координат на коллизии
+         * @param coords координаты
+         * @param enabled флаг, доступны ли координаты
+         */
+        virtual void _saveCheckResult(const std::vector<int> &/*coords*/, bool /*enabled*/) {}
+
+        /**
+         * проверка доступности координат с использованием сохранённых результатов проверок
+         * @param coords координаты
+         * @return флаг, доступны ли координаты
+         */
+        bool _checkCoordsWithResults(const std::vector<int> &coords);
+
+        /**
+         * очистить пакет соседей текущей ноды
+         */
+        void _clearNeighbors() { _neighborCnt = 0; }
+
+        /**
+         * добавить в пакет соседа текущей ноды
+         * @param currentCoords координаты текущей ноды
+         * @param offset смещение соседа
+         * @param endCoords целевые координаты
+         */
+        void _addNeighbor(
+                const std::vector<int> &currentCoords, const std::vector<int> &offset, const std::vector<int> &endCoords
+        );
+
+        /**
+         * @brief проверить пакет соседей и добавить подходящих в открытое множество
+         * Сначала соседи отбираются по множествам планировщика и границам сетки,
+         * потом все оставшиеся проверяются на коллизии одним обращением к
+         * коллайдеру. Ноды создаются в порядке добавления соседей в пакет
+         * @param currentNode индекс текущей ноды
+         * @param endKey ключ целевых координат
+         * @param maxOpenSetSize максимальный размер открытого множества
+         * @return индекс ноды с целевыми координатами, если поиск жадный и она
+         * порождена, иначе PathNodeArena::NO_NODE
          */
-        double _getPathNodeWeight(std::vector<int> curCoords, std::vector<int> &endCoords);
+        unsigned int _acceptNeighbors(unsigned int currentNode, const GridKey &endKey, unsigned int maxOpenSetSize);
 
         /**
          * коэффициент разницы в углах поворота сочленений робота
@@ -180,25 +302,198 @@ namespace bmpf {
          */
         unsigned int _kD;
         /**
-         * Последняя нода планирования
+         * индекс последней ноды планирования
          */
-        std::shared_ptr<PathNode> _endNode;
+        unsigned int _endNode = PathNodeArena::NO_NODE;
         /**
-         * список закрытых нод
+         * хранилище нод текущего поиска
          */
-        std::vector<std::shared_ptr<PathNode>> _closedNodes;
+        PathNodeArena _nodes;
         /**
-         * неупорядоченное множество свёрток обработанных состояний (так быстрее)
+         * индексы закрытых нод
          */
-        std::unordered_set<long> _closedStateConvCodeSet;
+        std::vector<unsigned int> _closedNodes;
         /**
-         * Открытое множество нод для обработки (упорядочено по метрике)
+         * индексы обработанных нод по ключам их координат
          */
-        std::set<PathNodePtr> _openSet;
+        std::unordered_map<GridKey, unsigned int, GridKeyHash> _closedNodeIndex;
+        /**
+         * ключ целевых координат
+         */
+        GridKey _endKey{};
+        /**
+         * Открытое множество нод для обработки (куча по метрике с хэш-индексом по координатам)
+         */
+        OpenSet _openSet;
         /**
          * максимальное количество нод
          */
         unsigned int _maxNodeCnt;
+        /**
+         * координаты соседей текущей ноды (буферы переиспользуются между тактами)
+         */
+        std::vector<std::vector<int>> _neighborCoords;
+        /**
+         * ключи координат соседей текущей ноды
+         */
+        std::vector<GridKey> _neighborKeys;
+        /**
+         * эвристики соседей текущей ноды
+         */
+        std::vector<double> _neighborHeuristics;
+        /**
+         * стоимости шагов от текущей ноды до соседей
+         */
+        std::vector<double> _neighborStepCosts;
+        /**
+         * стоимости путей до соседей текущей ноды
+         */
+        std::vector<double> _neighborCosts;
+        /**
+         * приоритеты соседей текущей ноды
+         */
+        std::vector<double> _neighborSums;
+        /**
+         * флаги доступности соседей текущей ноды
+         */
+        std::vector<char> _neighborEnabled;
+        /**
+         * номера соседей, которых нужно проверить на коллизии
+         */
+        std::vector<unsigned long> _candidateNeighbors;
+        /**
+         * состояния соседей, которых нужно проверить на коллизии, записанные подряд
+         */
+        std::vector<double> _candidateStates;
+        /**
+         * состояние одного соседа
+         */
+        std::vector<double> _neighborState;
+        /**
+         * количество соседей в пакете
+         */
+        unsigned long _neighborCnt = 0;
+        /**
+         * кэш кинематики текущей ноды (буферы переиспользуются между тактами)
+         */
+        FKCache _fkCache;
+        /**
+         * флаг ленивого режима: ноды проверяются на коллизии только
+         * при извлечении из открытого множества
+         */
+        bool _lazyCheck;
+        /**
+         * неупорядоченное множество ключей координат нод, отброшенных
+         * в ленивом режиме из-за коллизий
+         */
+        std::unordered_set<GridKey, GridKeyHash> _disabledKeySet;
+        /**
+         * количество проверок нод, извлечённых из открытого множества
+         */
+        unsigned long _lazyCheckCnt = 0;
+        /**
+         * вес эвристики w в приоритете g + w * h
+         */
+        double _heuristicWeight = std::numeric_limits<double>::infinity();
+        /**
+         * координаты, для которых в `_currentLinkPositions` посчитаны положения звеньев
+         */
+        std::vector<int> _currentLinkCoords;
+        /**
+         * положения звеньев в текущей ноде
+         */
+        std::vector<double> _currentLinkPositions;
+        /**
+         * координаты, для которых в `_endLinkPositions` посчитаны положения звеньев
+         */
+        std::vector<int> _endLinkCoords;
+        /**
+         * положения звеньев в целевых координатах
+         */
+        std::vector<double> _endLinkPositions;
+
+    private:
+        /**
+         * обновить кэш положений звеньев, если он посчитан для других координат
+         * @param coords координаты
+         * @param cachedCoords координаты, для которых посчитан кэш
+         * @param positions кэш положений звеньев
+         */
+        void _cacheLinkPositions(
+                const std::vector<int> &coords, std::vector<int> &cachedCoords, std::vector<double> &positions
+        );
+
+    public:
+
+        /**
+         * получить хранилище нод текущего поиска
+         * @return хранилище нод текущего поиска
+         */
+        const PathNodeArena &getNodes() const { return _nodes; }
+
+        /**
+         * получить индексы закрытых нод (в порядке закрытия)
+         * @return индексы закрытых нод
+         */
+        const std::vector<unsigned int> &getClosedNodes() const { return _closedNodes; }
+
+        /**
+         * получить индексы обработанных нод по ключам их координат
+         * @return индексы обработанных нод по ключам их координат
+         */
+        const std::unordered_map<GridKey, unsigned int, GridKeyHash> &getClosedNodeIndex() const {
+            return _closedNodeIndex;
+        }
+
+        /**
+         * получить индекс последней ноды планирования
+         * @return индекс последней ноды планирования или PathNodeArena::NO_NODE, если путь не найден
+         */
+        unsigned int getEndNode() const { return _endNode; }
+
+        /**
+         * получить флаг ленивого режима
+         * @return флаг ленивого режима
+         */
+        bool isLazyCheck() const { return _lazyCheck; }
+
+        /**
+         * получить количество проверок на коллизии, выполненных в ленивом режиме
+         * при извлечении нод из открытого множества
+         * @return количество проверок
+         */
+        unsigned long getLazyCheckCnt() const { return _lazyCheckCnt; }
+
+        /**
+         * получить количество проверок на коллизии, которых ленивый режим
+         * избежал: ноды были порождены и к концу поиска так и остались
+         * в открытом множестве непроверенными
+         * @return количество сэкономленных проверок
+         */
+        unsigned long getSavedCheckCnt() const;
+
+        /**
+         * получить вес эвристики
+         * @return вес эвристики
+         */
+        double getHeuristicWeight() const { return _heuristicWeight; }
+
+        /**
+         * задать вес эвристики w в приоритете g + w * h: 1 - A*,
+         * больше 1 - взвешенный A*, бесконечность - жадный поиск по эвристике
+         * @param heuristicWeight вес эвристики, не меньше 1
+         */
+        void setHeuristicWeight(double heuristicWeight) {
+            if (!(heuristicWeight >= 1)) {
+                char buf[1024];
+                sprintf(buf,
+                        "NodeGridPathFinder::setHeuristicWeight() ERROR: \n heuristic weight is %f, it must be >= 1",
+                        heuristicWeight
+                );
+                throw std::invalid_argument(buf);
+            }
+            _heuristicWeight = heuristicWeight;
+        }
 
     };
 
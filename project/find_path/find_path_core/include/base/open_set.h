@@ -0,0 +1,191 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "path_node.h"
+#include "grid_key.h"
+
+namespace bmpf {
+
+    /**
+     * @brief Открытое множество нод планировщика
+     *
+     * Открытое множество реализовано бинарной кучей (минимум метрики в вершине)
+     * и хэш-индексом "ключ координат -> позиция в куче". Это даёт проверку
+     * принадлежности за O(1), добавление, извлечение лучшей ноды и
+     * уменьшение метрики уже добавленной ноды за O(log n).
+     *
+     * Сами ноды хранятся в хранилище `PathNodeArena`, множество оперирует
+     * их индексами.
+     *
+     * Ноды с одинаковой метрикой не схлопываются: при равенстве метрик
+     * первой извлекается нода, дальше отстоящая от стартовой, а при
+     * равенстве и этого значения - добавленная раньше
+     */
+    class OpenSet {
+    public:
+        /**
+         * конструктор
+         * @param nodes хранилище нод
+         */
+        explicit OpenSet(const PathNodeArena &nodes) : _nodes(nodes) {}
+
+        /**
+         * добавить ноду в открытое множество; если нода с такими
+         * координатами уже есть, то она заменяется новой
+         * (если метрика новой ноды меньше)
+         * @param node индекс ноды в хранилище
+         * @return флаг, изменилось ли открытое множество
+         */
+        bool push(unsigned int node);
+
+        /**
+         * получить лучшую ноду (с минимальной метрикой)
+         * @return индекс лучшей ноды в хранилище
+         */
+        unsigned int top() const { return _heap.front().node; }
+
+        /**
+         * удалить лучшую ноду
+         */
+        void pop();
+
+        /**
+         * удалить ноду по ключу координат
+         * @param key ключ координат
+         * @return флаг, была ли удалена нода
+         */
+        bool erase(const GridKey &key);
+
+        /**
+         * найти ноду по ключу координат
+         * @param key ключ координат
+         * @return индекс ноды в хранилище или PathNodeArena::NO_NODE,
+         * если нод с такими координатами нет
+         */
+        unsigned int find(const GridKey &key) const;
+
+        /**
+         * проверка, содержатся ли координаты в открытом множестве
+         * @param key ключ координат
+         * @return флаг, содержатся ли координаты в открытом множестве
+         */
+        bool contains(const GridKey &key) const { return _index.find(key) != _index.end(); }
+
+        /**
+         * @brief ограничить размер открытого множества
+         * Если размер превышает maxSize больше, чем на восьмую часть,
+         * из множества удаляются худшие ноды, пока размер не станет равным maxSize.
+         * Запас нужен, чтобы не перестраивать кучу при каждом добавлении
+         * @param maxSize максимальный размер открытого множества, 0 - без ограничений
+         */
+        void truncate(unsigned int maxSize);
+
+        /**
+         * очистить открытое множество
+         */
+        void clear();
+
+        /**
+         * получить размер открытого множества
+         * @return размер открытого множества
+         */
+        std::size_t size() const { return _heap.size(); }
+
+        /**
+         * проверка, пустое ли открытое множество
+         * @return флаг, пустое ли открытое множество
+         */
+        bool empty() const { return _heap.empty(); }
+
+        /**
+         * получить индексы всех нод открытого множества (в порядке кучи)
+         * @return индексы нод в хранилище
+         */
+        std::vector<unsigned int> getNodes() const;
+
+    private:
+        /**
+         * тип хэш-индекса: ключ координат -> позиция в куче
+         */
+        using Index = std::unordered_map<GridKey, std::size_t, GridKeyHash>;
+
+        /**
+         * Элемент кучи
+         */
+        struct Entry {
+            /**
+             * метрика ноды (копия из хранилища, чтобы не обращаться к нему при сравнении)
+             */
+            double sum;
+            /**
+             * сколько нод отделяют ноду от стартовой
+             */
+            unsigned int order;
+            /**
+             * индекс ноды в хранилище
+             */
+            unsigned int node;
+            /**
+             * порядковый номер добавления (для разрешения равенства метрик)
+             */
+            unsigned long serial;
+            /**
+             * элемент хэш-индекса, соответствующий ноде (указатели на
+             * элементы unordered_map не инвалидируются при перехэшировании)
+             */
+            Index::value_type *item;
+        };
+
+        /**
+         * сравнение элементов кучи
+         * @param a первый элемент
+         * @param b второй элемент
+         * @return флаг, должен ли первый элемент быть извлечён раньше второго
+         */
+        static bool _isBetter(const Entry &a, const Entry &b);
+
+        /**
+         * поменять местами элементы кучи, обновив индекс
+         * @param i позиция первого элемента
+         * @param j позиция второго элемента
+         */
+        void _swap(std::size_t i, std::size_t j);
+
+        /**
+         * поднять элемент кучи к вершине
+         * @param pos позиция элемента
+         */
+        void _siftUp(std::size_t pos);
+
+        /**
+         * опустить элемент кучи к листьям
+         * @param pos позиция элемента
+         */
+        void _siftDown(std::size_t pos);
+
+        /**
+         * удалить элемент кучи
+         * @param pos позиция элемента
+         */
+        void _removeAt(std::size_t pos);
+
+        /**
+         * хранилище нод
+         */
+        const PathNodeArena &_nodes;
+        /**
+         * бинарная куча
+         */
+        std::vector<Entry> _heap;
+        /**
+         * индекс: ключ координат -> позиция в куче
+         */
+        Index _index;
+        /**
+         * счётчик добавлений
+         */
+        unsigned long _serial = 0;
+    };
+}
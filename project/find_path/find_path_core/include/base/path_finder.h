@@ -7,12 +7,14 @@
 #include <unordered_set>
 #include <scene.h>
 #include <json/json.h>
+#include <atomic>
 #include <chrono>
 #include "base/collider.h"
 #include "log.h"
 #include "solid_collider.h"
 #include "solid_sync_collider.h"
 #include "state.h"
+#include "ik_solver.h"
 
 namespace bmpf {
     /**
@@ -36,6 +38,29 @@ namespace bmpf {
          * Не удалось найти путь
          */
         static const int ERROR_CAN_NOT_FIND_PATH = 1;
+        /**
+         * Достигнуто максимальное кол-во нод (вершин, ячеек), которые
+         * планировщику разрешено раскрыть
+         */
+        static const int ERROR_REACHED_MAX_NODE_CNT = 4;
+        /**
+         * Не удалось найти безколлизионное состояние по целевым положениям рабочих инструментов
+         */
+        static const int ERROR_CAN_NOT_SOLVE_IK = 5;
+        /**
+         * Планирование отменено (см. `cancel()`)
+         */
+        static const int ERROR_CANCELLED = 6;
+        /**
+         * количество случайных состояний, по которым строится
+         * матрица разрешённых столкновений
+         */
+        static const unsigned long ACM_SAMPLE_CNT = 2000;
+        /**
+         * зерно генератора случайных состояний, по которым строится
+         * матрица разрешённых столкновений
+         */
+        static const unsigned int ACM_SEED = 42;
 
         /**
          * конструктор
@@ -46,15 +71,38 @@ namespace bmpf {
         PathFinder(const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, int threadCnt = 1);
 
         /**
-         * Поиск пути
+         * деструктор
+         */
+        virtual ~PathFinder() = default;
+
+        /**
+         * @brief Поиск пути
+         * между тактами поиска проверяется флаг отмены, если он выставлен,
+         * поиск прерывается с кодом ошибки ERROR_CANCELLED
          * @param startState стартовое состояние
          * @param endState конечное состояние
          * @param errorCode в эту переменную записывается код ошибки
-         * @return
+         * @return построенный путь
          */
         std::vector<std::vector<double>>
         findPath(const std::vector<double> &startState, const std::vector<double> &endState, int &errorCode);
 
+        /**
+         * @brief Поиск пути к целевым положениям рабочих инструментов
+         * конечное состояние находится решателем обратной кинематики (см. `IKSolver`),
+         * который при первом вызове стартует со стартового состояния, а при
+         * следующих - с предыдущего найденного решения
+         * @param startState стартовое состояние
+         * @param endPoses целевые матрицы преобразования рабочих инструментов
+         * (по одной на каждого робота с сочленениями)
+         * @param errorCode в эту переменную записывается код ошибки
+         * @return построенный путь
+         */
+        std::vector<std::vector<double>>
+        findPathToPoses(
+                const std::vector<double> &startState, const std::vector<Eigen::Matrix4d> &endPoses, int &errorCode
+        );
+
         /**
          * такт поиска
          * @param state текущее состояние планировщика
@@ -74,6 +122,32 @@ namespace bmpf {
          */
         virtual void buildPath() = 0;
 
+        /**
+         * @brief отменить планирование
+         * выставляет флаг отмены, который проверяется между тактами поиска;
+         * метод можно вызывать из другого потока. Флаг остаётся выставленным,
+         * пока не будет сброшен методом `clearCancel()`
+         */
+        void cancel() { _cancelFlag->store(true); }
+
+        /**
+         * сбросить флаг отмены
+         */
+        void clearCancel() { _cancelFlag->store(false); }
+
+        /**
+         * проверить, выставлен ли флаг отмены
+         * @return флаг, отменено ли планирование
+         */
+        bool isCancelled() const { return _cancelFlag->load(); }
+
+        /**
+         * задать флаг отмены, например, общий со внешним планировщиком,
+         * чтобы вложенные планировщики отменялись вместе с ним
+         * @param cancelFlag флаг отмены
+         */
+        void setCancelFlag(const std::shared_ptr<std::atomic<bool>> &cancelFlag) { _cancelFlag = cancelFlag; }
+
         /**
          * обновить коллайдер по сцене
          */
@@ -95,6 +169,21 @@ namespace bmpf {
          */
         bool divideCheckPathSegment(const std::vector<double> &prevPoint, std::vector<double> nextPoint, int checkCnt);
 
+        /**
+         * @brief добавить в буфер состояний точки отрезка
+         * добавить в конец непрерывного буфера состояний первую точку
+         * отрезка, checkCnt-1 промежуточных точек и вторую точку отрезка
+         * (всего checkCnt+1 состояние)
+         * @param prevPoint первая точка отрезка
+         * @param nextPoint вторая точка отрезка
+         * @param checkCnt количество промежуточных точек
+         * @param states буфер состояний
+         */
+        static void divideSegment(
+                const std::vector<double> &prevPoint, const std::vector<double> &nextPoint, int checkCnt,
+                std::vector<double> &states
+        );
+
         /**
          * проверить путь с промежуточными точками на коллизии
          * @param path путь
@@ -171,6 +260,22 @@ namespace bmpf {
          */
         bool checkState(const std::vector<double> &state);
 
+        /**
+         * @brief пакетная проверка доступности состояний
+         * Проверяет доступность углов каждого состояния, после проверяет
+         * все состояния с допустимыми углами на коллизии одним
+         * обращением к коллайдеру
+         * @param states состояния, записанные подряд в один буфер
+         * @param stateCnt количество состояний
+         * @param fkCache кэш кинематики базового состояния (например, текущей ноды),
+         * если задан, то кинематика состояний считается инкрементально относительно него
+         * @return битовая маска: i-й элемент равен true, если
+         * i-е состояние допустимо
+         */
+        std::vector<bool> checkStates(
+                const std::vector<double> &states, unsigned long stateCnt, const FKCache *fkCache = nullptr
+        );
+
         /**
          * получить случайное разрешённое состояние
          * @return случайное разрешённое состояние
@@ -207,13 +312,47 @@ namespace bmpf {
          * добавить объект на сцену
          * @param path путь к файлу с описанием
          */
-        void addObjectToScene(std::string path);
+        virtual void addObjectToScene(std::string path);
 
         /**
          * Удалить объект
          * @param robotNum номер робота в списке роботов
          */
-        void deleteObjectFromScene(long robotNum);
+        virtual void deleteObjectFromScene(long robotNum);
+
+        /**
+         * @brief построить матрицу разрешённых столкновений
+         * построить матрицу разрешённых столкновений: разрешаются все пары звеньев
+         * статических объектов (без сочленений), а также пары звеньев одного
+         * робота с сочленениями, которые ни разу не пересеклись в sampleCnt
+         * случайных состояниях сцены. Пары звеньев разных объектов, хотя бы один
+         * из которых - робот с сочленениями, проверяются всегда. Случайные
+         * состояния генерируются с фиксированным зерном ACM_SEED
+         * @param sampleCnt количество случайных состояний
+         * @return матрица разрешённых столкновений
+         */
+        AllowedCollisionMatrix buildAllowedCollisionMatrix(unsigned long sampleCnt);
+
+        /**
+         * @brief инициализировать матрицу разрешённых столкновений
+         * инициализировать матрицу разрешённых столкновений и передать её
+         * коллайдеру. Матрица загружается из файла рядом с описанием сцены
+         * (см. `getAllowedCollisionsPath`), если он построен для той же сцены
+         * и не меньшего числа состояний, иначе матрица строится заново
+         * и сохраняется в этот файл. Построенные матрицы кешируются
+         * в памяти процесса. Матрица не строится по умолчанию: после вызова этого
+         * метода она перестраивается при каждом изменении сцены
+         * @param sampleCnt количество случайных состояний
+         */
+        void initAllowedCollisions(unsigned long sampleCnt = ACM_SAMPLE_CNT);
+
+        /**
+         * получить путь к файлу матрицы разрешённых столкновений сцены:
+         * расширение ".json" заменяется на ".acm.json"
+         * @param scenePath путь к описанию сцены
+         * @return путь к файлу матрицы разрешённых столкновений
+         */
+        static std::string getAllowedCollisionsPath(const std::string &scenePath);
 
         /**
          * рассчитать общую протяжённость пути
@@ -244,6 +383,23 @@ namespace bmpf {
          * коллайдер
          */
         std::shared_ptr<bmpf::Collider> _collider;
+        /**
+         * матрица разрешённых столкновений
+         */
+        AllowedCollisionMatrix _allowedCollisions;
+        /**
+         * флаг, используется ли матрица разрешённых столкновений
+         */
+        bool _useAllowedCollisions = false;
+        /**
+         * количество случайных состояний, по которым строилась матрица
+         * разрешённых столкновений
+         */
+        unsigned long _allowedCollisionSampleCnt = ACM_SAMPLE_CNT;
+        /**
+         * решатель обратной кинематики, создаётся при первом поиске пути к положениям
+         */
+        std::shared_ptr<IKSolver> _ikSolver;
         /**
          * флаг, готов ли планировщик, в конструкторе выставляется в false;
          * бывает полезным, когда планировщику нужно подготовить
@@ -254,7 +410,7 @@ namespace bmpf {
         /**
          * количество потоков планировщика
          */
-        bool _threadCnt;
+        int _threadCnt;
         /**
          * конечное состояние
          */
@@ -275,6 +431,10 @@ namespace bmpf {
          * затраченное время на планирование
          */
         double _calculationTimeInSeconds;
+        /**
+         * флаг отмены планирования
+         */
+        std::shared_ptr<std::atomic<bool>> _cancelFlag;
 
     public:
 
@@ -294,7 +454,7 @@ namespace bmpf {
          * получить количество потоков планировщика
          * @return количество потоков планировщика
          */
-        bool getThreadCnt() const { return _threadCnt; }
+        int getThreadCnt() const { return _threadCnt; }
 
         /**
          * задать флаг, готов ли планировщик
@@ -338,6 +498,18 @@ namespace bmpf {
          */
         const std::shared_ptr<bmpf::Collider> &getCollider() const { return _collider; }
 
+        /**
+         * получить матрицу разрешённых столкновений
+         * @return матрица разрешённых столкновений
+         */
+        const AllowedCollisionMatrix &getAllowedCollisions() const { return _allowedCollisions; }
+
+        /**
+         * получить флаг отмены планирования
+         * @return флаг отмены планирования
+         */
+        const std::shared_ptr<std::atomic<bool>> &getCancelFlag() const { return _cancelFlag; }
+
         /**
          * получить затраченное время на обработку
          * @return затраченное время на обработку
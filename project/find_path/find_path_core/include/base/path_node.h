@@ -3,27 +3,22 @@
 #include <memory>
 #include <utility>
 #include <vector>
+#include <string>
+#include <cstdio>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "grid_key.h"
 
 namespace bmpf {
     /**
      * Нода планирощика
+     *
+     * Ноды хранятся в хранилище `PathNodeArena`, поэтому
+     * предок задаётся не указателем, а индексом в хранилище,
+     * а координаты хранятся в общем буфере хранилища
      */
     struct PathNode {
-        /**
-         * Конструктор
-         * @param coords координаты
-         * @param parent предок
-         * @param sum значение
-         */
-        PathNode(std::vector<int> coords, const std::shared_ptr<PathNode> &parent, double sum)
-                : coords(std::move(coords)), parent(parent), sum(sum) {
-
-            if (!parent)
-                order = 0;
-            else
-                order = parent->order + 1;
-        }
-
         /**
          * Строковое представление ноды
          * @return строковое представление ноды
@@ -31,43 +26,182 @@ namespace bmpf {
         std::string toString() const {
             std::string result = "{";
             char buf[256];
-            sprintf(buf, "sum:%.3f", sum);
+            sprintf(buf, "sum:%.3f cost:%.3f", sum, cost);
             result += buf;
             return result + "}";
         }
 
         /**
-         * Координаты
+         * индекс ноды предка в хранилище
          */
-        std::vector<int> coords;
+        unsigned int parent;
         /**
-         * Указатель на ноду предка
+         * приоритет ноды в открытом множестве: g + w * h, где g - стоимость
+         * пути от стартовой ноды (`cost`), h - эвристика расстояния до цели,
+         * w - вес эвристики; при бесконечном весе - просто h
          */
-        std::shared_ptr<PathNode> parent;
+        double sum;
         /**
-         * метрика расстояния от стартовой точки до рассматриваемой
+         * стоимость пути от стартовой ноды до рассматриваемой (g)
          */
-        double sum;
+        double cost;
         /**
          * сколько нод отделяют рассматриваемую от стартовой
          */
         unsigned int order;
+        /**
+         * флаг, проверены ли координаты ноды на коллизии; в ленивом режиме
+         * ноды попадают в открытое множество непроверенными
+         */
+        bool checked;
     };
 
     /**
-     * Указатель на ноду с возможностью сравнивания
+     * @brief Хранилище нод планировщика
+     *
+     * Все ноды одного поиска лежат в одном массиве, а их координаты - подряд
+     * в одном общем буфере (по `dim` координат на ноду) и, упакованные в ключи
+     * `GridKey`, в массиве ключей, поэтому создание
+     * ноды не требует отдельного выделения памяти, а сброс хранилища
+     * между поисками выполняется за O(1) с сохранением выделенной памяти.
+     *
+     * Ноды адресуются 32-битными индексами, индекс `NO_NODE` обозначает
+     * отсутствие ноды
      */
-    struct PathNodePtr {
+    class PathNodeArena {
+    public:
+        /**
+         * индекс, обозначающий отсутствие ноды
+         */
+        static const unsigned int NO_NODE = std::numeric_limits<unsigned int>::max();
+
+        /**
+         * сбросить хранилище
+         * @param dim размерность координат нод
+         */
+        void reset(unsigned long dim) {
+            _dim = dim;
+            _nodes.clear();
+            _coords.clear();
+            _keys.clear();
+        }
+
+        /**
+         * добавить ноду
+         * @param coords координаты
+         * @param key ключ координат
+         * @param parent индекс предка, NO_NODE, если предка нет
+         * @param sum приоритет
+         * @param cost стоимость пути от стартовой ноды
+         * @param checked флаг, проверены ли координаты ноды на коллизии
+         * @return индекс новой ноды
+         */
+        unsigned int add(
+                const std::vector<int> &coords, const GridKey &key, unsigned int parent, double sum,
+                double cost = 0, bool checked = true
+        ) {
+            if (coords.size() != _dim) {
+                char buf[1024];
+                sprintf(buf,
+                        "PathNodeArena::add() ERROR: \n coords size is %zu, arena dim is %lu"
+                        "\nthey must be equal",
+                        coords.size(), _dim
+                );
+                throw std::invalid_argument(buf);
+            }
+            if (_nodes.size() >= NO_NODE)
+                throw std::overflow_error("PathNodeArena::add() ERROR: too many nodes");
+
+            unsigned int order = parent == NO_NODE ? 0 : _nodes[parent].order + 1;
+            _nodes.push_back({parent, sum, cost, order, checked});
+            _coords.insert(_coords.end(), coords.begin(), coords.end());
+            _keys.push_back(key);
+            return (unsigned int) (_nodes.size() - 1);
+        }
+
+        /**
+         * получить ноду
+         * @param index индекс ноды
+         * @return нода
+         */
+        const PathNode &at(unsigned int index) const { return _nodes[index]; }
+
+        /**
+         * отметить координаты ноды как проверенные на коллизии
+         * @param index индекс ноды
+         */
+        void setChecked(unsigned int index) { _nodes[index].checked = true; }
+
+        /**
+         * задать приоритет ноды; нода при этом не должна находиться
+         * в открытом множестве, иначе нарушится порядок кучи
+         * @param index индекс ноды
+         * @param sum приоритет
+         */
+        void setSum(unsigned int index, double sum) { _nodes[index].sum = sum; }
+
+        /**
+         * получить ключ координат ноды
+         * @param index индекс ноды
+         * @return ключ координат ноды
+         */
+        const GridKey &getKey(unsigned int index) const { return _keys[index]; }
+
         /**
-         * Конструктор
-         * @param ptr указатель
+         * получить указатель на начало координат ноды в общем буфере
+         * @param index индекс ноды
+         * @return указатель на первую координату ноды
          */
-        explicit PathNodePtr(std::shared_ptr<PathNode> ptr) : ptr(std::move(ptr)) {}
+        const int *coordsData(unsigned int index) const { return _coords.data() + index * _dim; }
 
-        std::shared_ptr<PathNode> ptr;
+        /**
+         * получить координаты ноды
+         * @param index индекс ноды
+         * @return координаты ноды
+         */
+        std::vector<int> getCoords(unsigned int index) const {
+            const int *data = coordsData(index);
+            return std::vector<int>(data, data + _dim);
+        }
 
-        bool operator<(const PathNodePtr &obj) const {
-            return (this->ptr->sum < obj.ptr->sum);
+        /**
+         * проверка, совпадают ли координаты ноды с заданными
+         * @param index индекс ноды
+         * @param coords координаты
+         * @return флаг, совпадают ли координаты
+         */
+        bool coordsEqual(unsigned int index, const std::vector<int> &coords) const {
+            return coords.size() == _dim && std::equal(coords.begin(), coords.end(), coordsData(index));
         }
+
+        /**
+         * получить количество нод
+         * @return количество нод
+         */
+        std::size_t size() const { return _nodes.size(); }
+
+        /**
+         * получить размерность координат нод
+         * @return размерность координат нод
+         */
+        unsigned long getDim() const { return _dim; }
+
+    private:
+        /**
+         * размерность координат нод
+         */
+        unsigned long _dim = 0;
+        /**
+         * ноды
+         */
+        std::vector<PathNode> _nodes;
+        /**
+         * общий буфер координат всех нод
+         */
+        std::vector<int> _coords;
+        /**
+         * ключи координат всех нод
+         */
+        std::vector<GridKey> _keys;
     };
-}
\ No newline at end of file
+}
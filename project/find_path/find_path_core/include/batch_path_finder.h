@@ -0,0 +1,137 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <scene.h>
+#include <thread_pool.h>
+#include "base/path_finder.h"
+
+namespace bmpf {
+    /**
+     * @brief Пакетный поиск путей
+     *
+     * Решает список независимых задач (пар из стартового и конечного
+     * состояний) на пуле рабочих потоков. У каждого рабочего потока
+     * свой планировщик, т.к. планировщик хранит изменяемое состояние
+     * поиска, при этом все планировщики строятся по одной сцене, которая
+     * во время поиска только читается, а stl-модели звеньев и матрица
+     * разрешённых столкновений загружаются один раз и берутся из кешей
+     * (см. `StlShape::fromStlFile`, `PathFinder::initAllowedCollisions`).
+     *
+     * Задачи раздаются динамически: освободившийся поток берёт следующую
+     * нерешённую задачу, поэтому долгие задачи не задерживают остальные.
+     * Результаты возвращаются в порядке задач.
+     *
+     * Исключение, брошенное планировщиком на одной задаче, не прерывает
+     * пакет: в результат этой задачи записывается код ошибки
+     * ERROR_CAN_NOT_FIND_PATH. Исключения пробрасываются только при
+     * построении пакетного планировщика и при неверной размерности
+     * состояний в задачах
+     */
+    class BatchPathFinder {
+    public:
+        /**
+         * фабрика планировщиков: строит планировщик по сцене
+         */
+        typedef std::function<std::shared_ptr<PathFinder>(const std::shared_ptr<bmpf::Scene> &)> PathFinderFactory;
+
+        /**
+         * @brief результат решения одной задачи
+         */
+        struct QueryResult {
+            /**
+             * построенный путь, пустой, если путь не найден
+             */
+            std::vector<std::vector<double>> path;
+            /**
+             * код ошибки
+             */
+            int errorCode;
+            /**
+             * затраченное на задачу время, -1, если планировщик бросил исключение
+             */
+            double calculationTimeInSeconds;
+            /**
+             * номер рабочего потока, решившего задачу
+             */
+            unsigned int workerNum;
+        };
+
+        /**
+         * конструктор, планировщики рабочих потоков строятся
+         * по очереди, чтобы кеши заполнялись один раз
+         * @param scene сцена
+         * @param pathFinderFactory фабрика планировщиков
+         * @param workerCnt количество рабочих потоков
+         */
+        BatchPathFinder(
+                const std::shared_ptr<bmpf::Scene> &scene, const PathFinderFactory &pathFinderFactory,
+                unsigned int workerCnt
+        );
+
+        /**
+         * решить список задач, исключение планировщика на одной задаче
+         * не прерывает пакет: задача получает код ошибки ERROR_CAN_NOT_FIND_PATH
+         * @param tasks задачи: пары из стартового и конечного состояний
+         * @return результаты в порядке задач
+         */
+        std::vector<QueryResult> findPaths(
+                const std::vector<std::pair<std::vector<double>, std::vector<double>>> &tasks
+        );
+
+    protected:
+        /**
+         * решить одну задачу планировщиком рабочего потока
+         * @param workerNum номер рабочего потока
+         * @param task задача
+         * @return результат
+         */
+        QueryResult _findPath(
+                unsigned int workerNum, const std::pair<std::vector<double>, std::vector<double>> &task
+        );
+
+        /**
+         * сцена
+         */
+        std::shared_ptr<bmpf::Scene> _scene;
+        /**
+         * планировщики рабочих потоков
+         */
+        std::vector<std::shared_ptr<PathFinder>> _pathFinders;
+        /**
+         * пул рабочих потоков
+         */
+        std::shared_ptr<ThreadPool> _threadPool;
+        /**
+         * затраченное на последний пакет время
+         */
+        double _calculationTimeInSeconds = -1;
+
+    public:
+        /**
+         * получить количество рабочих потоков
+         * @return количество рабочих потоков
+         */
+        unsigned int getWorkerCnt() const { return (unsigned int) _pathFinders.size(); }
+
+        /**
+         * получить планировщики рабочих потоков
+         * @return планировщики рабочих потоков
+         */
+        const std::vector<std::shared_ptr<PathFinder>> &getPathFinders() const { return _pathFinders; }
+
+        /**
+         * получить сцену
+         * @return сцена
+         */
+        const std::shared_ptr<bmpf::Scene> &getScene() const { return _scene; }
+
+        /**
+         * получить затраченное на последний пакет время
+         * @return затраченное на последний пакет время
+         */
+        double getCalculationTimeInSeconds() const { return _calculationTimeInSeconds; }
+    };
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <base/grid_path_finder.h>
+#include <base/node_grid_path_finder.h>
+
+#include <memory>
+#include <vector>
+
+#include "scene.h"
+#include "thread_pool.h"
+#include "base/path_node.h"
+#include "one_direction_path_finder.h"
+
+namespace bmpf {
+    /**
+     * @brief Двунаправленный планировщик на сетке
+     *
+     * Поиск ведётся одновременно из стартовых координат к конечным и из конечных
+     * к стартовым двумя планировщиками `OneDirectionPathFinder`, у каждого из
+     * которых свой коллайдер. Направления выполняются в двух потоках пула
+     * раундами по `ROUND_TICK_CNT` тактов, после каждого раунда ключи нод,
+     * закрытых за раунд одним направлением, ищутся в хэш-индексе закрытых
+     * нод другого. Как только такая нода найдена, фронты встретились, и путь
+     * собирается из цепочек предков обоих направлений.
+     *
+     * Фронты двух поисков растут навстречу друг другу, поэтому на узких
+     * проходах каждому из них приходится раскрыть значительно меньше нод,
+     * чем одному поиску от старта до цели.
+     *
+     * Логика работы планировщика следующая:
+     * 1) подготовка к тактам поиска пути
+     * 2) выполнение тактов поиска пути с попутным заполнением тех или иных структур
+     * 3) если путь найден из этих структур собирается путь и сохраняется в
+     * переменную `_buildedPath`
+     *
+     */
+    class BiDirectionalPathFinder : public GridPathFinder {
+    public:
+        /**
+         * количество тактов каждого из направлений между проверками встречи фронтов
+         */
+        static const unsigned int ROUND_TICK_CNT = 8;
+
+        /**
+         * конструктор
+         * @param scene сцена
+         * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+         * @param maxOpenSetSize максимальный размер открытого множества каждого из направлений
+         * @param gridSize размер сетки планирования
+         * @param maxNodeCnt максимальное кол-во нод в закрытом множестве каждого из направлений
+         * @param kG коэффициент разницы в углах поворота сочленений робота
+         * @param kD коэффициент разницы в положениях звеньев робота
+         * @param threadCnt количество потоков коллайдера каждого из направлений
+         * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+         * только при извлечении из открытого множества
+         */
+        BiDirectionalPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
+                                bool showTrace,
+                                unsigned int maxOpenSetSize,
+                                int gridSize,
+                                unsigned int maxNodeCnt,
+                                unsigned int kG = 1,
+                                unsigned int kD = 0,
+                                int threadCnt = 1,
+                                bool lazyCheck = false
+        );
+
+        /**
+         * такт поиска: раунд из `ROUND_TICK_CNT` тактов каждого из направлений
+         * и проверка встречи фронтов
+         * @param state текущее состояние планировщика
+         * @return возвращает true, если планирование закончено
+         */
+        bool findTick(std::vector<double> &state) override;
+
+        /**
+         * подготовка к планированию
+         * @param startState начальное состояние
+         * @param endState конечное состояние
+         */
+        void prepare(const std::vector<double> &startState, const std::vector<double> &endState) override;
+
+        /**
+         * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+         * @param startCoords начальные координаты
+         * @param endCoords конечные координаты
+         */
+        void prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) override;
+
+        /**
+         * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+         */
+        void buildPath() override;
+
+    protected:
+
+        /**
+         * подготовить оба направления по уже найденным стартовым и конечным координатам
+         */
+        void _prepareDirections();
+
+        /**
+         * выполнить до `ROUND_TICK_CNT` тактов одного направления
+         * @param direction номер направления: 0 - прямое, 1 - обратное
+         */
+        void _runRound(unsigned long direction);
+
+        /**
+         * найти среди нод, закрытых направлением за последний раунд,
+         * ноду, ключ которой закрыт другим направлением
+         * @param direction номер направления: 0 - прямое, 1 - обратное
+         * @return флаг, встретились ли фронты
+         */
+        bool _findMeeting(unsigned long direction);
+
+        /**
+         * найти закрытую ноду направления по ключу координат
+         * @param direction номер направления: 0 - прямое, 1 - обратное
+         * @param key ключ координат
+         * @return индекс ноды или PathNodeArena::NO_NODE
+         */
+        unsigned int _findClosedNode(unsigned long direction, const GridKey &key) const;
+
+        /**
+         * планировщики направлений: 0 - от старта к цели, 1 - от цели к старту
+         */
+        std::shared_ptr<OneDirectionPathFinder> _directions[2];
+        /**
+         * пул из двух потоков, в которых выполняются направления
+         */
+        std::shared_ptr<ThreadPool> _threadPool;
+        /**
+         * флаги, закончило ли направление поиск
+         */
+        bool _directionFinished[2]{};
+        /**
+         * количество закрытых нод направления до начала последнего раунда
+         */
+        unsigned long _prevClosedCnt[2]{};
+        /**
+         * индексы нод встречи фронтов в хранилищах направлений
+         */
+        unsigned int _meetNodes[2]{PathNodeArena::NO_NODE, PathNodeArena::NO_NODE};
+
+    public:
+
+        /**
+         * получить суммарное количество нод, закрытых обоими направлениями
+         * @return суммарное количество закрытых нод
+         */
+        unsigned long getClosedNodeCnt() const {
+            return _directions[0]->getClosedNodes().size() + _directions[1]->getClosedNodes().size();
+        }
+    };
+}
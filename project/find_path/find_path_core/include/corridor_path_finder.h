@@ -0,0 +1,212 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "scene.h"
+#include "base/grid_check_cache.h"
+#include "one_direction_path_finder.h"
+
+namespace bmpf {
+    /**
+     * @brief Планировщик со смещениями вдоль одной из координат, ограниченный коридором
+     *
+     * Коридор задаётся путём, найденным на сетке, которая в два раза грубее
+     * сетки планировщика. Соседние ноды, которые отстоят от всех ячеек этого
+     * пути больше, чем на ширину коридора (в ячейках грубой сетки), не
+     * рассматриваются. Чтобы поиск не упирался в стенки коридора, эвристика
+     * считается не до цели, а до следующей ячейки пути на грубой сетке, к ней
+     * прибавляется оценка стоимости оставшейся части этого пути (с теми же
+     * коэффициентами kG и kD). Если коридор не задан, планировщик работает
+     * так же, как `OneDirectionPathFinder`.
+     *
+     * Грубая сетка проверяет на коллизии только ячейки, поэтому путь на ней
+     * может перешагивать через препятствие. Если поиск долго не продвигается
+     * вдоль пути на грубой сетке, он заканчивается ошибкой `ERROR_CAN_NOT_FIND_PATH`
+     *
+     * Результаты проверок на коллизии сохраняются в общий для нескольких
+     * планировщиков кэш `GridCheckCache`
+     */
+    class CorridorPathFinder : public OneDirectionPathFinder {
+    public:
+        /**
+         * конструктор
+         * @param scene сцена
+         * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+         * @param maxOpenSetSize максимальный размер открытого множества
+         * @param gridSize размер сетки планирования
+         * @param maxNodeCnt максимальное кол-во нод в закрытом множестве
+         * @param checkCache кэш результатов проверок на коллизии
+         * @param cacheScale во сколько раз сетка планировщика грубее сетки кэша
+         * @param kG коэффициент разницы в углах поворота сочленений робота
+         * @param kD коэффициент разницы в положениях звеньев робота
+         * @param threadCnt количество потоков планировщика
+         * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+         * только при извлечении из открытого множества
+         */
+        CorridorPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
+                           bool showTrace,
+                           unsigned int maxOpenSetSize,
+                           int gridSize,
+                           unsigned int maxNodeCnt,
+                           const std::shared_ptr<GridCheckCache> &checkCache,
+                           int cacheScale,
+                           unsigned int kG = 1,
+                           unsigned int kD = 0,
+                           int threadCnt = 1,
+                           bool lazyCheck = false
+        );
+
+        /**
+         * задать коридор
+         * @param coarseGridPath путь на сетке, которая в два раза грубее сетки планировщика
+         * @param width ширина коридора в ячейках грубой сетки
+         */
+        void setCorridor(const std::vector<std::vector<int>> &coarseGridPath, int width);
+
+        /**
+         * убрать коридор
+         */
+        void clearCorridor() {
+            _corridor.clear();
+            _corridorCells.clear();
+        }
+
+        /**
+         * проверка, лежат ли координаты в коридоре; если коридор не задан,
+         * все координаты лежат в нём
+         * @param coords координаты
+         * @return флаг, лежат ли координаты в коридоре
+         */
+        bool isInCorridor(const std::vector<int> &coords);
+
+        /**
+         * такт поиска
+         * @param state текущее состояние планировщика
+         * @return возвращает true, если планирование закончено
+         */
+        bool findTick(std::vector<double> &state) override;
+
+        /**
+         * подготовка к планированию
+         * @param startState начальное состояние
+         * @param endState конечное состояние
+         */
+        void prepare(const std::vector<double> &startState, const std::vector<double> &endState) override;
+
+        /**
+         * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+         * @param startCoords начальные координаты
+         * @param endCoords конечные координаты
+         */
+        void prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) override;
+
+    protected:
+        /**
+         * найти последнюю ячейку пути на грубой сетке, рядом с которой лежат
+         * координаты; найденный номер запоминается по ключу координат
+         * @param coords координаты
+         * @return номер ячейки или -1, если координаты лежат вне коридора
+         */
+        long _findCorridorCell(const std::vector<int> &coords);
+
+        /**
+         * проверка, лежат ли координаты рядом с ячейкой пути на грубой сетке
+         * @param coords координаты
+         * @param cell ячейка пути на грубой сетке
+         * @return флаг, лежат ли координаты рядом с ячейкой
+         */
+        bool _isNearCell(const std::vector<int> &coords, const std::vector<int> &cell) const;
+
+        /**
+         * для всех соседей текущей ноды, лежащих в коридоре, метод должен добавить только
+         * подходящих в множество _openSet, если один из соседей
+         * имеет целевые указания (т.е. найден путь), то возвращаем индекс этой ноды,
+         * в противном случае должен быть возвращён PathNodeArena::NO_NODE
+         * @param currentNode индекс текущей ноды
+         * @param endCoords целевые координаты
+         * @return индекс найденной ноды или PathNodeArena::NO_NODE
+         */
+        unsigned int _forEachNeighbor(unsigned int currentNode, std::vector<int> &endCoords) override;
+
+        /**
+         * найти результат проверки координат на коллизии в кэше
+         * @param coords координаты
+         * @param enabled в эту переменную записывается результат проверки
+         * @return флаг, найден ли результат
+         */
+        bool _findCheckResult(const std::vector<int> &coords, bool &enabled) override;
+
+        /**
+         * сохранить результат проверки координат на коллизии в кэш
+         * @param coords координаты
+         * @param enabled флаг, доступны ли координаты
+         */
+        void _saveCheckResult(const std::vector<int> &coords, bool enabled) override;
+
+        /**
+         * кэш результатов проверок на коллизии
+         */
+        std::shared_ptr<GridCheckCache> _checkCache;
+        /**
+         * во сколько раз сетка планировщика грубее сетки кэша
+         */
+        int _cacheScale;
+        /**
+         * ячейки пути на грубой сетке, задающего коридор
+         */
+        std::vector<std::vector<int>> _corridor;
+        /**
+         * оценки стоимости оставшейся части пути на грубой сетке от каждой
+         * его ячейки до конца (в той же метрике, что и эвристика)
+         */
+        std::vector<double> _corridorRemainders;
+        /**
+         * номера последних ячеек пути на грубой сетке, рядом с которыми лежат
+         * уже рассмотренные координаты, по ключам этих координат
+         */
+        std::unordered_map<GridKey, long, GridKeyHash> _corridorCells;
+        /**
+         * ширина коридора в ячейках грубой сетки
+         */
+        int _corridorWidth = 0;
+        /**
+         * номер самой дальней ячейки пути на грубой сетке, до которой дошёл поиск
+         */
+        long _farthestCell = -1;
+        /**
+         * кол-во шагов поиска с последнего продвижения вдоль пути на грубой сетке
+         */
+        unsigned int _stallCnt = 0;
+        /**
+         * максимальное кол-во шагов поиска без продвижения вдоль пути на грубой сетке
+         */
+        unsigned int _maxStallCnt = 200;
+
+    public:
+        /**
+         * получить флаг, задан ли коридор
+         * @return флаг, задан ли коридор
+         */
+        bool hasCorridor() const { return !_corridor.empty(); }
+
+        /**
+         * получить максимальное кол-во шагов поиска без продвижения вдоль пути на грубой сетке
+         * @return максимальное кол-во шагов поиска без продвижения
+         */
+        unsigned int getMaxStallCnt() const { return _maxStallCnt; }
+
+        /**
+         * задать максимальное кол-во шагов поиска без продвижения вдоль пути на грубой сетке
+         * @param maxStallCnt максимальное кол-во шагов поиска без продвижения
+         */
+        void setMaxStallCnt(unsigned int maxStallCnt) { _maxStallCnt = maxStallCnt; }
+
+        /**
+         * получить кэш результатов проверок на коллизии
+         * @return кэш результатов проверок на коллизии
+         */
+        const std::shared_ptr<GridCheckCache> &getCheckCache() const { return _checkCache; }
+    };
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "scene.h"
+#include "base/grid_path_finder.h"
+#include "base/grid_check_cache.h"
+#include "corridor_path_finder.h"
+
+namespace bmpf {
+    /**
+     * @brief Иерархический планировщик: поиск от грубой сетки к мелкой
+     *
+     * Планировщик строит несколько уровней сетки, размер каждой следующей
+     * в два раза больше размера предыдущей. Сначала путь ищется на самой
+     * грубой сетке, затем на каждом следующем уровне поиск ограничивается
+     * коридором вокруг пути, найденного на предыдущем уровне. Путь на самой
+     * мелкой сетке и является результатом планирования.
+     *
+     * Если в коридоре путь найти не удалось, поиск на этом уровне повторяется
+     * без коридора; если на грубом уровне путь не найден и без коридора,
+     * следующий уровень ищет путь без коридора. Результаты проверок на
+     * коллизии хранятся в общем для всех уровней кэше, поэтому ячейки,
+     * совпадающие на разных уровнях, проверяются только один раз
+     */
+    class HierarchicalPathFinder : public GridPathFinder {
+    public:
+        /**
+         * конструктор
+         * @param scene сцена
+         * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+         * @param maxOpenSetSize максимальный размер открытого множества
+         * @param coarseGridSize размер самой грубой сетки
+         * @param levelCnt кол-во уровней
+         * @param maxNodeCnt максимальное кол-во нод в закрытом множестве на каждом уровне
+         * @param corridorWidth ширина коридора в ячейках сетки предыдущего уровня
+         * @param kG коэффициент разницы в углах поворота сочленений робота
+         * @param kD коэффициент разницы в положениях звеньев робота
+         * @param threadCnt количество потоков планировщика
+         * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+         * только при извлечении из открытого множества
+         */
+        HierarchicalPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
+                               bool showTrace,
+                               unsigned int maxOpenSetSize,
+                               int coarseGridSize,
+                               unsigned int levelCnt,
+                               unsigned int maxNodeCnt,
+                               int corridorWidth = 1,
+                               unsigned int kG = 1,
+                               unsigned int kD = 0,
+                               int threadCnt = 1,
+                               bool lazyCheck = false
+        );
+
+        /**
+         * такт поиска
+         * @param state текущее состояние планировщика
+         * @return возвращает true, если планирование закончено
+         */
+        bool findTick(std::vector<double> &state) override;
+
+        /**
+         * подготовка к планированию
+         * @param startState начальное состояние
+         * @param endState конечное состояние
+         */
+        void prepare(const std::vector<double> &startState, const std::vector<double> &endState) override;
+
+        /**
+         * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+         * @param startCoords начальные координаты на самой мелкой сетке
+         * @param endCoords конечные координаты на самой мелкой сетке
+         */
+        void prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) override;
+
+        /**
+         * построение пути
+         */
+        void buildPath() override;
+
+    protected:
+
+        /**
+         * начать поиск на уровне; уровни, на которых начальные и конечные
+         * координаты совпадают или не найдены, пропускаются
+         * @param level номер уровня
+         */
+        void _startLevel(unsigned int level);
+
+        /**
+         * перейти к следующему уровню
+         * @param gridPath путь, найденный на текущем уровне, или пустой
+         * вектор, если следующий уровень должен искать путь без коридора
+         */
+        void _nextLevel(const std::vector<std::vector<int>> &gridPath);
+
+        /**
+         * планировщики уровней, от самого грубого к самому мелкому
+         */
+        std::vector<std::shared_ptr<CorridorPathFinder>> _levels;
+        /**
+         * кэш результатов проверок на коллизии
+         */
+        std::shared_ptr<GridCheckCache> _checkCache;
+        /**
+         * ширина коридора в ячейках сетки предыдущего уровня
+         */
+        int _corridorWidth;
+        /**
+         * номер текущего уровня
+         */
+        unsigned int _currentLevel = 0;
+        /**
+         * кол-во уровней, на которых поиск в коридоре пришлось повторить без коридора
+         */
+        unsigned int _fallbackCnt = 0;
+
+    public:
+        /**
+         * получить кол-во уровней
+         * @return кол-во уровней
+         */
+        unsigned int getLevelCnt() const { return (unsigned int) _levels.size(); }
+
+        /**
+         * получить планировщик уровня
+         * @param level номер уровня, 0 - самая грубая сетка
+         * @return планировщик уровня
+         */
+        const std::shared_ptr<CorridorPathFinder> &getLevel(unsigned int level) const { return _levels.at(level); }
+
+        /**
+         * получить кэш результатов проверок на коллизии
+         * @return кэш результатов проверок на коллизии
+         */
+        const std::shared_ptr<GridCheckCache> &getCheckCache() const { return _checkCache; }
+
+        /**
+         * получить кол-во уровней, на которых поиск в коридоре пришлось повторить без коридора
+         * @return кол-во уровней с повторным поиском
+         */
+        unsigned int getFallbackCnt() const { return _fallbackCnt; }
+    };
+}
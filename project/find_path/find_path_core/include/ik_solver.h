@@ -0,0 +1,211 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <Eigen/Dense>
+#include <scene.h>
+#include <thread_pool.h>
+#include "base/collider.h"
+
+namespace bmpf {
+    /**
+     * @brief Решатель обратной кинематики
+     *
+     * По целевым положениям рабочих инструментов (по одной матрице преобразования
+     * на каждого робота с сочленениями, в том же порядке, что и
+     * Scene::getEndEffectorTransformMatrices()) находит безколлизионное состояние сцены.
+     *
+     * Для каждого робота решение ищется методом затухающих наименьших квадратов:
+     * dq = J^T (J J^T + lambda^2 E)^(-1) e, где J - геометрический якобиан робота,
+     * e - ошибка положения и ориентации рабочего инструмента. После каждого шага
+     * координаты ограничиваются пределами из `JointParams`.
+     *
+     * Поиск запускается из нескольких начальных состояний параллельно: первое из них -
+     * предыдущее найденное решение (тёплый старт) или заданное вызывающим кодом
+     * состояние, остальные - случайные. Каждый робот решается из каждого начального
+     * состояния независимо, и сошедшиеся решения разных роботов комбинируются
+     * между собой, даже если получены из разных начальных состояний. Составленные
+     * так состояния сцены одним пакетом проверяются коллайдером, из безколлизионных
+     * выбирается ближайшее к первому начальному состоянию
+     */
+    class IKSolver {
+    public:
+        /**
+         * Нет ошибки
+         */
+        static const int NO_ERROR = -1;
+        /**
+         * Не удалось найти решение
+         */
+        static const int ERROR_CAN_NOT_FIND_SOLUTION = 1;
+        /**
+         * количество начальных состояний по умолчанию
+         */
+        static const unsigned long DEFAULT_SEED_CNT = 16;
+        /**
+         * максимальное количество итераций по умолчанию
+         */
+        static const unsigned long DEFAULT_MAX_ITERATION_CNT = 200;
+
+        /**
+         * конструктор
+         * @param scene сцена
+         * @param collider коллайдер, проинициализированный по этой сцене
+         * @param threadCnt количество потоков для параллельного поиска
+         */
+        IKSolver(
+                const std::shared_ptr<bmpf::Scene> &scene, const std::shared_ptr<bmpf::Collider> &collider,
+                unsigned int threadCnt = 1
+        );
+
+        /**
+         * @brief найти состояние сцены по целевым положениям рабочих инструментов
+         * первым начальным состоянием служит предыдущее найденное решение,
+         * если его нет - середина диапазонов координат
+         * @param targetPoses целевые матрицы преобразования рабочих инструментов
+         * @param errorCode в эту переменную записывается код ошибки
+         * @return найденное состояние или пустой список, если решение не найдено
+         */
+        std::vector<double> solve(const std::vector<Eigen::Matrix4d> &targetPoses, int &errorCode);
+
+        /**
+         * @brief найти состояние сцены по целевым положениям рабочих инструментов
+         * @param targetPoses целевые матрицы преобразования рабочих инструментов
+         * @param seedState первое начальное состояние (тёплый старт)
+         * @param errorCode в эту переменную записывается код ошибки
+         * @return найденное состояние или пустой список, если решение не найдено
+         */
+        std::vector<double> solve(
+                const std::vector<Eigen::Matrix4d> &targetPoses, const std::vector<double> &seedState,
+                int &errorCode
+        );
+
+        /**
+         * @brief решить обратную задачу для одного робота
+         * итерации метода затухающих наименьших квадратов из состояния `state`;
+         * метод не меняет робота, поэтому его можно вызывать из разных потоков
+         * @param robot робот
+         * @param jointParams параметры сочленений робота
+         * @param targetPose целевая матрица преобразования рабочего инструмента
+         * @param state начальное состояние, в эту переменную записывается результат
+         * @param maxIterationCnt максимальное количество итераций
+         * @param damping коэффициент затухания lambda
+         * @param posEps допустимая ошибка положения
+         * @param rotEps допустимая ошибка ориентации (угол, рад)
+         * @return флаг, сошёлся ли метод
+         */
+        static bool solveRobot(
+                const bmpf::BaseRobot &robot, const std::vector<std::shared_ptr<bmpf::JointParams>> &jointParams,
+                const Eigen::Matrix4d &targetPose, std::vector<double> &state,
+                unsigned long maxIterationCnt, double damping, double posEps, double rotEps
+        );
+
+        /**
+         * получить ошибку положения и ориентации рабочего инструмента:
+         * первые три элемента - разность положений, последние три - вектор
+         * поворота (ось, умноженная на угол) от текущей ориентации к целевой,
+         * оба в СК мира
+         * @param pose текущая матрица преобразования рабочего инструмента
+         * @param targetPose целевая матрица преобразования рабочего инструмента
+         * @return ошибка
+         */
+        static Eigen::Matrix<double, 6, 1> getPoseError(const Eigen::Matrix4d &pose, const Eigen::Matrix4d &targetPose);
+
+        /**
+         * сбросить тёплый старт: следующий поиск начнётся
+         * с середины диапазонов координат
+         */
+        void resetWarmStart() { _lastSolution.clear(); }
+
+    private:
+        /**
+         * сцена
+         */
+        std::shared_ptr<bmpf::Scene> _scene;
+        /**
+         * коллайдер
+         */
+        std::shared_ptr<bmpf::Collider> _collider;
+        /**
+         * пул потоков для параллельного поиска из разных начальных состояний
+         */
+        std::shared_ptr<ThreadPool> _threadPool;
+        /**
+         * последнее найденное решение (тёплый старт)
+         */
+        std::vector<double> _lastSolution;
+        /**
+         * количество начальных состояний
+         */
+        unsigned long _seedCnt;
+        /**
+         * максимальное количество итераций для одного начального состояния
+         */
+        unsigned long _maxIterationCnt;
+        /**
+         * коэффициент затухания lambda
+         */
+        double _damping;
+        /**
+         * допустимая ошибка положения
+         */
+        double _posEps;
+        /**
+         * допустимая ошибка ориентации (угол, рад)
+         */
+        double _rotEps;
+
+    public:
+        /**
+         * получить последнее найденное решение
+         * @return последнее найденное решение (пустой список, если его нет)
+         */
+        const std::vector<double> &getLastSolution() const { return _lastSolution; }
+
+        /**
+         * получить количество начальных состояний
+         * @return количество начальных состояний
+         */
+        unsigned long getSeedCnt() const { return _seedCnt; }
+
+        /**
+         * задать количество начальных состояний
+         * @param seedCnt количество начальных состояний
+         */
+        void setSeedCnt(unsigned long seedCnt) { _seedCnt = seedCnt; }
+
+        /**
+         * получить максимальное количество итераций
+         * @return максимальное количество итераций
+         */
+        unsigned long getMaxIterationCnt() const { return _maxIterationCnt; }
+
+        /**
+         * задать максимальное количество итераций
+         * @param maxIterationCnt максимальное количество итераций
+         */
+        void setMaxIterationCnt(unsigned long maxIterationCnt) { _maxIterationCnt = maxIterationCnt; }
+
+        /**
+         * получить коэффициент затухания
+         * @return коэффициент затухания
+         */
+        double getDamping() const { return _damping; }
+
+        /**
+         * задать коэффициент затухания
+         * @param damping коэффициент затухания
+         */
+        void setDamping(double damping) { _damping = damping; }
+
+        /**
+         * задать допустимые ошибки
+         * @param posEps допустимая ошибка положения
+         * @param rotEps допустимая ошибка ориентации (угол, рад)
+         */
+        void setTolerance(double posEps, double rotEps) {
+            _posEps = posEps;
+            _rotEps = rotEps;
+        }
+    };
+}
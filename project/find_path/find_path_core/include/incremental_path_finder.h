@@ -0,0 +1,366 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "scene.h"
+#include "base/grid_path_finder.h"
+#include "base/grid_key.h"
+
+namespace bmpf {
+    /**
+     * @brief Планировщик на сетке с инкрементальным перепланированием (D* Lite)
+     *
+     * Поиск ведётся от конечных координат к начальным со смещениями ровно
+     * вдоль одной из координат, цена шага - цена шага сетки вдоль этой
+     * координаты, эвристика - взвешенное манхэттенское расстояние.
+     * Для каждой затронутой ячейки сетки хранятся её доступность, стоимость
+     * пути до цели g и её оценка по соседям rhs; ячейка, у которой g и rhs
+     * не совпадают, лежит в открытом множестве. Эти данные сохраняются
+     * между запросами с той же конечной точкой: при смене начальной точки
+     * (робот сдвинулся по уже построенному пути) ключи открытого множества
+     * корректируются накопленной поправкой _km, а не пересчитываются.
+     *
+     * При добавлении или удалении объекта без сочленений затрагиваются
+     * только те ячейки, в которых ограничивающий параллелепипед хотя бы
+     * одного робота пересекается с ограничивающим параллелепипедом объекта
+     * (см. `Collider::getBoxCoords`). У ячеек, доступность которых изменилась,
+     * и их соседей пересчитывается rhs, после чего следующий запрос
+     * исправляет только ту часть графа, на которую повлияло изменение
+     * (см. `updateRegion()`).
+     *
+     * Ячейки проверяются на коллизии лениво - когда в первый раз становятся
+     * соседями раскрываемой ячейки, соседи проверяются одним пакетом
+     */
+    class IncrementalPathFinder : public GridPathFinder {
+    public:
+        /**
+         * Доступность ячейки ещё не проверена
+         */
+        static const char CELL_UNKNOWN = 0;
+        /**
+         * Ячейка доступна
+         */
+        static const char CELL_ENABLED = 1;
+        /**
+         * Ячейка недоступна
+         */
+        static const char CELL_DISABLED = 2;
+
+        /**
+         * конструктор
+         * @param scene сцена
+         * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+         * @param gridSize размер сетки планирования
+         * @param maxNodeCnt максимальное кол-во раскрытых ячеек за один запрос
+         * @param threadCnt количество потоков планировщика
+         */
+        IncrementalPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
+                              bool showTrace,
+                              int gridSize,
+                              unsigned int maxNodeCnt,
+                              int threadCnt = 1
+        );
+
+        /**
+         * такт поиска
+         * @param state текущее состояние планировщика
+         * @return возвращает true, если планирование закончено
+         */
+        bool findTick(std::vector<double> &state) override;
+
+        /**
+         * подготовка к планированию; если конечные координаты совпадают с
+         * предыдущими, граф поиска переиспользуется
+         * @param startState начальное состояние
+         * @param endState конечное состояние
+         */
+        void prepare(const std::vector<double> &startState, const std::vector<double> &endState) override;
+
+        /**
+         * подготовка к планированию; если конечные координаты совпадают с
+         * предыдущими, граф поиска переиспользуется
+         * @param startCoords начальные координаты
+         * @param endCoords конечные координаты
+         */
+        void prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) override;
+
+        /**
+         * построение пути
+         */
+        void buildPath() override;
+
+        /**
+         * добавить объект на сцену; если у объекта нет сочленений, перепроверяются
+         * только ячейки, затронутые его ограничивающим параллелепипедом,
+         * в противном случае граф поиска сбрасывается
+         * @param path путь к файлу с описанием
+         */
+        void addObjectToScene(std::string path) override;
+
+        /**
+         * удалить объект; если у объекта нет сочленений, перепроверяются
+         * только ячейки, затронутые его ограничивающим параллелепипедом,
+         * в противном случае граф поиска сбрасывается
+         * @param robotNum номер робота в списке роботов
+         */
+        void deleteObjectFromScene(long robotNum) override;
+
+        /**
+         * @brief обновить граф поиска после изменения сцены внутри параллелепипеда
+         * находит ячейки графа поиска, в которых ограничивающий параллелепипед
+         * хотя бы одного робота пересекается с заданным. Недоступные ячейки
+         * перепроверяются сразу, у тех, доступность которых изменилась, и их
+         * соседей пересчитывается rhs. Доступные ячейки только помечаются:
+         * стоимость пути через них может лишь вырасти, поэтому их достаточно
+         * перепроверить, когда они окажутся на найденном пути.
+         * Доступность ячеек, от которых не зависит ни одна стоимость, сбрасывается
+         * @param boxCoords координаты параллелепипеда:
+         * min.x(), min.y(), min.z(), max.x(), max.y(), max.z()
+         * @param recheckEnabled флаг, нужно ли перепроверять доступные ячейки
+         * (при добавлении объекта недоступные ячейки доступными не станут)
+         * @param recheckDisabled флаг, нужно ли перепроверять недоступные ячейки
+         * (при удалении объекта доступные ячейки недоступными не станут)
+         */
+        void updateRegion(const std::vector<double> &boxCoords, bool recheckEnabled = true,
+                          bool recheckDisabled = true);
+
+        /**
+         * сбросить граф поиска, следующий запрос будет выполнен с нуля
+         */
+        void resetGraph();
+
+        /**
+         * получить координаты параллелепипеда, ограничивающего объект без сочленений
+         * @param objectNum номер объекта в списке роботов
+         * @return координаты параллелепипеда:
+         * min.x(), min.y(), min.z(), max.x(), max.y(), max.z()
+         */
+        std::vector<double> getObjectBoxCoords(unsigned long objectNum);
+
+    protected:
+        /**
+         * @brief ячейка графа поиска
+         */
+        struct Cell {
+            /**
+             * стоимость пути от ячейки до цели
+             */
+            double g;
+            /**
+             * оценка стоимости пути до цели по соседям
+             */
+            double rhs;
+            /**
+             * доступность ячейки
+             */
+            char state;
+            /**
+             * флаг, нужно ли перепроверить доступную ячейку, прежде чем
+             * использовать её в пути (сцена изменилась рядом с ней)
+             */
+            bool dirty;
+            /**
+             * флаг, лежит ли ячейка в открытом множестве
+             */
+            bool open;
+            /**
+             * ключ, с которым ячейка положена в открытое множество
+             */
+            std::pair<double, double> queueKey;
+        };
+
+        /**
+         * @brief элемент открытого множества
+         * элементы не удаляются из очереди при изменении ячейки,
+         * элемент устаревает, если его ключ не совпадает с ключом ячейки
+         */
+        struct QueueItem {
+            /**
+             * ключ
+             */
+            std::pair<double, double> key;
+            /**
+             * ключ координат ячейки
+             */
+            GridKey cellKey;
+
+            bool operator>(const QueueItem &other) const { return key > other.key; }
+        };
+
+        /**
+         * подготовить граф поиска к запросу: сбросить его, если конечные
+         * координаты изменились, иначе учесть сдвиг начальной точки
+         */
+        void _prepareGraph();
+
+        /**
+         * получить ячейку, при необходимости создав её
+         * @param key ключ координат ячейки
+         * @return ячейка
+         */
+        Cell &_getCell(const GridKey &key);
+
+        /**
+         * эвристика - взвешенное манхэттенское расстояние между координатами
+         * @param a первые координаты
+         * @param b вторые координаты
+         * @return оценка стоимости пути
+         */
+        double _heuristic(const std::vector<int> &a, const std::vector<int> &b) const;
+
+        /**
+         * ключ ячейки в открытом множестве
+         * @param coords координаты ячейки
+         * @param cell ячейка
+         * @return ключ
+         */
+        std::pair<double, double> _calculateKey(const std::vector<int> &coords, const Cell &cell) const;
+
+        /**
+         * положить ячейку в открытое множество, если она несогласованна,
+         * иначе убрать её оттуда
+         * @param coords координаты ячейки
+         * @param cell ячейка
+         */
+        void _updateQueue(const std::vector<int> &coords, Cell &cell);
+
+        /**
+         * пересчитать rhs ячейки по её соседям и обновить открытое множество
+         * @param coords координаты ячейки
+         */
+        void _updateVertex(const std::vector<int> &coords);
+
+        /**
+         * задать доступность перепроверенных ячеек; у ячеек, доступность которых
+         * изменилась, поменялись цены всех рёбер, поэтому rhs пересчитывается
+         * и у них, и у их соседей
+         * @param keys ключи координат ячеек
+         * @param enabled i-й элемент равен true, если i-я ячейка доступна
+         * @return флаг, изменилась ли доступность хотя бы одной ячейки
+         */
+        bool _setCellStates(const std::vector<GridKey> &keys, const std::vector<bool> &enabled);
+
+        /**
+         * перепроверить помеченные ячейки пути одним пакетом
+         * @param gridPath путь по координатам сетки планирования
+         * @return флаг, остались ли все ячейки пути доступными
+         */
+        bool _verifyGridPath(const std::vector<std::vector<int>> &gridPath);
+
+        /**
+         * собрать путь от начальных координат к конечным по убыванию стоимости до цели
+         * @param gridPath в этот вектор записывается путь по координатам сетки планирования
+         * @return флаг, удалось ли собрать путь
+         */
+        bool _extractGridPath(std::vector<std::vector<int>> &gridPath);
+
+        /**
+         * перебрать соседей ячейки внутри сетки
+         * @param coords координаты ячейки
+         * @param handler обработчик: ключ и координаты соседа, цена шага к нему
+         */
+        void _forEachNeighbor(
+                const std::vector<int> &coords,
+                const std::function<void(const GridKey &, const std::vector<int> &, double)> &handler
+        ) const;
+
+        /**
+         * проверить одним пакетом ещё не проверенных соседей ячейки
+         * @param coords координаты ячейки
+         */
+        void _checkNeighbors(const std::vector<int> &coords);
+
+        /**
+         * убрать из вершины открытого множества устаревшие элементы
+         */
+        void _skipStaleItems();
+
+        /**
+         * граф поиска: ячейки по ключам координат
+         */
+        std::unordered_map<GridKey, Cell, GridKeyHash> _cells;
+        /**
+         * открытое множество
+         */
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> _openSet;
+        /**
+         * поправка ключей на сдвиг начальной точки
+         */
+        double _km = 0;
+        /**
+         * конечные координаты, для которых построен граф поиска
+         */
+        std::vector<int> _graphEndCoords;
+        /**
+         * ключ конечных координат, для которых построен граф поиска
+         */
+        GridKey _graphEndKey{};
+        /**
+         * начальные координаты, для которых посчитаны ключи
+         */
+        std::vector<int> _lastStartCoords;
+        /**
+         * максимальное кол-во раскрытых ячеек за один запрос
+         */
+        unsigned int _maxNodeCnt;
+        /**
+         * кол-во раскрытых ячеек в последнем запросе
+         */
+        unsigned int _expandCnt = 0;
+        /**
+         * флаг, переиспользован ли граф поиска в последнем запросе
+         */
+        bool _graphReused = false;
+        /**
+         * кол-во ячеек, затронутых последним обновлением
+         */
+        unsigned long _affectedCellCnt = 0;
+        /**
+         * кол-во ячеек, доступность которых изменилась после последнего
+         * обновления (в том числе найденных при перепроверке путей)
+         */
+        unsigned long _changedCellCnt = 0;
+
+    public:
+        /**
+         * получить кол-во раскрытых ячеек в последнем запросе
+         * @return кол-во раскрытых ячеек
+         */
+        unsigned int getExpandCnt() const { return _expandCnt; }
+
+        /**
+         * получить кол-во ячеек графа поиска
+         * @return кол-во ячеек
+         */
+        unsigned long getCellCnt() const { return _cells.size(); }
+
+        /**
+         * получить флаг, переиспользован ли граф поиска в последнем запросе
+         * @return флаг, переиспользован ли граф поиска
+         */
+        bool isGraphReused() const { return _graphReused; }
+
+        /**
+         * получить кол-во ячеек, затронутых последним обновлением графа
+         * @return кол-во затронутых ячеек
+         */
+        unsigned long getAffectedCellCnt() const { return _affectedCellCnt; }
+
+        /**
+         * получить кол-во ячеек, доступность которых изменилась после последнего
+         * обновления графа, в том числе найденных при перепроверке путей
+         * @return кол-во ячеек, доступность которых изменилась
+         */
+        unsigned long getChangedCellCnt() const { return _changedCellCnt; }
+
+        /**
+         * получить максимальное кол-во раскрытых ячеек за один запрос
+         * @return максимальное кол-во раскрытых ячеек
+         */
+        unsigned int getMaxNodeCnt() const { return _maxNodeCnt; }
+    };
+}
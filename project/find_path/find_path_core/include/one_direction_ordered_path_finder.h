@@ -58,6 +58,8 @@ namespace bmpf {
          * @param kG коэффициент разницы в углах поворота сочленений робота
          * @param kD коэффициент разницы в положениях звеньев робота
          * @param threadCnt количество потоков планировщика
+         * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+         * только при извлечении из открытого множества
          */
         OneDirectionOrderedPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
                                       bool showTrace,
@@ -66,13 +68,14 @@ namespace bmpf {
                                       unsigned int maxNodeCnt,
                                       unsigned int kG = 1,
                                       unsigned int kD = 0,
-                                      int threadCnt = 1)
+                                      int threadCnt = 1,
+                                      bool lazyCheck = false)
                 : OneDirectionPathFinder(scene,
                                          showTrace,
                                          maxOpenSetSize,
                                          gridSize,
                                          maxNodeCnt,
-                                         kG, kD, threadCnt) {};
+                                         kG, kD, threadCnt, lazyCheck) {};
 
 
     protected:
@@ -101,16 +104,13 @@ namespace bmpf {
         /**
          * для всех соседей текущей ноды метод должен добавить только
          * подходящих в множество _openSet, если один из соседей
-         * имеет целевые указания (т.е. найден путь), то возвращаем указатель на эту ноду,
-         * в противном случае должен быть возвращён nullptr
-         * @param currentNode текущая нода
+         * имеет целевые указания (т.е. найден путь), то возвращаем индекс этой ноды,
+         * в противном случае должен быть возвращён PathNodeArena::NO_NODE
+         * @param currentNode индекс текущей ноды
          * @param endCoords целевые координаты
-         * @return найденная нода или null
+         * @return индекс найденной ноды или PathNodeArena::NO_NODE
          */
-        std::shared_ptr<PathNode> _forEachNeighbor(
-                std::shared_ptr<PathNode> currentNode,
-                std::vector<int> &endCoords
-        ) override;
+        unsigned int _forEachNeighbor(unsigned int currentNode, std::vector<int> &endCoords) override;
 
     };
 
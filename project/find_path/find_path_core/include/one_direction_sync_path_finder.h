@@ -6,7 +6,6 @@
 #include <utility>
 #include <unordered_set>
 #include <base/grid_path_finder.h>
-#include <future>
 #include <solid_collider.h>
 #include "solid_sync_collider.h"
 #include "scene.h"
@@ -20,9 +19,10 @@ namespace bmpf {
      * на каждом шаге ровно звена робота). Реализовано это с помощью списков смещений,
      * которые перебираются при каждом вызове `_forEachNeighbor`
      *
-     * Отличается от предка тем, что все смещения разбиваются по пакетам,
-     * размером, равным количеству потоков, в цикле каждый пакет по
-     * очереди перебирается заданным количеством потоков (использует многопоточный коллайдер)
+     * Отличается от предка тем, что использует многопоточный коллайдер:
+     * пакет соседей каждой ноды (см. `NodeGridPathFinder::_acceptNeighbors`)
+     * делится коллайдером на части, которые проверяются параллельно в его
+     * пуле потоков
      *
      * Cуть планирования
      * на сетке заключается в том, что каждой вещественной
@@ -58,6 +58,8 @@ namespace bmpf {
          * @param kG коэффициент разницы в углах поворота сочленений робота
          * @param kD коэффициент разницы в положениях звеньев робота
          * @param threadCnt количество потоков планировщика
+         * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+         * только при извлечении из открытого множества
          */
         OneDirectionSyncPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
                                    bool showTrace,
@@ -66,49 +68,8 @@ namespace bmpf {
                                    unsigned int maxNodeCnt,
                                    unsigned int kG = 1,
                                    unsigned int kD = 0,
-                                   int threadCnt = 1)
-                : OneDirectionPathFinder(scene, showTrace, maxOpenSetSize, gridSize, maxNodeCnt, kG, kD, threadCnt) {
-
-            // инициализируем многопоточный коллайдер
-            _collider = std::make_shared<bmpf::SolidSyncCollider>(threadCnt);
-            _collider->init(scene->getGroupedModelPaths(), false);
-
-            // разбиваем смещения по пакетам
-            std::vector<std::vector<int>> group;
-            int cnt = 0;
-            for (auto &offset: _offsetList) {
-                group.emplace_back(offset);
-                cnt++;
-                if (cnt >= threadCnt) {
-                    _groupedOffsetList.emplace_back(group);
-                    group.clear();
-                    cnt = 0;
-                }
-
-            }
-        };
-
-    protected:
-
-        /**
-         * для всех соседей текущей ноды метод должен добавить только
-         * подходящих в множество _openSet, если один из соседей
-         * имеет целевые указания (т.е. найден путь), то возвращаем указатель на эту ноду,
-         * в противном случае должен быть возвращён nullptr
-         * @param currentNode текущая нода
-         * @param endCoords целевые координаты
-         * @return найденная нода или null
-         */
-        std::shared_ptr<PathNode> _forEachNeighbor(
-                std::shared_ptr<PathNode> currentNode,
-                std::vector<int> &endCoords
-        ) override;
-
-        /**
-         * список смещений, сгруппированый по пакетам, размером равным
-         * кол-ву потоков
-         */
-        std::vector<std::vector<std::vector<int>>> _groupedOffsetList;
+                                   int threadCnt = 1,
+                                   bool lazyCheck = false);
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <json/json.h>
+#include <thread_pool.h>
+#include "base/path_finder.h"
+
+namespace bmpf {
+    /**
+     * @brief Портфель планировщиков
+     *
+     * Запускает одну и ту же задачу сразу на нескольких планировщиках,
+     * каждый в своём потоке, и возвращает путь того, кто первым нашёл
+     * путь. Остальные планировщики отменяются через флаг отмены
+     * (см. `PathFinder::cancel()`), который проверяется между тактами
+     * поиска, поэтому поток портфеля освобождается вскоре после победы.
+     *
+     * По каждому алгоритму копится статистика: в скольких гонках он
+     * участвовал, сколько выиграл и сколько раз не смог найти путь.
+     * Алгоритмы упорядочиваются по сглаженной доле побед
+     * (winCnt + 1) / (raceCnt + 2): алгоритм без гонок получает оценку 1/2,
+     * поэтому новые алгоритмы тоже получают шанс. Если в гонке участвует
+     * не весь портфель (raceCnt), в неё попадают первые по этому порядку.
+     * Статистику можно сохранить в json и загрузить в следующем сеансе.
+     *
+     * Планировщики должны быть разными объектами: они работают одновременно,
+     * а планировщик хранит изменяемое состояние поиска. Сцена у них может
+     * быть общей, во время поиска она только читается
+     */
+    class PortfolioPathFinder {
+    public:
+        /**
+         * @brief статистика алгоритма
+         */
+        struct AlgorithmStat {
+            /**
+             * кол-во гонок, в которых участвовал алгоритм
+             */
+            unsigned long raceCnt;
+            /**
+             * кол-во выигранных гонок
+             */
+            unsigned long winCnt;
+            /**
+             * кол-во гонок, в которых алгоритм не смог найти путь
+             * (отменённые поиски не учитываются)
+             */
+            unsigned long failCnt;
+            /**
+             * суммарное время выигранных гонок
+             */
+            double winTimeInSeconds;
+        };
+
+        /**
+         * конструктор
+         * @param pathFinders планировщики с названиями алгоритмов
+         * @param raceCnt кол-во планировщиков, участвующих в каждой гонке,
+         * 0 - все планировщики
+         */
+        explicit PortfolioPathFinder(
+                const std::vector<std::pair<std::string, std::shared_ptr<PathFinder>>> &pathFinders,
+                unsigned int raceCnt = 0
+        );
+
+        /**
+         * поиск пути: гонка планировщиков
+         * @param startState стартовое состояние
+         * @param endState конечное состояние
+         * @param errorCode в эту переменную записывается код ошибки:
+         * NO_ERROR, если хотя бы один планировщик нашёл путь, иначе
+         * код ошибки первого по порядку участника гонки
+         * @return путь победителя
+         */
+        std::vector<std::vector<double>>
+        findPath(const std::vector<double> &startState, const std::vector<double> &endState, int &errorCode);
+
+        /**
+         * получить номера алгоритмов в порядке убывания сглаженной доли побед
+         * @return номера алгоритмов
+         */
+        std::vector<unsigned long> getRanking() const;
+
+        /**
+         * получить json-представление статистики алгоритмов
+         * @return json-представление
+         */
+        Json::Value getStatsJSON() const;
+
+        /**
+         * загрузить статистику алгоритмов из json-представления,
+         * записи сопоставляются с алгоритмами по названиям, записи
+         * неизвестных алгоритмов пропускаются
+         * @param json json-представление
+         */
+        void loadStatsFromJSON(const Json::Value &json);
+
+        /**
+         * обнулить статистику алгоритмов
+         */
+        void resetStats();
+
+    protected:
+        /**
+         * сглаженная доля побед алгоритма
+         * @param num номер алгоритма
+         * @return сглаженная доля побед
+         */
+        double _getWinRate(unsigned long num) const;
+
+        /**
+         * названия алгоритмов
+         */
+        std::vector<std::string> _names;
+        /**
+         * планировщики
+         */
+        std::vector<std::shared_ptr<PathFinder>> _pathFinders;
+        /**
+         * статистика алгоритмов
+         */
+        std::vector<AlgorithmStat> _stats;
+        /**
+         * кол-во планировщиков, участвующих в каждой гонке
+         */
+        unsigned int _raceCnt;
+        /**
+         * пул потоков гонки
+         */
+        std::shared_ptr<ThreadPool> _threadPool;
+        /**
+         * номер алгоритма, выигравшего последнюю гонку, -1, если путь не найден
+         */
+        long _winnerNum = -1;
+        /**
+         * коды ошибок участников последней гонки по номерам алгоритмов,
+         * у не участвовавших - NO_ERROR
+         */
+        std::vector<int> _errorCodes;
+        /**
+         * затраченное на последнюю гонку время
+         */
+        double _calculationTimeInSeconds = -1;
+
+    public:
+        /**
+         * получить кол-во алгоритмов
+         * @return кол-во алгоритмов
+         */
+        unsigned long getAlgorithmCnt() const { return _pathFinders.size(); }
+
+        /**
+         * получить кол-во планировщиков, участвующих в каждой гонке
+         * @return кол-во планировщиков, участвующих в каждой гонке
+         */
+        unsigned int getRaceCnt() const { return _raceCnt; }
+
+        /**
+         * получить название алгоритма
+         * @param num номер алгоритма
+         * @return название алгоритма
+         */
+        const std::string &getName(unsigned long num) const { return _names.at(num); }
+
+        /**
+         * получить планировщик
+         * @param num номер алгоритма
+         * @return планировщик
+         */
+        const std::shared_ptr<PathFinder> &getPathFinder(unsigned long num) const { return _pathFinders.at(num); }
+
+        /**
+         * получить статистику алгоритма
+         * @param num номер алгоритма
+         * @return статистика алгоритма
+         */
+        const AlgorithmStat &getStat(unsigned long num) const { return _stats.at(num); }
+
+        /**
+         * получить номер алгоритма, выигравшего последнюю гонку
+         * @return номер алгоритма, -1, если путь не найден
+         */
+        long getWinnerNum() const { return _winnerNum; }
+
+        /**
+         * получить коды ошибок участников последней гонки по номерам алгоритмов
+         * @return коды ошибок
+         */
+        const std::vector<int> &getErrorCodes() const { return _errorCodes; }
+
+        /**
+         * получить затраченное на последнюю гонку время
+         * @return затраченное на последнюю гонку время
+         */
+        double getCalculationTimeInSeconds() const { return _calculationTimeInSeconds; }
+    };
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "scene.h"
+#include "base/path_finder.h"
+#include "base/kd_tree.h"
+
+namespace bmpf {
+    /**
+     * @brief Планировщик по вероятностной дорожной карте (lazy PRM)
+     *
+     * Дорожная карта строится один раз для сцены: случайные безколлизионные
+     * состояния становятся вершинами, каждая вершина соединяется рёбрами
+     * с `neighborCnt` ближайшими. Рёбра при построении не проверяются:
+     * на каждом такте поиска A* ищет кратчайший путь по рёбрам, не
+     * отмеченным как недопустимые, после чего проверяются только рёбра
+     * этого пути (одним пакетом). Если все они допустимы, путь найден,
+     * иначе недопустимые рёбра отмечаются, и поиск повторяется. Результаты
+     * проверок рёбер сохраняются в карте и используются следующими запросами.
+     *
+     * Начальное и конечное состояния запроса соединяются временными рёбрами
+     * с ближайшими вершинами карты и друг с другом.
+     *
+     * Если у сцены есть файл описания, карта сохраняется в двоичный файл
+     * рядом с ним (см. `getRoadmapPath`) и при создании следующего
+     * планировщика для той же сцены и тех же параметров загружается
+     * из этого файла. Если запросы изменили статусы рёбер, карта
+     * сохраняется в тот же файл ещё раз при удалении планировщика.
+     *
+     * При добавлении и удалении объекта через `addObjectToScene()` и
+     * `deleteObjectFromScene()` карта строится заново, если изменилось
+     * кол-во сочленений сцены, иначе вершины карты перепроверяются, а
+     * результаты проверок рёбер, которые могли устареть, сбрасываются.
+     * После изменения сцены в обход планировщика нужно вызвать `buildRoadmap()`
+     */
+    class PRMPathFinder : public PathFinder {
+    public:
+        /**
+         * Ребро ещё не проверено
+         */
+        static const char EDGE_UNKNOWN = 0;
+        /**
+         * Ребро безколлизионно
+         */
+        static const char EDGE_VALID = 1;
+        /**
+         * Ребро пересекает препятствие
+         */
+        static const char EDGE_INVALID = 2;
+
+        /**
+         * конструктор, загружает дорожную карту из файла рядом
+         * с описанием сцены или строит её
+         * @param scene сцена
+         * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+         * @param vertexCnt кол-во вершин дорожной карты
+         * @param neighborCnt кол-во ближайших вершин, с которыми соединяется каждая вершина
+         * @param checkStep максимальное расстояние между проверяемыми точками ребра
+         * @param seed зерно генератора случайных чисел
+         * @param threadCnt количество потоков планировщика
+         */
+        PRMPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
+                      bool showTrace,
+                      unsigned int vertexCnt = 5000,
+                      unsigned int neighborCnt = 10,
+                      double checkStep = 0.05,
+                      unsigned int seed = 1,
+                      int threadCnt = 1
+        );
+
+        /**
+         * деструктор, сохраняет карту в файл сцены, если запросы
+         * изменили статусы её рёбер
+         */
+        ~PRMPathFinder() override;
+
+        /**
+         * такт поиска
+         * @param state текущее состояние планировщика
+         * @return возвращает true, если планирование закончено
+         */
+        bool findTick(std::vector<double> &state) override;
+
+        /**
+         * подготовка к планированию
+         * @param startState начальное состояние
+         * @param endState конечное состояние
+         */
+        void prepare(const std::vector<double> &startState, const std::vector<double> &endState) override;
+
+        /**
+         * построение пути
+         */
+        void buildPath() override;
+
+        /**
+         * построить дорожную карту заново
+         */
+        void buildRoadmap();
+
+        /**
+         * добавить объект на сцену; если у объекта есть сочленения,
+         * карта строится заново, иначе перепроверяются вершины карты
+         * и допустимые рёбра (недопустимые такими и остаются)
+         * @param path путь к файлу с описанием
+         */
+        void addObjectToScene(std::string path) override;
+
+        /**
+         * удалить объект; если у объекта есть сочленения, карта строится
+         * заново, иначе перепроверяются вершины карты и все рёбра
+         * @param robotNum номер робота в списке роботов
+         */
+        void deleteObjectFromScene(long robotNum) override;
+
+        /**
+         * загрузить дорожную карту из файла
+         * @param path путь к файлу
+         * @return флаг, загружена ли карта; карта не загружается, если файла
+         * нет, он повреждён (в том числе если статус одного из рёбер не
+         * `EDGE_UNKNOWN`, `EDGE_VALID` или `EDGE_INVALID`) или построен
+         * для другой сцены или других параметров
+         */
+        bool loadRoadmap(const std::string &path);
+
+        /**
+         * сохранить дорожную карту в файл вместе с результатами проверок рёбер
+         * @param path путь к файлу
+         * @return флаг, сохранена ли карта
+         */
+        bool saveRoadmap(const std::string &path) const;
+
+        /**
+         * получить путь к файлу дорожной карты сцены:
+         * расширение ".json" заменяется на ".prm.bin"
+         * @param scenePath путь к описанию сцены
+         * @return путь к файлу дорожной карты
+         */
+        static std::string getRoadmapPath(const std::string &scenePath);
+
+    protected:
+        /**
+         * получить описание сцены и параметров карты, по которому
+         * проверяется, подходит ли сохранённая карта
+         * @return описание сцены и параметров карты
+         */
+        std::string _getRoadmapDescription() const;
+
+        /**
+         * получить случайное состояние в пределах допустимых углов
+         * (на коллизии не проверяется)
+         * @return случайное состояние
+         */
+        std::vector<double> _getRandomState();
+
+        /**
+         * построить списки смежности по списку рёбер
+         */
+        void _buildAdjacency();
+
+        /**
+         * @brief обновить статусы рёбер после изменения объектов сцены без сочленений
+         * сбрасывает статусы рёбер в EDGE_UNKNOWN и перепроверяет вершины карты
+         * одним пакетом: рёбра, инцидентные занятым вершинам, сразу отмечаются
+         * как недопустимые, остальные проверяются лениво при следующих запросах
+         * @param keepInvalid флаг, нужно ли сохранить недопустимые рёбра;
+         * после добавления препятствия недопустимое ребро не может стать допустимым
+         */
+        void _resetEdgeStatuses(bool keepInvalid);
+
+        /**
+         * добавить временное ребро запроса
+         * @param a первая вершина
+         * @param b вторая вершина
+         */
+        void _addQueryEdge(unsigned int a, unsigned int b);
+
+        /**
+         * получить состояние вершины, в том числе начальной и конечной вершин запроса
+         * @param vertex индекс вершины
+         * @return состояние
+         */
+        std::vector<double> _getVertexState(unsigned int vertex) const;
+
+        /**
+         * найти кратчайший путь по рёбрам, не отмеченным как недопустимые
+         * @param edges в этот вектор записываются рёбра пути: индекс ребра карты
+         * или индекс временного ребра, сдвинутый на кол-во рёбер карты
+         * @return вершины пути от начальной к конечной, пустой вектор, если пути нет
+         */
+        std::vector<unsigned int> _searchPath(std::vector<unsigned int> &edges);
+
+        /**
+         * проверить непроверенные рёбра пути и сохранить результаты: сначала
+         * все рёбра одним пакетом проверяются с крупным шагом, и только если ни одно
+         * из них не оказалось недопустимым, - с шагом `_checkStep`
+         * @param edges рёбра
+         * @param vertices вершины пути, i-е ребро соединяет i-ю и (i+1)-ю вершины
+         * @return флаг, допустимы ли все рёбра
+         */
+        bool _checkEdges(const std::vector<unsigned int> &edges, const std::vector<unsigned int> &vertices);
+
+        /**
+         * проверить непроверенные рёбра пути одним пакетом
+         * @param edges рёбра
+         * @param vertices вершины пути, i-е ребро соединяет i-ю и (i+1)-ю вершины
+         * @param checkStep максимальное расстояние между проверяемыми точками ребра
+         * @param markValid флаг, нужно ли отмечать допустимые рёбра; недопустимые
+         * рёбра отмечаются всегда
+         * @return флаг, допустимы ли все рёбра
+         */
+        bool _checkEdgeStates(
+                const std::vector<unsigned int> &edges, const std::vector<unsigned int> &vertices,
+                double checkStep, bool markValid
+        );
+
+        /**
+         * получить ссылку на статус ребра карты или временного ребра
+         * @param edge индекс ребра
+         * @return статус ребра
+         */
+        char &_edgeStatus(unsigned int edge) {
+            return edge < _edgeStatuses.size() ? _edgeStatuses[edge] : _queryEdgeStatuses[edge - _edgeStatuses.size()];
+        }
+
+        /**
+         * кол-во вершин дорожной карты
+         */
+        unsigned int _vertexCnt;
+        /**
+         * кол-во ближайших вершин, с которыми соединяется каждая вершина
+         */
+        unsigned int _neighborCnt;
+        /**
+         * максимальное расстояние между проверяемыми точками ребра
+         */
+        double _checkStep;
+        /**
+         * зерно генератора случайных чисел
+         */
+        unsigned int _seed;
+        /**
+         * генератор случайных чисел
+         */
+        std::mt19937 _rng;
+        /**
+         * вершины дорожной карты
+         */
+        KDTree _vertices;
+        /**
+         * рёбра дорожной карты, записанные парами индексов вершин
+         */
+        std::vector<unsigned int> _edges;
+        /**
+         * статусы рёбер дорожной карты
+         */
+        std::vector<char> _edgeStatuses;
+        /**
+         * начала списков смежности вершин в `_adjacency`
+         */
+        std::vector<unsigned int> _adjacencyOffsets;
+        /**
+         * списки смежности: пары (соседняя вершина, индекс ребра)
+         */
+        std::vector<std::pair<unsigned int, unsigned int>> _adjacency;
+        /**
+         * временные рёбра запроса, записанные парами индексов вершин
+         */
+        std::vector<unsigned int> _queryEdges;
+        /**
+         * статусы временных рёбер запроса
+         */
+        std::vector<char> _queryEdgeStatuses;
+        /**
+         * списки временных рёбер, инцидентных вершинам
+         */
+        std::unordered_map<unsigned int, std::vector<unsigned int>> _queryAdjacency;
+        /**
+         * вершины найденного пути
+         */
+        std::vector<unsigned int> _pathVertices;
+        /**
+         * кол-во поисков A* в последнем запросе
+         */
+        unsigned int _searchCnt = 0;
+        /**
+         * флаг, загружена ли карта из файла
+         */
+        bool _roadmapLoaded = false;
+        /**
+         * путь к файлу дорожной карты сцены, пустой, если у сцены нет файла описания
+         */
+        std::string _roadmapPath;
+        /**
+         * описание сцены и параметров карты, для которых записан файл `_roadmapPath`
+         */
+        std::string _roadmapDescription;
+        /**
+         * флаг, изменились ли статусы рёбер карты после записи файла `_roadmapPath`
+         */
+        bool _roadmapChanged = false;
+
+    public:
+        /**
+         * получить кол-во вершин дорожной карты
+         * @return кол-во вершин
+         */
+        unsigned long getVertexCnt() const { return _vertices.size(); }
+
+        /**
+         * получить кол-во рёбер дорожной карты
+         * @return кол-во рёбер
+         */
+        unsigned long getEdgeCnt() const { return _edgeStatuses.size(); }
+
+        /**
+         * получить кол-во рёбер дорожной карты с заданным статусом
+         * @param status статус ребра
+         * @return кол-во рёбер
+         */
+        unsigned long getEdgeCnt(char status) const;
+
+        /**
+         * получить кол-во ближайших вершин, с которыми соединяется каждая вершина
+         * @return кол-во ближайших вершин
+         */
+        unsigned int getNeighborCnt() const { return _neighborCnt; }
+
+        /**
+         * получить максимальное расстояние между проверяемыми точками ребра
+         * @return максимальное расстояние между проверяемыми точками ребра
+         */
+        double getCheckStep() const { return _checkStep; }
+
+        /**
+         * получить кол-во поисков A* в последнем запросе
+         * @return кол-во поисков
+         */
+        unsigned int getSearchCnt() const { return _searchCnt; }
+
+        /**
+         * получить флаг, загружена ли карта из файла
+         * @return флаг, загружена ли карта из файла
+         */
+        bool isRoadmapLoaded() const { return _roadmapLoaded; }
+    };
+}
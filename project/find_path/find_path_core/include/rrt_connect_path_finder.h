@@ -0,0 +1,206 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "scene.h"
+#include "base/path_finder.h"
+#include "base/kd_tree.h"
+
+namespace bmpf {
+    /**
+     * @brief Планировщик RRT-Connect
+     *
+     * Планировщик строит два дерева быстро исследующих случайных путей
+     * (RRT): одно от начального состояния, другое от конечного. На каждом
+     * такте одно из деревьев делает шаг длины не больше `stepSize` в сторону
+     * случайного состояния, а второе дерево жадно растёт в сторону новой
+     * вершины, пока не упрётся в препятствие или не достигнет её; после
+     * этого деревья меняются ролями. Путь найден, когда деревья соединились.
+     *
+     * В отличие от планировщиков на сетке, размер задачи не растёт
+     * экспоненциально с числом сочленений. Ближайшие вершины ищутся k-d
+     * деревом, рёбра проверяются методом `divideCheckPathSegment()` с шагом
+     * не больше `checkStep`. Генератор случайных чисел инициализируется
+     * заданным зерном при каждой подготовке, поэтому для одной сцены
+     * и одних и тех же состояний находится один и тот же путь
+     */
+    class RRTConnectPathFinder : public PathFinder {
+    public:
+        /**
+         * конструктор
+         * @param scene сцена
+         * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+         * @param stepSize максимальная длина ребра дерева
+         * @param checkStep максимальное расстояние между проверяемыми точками ребра
+         * @param maxNodeCnt максимальное кол-во вершин в обоих деревьях
+         * @param seed зерно генератора случайных чисел
+         * @param threadCnt количество потоков планировщика
+         */
+        RRTConnectPathFinder(const std::shared_ptr<bmpf::Scene> &scene,
+                             bool showTrace,
+                             double stepSize = 0.5,
+                             double checkStep = 0.05,
+                             unsigned int maxNodeCnt = 100000,
+                             unsigned int seed = 1,
+                             int threadCnt = 1
+        );
+
+        /**
+         * такт поиска
+         * @param state текущее состояние планировщика
+         * @return возвращает true, если планирование закончено
+         */
+        bool findTick(std::vector<double> &state) override;
+
+        /**
+         * подготовка к планированию
+         * @param startState начальное состояние
+         * @param endState конечное состояние
+         */
+        void prepare(const std::vector<double> &startState, const std::vector<double> &endState) override;
+
+        /**
+         * построение пути
+         */
+        void buildPath() override;
+
+    protected:
+        /**
+         * @brief Дерево RRT
+         * вершины дерева хранятся в k-d дереве, индексы предков - в отдельном массиве
+         */
+        struct Tree {
+            /**
+             * состояния вершин
+             */
+            KDTree states;
+            /**
+             * индексы предков вершин, KDTree::NO_POINT у корня
+             */
+            std::vector<unsigned int> parents;
+        };
+
+        /**
+         * получить случайное состояние в пределах допустимых углов
+         * (на коллизии не проверяется)
+         * @return случайное состояние
+         */
+        std::vector<double> _getRandomState();
+
+        /**
+         * получить состояние на отрезке от from к to на расстоянии не больше длины шага
+         * @param from начало отрезка
+         * @param to конец отрезка
+         * @param reached в эту переменную записывается флаг, совпадает ли результат с to
+         * @return состояние
+         */
+        std::vector<double> _steer(const std::vector<double> &from, const std::vector<double> &to, bool &reached) const;
+
+        /**
+         * проверить ребро на коллизии, начало ребра - вершина дерева,
+         * т.е. оно уже проверено
+         * @param from начало ребра
+         * @param to конец ребра
+         * @return флаг, является ли ребро безколлизионным
+         */
+        bool _checkEdge(const std::vector<double> &from, const std::vector<double> &to);
+
+        /**
+         * добавить вершину в дерево
+         * @param tree дерево
+         * @param state состояние
+         * @param parent индекс предка
+         * @return индекс вершины
+         */
+        unsigned int _addNode(Tree &tree, const std::vector<double> &state, unsigned int parent);
+
+        /**
+         * сделать шаг дерева в сторону состояния
+         * @param tree дерево
+         * @param target состояние, в сторону которого растёт дерево
+         * @return индекс новой вершины или KDTree::NO_POINT, если шаг невозможен
+         */
+        unsigned int _extend(Tree &tree, const std::vector<double> &target);
+
+        /**
+         * растить дерево в сторону состояния, пока оно не будет достигнуто
+         * @param tree дерево
+         * @param target состояние, в сторону которого растёт дерево
+         * @return индекс вершины, совпадающей с target, или KDTree::NO_POINT,
+         * если дерево упёрлось в препятствие
+         */
+        unsigned int _connect(Tree &tree, const std::vector<double> &target);
+
+        /**
+         * проверка, достигнуто ли максимальное кол-во вершин
+         * @return флаг, достигнуто ли максимальное кол-во вершин
+         */
+        bool _isFull() const { return _trees[0].parents.size() + _trees[1].parents.size() >= _maxNodeCnt; }
+
+        /**
+         * максимальная длина ребра дерева
+         */
+        double _stepSize;
+        /**
+         * максимальное расстояние между проверяемыми точками ребра
+         */
+        double _checkStep;
+        /**
+         * максимальное кол-во вершин в обоих деревьях
+         */
+        unsigned int _maxNodeCnt;
+        /**
+         * зерно генератора случайных чисел
+         */
+        unsigned int _seed;
+        /**
+         * генератор случайных чисел
+         */
+        std::mt19937 _rng;
+        /**
+         * деревья: 0 - от начального состояния, 1 - от конечного
+         */
+        Tree _trees[2];
+        /**
+         * номер дерева, которое делает шаг к случайному состоянию на следующем такте
+         */
+        unsigned int _activeTree = 0;
+        /**
+         * индексы вершин, в которых соединились деревья
+         */
+        unsigned int _connectNodes[2] = {KDTree::NO_POINT, KDTree::NO_POINT};
+
+    public:
+        /**
+         * получить кол-во вершин в обоих деревьях
+         * @return кол-во вершин
+         */
+        unsigned long getNodeCnt() const { return _trees[0].parents.size() + _trees[1].parents.size(); }
+
+        /**
+         * получить максимальную длину ребра дерева
+         * @return максимальная длина ребра дерева
+         */
+        double getStepSize() const { return _stepSize; }
+
+        /**
+         * получить максимальное расстояние между проверяемыми точками ребра
+         * @return максимальное расстояние между проверяемыми точками ребра
+         */
+        double getCheckStep() const { return _checkStep; }
+
+        /**
+         * получить зерно генератора случайных чисел
+         * @return зерно генератора случайных чисел
+         */
+        unsigned int getSeed() const { return _seed; }
+
+        /**
+         * задать зерно генератора случайных чисел, оно используется со следующей подготовки
+         * @param seed зерно генератора случайных чисел
+         */
+        void setSeed(unsigned int seed) { _seed = seed; }
+    };
+}
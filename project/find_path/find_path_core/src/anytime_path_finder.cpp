@@ -0,0 +1,220 @@
+#include "anytime_path_finder.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace bmpf;
+
+/**
+ * конструктор
+ * @param scene сцена
+ * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+ * @param maxOpenSetSize максимальный размер открытого множества
+ * @param gridSize размер сетки планирования
+ * @param maxNodeCnt максимальное кол-во нод в закрытом множестве
+ * @param timeLimit время на улучшение пути, сек; первый путь ищется без ограничения времени
+ * @param initialWeight вес эвристики на первой итерации
+ * @param weightStep на сколько уменьшается вес эвристики после каждой итерации
+ * @param kG коэффициент разницы в углах поворота сочленений робота
+ * @param kD коэффициент разницы в положениях звеньев робота
+ * @param threadCnt количество потоков планировщика
+ * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+ * только при извлечении из открытого множества
+ */
+AnytimePathFinder::AnytimePathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, unsigned int maxOpenSetSize, int gridSize,
+        unsigned int maxNodeCnt, double timeLimit, double initialWeight, double weightStep,
+        unsigned int kG, unsigned int kD, int threadCnt, bool lazyCheck
+) : OneDirectionPathFinder(scene, showTrace, maxOpenSetSize, gridSize, maxNodeCnt, kG, kD, threadCnt, lazyCheck),
+    _timeLimit(timeLimit), _initialWeight(initialWeight), _weightStep(weightStep) {
+    if (!(initialWeight >= 1) || std::isinf(initialWeight) || !(weightStep > 0)) {
+        char buf[1024];
+        sprintf(buf,
+                "AnytimePathFinder::AnytimePathFinder() ERROR: \n initial weight is %f, weight step is %f"
+                "\ninitial weight must be finite and >= 1, weight step must be > 0",
+                initialWeight, weightStep
+        );
+        throw std::invalid_argument(buf);
+    }
+}
+
+/**
+ * подготовка к планированию
+ * @param startState начальное состояние
+ * @param endState конечное состояние
+ */
+void AnytimePathFinder::prepare(const std::vector<double> &startState, const std::vector<double> &endState) {
+    _resetSearch();
+    OneDirectionPathFinder::prepare(startState, endState);
+}
+
+/**
+ * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+ * @param startCoords начальные координаты
+ * @param endCoords конечные координаты
+ */
+void AnytimePathFinder::prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) {
+    _resetSearch();
+    OneDirectionPathFinder::prepare(startCoords, endCoords);
+}
+
+/**
+ * сбросить состояние поиска перед подготовкой
+ */
+void AnytimePathFinder::_resetSearch() {
+    // вес задаётся до подготовки, потому что по нему считается приоритет стартовой ноды
+    setHeuristicWeight(_initialWeight);
+    _bestNodes.clear();
+    _inconsNodes.clear();
+    _goalNode = PathNodeArena::NO_NODE;
+    _improvedPaths.clear();
+    _improvedPathCosts.clear();
+    _improvedPathWeights.clear();
+    _searchStartTime = std::chrono::steady_clock::now();
+}
+
+/**
+ * такт поиска
+ * @param state текущее состояние планировщика
+ * @return возвращает true, если планирование закончено
+ */
+bool AnytimePathFinder::findTick(std::vector<double> &state) {
+    if (_goalNode != PathNodeArena::NO_NODE) {
+        // итерация закончена: ни одна из открытых нод не даст пути дешевле найденного
+        if (_openSet.empty() || _nodes.at(_openSet.top()).sum >= _nodes.at(_goalNode).cost) {
+            _publishPath();
+            if (_heuristicWeight <= 1 || _isTimeOver())
+                return _finish();
+            _startNextIteration();
+        } else if (_isTimeOver()) {
+            _publishPath();
+            return _finish();
+        }
+    }
+
+    if (!NodeGridPathFinder::findTick(state))
+        return false;
+
+    if (_endNode == PathNodeArena::NO_NODE) {
+        // поиск закончился ошибкой, но путь уже был найден
+        if (_goalNode != PathNodeArena::NO_NODE) {
+            _publishPath();
+            return _finish();
+        }
+        return true;
+    }
+
+    // найдена нода цели: поиск продолжается до конца итерации
+    if (_goalNode == PathNodeArena::NO_NODE || _nodes.at(_endNode).cost < _nodes.at(_goalNode).cost) {
+        _goalNode = _endNode;
+        _bestNodes[_endKey] = _endNode;
+    }
+    _endNode = PathNodeArena::NO_NODE;
+    return false;
+}
+
+/**
+ * проверка соседней ноды: координаты не должны быть отброшены
+ * в ленивом режиме, а стоимость пути до них должна быть меньше
+ * лучшей известной (в том числе для уже закрытых координат)
+ * @param newKey ключ координат
+ * @param sum приоритет
+ * @param cost стоимость пути от стартовой ноды
+ * @return флаг, может ли нода быть создана, если её координаты доступны
+ */
+bool AnytimePathFinder::_isNeighborNew(const GridKey &newKey, double /*sum*/, double cost) {
+    if (_lazyCheck && _disabledKeySet.find(newKey) != _disabledKeySet.end())
+        return false;
+
+    auto it = _bestNodes.find(newKey);
+    return it == _bestNodes.end() || _nodes.at(it->second).cost > cost;
+}
+
+/**
+ * добавить созданную соседнюю ноду в открытое множество, а если её
+ * координаты уже закрыты на этой итерации - в список несогласованных нод
+ * @param node индекс ноды
+ */
+void AnytimePathFinder::_openNode(unsigned int node) {
+    const GridKey &key = _nodes.getKey(node);
+    _bestNodes[key] = node;
+
+    if (_findCoordsInClosedList(key)) {
+        // закрытые координаты уже проверены на коллизии
+        _nodes.setChecked(node);
+        _inconsNodes.push_back(node);
+        // найден более дешёвый путь до уже извлечённой цели
+        if (key == _endKey)
+            _goalNode = node;
+    } else
+        _openSet.push(node);
+}
+
+/**
+ * сохранить путь до лучшей ноды цели, если он короче последнего сохранённого
+ */
+void AnytimePathFinder::_publishPath() {
+    double cost = _nodes.at(_goalNode).cost;
+    if (!_improvedPathCosts.empty() && _improvedPathCosts.back() <= cost)
+        return;
+
+    _endNode = _goalNode;
+    _buildedPath.clear();
+    NodeGridPathFinder::buildPath();
+    _endNode = PathNodeArena::NO_NODE;
+
+    _improvedPaths.push_back(_buildedPath);
+    _improvedPathCosts.push_back(cost);
+    _improvedPathWeights.push_back(_heuristicWeight);
+
+    if (_showTrace)
+        bmpf::infoMsg("path improved: weight ", _heuristicWeight, " cost ", cost);
+}
+
+/**
+ * уменьшить вес эвристики и подготовить открытое множество к следующей итерации
+ */
+void AnytimePathFinder::_startNextIteration() {
+    double prevWeight = _heuristicWeight;
+    setHeuristicWeight(std::max(1.0, _heuristicWeight - _weightStep));
+
+    std::vector<unsigned int> nodes = _openSet.getNodes();
+    nodes.insert(nodes.end(), _inconsNodes.begin(), _inconsNodes.end());
+    _inconsNodes.clear();
+    _openSet.clear();
+    _closedNodeIndex.clear();
+    _closedNodes.clear();
+
+    for (unsigned int node: nodes) {
+        // в списке несогласованных нод могут быть ноды, для координат
+        // которых потом нашлись пути дешевле
+        const GridKey &key = _nodes.getKey(node);
+        if (_openSet.contains(key))
+            continue;
+        node = _bestNodes.at(key);
+
+        // эвристика восстанавливается по приоритету, посчитанному с прежним весом
+        const PathNode &pathNode = _nodes.at(node);
+        double heuristic = (pathNode.sum - pathNode.cost) / prevWeight;
+        _nodes.setSum(node, _getPriority(pathNode.cost, heuristic));
+        _openSet.push(node);
+    }
+}
+
+/**
+ * закончить поиск с лучшим найденным путём
+ * @return всегда true
+ */
+bool AnytimePathFinder::_finish() {
+    _endNode = _goalNode;
+    _errorCode = NO_ERROR;
+    return true;
+}
+
+/**
+ * проверка, истекло ли время на улучшение пути
+ * @return флаг, истекло ли время
+ */
+bool AnytimePathFinder::_isTimeOver() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _searchStartTime).count() >= _timeLimit;
+}
@@ -0,0 +1,56 @@
+#include "base/grid_check_cache.h"
+
+using namespace bmpf;
+
+/**
+ * найти сохранённый результат проверки
+ * @param coords координаты
+ * @param scale во сколько раз сетка координат грубее самой мелкой
+ * @param enabled в эту переменную записывается результат проверки
+ * @return флаг, найден ли результат
+ */
+bool GridCheckCache::find(const std::vector<int> &coords, int scale, bool &enabled) {
+    auto it = _results.find(_getKey(coords, scale));
+    if (it == _results.end()) {
+        _missCnt++;
+        return false;
+    }
+    _hitCnt++;
+    enabled = it->second;
+    return true;
+}
+
+/**
+ * сохранить результат проверки
+ * @param coords координаты
+ * @param scale во сколько раз сетка координат грубее самой мелкой
+ * @param enabled флаг, доступны ли координаты
+ */
+void GridCheckCache::save(const std::vector<int> &coords, int scale, bool enabled) {
+    _results[_getKey(coords, scale)] = enabled;
+}
+
+/**
+ * очистить кэш и счётчики
+ */
+void GridCheckCache::clear() {
+    _results.clear();
+    _hitCnt = 0;
+    _missCnt = 0;
+}
+
+/**
+ * получить ключ ячейки самой мелкой сетки
+ * @param coords координаты
+ * @param scale во сколько раз сетка координат грубее самой мелкой
+ * @return ключ ячейки самой мелкой сетки
+ */
+GridKey GridCheckCache::_getKey(const std::vector<int> &coords, int scale) const {
+    if (scale == 1)
+        return _keyCoder.encode(coords);
+
+    std::vector<int> fineCoords(coords.size());
+    for (unsigned long i = 0; i < coords.size(); i++)
+        fineCoords[i] = coords[i] * scale;
+    return _keyCoder.encode(fineCoords);
+}
@@ -0,0 +1,100 @@
+#include "base/grid_key.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+using namespace bmpf;
+
+/**
+ * получить количество бит, необходимое для кодирования координат
+ * из диапазона [-1, gridSize]
+ * @param gridSize размер сетки планирования
+ * @return количество бит
+ */
+static unsigned int getGridBitCnt(int gridSize) {
+    if (gridSize <= 0) {
+        char buf[1024];
+        sprintf(buf, "GridKeyCoder ERROR: \n grid size is %d, it must be positive", gridSize);
+        throw std::invalid_argument(buf);
+    }
+    // со сдвигом на 1 кодируются значения [0, gridSize+1]
+    unsigned int bitCnt = 1;
+    while (bitCnt < 32 && ((uint64_t) 1 << bitCnt) <= (uint64_t) gridSize + 1)
+        bitCnt++;
+    return bitCnt;
+}
+
+/**
+ * получить максимальную размерность координат для заданного размера сетки
+ * @param gridSize размер сетки планирования
+ * @return максимальная размерность координат
+ */
+unsigned long GridKeyCoder::getMaxDim(int gridSize) {
+    return (unsigned long) (64 / getGridBitCnt(gridSize)) * GridKey::WORD_CNT;
+}
+
+/**
+ * конструктор
+ * @param dim размерность координат
+ * @param gridSize размер сетки планирования
+ */
+GridKeyCoder::GridKeyCoder(unsigned long dim, int gridSize) : _dim(dim), _gridSize(gridSize) {
+    _bitCnt = getGridBitCnt(gridSize);
+    _coordsPerWord = 64 / _bitCnt;
+    _mask = ((uint64_t) 1 << _bitCnt) - 1;
+
+    if (dim > getMaxDim(gridSize)) {
+        char buf[1024];
+        sprintf(buf,
+                "GridKeyCoder ERROR: \n dim is %lu, grid size is %d"
+                "\ncoords need %u bits each, max dim is %lu",
+                dim, gridSize, _bitCnt, getMaxDim(gridSize)
+        );
+        throw std::invalid_argument(buf);
+    }
+}
+
+/**
+ * упаковать координаты в ключ
+ * @param coords координаты
+ * @return ключ
+ */
+GridKey GridKeyCoder::encode(const std::vector<int> &coords) const {
+    if (coords.size() != _dim) {
+        char buf[1024];
+        sprintf(buf,
+                "GridKeyCoder::encode() ERROR: \n coords size is %zu, dim is %lu"
+                "\nthey must be equal",
+                coords.size(), _dim
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    GridKey key{};
+    for (unsigned long i = 0; i < _dim; i++) {
+        int coord = coords[i];
+        if (coord < -1 || coord > _gridSize) {
+            char buf[1024];
+            sprintf(buf,
+                    "GridKeyCoder::encode() ERROR: \n coord %lu is %d"
+                    "\nit must be in range [-1, %d]",
+                    i, coord, _gridSize
+            );
+            throw std::out_of_range(buf);
+        }
+        key.words[i / _coordsPerWord] |= (uint64_t) (coord + 1) << ((i % _coordsPerWord) * _bitCnt);
+    }
+    return key;
+}
+
+/**
+ * распаковать ключ в координаты
+ * @param key ключ
+ * @param coords координаты, вектор переиспользуется, если его размер
+ * совпадает с размерностью упаковщика
+ */
+void GridKeyCoder::decode(const GridKey &key, std::vector<int> &coords) const {
+    coords.resize(_dim);
+    for (unsigned long i = 0; i < _dim; i++)
+        coords[i] = getCoord(key, i);
+}
@@ -105,6 +105,7 @@ void GridPathFinder::prepare(const std::vector<double> &startState, const std::v
 
 
     _coordsUsed = false;
+    _keyCoder = GridKeyCoder(_scene->getJointCnt(), _gridSize);
 
     _startState = startState;
     _endState = endState;
@@ -166,6 +167,7 @@ void GridPathFinder::prepare(std::vector<int> &startCoords, std::vector<int> &en
     }
 
     _coordsUsed = true;
+    _keyCoder = GridKeyCoder(_scene->getJointCnt(), _gridSize);
 
     _startState = coordsToState(startCoords);
     _endState = coordsToState(endCoords);
@@ -235,7 +237,12 @@ GridPathFinder::findGridPath(std::vector<int> &startCoords, std::vector<int> &en
     std::vector<double> actualState;
 
     // если очередной такт поиска пути не последний
-    while (!findTick(actualState)) {};
+    while (!findTick(actualState)) {
+        if (isCancelled()) {
+            _errorCode = ERROR_CANCELLED;
+            break;
+        }
+    }
 
     if (_errorCode != NO_ERROR)
         return {};
@@ -256,13 +263,25 @@ GridPathFinder::findGridPath(std::vector<int> &startCoords, std::vector<int> &en
  * @param coords координаты
  * @return состояние
  */
-std::vector<double> GridPathFinder::coordsToState(std::vector<int> &coords) const {
+std::vector<double> GridPathFinder::coordsToState(const std::vector<int> &coords) const {
     std::vector<double> state;
     for (unsigned int i = 0; i < coords.size(); i++)
         state.push_back(coords.at(i) * _gridSteps.at(i) + _scene->getJointParamsList().at(i)->minAngle);
     return state;
 }
 
+/**
+ * преобразование целочисленных координат в вещественное состояние
+ * без выделения памяти, если размер буфера уже подходит
+ * @param coords координаты
+ * @param state в эту переменную записывается состояние
+ */
+void GridPathFinder::coordsToState(const std::vector<int> &coords, std::vector<double> &state) const {
+    state.resize(coords.size());
+    for (unsigned int i = 0; i < coords.size(); i++)
+        state[i] = coords[i] * _gridSteps.at(i) + _scene->getJointParamsList().at(i)->minAngle;
+}
+
 /**
  * преобразование целочисленных координат в вещественное состояние
  * @param coords координаты
@@ -270,9 +289,12 @@ std::vector<double> GridPathFinder::coordsToState(std::vector<int> &coords) cons
  * @return состояние
  */
 std::vector<double> GridPathFinder::coordsToState(std::vector<int> coords, unsigned long robotNum) {
+    // индекс первой координаты робота в состоянии сцены
+    unsigned long offset = _scene->getJointIndexRanges().at(robotNum).first;
     std::vector<double> state;
-    for (unsigned int i = 0; i < 6; i++)
-        state.push_back(coords.at(i) * _gridSteps.at(i) + _scene->getJointParamsList().at(i)->minAngle);
+    for (unsigned long i = 0; i < coords.size(); i++)
+        state.push_back(coords.at(i) * _gridSteps.at(offset + i) +
+                        _scene->getJointParamsList().at(offset + i)->minAngle);
     return state;
 }
 
@@ -281,7 +303,7 @@ std::vector<double> GridPathFinder::coordsToState(std::vector<int> coords, unsig
  * @param coords координаты
  * @return флаг, доступны ли целочисленных координаты
  */
-bool GridPathFinder::checkCoords(std::vector<int> coords) {
+bool GridPathFinder::checkCoords(const std::vector<int> &coords) {
     if (coords.size() != _scene->getJointCnt()) {
         char buf[1024];
         sprintf(buf,
@@ -292,12 +314,22 @@ bool GridPathFinder::checkCoords(std::vector<int> coords) {
         throw std::invalid_argument(buf);
     }
 
+    if (!isCoordsInGrid(coords))
+        return false;
+
+    return checkState(coordsToState(coords));
+}
+
+/**
+ * Проверка, лежат ли целочисленные координаты внутри сетки планирования
+ * @param coords координаты
+ * @return флаг, лежат ли координаты внутри сетки
+ */
+bool GridPathFinder::isCoordsInGrid(const std::vector<int> &coords) const {
     for (int coord: coords)
         if (coord < 0 || coord >= _gridSize)
             return false;
-
-
-    return checkState(coordsToState(coords));
+    return true;
 }
 
 /**
@@ -0,0 +1,175 @@
+#include "base/kd_tree.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+using namespace bmpf;
+
+const unsigned int KDTree::NO_POINT;
+
+/**
+ * сбросить дерево
+ * @param dim размерность точек
+ */
+void KDTree::reset(unsigned long dim) {
+    _dim = dim;
+    _points.clear();
+    _left.clear();
+    _right.clear();
+    _depths.clear();
+}
+
+/**
+ * добавить точку
+ * @param point точка
+ * @return индекс точки
+ */
+unsigned int KDTree::add(const std::vector<double> &point) {
+    if (point.size() != _dim) {
+        char buf[1024];
+        sprintf(buf,
+                "KDTree::add() ERROR: \n point size is %zu, tree dim is %lu"
+                "\nthey must be equal",
+                point.size(), _dim
+        );
+        throw std::invalid_argument(buf);
+    }
+    if (_left.size() >= NO_POINT)
+        throw std::overflow_error("KDTree::add() ERROR: too many points");
+
+    auto index = (unsigned int) _left.size();
+    _points.insert(_points.end(), point.begin(), point.end());
+    _left.push_back(NO_POINT);
+    _right.push_back(NO_POINT);
+
+    if (index == 0) {
+        _depths.push_back(0);
+        return index;
+    }
+
+    // спускаемся от корня до свободного места
+    unsigned int node = 0;
+    while (true) {
+        unsigned long axis = _depths[node] % _dim;
+        std::vector<unsigned int> &children = point[axis] < _points[node * _dim + axis] ? _left : _right;
+        if (children[node] == NO_POINT) {
+            children[node] = index;
+            _depths.push_back(_depths[node] + 1);
+            return index;
+        }
+        node = children[node];
+    }
+}
+
+/**
+ * найти ближайшую точку
+ * @param point точка, для которой ищется ближайшая
+ * @return индекс ближайшей точки, NO_POINT, если дерево пустое
+ */
+unsigned int KDTree::nearest(const std::vector<double> &point) const {
+    if (_left.empty())
+        return NO_POINT;
+
+    unsigned int best = NO_POINT;
+    double bestSqrDistance = std::numeric_limits<double>::infinity();
+
+    // стек узлов с нижней оценкой квадрата расстояния до их поддеревьев;
+    // обход идёт без рекурсии, т.к. глубина дерева не ограничена
+    std::vector<std::pair<unsigned int, double>> stack{{0, 0}};
+    while (!stack.empty()) {
+        unsigned int node = stack.back().first;
+        double bound = stack.back().second;
+        stack.pop_back();
+        if (bound >= bestSqrDistance)
+            continue;
+
+        double sqrDistance = _getSqrDistance(point, node);
+        if (sqrDistance < bestSqrDistance) {
+            bestSqrDistance = sqrDistance;
+            best = node;
+        }
+
+        unsigned long axis = _depths[node] % _dim;
+        double diff = point[axis] - _points[node * _dim + axis];
+        unsigned int nearChild = diff < 0 ? _left[node] : _right[node];
+        unsigned int farChild = diff < 0 ? _right[node] : _left[node];
+
+        // дальнее поддерево кладётся первым, чтобы ближнее обошлось раньше
+        // и успело уменьшить расстояние до лучшей точки
+        if (farChild != NO_POINT)
+            stack.emplace_back(farChild, std::max(bound, diff * diff));
+        if (nearChild != NO_POINT)
+            stack.emplace_back(nearChild, bound);
+    }
+    return best;
+}
+
+/**
+ * найти несколько ближайших точек
+ * @param point точка, для которой ищутся ближайшие
+ * @param cnt максимальное кол-во точек
+ * @return индексы точек в порядке возрастания расстояния
+ */
+std::vector<unsigned int> KDTree::nearest(const std::vector<double> &point, unsigned long cnt) const {
+    if (_left.empty() || cnt == 0)
+        return {};
+
+    // куча найденных точек, в вершине - самая дальняя из них
+    std::vector<std::pair<double, unsigned int>> found;
+    auto bestSqrDistance = [&found, cnt]() {
+        return found.size() < cnt ? std::numeric_limits<double>::infinity() : found.front().first;
+    };
+
+    std::vector<std::pair<unsigned int, double>> stack{{0, 0}};
+    while (!stack.empty()) {
+        unsigned int node = stack.back().first;
+        double bound = stack.back().second;
+        stack.pop_back();
+        if (bound >= bestSqrDistance())
+            continue;
+
+        double sqrDistance = _getSqrDistance(point, node);
+        if (sqrDistance < bestSqrDistance()) {
+            if (found.size() == cnt) {
+                std::pop_heap(found.begin(), found.end());
+                found.pop_back();
+            }
+            found.emplace_back(sqrDistance, node);
+            std::push_heap(found.begin(), found.end());
+        }
+
+        unsigned long axis = _depths[node] % _dim;
+        double diff = point[axis] - _points[node * _dim + axis];
+        unsigned int nearChild = diff < 0 ? _left[node] : _right[node];
+        unsigned int farChild = diff < 0 ? _right[node] : _left[node];
+
+        if (farChild != NO_POINT)
+            stack.emplace_back(farChild, std::max(bound, diff * diff));
+        if (nearChild != NO_POINT)
+            stack.emplace_back(nearChild, bound);
+    }
+
+    std::sort_heap(found.begin(), found.end());
+    std::vector<unsigned int> indexes;
+    for (auto &pair: found)
+        indexes.push_back(pair.second);
+    return indexes;
+}
+
+/**
+ * квадрат расстояния от точки до точки дерева
+ * @param point точка
+ * @param index индекс точки дерева
+ * @return квадрат расстояния
+ */
+double KDTree::_getSqrDistance(const std::vector<double> &point, unsigned int index) const {
+    double sum = 0;
+    const double *treePoint = &_points[index * _dim];
+    for (unsigned long i = 0; i < _dim; i++) {
+        double diff = point[i] - treePoint[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
@@ -1,46 +1,40 @@
 #include "base/node_grid_path_finder.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace bmpf;
 
 /**
  * переместить ноду из открытого множества открытых в множество закрытых
  * @param node нода
  */
-void NodeGridPathFinder::_moveNodeFromOpenedToClosed(const std::shared_ptr<PathNode> &node) {
-    // получаем свёртку состояния
-    long code = (long) convState(node->coords, _gridSize);
-    // добавляем его в список обработанных нод
-    _closedStateConvCodeSet.insert(code);
+void NodeGridPathFinder::_moveNodeFromOpenedToClosed(unsigned int node) {
+    const GridKey &key = _nodes.getKey(node);
+    // добавляем ноду в индекс обработанных нод
+    _closedNodeIndex[key] = node;
     _closedNodes.push_back(node);
 
-    // удаляем ноду из множества открытых (и все её дублёры)
-    std::multiset<PathNodePtr>::iterator it;
-    for (it = _openSet.begin(); it != _openSet.end() && !areStatesEqual(it->ptr->coords, node->coords); it++);
-    if (it != _openSet.end())
-        _openSet.erase(it);
-
+    // удаляем ноду из множества открытых
+    _openSet.erase(key);
 }
 
 /**
  * поиск координат в списке закрытых нод
- * @param coords координаты
+ * @param key ключ координат
  * @return флаг, содержатся ли координаты в закрытом списке
  */
-bool NodeGridPathFinder::_findCoordsInClosedList(std::vector<int> &coords) {
-    long code = (long) convState(coords, _gridSize);
-    return _closedStateConvCodeSet.find(code) != _closedStateConvCodeSet.end();
+bool NodeGridPathFinder::_findCoordsInClosedList(const GridKey &key) {
+    return _closedNodeIndex.find(key) != _closedNodeIndex.end();
 }
 
 /**
  * поиск координат в списке открытых нод
- * @param coords
+ * @param key ключ координат
  * @return флаг, содержатся ли координаты в открытом списке
  */
-bool NodeGridPathFinder::_findCoordsInOpenedList(std::vector<int> &coords) {
-    for (const PathNodePtr &node: _openSet)
-        if (areStatesEqual(node.ptr->coords, coords))
-            return true;
-    return false;
+bool NodeGridPathFinder::_findCoordsInOpenedList(const GridKey &key) {
+    return _openSet.contains(key);
 }
 
 /**
@@ -52,20 +46,20 @@ void NodeGridPathFinder::buildPath() {
         return;
     }
 
-    if (!_endNode) {
+    if (_endNode == PathNodeArena::NO_NODE) {
         _errorCode = ERROR_CAN_NOT_FIND_PATH;
         return;
     }
 
+    _buildedGridPath.clear();
 
     // move between nodes in reverse order: from end node to start node
-    while (_endNode) {
-        // always insert new node at the begin of list
-        std::vector<double> state = coordsToState(_endNode->coords);
-        _buildedGridPath.insert(_buildedGridPath.begin(), _endNode->coords);
-        _buildedPath.insert(_buildedPath.begin(), state);
-        _endNode = _endNode->parent;
-    }
+    for (unsigned int node = _endNode; node != PathNodeArena::NO_NODE; node = _nodes.at(node).parent)
+        _buildedGridPath.emplace_back(_nodes.getCoords(node));
+
+    std::reverse(_buildedGridPath.begin(), _buildedGridPath.end());
+    for (auto &coords: _buildedGridPath)
+        _buildedPath.emplace_back(coordsToState(coords));
 
 
     _buildedGridPath.insert(_buildedGridPath.begin(), _startCoords);
@@ -83,25 +77,236 @@ void NodeGridPathFinder::buildPath() {
 }
 
 /**
- * вспомогательный метод, возвращающий указатель на новую ноду только,
- * если её можно создать
+ * проверка, можно ли создать соседнюю ноду: координаты не должны быть
+ * обработаны, в открытом множестве не должно быть ноды с такими
+ * координатами и не худшей метрикой, а сами координаты должны быть
+ * доступны. Метод не меняет состояние планировщика, поэтому его
+ * можно вызывать из нескольких потоков одновременно
  * @param newCoords координаты
- * @param parentNode указатель на предка
- * @param sum значение метрики
- * @return указатель на новую ноду
+ * @param newKey ключ координат
+ * @param sum приоритет
+ * @param cost стоимость пути от стартовой ноды
+ * @return флаг, можно ли создать ноду
+ */
+bool NodeGridPathFinder::checkNeighbor(
+        const std::vector<int> &newCoords, const GridKey &newKey, double sum, double cost
+) {
+    return _isNeighborNew(newKey, sum, cost) && checkCoords(newCoords);
+}
+
+/**
+ * проверка соседней ноды по множествам планировщика: координаты не
+ * должны быть обработаны, а в открытом множестве не должно быть ноды
+ * с такими координатами и не худшей метрикой
+ * @param newKey ключ координат
+ * @param sum приоритет
+ * @param cost стоимость пути от стартовой ноды
+ * @return флаг, может ли нода быть создана, если её координаты доступны
+ */
+bool NodeGridPathFinder::_isNeighborNew(const GridKey &newKey, double sum, double /*cost*/) {
+    // если нода уже обработана
+    if (_findCoordsInClosedList(newKey))
+        return false;
+
+    // если нода уже отброшена в ленивом режиме
+    if (_lazyCheck && _disabledKeySet.find(newKey) != _disabledKeySet.end())
+        return false;
+
+    // если нода уже есть в открытом множестве с не худшей метрикой
+    unsigned int openedNode = _openSet.find(newKey);
+    return openedNode == PathNodeArena::NO_NODE || _nodes.at(openedNode).sum > sum;
+}
+
+/**
+ * добавить в пакет соседа текущей ноды
+ * @param currentCoords координаты текущей ноды
+ * @param offset смещение соседа
+ * @param endCoords целевые координаты
  */
-std::shared_ptr<PathNode> NodeGridPathFinder::tryToGetNeighborPtr(
-        std::vector<int> newCoords, const std::shared_ptr<PathNode> &parentNode, double sum
+void NodeGridPathFinder::_addNeighbor(
+        const std::vector<int> &currentCoords, const std::vector<int> &offset, const std::vector<int> &endCoords
 ) {
-    if (checkCoords(newCoords)) {
-        // если нода уже есть
-        if (_findCoordsInClosedList(newCoords) || _findCoordsInOpenedList(newCoords)) {
-            return nullptr;
+    if (_neighborCnt == _neighborCoords.size()) {
+        _neighborCoords.emplace_back(currentCoords.size());
+        _neighborKeys.emplace_back();
+        _neighborHeuristics.emplace_back();
+        _neighborStepCosts.emplace_back();
+        _neighborCosts.emplace_back();
+        _neighborSums.emplace_back();
+        _neighborEnabled.emplace_back();
+    }
+
+    std::vector<int> &newCoords = _neighborCoords[_neighborCnt];
+    bmpf::sumStates(currentCoords, offset, newCoords);
+    _neighborKeys[_neighborCnt] = _keyCoder.encode(newCoords);
+
+    // эвристика и стоимость шага считаются так же, как в `_getPathNodeWeight()` и
+    // `_getStepCost()`, но положения звеньев соседа находятся один раз, а текущей
+    // ноды и цели - берутся из кэша
+    double heuristic = 0;
+    double stepCost = 0;
+    if (_kD != 0) {
+        _cacheLinkPositions(currentCoords, _currentLinkCoords, _currentLinkPositions);
+        _cacheLinkPositions(endCoords, _endLinkCoords, _endLinkPositions);
+        coordsToState(newCoords, _neighborState);
+        std::vector<double> positions = _scene->getAllLinkPositions(_neighborState);
+        heuristic += getAbsDistance(positions, _endLinkPositions) * _kD;
+        stepCost += getAbsDistance(positions, _currentLinkPositions) * _kD;
+    }
+    if (_kG != 0) {
+        double g = 0;
+        double step = 0;
+        for (unsigned int i = 0; i < newCoords.size(); i++) {
+            g += std::abs(newCoords[i] - endCoords[i]);
+            step += std::abs(offset[i]);
         }
-        return std::make_shared<PathNode>(newCoords, parentNode, sum);
-    } else {
-        return nullptr;
+        heuristic += g * _kG;
+        stepCost += step * _kG;
     }
+    _neighborHeuristics[_neighborCnt] = heuristic;
+    _neighborStepCosts[_neighborCnt] = stepCost;
+    _neighborCnt++;
+}
+
+/**
+ * @brief проверить пакет соседей и добавить подходящих в открытое множество
+ * Сначала соседи отбираются по множествам планировщика и границам сетки,
+ * потом все оставшиеся проверяются на коллизии одним обращением к
+ * коллайдеру. В ленивом режиме проверка на коллизии откладывается до
+ * извлечения ноды из открытого множества. Ноды создаются в порядке
+ * добавления соседей в пакет
+ * @param currentNode индекс текущей ноды
+ * @param endKey ключ целевых координат
+ * @param maxOpenSetSize максимальный размер открытого множества
+ * @return индекс ноды с целевыми координатами, если поиск жадный и она
+ * порождена, иначе PathNodeArena::NO_NODE
+ */
+unsigned int NodeGridPathFinder::_acceptNeighbors(
+        unsigned int currentNode, const GridKey &endKey, unsigned int maxOpenSetSize
+) {
+    // стоимости путей до соседей и их приоритеты
+    const double parentCost = _nodes.at(currentNode).cost;
+    std::vector<double> &costs = _neighborCosts;
+    std::vector<double> &sums = _neighborSums;
+    for (unsigned long i = 0; i < _neighborCnt; i++) {
+        costs[i] = parentCost + _neighborStepCosts[i];
+        sums[i] = _getPriority(costs[i], _neighborHeuristics[i]);
+    }
+
+    // жадный поиск заканчивается, как только порождена нода с целевыми
+    // координатами, она возвращается после того, как открыты все остальные
+    // соседи пакета; при конечном весе эвристики цель открывается как
+    // обычная нода, и поиск заканчивается, когда она извлечена из
+    // открытого множества (см. `findTick()`)
+    const bool greedy = _heuristicWeight == std::numeric_limits<double>::infinity();
+    unsigned int endNode = PathNodeArena::NO_NODE;
+
+    if (_lazyCheck) {
+        for (unsigned long i = 0; i < _neighborCnt; i++) {
+            if (!_isNeighborNew(_neighborKeys[i], sums[i], costs[i]) || !isCoordsInGrid(_neighborCoords[i]))
+                continue;
+
+            // целевые координаты уже проверены при подготовке к планированию
+            if (_neighborKeys[i] == endKey) {
+                unsigned int newNode = _nodes.add(_neighborCoords[i], _neighborKeys[i], currentNode, sums[i], costs[i]);
+                if (greedy)
+                    endNode = newNode;
+                else {
+                    _openNode(newNode);
+                    _openSet.truncate(maxOpenSetSize);
+                }
+                continue;
+            }
+
+            _openNode(_nodes.add(_neighborCoords[i], _neighborKeys[i], currentNode, sums[i], costs[i], false));
+            _openSet.truncate(maxOpenSetSize);
+        }
+        return endNode;
+    }
+
+    // флаги доступности соседей, номера соседей, которых нужно
+    // проверить на коллизии, и их состояния
+    std::vector<char> &enabled = _neighborEnabled;
+    std::vector<unsigned long> &candidates = _candidateNeighbors;
+    std::vector<double> &states = _candidateStates;
+    std::fill(enabled.begin(), enabled.begin() + _neighborCnt, false);
+    candidates.clear();
+    states.clear();
+    for (unsigned long i = 0; i < _neighborCnt; i++) {
+        if (!_isNeighborNew(_neighborKeys[i], sums[i], costs[i]) || !isCoordsInGrid(_neighborCoords[i]))
+            continue;
+
+        bool savedEnabled;
+        if (_findCheckResult(_neighborCoords[i], savedEnabled)) {
+            enabled[i] = savedEnabled;
+            continue;
+        }
+
+        coordsToState(_neighborCoords[i], _neighborState);
+        states.insert(states.end(), _neighborState.begin(), _neighborState.end());
+        candidates.push_back(i);
+    }
+
+    if (!candidates.empty()) {
+        // соседи отличаются от текущей ноды небольшим числом координат,
+        // поэтому их кинематика считается инкрементально от кинематики текущей ноды
+        _scene->fillFKCache(coordsToState(_nodes.getCoords(currentNode)), _fkCache);
+        std::vector<bool> checked = checkStates(states, candidates.size(), &_fkCache);
+        for (unsigned long j = 0; j < candidates.size(); j++) {
+            enabled[candidates[j]] = checked[j];
+            _saveCheckResult(_neighborCoords[candidates[j]], checked[j]);
+        }
+    }
+
+    for (unsigned long i = 0; i < _neighborCnt; i++) {
+        if (!enabled[i])
+            continue;
+
+        unsigned int newNode = _nodes.add(_neighborCoords[i], _neighborKeys[i], currentNode, sums[i], costs[i]);
+        if (greedy && _neighborKeys[i] == endKey) {
+            endNode = newNode;
+            continue;
+        }
+
+        _openNode(newNode);
+        _openSet.truncate(maxOpenSetSize);
+    }
+    return endNode;
+}
+
+/**
+ * вспомогательный метод, создающий новую ноду только,
+ * если её можно создать; стоимость ноды считается
+ * по стоимости предка
+ * @param newCoords координаты
+ * @param newKey ключ координат
+ * @param parentNode индекс предка
+ * @param sum приоритет
+ * @return индекс новой ноды или PathNodeArena::NO_NODE
+ */
+unsigned int NodeGridPathFinder::tryToGetNeighbor(
+        const std::vector<int> &newCoords, const GridKey &newKey, unsigned int parentNode, double sum
+) {
+    double cost = _nodes.at(parentNode).cost + _getStepCost(_nodes.getCoords(parentNode), newCoords);
+    if (!checkNeighbor(newCoords, newKey, sum, cost))
+        return PathNodeArena::NO_NODE;
+
+    return _nodes.add(newCoords, newKey, parentNode, sum, cost);
+}
+
+/**
+ * проверка доступности координат с использованием сохранённых результатов проверок
+ * @param coords координаты
+ * @return флаг, доступны ли координаты
+ */
+bool NodeGridPathFinder::_checkCoordsWithResults(const std::vector<int> &coords) {
+    bool enabled;
+    if (_findCheckResult(coords, enabled))
+        return enabled;
+
+    enabled = checkCoords(coords);
+    _saveCheckResult(coords, enabled);
+    return enabled;
 }
 
 /**
@@ -114,8 +319,8 @@ std::vector<double> NodeGridPathFinder::getCurrentState() {
         // возвращаем состояние, соответствующее целевым координатам
         return coordsToState(_endCoords);
 
-    std::shared_ptr<PathNode> currentNode = _openSet.begin()->ptr;
-    return coordsToState(currentNode->coords);
+    std::vector<int> coords = _nodes.getCoords(_openSet.top());
+    return coordsToState(coords);
 }
 
 /**
@@ -130,37 +335,52 @@ bool NodeGridPathFinder::findTick(std::vector<double> &state) {
         return true;
     }
 
-    std::shared_ptr<PathNode> currentNode = _openSet.begin()->ptr;
+    unsigned int currentNode = _openSet.top();
 
-    if (areStatesEqual(currentNode->coords, _endCoords)) {
+    // при конечном весе эвристики путь до цели найден, только
+    // когда нода цели извлечена из открытого множества
+    if (_nodes.getKey(currentNode) == _endKey) {
+        _moveNodeFromOpenedToClosed(currentNode);
+        _endNode = currentNode;
         _errorCode = NO_ERROR;
         return true;
     }
-    state = coordsToState(currentNode->coords);
-
-    if (!checkCoords(currentNode->coords)) {
+    std::vector<int> currentCoords = _nodes.getCoords(currentNode);
+    state = coordsToState(currentCoords);
+
+    if (!_nodes.at(currentNode).checked) {
+        // ленивый режим: нода проверяется только сейчас, недоступная
+        // нода отбрасывается, и поиск продолжается со следующей
+        _lazyCheckCnt++;
+        if (!_checkCoordsWithResults(currentCoords)) {
+            _disabledKeySet.insert(_nodes.getKey(currentNode));
+            _openSet.erase(_nodes.getKey(currentNode));
+            return false;
+        }
+        _nodes.setChecked(currentNode);
+    } else if (!_checkCoordsWithResults(currentCoords)) {
         throw std::runtime_error("NodeGridPathFinder::findTick() ERROR: coords are disabled");
     }
 
     _moveNodeFromOpenedToClosed(currentNode);
-    std::vector<int> deltaCoords = subtractStates(_endCoords, currentNode->coords);
+    std::vector<int> deltaCoords = subtractStates(_endCoords, currentCoords);
 
-    if (_closedStateConvCodeSet.size() > _maxNodeCnt) {
+    if (_closedNodeIndex.size() > _maxNodeCnt) {
         errMsg("closedSet is full");
         _errorCode = ERROR_REACHED_MAX_NODE_CNT;
         return true;
     }
     if (_showTrace) {
-        bmpf::infoMsg(currentNode->toString(),
+        bmpf::infoMsg(_nodes.at(currentNode).toString(),
                       " openSet:", _openSet.size(),
-                      " closedSet: ", _closedStateConvCodeSet.size());
+                      " closedSet: ", _closedNodeIndex.size());
         bmpf::infoState("delta node", deltaCoords);
-        bmpf::infoState("actual state", coordsToState(currentNode->coords));
+        bmpf::infoState("actual state", coordsToState(currentCoords));
     }
 
-    auto endNode = _forEachNeighbor(currentNode, _endCoords);
+    unsigned int endNode = _forEachNeighbor(currentNode, _endCoords);
 
-    if (endNode) {
+    if (endNode != PathNodeArena::NO_NODE) {
         _endNode = endNode;
         return true;
     }
@@ -174,12 +394,30 @@ bool NodeGridPathFinder::findTick(std::vector<double> &state) {
  */
 std::vector<std::vector<double>> NodeGridPathFinder::getAllProcessedStates() {
     std::vector<std::vector<double>> findingPoses;
-    for (auto &node: _closedNodes)
-        findingPoses.emplace_back(coordsToState(node->coords));
+    for (unsigned int node: _closedNodes) {
+        std::vector<int> coords = _nodes.getCoords(node);
+        findingPoses.emplace_back(coordsToState(coords));
+    }
 
     return findingPoses;
 }
 
+/**
+ * получить количество проверок на коллизии, которых ленивый режим
+ * избежал: ноды были порождены и к концу поиска так и остались
+ * в открытом множестве непроверенными
+ * @return количество сэкономленных проверок
+ */
+unsigned long NodeGridPathFinder::getSavedCheckCnt() const {
+    // в открытом множестве у каждых координат не больше одной ноды,
+    // поэтому замещённые ноды с теми же координатами не учитываются
+    unsigned long savedCheckCnt = 0;
+    for (unsigned int node: _openSet.getNodes())
+        if (!_nodes.at(node).checked)
+            savedCheckCnt++;
+    return savedCheckCnt;
+}
+
 /**
  * подготовка к планированию
  * @param startState начальное состояние
@@ -190,24 +428,30 @@ void NodeGridPathFinder::prepare(
 ) {
     GridPathFinder::prepare(startState, endState);
 
-    _endNode = nullptr;
+    _endNode = PathNodeArena::NO_NODE;
+    _lazyCheckCnt = 0;
 
     if (_errorCode != NO_ERROR) {
         return;
     }
 
-    _closedStateConvCodeSet.clear();
+    _closedNodeIndex.clear();
     _closedNodes.clear();
     _openSet.clear();
+    _disabledKeySet.clear();
+    // сцена могла измениться между поисками
+    _currentLinkCoords.clear();
+    _endLinkCoords.clear();
 
     _startState = startState;
     _endState = endState;
 
-    std::shared_ptr<PathNode> pathNodePtr = std::make_shared<PathNode>(
-            _startCoords, std::shared_ptr<PathNode>(),
-            _getPathNodeWeight(_startCoords, _endCoords)
-    );
-    _openSet.insert(PathNodePtr(pathNodePtr));
+    _endKey = _keyCoder.encode(_endCoords);
+    _nodes.reset(_startCoords.size());
+    _openNode(_nodes.add(
+            _startCoords, _keyCoder.encode(_startCoords), PathNodeArena::NO_NODE,
+            _getPriority(0, _getPathNodeWeight(_startCoords, _endCoords))
+    ));
 }
 
 /**
@@ -218,30 +462,36 @@ void NodeGridPathFinder::prepare(
 void NodeGridPathFinder::prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) {
     GridPathFinder::prepare(startCoords, endCoords);
 
-    _endNode = nullptr;
+    _endNode = PathNodeArena::NO_NODE;
+    _lazyCheckCnt = 0;
 
     if (_errorCode != NO_ERROR) {
         return;
     }
 
-    _closedStateConvCodeSet.clear();
+    _closedNodeIndex.clear();
     _closedNodes.clear();
     _openSet.clear();
-
-    std::shared_ptr<PathNode> pathNodePtr = std::make_shared<PathNode>(
-            _startCoords, std::shared_ptr<PathNode>(),
-            _getPathNodeWeight(_startCoords, _endCoords)
-    );
-    _openSet.insert(PathNodePtr(pathNodePtr));
+    _disabledKeySet.clear();
+    // сцена могла измениться между поисками
+    _currentLinkCoords.clear();
+    _endLinkCoords.clear();
+
+    _endKey = _keyCoder.encode(_endCoords);
+    _nodes.reset(_startCoords.size());
+    _openNode(_nodes.add(
+            _startCoords, _keyCoder.encode(_startCoords), PathNodeArena::NO_NODE,
+            _getPriority(0, _getPathNodeWeight(_startCoords, _endCoords))
+    ));
 }
 
 /**
- * Получить метрику ноды
+ * Получить эвристику ноды (оценку стоимости пути до цели)
  * @param curCoords текущие координаты
  * @param endCoords целевые координаты
- * @return метрика ноды
+ * @return эвристика ноды
  */
-double NodeGridPathFinder::_getPathNodeWeight(std::vector<int> curCoords, std::vector<int> &endCoords) {
+double NodeGridPathFinder::_getPathNodeWeight(const std::vector<int> &curCoords, const std::vector<int> &endCoords) {
     double sum = 0;
     if (_kD != 0) {
         sum += _findLinkDistance(curCoords, endCoords) * _kD;
@@ -259,13 +509,39 @@ double NodeGridPathFinder::_getPathNodeWeight(std::vector<int> curCoords, std::v
     return sum;
 }
 
+/**
+ * получить стоимость перехода между координатами
+ * (в той же метрике, что и эвристика)
+ * @param a координаты первой точки
+ * @param b координаты второй точки
+ * @return стоимость перехода
+ */
+double NodeGridPathFinder::_getStepCost(const std::vector<int> &a, const std::vector<int> &b) {
+    return _getPathNodeWeight(a, b);
+}
+
+/**
+ * обновить кэш положений звеньев, если он посчитан для других координат
+ * @param coords координаты
+ * @param cachedCoords координаты, для которых посчитан кэш
+ * @param positions кэш положений звеньев
+ */
+void NodeGridPathFinder::_cacheLinkPositions(
+        const std::vector<int> &coords, std::vector<int> &cachedCoords, std::vector<double> &positions
+) {
+    if (cachedCoords == coords)
+        return;
+    cachedCoords = coords;
+    positions = _scene->getAllLinkPositions(coordsToState(coords));
+}
+
 /**
  * получить расстояние между звеньями (по координатам планировщика)
  * @param a координаты первой точки
  * @param b координаты второй точки
  * @return
  */
-double NodeGridPathFinder::_findLinkDistance(std::vector<int> &a, std::vector<int> &b) {
+double NodeGridPathFinder::_findLinkDistance(const std::vector<int> &a, const std::vector<int> &b) {
     if (a.size() != b.size()) {
         char buf[1024];
         sprintf(buf,
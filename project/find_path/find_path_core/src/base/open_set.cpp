@@ -0,0 +1,191 @@
+#include "base/open_set.h"
+
+#include <algorithm>
+
+using namespace bmpf;
+
+/**
+ * сравнение элементов кучи
+ * @param a первый элемент
+ * @param b второй элемент
+ * @return флаг, должен ли первый элемент быть извлечён раньше второго
+ */
+bool OpenSet::_isBetter(const Entry &a, const Entry &b) {
+    if (a.sum != b.sum)
+        return a.sum < b.sum;
+    if (a.order != b.order)
+        return a.order > b.order;
+    return a.serial < b.serial;
+}
+
+/**
+ * поменять местами элементы кучи, обновив индекс
+ * @param i позиция первого элемента
+ * @param j позиция второго элемента
+ */
+void OpenSet::_swap(std::size_t i, std::size_t j) {
+    std::swap(_heap[i], _heap[j]);
+    _heap[i].item->second = i;
+    _heap[j].item->second = j;
+}
+
+/**
+ * поднять элемент кучи к вершине
+ * @param pos позиция элемента
+ */
+void OpenSet::_siftUp(std::size_t pos) {
+    while (pos > 0) {
+        std::size_t parent = (pos - 1) / 2;
+        if (!_isBetter(_heap[pos], _heap[parent]))
+            return;
+        _swap(pos, parent);
+        pos = parent;
+    }
+}
+
+/**
+ * опустить элемент кучи к листьям
+ * @param pos позиция элемента
+ */
+void OpenSet::_siftDown(std::size_t pos) {
+    const std::size_t size = _heap.size();
+    while (true) {
+        std::size_t best = pos;
+        std::size_t left = 2 * pos + 1;
+        std::size_t right = left + 1;
+        if (left < size && _isBetter(_heap[left], _heap[best]))
+            best = left;
+        if (right < size && _isBetter(_heap[right], _heap[best]))
+            best = right;
+        if (best == pos)
+            return;
+        _swap(pos, best);
+        pos = best;
+    }
+}
+
+/**
+ * удалить элемент кучи
+ * @param pos позиция элемента
+ */
+void OpenSet::_removeAt(std::size_t pos) {
+    _index.erase(_index.find(_heap[pos].item->first));
+
+    std::size_t last = _heap.size() - 1;
+    if (pos != last) {
+        _heap[pos] = _heap[last];
+        _heap[pos].item->second = pos;
+    }
+    _heap.pop_back();
+
+    if (pos < _heap.size()) {
+        _siftUp(pos);
+        _siftDown(pos);
+    }
+}
+
+/**
+ * добавить ноду в открытое множество; если нода с такими
+ * координатами уже есть, то она заменяется новой
+ * (если метрика новой ноды меньше)
+ * @param node индекс ноды в хранилище
+ * @return флаг, изменилось ли открытое множество
+ */
+bool OpenSet::push(unsigned int node) {
+    const PathNode &pathNode = _nodes.at(node);
+
+    auto res = _index.emplace(_nodes.getKey(node), _heap.size());
+    if (!res.second) {
+        std::size_t pos = res.first->second;
+        if (_heap[pos].sum <= pathNode.sum)
+            return false;
+        // уменьшение ключа: заменяем ноду и поднимаем её к вершине
+        _heap[pos].sum = pathNode.sum;
+        _heap[pos].order = pathNode.order;
+        _heap[pos].node = node;
+        _siftUp(pos);
+        return true;
+    }
+
+    _heap.push_back({pathNode.sum, pathNode.order, node, _serial++, &*res.first});
+    _siftUp(_heap.size() - 1);
+    return true;
+}
+
+/**
+ * удалить лучшую ноду
+ */
+void OpenSet::pop() {
+    if (!_heap.empty())
+        _removeAt(0);
+}
+
+/**
+ * удалить ноду по ключу координат
+ * @param key ключ координат
+ * @return флаг, была ли удалена нода
+ */
+bool OpenSet::erase(const GridKey &key) {
+    auto it = _index.find(key);
+    if (it == _index.end())
+        return false;
+    _removeAt(it->second);
+    return true;
+}
+
+/**
+ * найти ноду по ключу координат
+ * @param key ключ координат
+ * @return индекс ноды в хранилище или PathNodeArena::NO_NODE,
+ * если нод с такими координатами нет
+ */
+unsigned int OpenSet::find(const GridKey &key) const {
+    auto it = _index.find(key);
+    if (it == _index.end())
+        return PathNodeArena::NO_NODE;
+    return _heap[it->second].node;
+}
+
+/**
+ * @brief ограничить размер открытого множества
+ * Если размер превышает maxSize больше, чем на восьмую часть,
+ * из множества удаляются худшие ноды, пока размер не станет равным maxSize.
+ * Запас нужен, чтобы не перестраивать кучу при каждом добавлении
+ * @param maxSize максимальный размер открытого множества, 0 - без ограничений
+ */
+void OpenSet::truncate(unsigned int maxSize) {
+    if (maxSize == 0 || _heap.size() <= maxSize + std::max(1u, maxSize / 8))
+        return;
+
+    // оставляем в начале массива maxSize лучших нод
+    std::nth_element(_heap.begin(), _heap.begin() + maxSize, _heap.end(), _isBetter);
+    for (std::size_t i = maxSize; i < _heap.size(); i++)
+        _index.erase(_index.find(_heap[i].item->first));
+    _heap.resize(maxSize);
+
+    // восстанавливаем кучу и индекс
+    std::make_heap(_heap.begin(), _heap.end(), [](const Entry &a, const Entry &b) { return _isBetter(b, a); });
+    for (std::size_t i = 0; i < _heap.size(); i++)
+        _heap[i].item->second = i;
+}
+
+/**
+ * получить индексы всех нод открытого множества (в порядке кучи)
+ * @return индексы нод в хранилище
+ */
+std::vector<unsigned int> OpenSet::getNodes() const {
+    std::vector<unsigned int> nodes;
+    nodes.reserve(_heap.size());
+    for (const Entry &entry: _heap)
+        nodes.push_back(entry.node);
+    return nodes;
+}
+
+/**
+ * очистить открытое множество
+ */
+void OpenSet::clear() {
+    _heap.clear();
+    _index.clear();
+    _serial = 0;
+}
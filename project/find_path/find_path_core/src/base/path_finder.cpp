@@ -1,8 +1,16 @@
 #include "base/path_finder.h"
 
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+
 
 using namespace bmpf;
 
+const int PathFinder::ERROR_REACHED_MAX_NODE_CNT;
+
 /**
  * конструктор
  * @param scene сцена
@@ -33,11 +41,14 @@ PathFinder::PathFinder(const std::shared_ptr<bmpf::Scene> &scene, bool showTrace
 
     _calculationTimeInSeconds = -1;
     _errorCode = NO_ERROR;
+    _cancelFlag = std::make_shared<std::atomic<bool>>(false);
 }
 
 
 /**
- * Поиск пути
+ * @brief Поиск пути
+ * между тактами поиска проверяется флаг отмены, если он выставлен,
+ * поиск прерывается с кодом ошибки ERROR_CANCELLED
  * @param startState стартовое состояние
  * @param endState конечное состояние
  * @param errorCode в эту переменную записывается код ошибки
@@ -48,6 +59,7 @@ PathFinder::findPath(const std::vector<double> &startState, const std::vector<do
 
     _startState = startState;
     _endState = endState;
+    _errorCode = NO_ERROR;
 
     _startTime = std::chrono::high_resolution_clock::now();
 
@@ -61,14 +73,28 @@ PathFinder::findPath(const std::vector<double> &startState, const std::vector<do
     std::vector<double> actualState;
 
     // если очередной такт поиска пути не последний
-    while (!findTick(actualState)) {};
+    while (!findTick(actualState)) {
+        if (isCancelled()) {
+            _errorCode = ERROR_CANCELLED;
+            break;
+        }
+    }
 
-    if (_errorCode != NO_ERROR)
+    if (_errorCode != NO_ERROR) {
+        errorCode = _errorCode;
         return {};
+    }
 
     // строим путь
     buildPath();
 
+    // сборка пути тоже может прерваться (например, при отмене
+    // вложенных поисков), тогда путь не возвращается
+    if (_errorCode != NO_ERROR) {
+        errorCode = _errorCode;
+        return {};
+    }
+
     auto endTime = std::chrono::high_resolution_clock::now();
     _calculationTimeInSeconds =
             (double) std::chrono::duration_cast<std::chrono::milliseconds>(endTime - _startTime).count() / 1000;
@@ -78,6 +104,36 @@ PathFinder::findPath(const std::vector<double> &startState, const std::vector<do
     return _buildedPath;
 }
 
+/**
+ * @brief Поиск пути к целевым положениям рабочих инструментов
+ * конечное состояние находится решателем обратной кинематики (см. `IKSolver`),
+ * который при первом вызове стартует со стартового состояния, а при
+ * следующих - с предыдущего найденного решения
+ * @param startState стартовое состояние
+ * @param endPoses целевые матрицы преобразования рабочих инструментов
+ * (по одной на каждого робота с сочленениями)
+ * @param errorCode в эту переменную записывается код ошибки
+ * @return построенный путь
+ */
+std::vector<std::vector<double>> PathFinder::findPathToPoses(
+        const std::vector<double> &startState, const std::vector<Eigen::Matrix4d> &endPoses, int &errorCode
+) {
+    if (!_ikSolver)
+        _ikSolver = std::make_shared<IKSolver>(_scene, _collider, (unsigned int) std::max(_threadCnt, 1));
+
+    int ikErrorCode = IKSolver::NO_ERROR;
+    std::vector<double> endState = _ikSolver->getLastSolution().empty() ?
+                                   _ikSolver->solve(endPoses, startState, ikErrorCode) :
+                                   _ikSolver->solve(endPoses, ikErrorCode);
+    if (ikErrorCode != IKSolver::NO_ERROR) {
+        _errorCode = ERROR_CAN_NOT_SOLVE_IK;
+        errorCode = _errorCode;
+        return {};
+    }
+
+    return findPath(startState, endState, errorCode);
+}
+
 /**
  * добавить объект на сцену
  * @param path путь к файлу с описанием
@@ -85,6 +141,9 @@ PathFinder::findPath(const std::vector<double> &startState, const std::vector<do
 void PathFinder::addObjectToScene(std::string path) {
     _scene->addObject(std::move(path));
     _collider->init(_scene->getGroupedModelPaths(), false);
+    // коллайдер сбрасывает матрицу при инициализации
+    if (_useAllowedCollisions)
+        initAllowedCollisions(_allowedCollisionSampleCnt);
 }
 
 /**
@@ -94,6 +153,9 @@ void PathFinder::addObjectToScene(std::string path) {
 void PathFinder::deleteObjectFromScene(long robotNum) {
     _scene->deleteRobot(robotNum);
     _collider->init(_scene->getGroupedModelPaths(), false);
+    // коллайдер сбрасывает матрицу при инициализации
+    if (_useAllowedCollisions)
+        initAllowedCollisions(_allowedCollisionSampleCnt);
 }
 
 /**
@@ -108,11 +170,258 @@ bool PathFinder::checkState(const std::vector<double> &state) {
     return !_collider->isCollided(_scene->getTransformMatrices(state));
 }
 
+/**
+ * @brief пакетная проверка доступности состояний
+ * Проверяет доступность углов каждого состояния, после проверяет
+ * все состояния с допустимыми углами на коллизии одним
+ * обращением к коллайдеру
+ * @param states состояния, записанные подряд в один буфер
+ * @param stateCnt количество состояний
+ * @param fkCache кэш кинематики базового состояния (например, текущей ноды),
+ * если задан, то кинематика состояний считается инкрементально относительно него
+ * @return битовая маска: i-й элемент равен true, если
+ * i-е состояние допустимо
+ */
+std::vector<bool> PathFinder::checkStates(
+        const std::vector<double> &states, unsigned long stateCnt, const FKCache *fkCache
+) {
+    unsigned long jointCnt = _scene->getJointCnt();
+    if (states.size() != stateCnt * jointCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "PathFinder::checkStates() ERROR: \n states size is %zu, but stateCnt is %lu"
+                " and joint count is %lu\nstates size must be equal to their product",
+                states.size(), stateCnt, jointCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    std::vector<bool> enabled(stateCnt, false);
+
+    // индексы состояний с допустимыми углами
+    std::vector<unsigned long> checkedIndexes;
+    std::vector<double> state(jointCnt);
+    for (unsigned long i = 0; i < stateCnt; i++) {
+        std::copy(states.begin() + i * jointCnt, states.begin() + (i + 1) * jointCnt, state.begin());
+        if (_scene->isStateEnabled(state))
+            checkedIndexes.push_back(i);
+    }
+
+    if (checkedIndexes.empty())
+        return enabled;
+
+    // матрицы преобразований этих состояний, записанные подряд
+    unsigned long linkCnt = _scene->getLinkCnt();
+    std::vector<Eigen::Matrix4d> matrices(checkedIndexes.size() * linkCnt);
+    if (fkCache) {
+        for (unsigned long j = 0; j < checkedIndexes.size(); j++) {
+            unsigned long i = checkedIndexes[j];
+            std::copy(states.begin() + i * jointCnt, states.begin() + (i + 1) * jointCnt, state.begin());
+            _scene->fillTransformMatrices(state, matrices.data() + j * linkCnt, *fkCache);
+        }
+    } else {
+        // пакетная кинематика принимает состояния, разложенные по координатам
+        std::vector<double> batchStates(checkedIndexes.size() * jointCnt);
+        for (unsigned long j = 0; j < checkedIndexes.size(); j++)
+            for (unsigned long k = 0; k < jointCnt; k++)
+                batchStates[k * checkedIndexes.size() + j] = states[checkedIndexes[j] * jointCnt + k];
+        _scene->fillBatchTransformMatrices(batchStates, checkedIndexes.size(), matrices.data());
+    }
+
+    std::vector<bool> collided = _collider->areCollided(matrices, checkedIndexes.size());
+    for (unsigned long i = 0; i < checkedIndexes.size(); i++)
+        enabled[checkedIndexes[i]] = !collided[i];
+
+    return enabled;
+}
+
 /**
  * обновить коллайдер по сцене
  */
 void PathFinder::updateCollider() {
     _collider->init(_scene->getGroupedModelPaths(), false);
+    // коллайдер сбрасывает матрицу при инициализации
+    if (_useAllowedCollisions)
+        initAllowedCollisions(_allowedCollisionSampleCnt);
+}
+
+/**
+ * @brief построить матрицу разрешённых столкновений
+ * построить матрицу разрешённых столкновений: разрешаются все пары звеньев
+ * статических объектов (без сочленений), а также пары звеньев одного
+ * робота с сочленениями, которые ни разу не пересеклись в sampleCnt
+ * случайных состояниях сцены. Пары звеньев разных объектов, хотя бы один
+ * из которых - робот с сочленениями, проверяются всегда: препятствие,
+ * до которого робот дотягивается лишь из малой области пространства
+ * конфигураций, легко пропустить при случайной выборке. Случайные состояния
+ * генерируются с фиксированным зерном ACM_SEED, поэтому матрица
+ * воспроизводима
+ * @param sampleCnt количество случайных состояний
+ * @return матрица разрешённых столкновений
+ */
+AllowedCollisionMatrix PathFinder::buildAllowedCollisionMatrix(unsigned long sampleCnt) {
+    // номер объекта и флаг, есть ли у объекта сочленения, для каждого звена
+    std::vector<unsigned long> linkObjects;
+    std::vector<bool> isLinkJointed;
+    const std::vector<std::shared_ptr<bmpf::BaseRobot>> &objects = _scene->getRobots();
+    for (unsigned long i = 0; i < objects.size(); i++)
+        for (unsigned long j = 0; j < objects.at(i)->getLinkCnt(); j++) {
+            linkObjects.emplace_back(i);
+            isLinkJointed.emplace_back(objects.at(i)->getJointCnt() != 0);
+        }
+    unsigned long linkCnt = linkObjects.size();
+
+    // флаги пар, пересёкшихся хотя бы в одном состоянии
+    std::vector<char> collided(linkCnt * linkCnt, 0);
+    std::mt19937 generator(ACM_SEED);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::vector<std::shared_ptr<bmpf::JointParams>> jointParamsList = _scene->getJointParamsList();
+    std::vector<double> state(jointParamsList.size());
+    for (unsigned long i = 0; i < sampleCnt; i++) {
+        do {
+            for (unsigned long j = 0; j < jointParamsList.size(); j++)
+                state[j] = jointParamsList[j]->minAngle +
+                           distribution(generator) * (jointParamsList[j]->maxAngle - jointParamsList[j]->minAngle);
+        } while (!_scene->isStateEnabled(state));
+
+        for (auto &pair: _collider->getCollidedPairs(_scene->getTransformMatrices(state)))
+            collided[pair.first * linkCnt + pair.second] = 1;
+    }
+
+    AllowedCollisionMatrix allowedCollisions(linkCnt);
+    for (unsigned long i = 0; i < linkCnt; i++)
+        for (unsigned long j = i + 1; j < linkCnt; j++) {
+            bool bothStatic = !isLinkJointed[i] && !isLinkJointed[j];
+            bool sameRobot = isLinkJointed[i] && linkObjects[i] == linkObjects[j];
+            if (bothStatic || (sameRobot && sampleCnt > 0 && !collided[i * linkCnt + j]))
+                allowedCollisions.allow(i, j);
+        }
+
+    return allowedCollisions;
+}
+
+/**
+ * @brief инициализировать матрицу разрешённых столкновений
+ * инициализировать матрицу разрешённых столкновений и передать её
+ * коллайдеру. Матрица загружается из файла рядом с описанием сцены
+ * (см. `getAllowedCollisionsPath`), если он построен для той же сцены
+ * и не меньшего числа состояний, иначе матрица строится заново
+ * и сохраняется в этот файл. Построенные матрицы кешируются
+ * в памяти процесса. Матрица не строится по умолчанию: после вызова этого
+ * метода она перестраивается при каждом изменении сцены
+ * @param sampleCnt количество случайных состояний
+ */
+void PathFinder::initAllowedCollisions(unsigned long sampleCnt) {
+    _useAllowedCollisions = true;
+    _allowedCollisionSampleCnt = sampleCnt;
+
+    // кеш матриц процесса, ключ - описание сцены
+    static std::mutex cacheMutex;
+    static std::map<std::string, AllowedCollisionMatrix> cache;
+
+    // описание сцены, по которому проверяется, подходит ли сохранённая матрица
+    Json::Value models;
+    for (auto &objectModelPaths: _scene->getGroupedModelPaths()) {
+        Json::Value objectModels(Json::arrayValue);
+        for (auto &modelPath: objectModelPaths)
+            objectModels.append(modelPath);
+        models.append(objectModels);
+    }
+    Json::Value transforms;
+    for (auto &transformVector: _scene->getGroupedTransformVector()) {
+        Json::Value transform(Json::arrayValue);
+        for (double val: transformVector)
+            transform.append(val);
+        transforms.append(transform);
+    }
+    std::string key = models.toStyledString() + transforms.toStyledString() + std::to_string(sampleCnt) + "/" +
+                      std::to_string(ACM_SEED);
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            _allowedCollisions = it->second;
+            _collider->setAllowedCollisionMatrix(_allowedCollisions);
+            return;
+        }
+    }
+
+    std::string acmPath;
+    if (!_scene->getScenePath().empty())
+        acmPath = getAllowedCollisionsPath(_scene->getScenePath());
+
+    bool loaded = false;
+    if (!acmPath.empty()) {
+        std::ifstream ifs(acmPath, std::ios_base::binary);
+        std::string content((std::istreambuf_iterator<char>(ifs)),
+                            (std::istreambuf_iterator<char>()));
+
+        Json::Reader reader;
+        Json::Value obj;
+        if (!content.empty() && reader.parse(content, obj) &&
+            obj["models"] == models && obj["transforms"] == transforms &&
+            obj["sampleCnt"].asUInt64() >= sampleCnt && obj["seed"].asUInt() == ACM_SEED) {
+            unsigned long linkCnt = 0;
+            for (auto &objectModelPaths: _scene->getGroupedModelPaths())
+                linkCnt += objectModelPaths.size();
+
+            _allowedCollisions = AllowedCollisionMatrix(linkCnt);
+            for (const Json::Value &pair: obj["allowed"])
+                _allowedCollisions.allow(pair[0].asUInt64(), pair[1].asUInt64());
+            loaded = true;
+        }
+    }
+
+    if (!loaded) {
+        _allowedCollisions = buildAllowedCollisionMatrix(sampleCnt);
+
+        if (!acmPath.empty()) {
+            Json::Value json;
+            json["models"] = models;
+            json["transforms"] = transforms;
+            json["sampleCnt"] = Json::UInt64(sampleCnt);
+            json["seed"] = Json::UInt(ACM_SEED);
+            Json::Value allowed(Json::arrayValue);
+            for (auto &pair: _allowedCollisions.getAllowedPairs()) {
+                Json::Value jsonPair;
+                jsonPair.append(Json::UInt64(pair.first));
+                jsonPair.append(Json::UInt64(pair.second));
+                allowed.append(jsonPair);
+            }
+            json["allowed"] = allowed;
+
+            std::ofstream ofs(acmPath, std::ios::out | std::ios::binary);
+            if (ofs)
+                ofs << json.toStyledString();
+            else
+                errMsg("PathFinder::initAllowedCollisions() can not save allowed collisions to ", acmPath);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache[key] = _allowedCollisions;
+    }
+
+    if (_showTrace)
+        infoMsg("allowed collision pairs: ", _allowedCollisions.getAllowedPairs().size());
+
+    _collider->setAllowedCollisionMatrix(_allowedCollisions);
+}
+
+/**
+ * получить путь к файлу матрицы разрешённых столкновений сцены:
+ * расширение ".json" заменяется на ".acm.json"
+ * @param scenePath путь к описанию сцены
+ * @return путь к файлу матрицы разрешённых столкновений
+ */
+std::string PathFinder::getAllowedCollisionsPath(const std::string &scenePath) {
+    const std::string extension = ".json";
+    if (scenePath.size() >= extension.size() &&
+        scenePath.compare(scenePath.size() - extension.size(), extension.size(), extension) == 0)
+        return scenePath.substr(0, scenePath.size() - extension.size()) + ".acm.json";
+    return scenePath + ".acm.json";
 }
 
 /**
@@ -124,19 +433,38 @@ void PathFinder::updateCollider() {
  */
 bool PathFinder::divideCheckPathSegment(
         const std::vector<double> &prevPoint, std::vector<double> nextPoint, int checkCnt
+) {
+    std::vector<double> states;
+    divideSegment(prevPoint, nextPoint, checkCnt, states);
+
+    std::vector<bool> enabled = checkStates(states, states.size() / _scene->getJointCnt());
+    return std::find(enabled.begin(), enabled.end(), false) == enabled.end();
+}
+
+/**
+ * @brief добавить в буфер состояний точки отрезка
+ * добавить в конец непрерывного буфера состояний первую точку
+ * отрезка, checkCnt-1 промежуточных точек и вторую точку отрезка
+ * (всего checkCnt+1 состояние)
+ * @param prevPoint первая точка отрезка
+ * @param nextPoint вторая точка отрезка
+ * @param checkCnt количество промежуточных точек
+ * @param states буфер состояний
+ */
+void PathFinder::divideSegment(
+        const std::vector<double> &prevPoint, const std::vector<double> &nextPoint, int checkCnt,
+        std::vector<double> &states
 ) {
     double checkStep = 1.0 / checkCnt;
 
-    std::vector<double> delta = mulState(subtractStates(std::move(nextPoint), prevPoint), checkStep);
+    std::vector<double> delta = mulState(subtractStates(nextPoint, prevPoint), checkStep);
 
     std::vector<double> currentPoint = prevPoint;
     for (int i = 0; i < checkCnt; i++) {
-        if (!checkState(currentPoint))
-            return false;
-
+        states.insert(states.end(), currentPoint.begin(), currentPoint.end());
         currentPoint = sumStates(currentPoint, delta);
     }
-    return checkState(currentPoint);
+    states.insert(states.end(), currentPoint.begin(), currentPoint.end());
 }
 
 /**
@@ -170,12 +498,13 @@ bool PathFinder::simpleCheckPath(const std::vector<std::vector<double>> &path, d
             return false;
     }
 
-    // проверка точек
-    for (const auto &i: path)
-        if (!checkState(i))
-            return false;
+    // проверка точек одним пакетом
+    std::vector<double> states;
+    for (const auto &point: path)
+        states.insert(states.end(), point.begin(), point.end());
 
-    return true;
+    std::vector<bool> enabled = checkStates(states, path.size());
+    return std::find(enabled.begin(), enabled.end(), false) == enabled.end();
 }
 
 /**
@@ -0,0 +1,110 @@
+#include "batch_path_finder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+using namespace bmpf;
+
+/**
+ * конструктор, планировщики рабочих потоков строятся
+ * по очереди, чтобы кеши заполнялись один раз
+ * @param scene сцена
+ * @param pathFinderFactory фабрика планировщиков
+ * @param workerCnt количество рабочих потоков
+ */
+BatchPathFinder::BatchPathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, const PathFinderFactory &pathFinderFactory,
+        unsigned int workerCnt
+) : _scene(scene) {
+    if (!scene)
+        throw std::runtime_error("BatchPathFinder::BatchPathFinder() ERROR: scene is null");
+    if (workerCnt == 0)
+        throw std::invalid_argument("BatchPathFinder::BatchPathFinder() ERROR: \n worker count must be positive");
+
+    for (unsigned int i = 0; i < workerCnt; i++) {
+        std::shared_ptr<PathFinder> pathFinder = pathFinderFactory(scene);
+        if (!pathFinder || pathFinder->getScene() != scene) {
+            char buf[1024];
+            sprintf(buf,
+                    "BatchPathFinder::BatchPathFinder() ERROR: \n path finder %u is null or built for another scene",
+                    i
+            );
+            throw std::invalid_argument(buf);
+        }
+        _pathFinders.emplace_back(pathFinder);
+    }
+
+    _threadPool = std::make_shared<ThreadPool>(workerCnt);
+}
+
+/**
+ * решить список задач, исключение планировщика на одной задаче
+ * не прерывает пакет: задача получает код ошибки ERROR_CAN_NOT_FIND_PATH
+ * @param tasks задачи: пары из стартового и конечного состояний
+ * @return результаты в порядке задач
+ */
+std::vector<BatchPathFinder::QueryResult> BatchPathFinder::findPaths(
+        const std::vector<std::pair<std::vector<double>, std::vector<double>>> &tasks
+) {
+    // состояния неверной размерности - ошибка вызывающего кода,
+    // поэтому она обнаруживается до запуска пакета
+    for (unsigned long i = 0; i < tasks.size(); i++)
+        if (tasks[i].first.size() != _scene->getJointCnt() || tasks[i].second.size() != _scene->getJointCnt()) {
+            char buf[1024];
+            sprintf(buf,
+                    "BatchPathFinder::findPaths() ERROR: \n task %lu states sizes are %zu and %zu,"
+                    " but joint count is %lu\nthey must be equal",
+                    i, tasks[i].first.size(), tasks[i].second.size(), _scene->getJointCnt()
+            );
+            throw std::invalid_argument(buf);
+        }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<QueryResult> results(tasks.size());
+    // номер следующей нерешённой задачи
+    std::atomic<unsigned long> nextTask{0};
+
+    // каждый вызов работает со своим планировщиком и берёт задачи,
+    // пока они не кончатся
+    unsigned long workerCnt = std::min((unsigned long) _pathFinders.size(), (unsigned long) tasks.size());
+    _threadPool->parallelFor(workerCnt, [&](unsigned long workerNum) {
+        for (unsigned long taskNum = nextTask++; taskNum < tasks.size(); taskNum = nextTask++) {
+            try {
+                results[taskNum] = _findPath((unsigned int) workerNum, tasks[taskNum]);
+            } catch (std::exception &e) {
+                // исключение на одной задаче не должно прерывать пакет
+                errMsg("BatchPathFinder::findPaths() task ", taskNum, " ERROR: ", e.what());
+                results[taskNum] = QueryResult{{}, PathFinder::ERROR_CAN_NOT_FIND_PATH, -1, (unsigned int) workerNum};
+            }
+        }
+    });
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    _calculationTimeInSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    return results;
+}
+
+/**
+ * решить одну задачу планировщиком рабочего потока
+ * @param workerNum номер рабочего потока
+ * @param task задача
+ * @return результат
+ */
+BatchPathFinder::QueryResult BatchPathFinder::_findPath(
+        unsigned int workerNum, const std::pair<std::vector<double>, std::vector<double>> &task
+) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    QueryResult result{};
+    result.errorCode = PathFinder::NO_ERROR;
+    result.path = _pathFinders.at(workerNum)->findPath(task.first, task.second, result.errorCode);
+    result.workerNum = workerNum;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.calculationTimeInSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    return result;
+}
@@ -0,0 +1,214 @@
+#include "bi_directional_path_finder.h"
+
+#include <algorithm>
+
+using namespace bmpf;
+
+/**
+ * конструктор
+ * @param scene сцена
+ * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+ * @param maxOpenSetSize максимальный размер открытого множества каждого из направлений
+ * @param gridSize размер сетки планирования
+ * @param maxNodeCnt максимальное кол-во нод в закрытом множестве каждого из направлений
+ * @param kG коэффициент разницы в углах поворота сочленений робота
+ * @param kD коэффициент разницы в положениях звеньев робота
+ * @param threadCnt количество потоков коллайдера каждого из направлений
+ * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+ * только при извлечении из открытого множества
+ */
+BiDirectionalPathFinder::BiDirectionalPathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, unsigned int maxOpenSetSize, int gridSize,
+        unsigned int maxNodeCnt, unsigned int kG, unsigned int kD, int threadCnt, bool lazyCheck
+) : GridPathFinder(scene, showTrace, gridSize, threadCnt) {
+    // у каждого направления свой планировщик, а значит и свой коллайдер
+    for (auto &direction: _directions)
+        direction = std::make_shared<OneDirectionPathFinder>(
+                scene, false, maxOpenSetSize, gridSize, maxNodeCnt, kG, kD, threadCnt, lazyCheck
+        );
+    _threadPool = std::make_shared<ThreadPool>(2);
+    _ready = true;
+}
+
+/**
+ * подготовка к планированию
+ * @param startState начальное состояние
+ * @param endState конечное состояние
+ */
+void BiDirectionalPathFinder::prepare(const std::vector<double> &startState, const std::vector<double> &endState) {
+    GridPathFinder::prepare(startState, endState);
+    if (_errorCode != NO_ERROR)
+        return;
+
+    _prepareDirections();
+}
+
+/**
+ * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+ * @param startCoords начальные координаты
+ * @param endCoords конечные координаты
+ */
+void BiDirectionalPathFinder::prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) {
+    GridPathFinder::prepare(startCoords, endCoords);
+    if (_errorCode != NO_ERROR)
+        return;
+
+    _prepareDirections();
+}
+
+/**
+ * подготовить оба направления по уже найденным стартовым и конечным координатам
+ */
+void BiDirectionalPathFinder::_prepareDirections() {
+    std::vector<int> startCoords = _startCoords;
+    std::vector<int> endCoords = _endCoords;
+    _directions[0]->prepare(startCoords, endCoords);
+    _directions[1]->prepare(endCoords, startCoords);
+
+    for (unsigned long direction = 0; direction < 2; direction++) {
+        _directionFinished[direction] = false;
+        _prevClosedCnt[direction] = 0;
+        _meetNodes[direction] = PathNodeArena::NO_NODE;
+        if (_directions[direction]->getErrorCode() != NO_ERROR)
+            _errorCode = _directions[direction]->getErrorCode();
+    }
+}
+
+/**
+ * выполнить до `ROUND_TICK_CNT` тактов одного направления
+ * @param direction номер направления: 0 - прямое, 1 - обратное
+ */
+void BiDirectionalPathFinder::_runRound(unsigned long direction) {
+    _prevClosedCnt[direction] = _directions[direction]->getClosedNodes().size();
+    if (_directionFinished[direction])
+        return;
+
+    std::vector<double> state;
+    for (unsigned int i = 0; i < ROUND_TICK_CNT; i++)
+        if (_directions[direction]->findTick(state)) {
+            _directionFinished[direction] = true;
+            return;
+        }
+}
+
+/**
+ * найти закрытую ноду направления по ключу координат
+ * @param direction номер направления: 0 - прямое, 1 - обратное
+ * @param key ключ координат
+ * @return индекс ноды или PathNodeArena::NO_NODE
+ */
+unsigned int BiDirectionalPathFinder::_findClosedNode(unsigned long direction, const GridKey &key) const {
+    const auto &closedNodeIndex = _directions[direction]->getClosedNodeIndex();
+    auto it = closedNodeIndex.find(key);
+    if (it == closedNodeIndex.end())
+        return PathNodeArena::NO_NODE;
+    return it->second;
+}
+
+/**
+ * найти среди нод, закрытых направлением за последний раунд,
+ * ноду, ключ которой закрыт другим направлением
+ * @param direction номер направления: 0 - прямое, 1 - обратное
+ * @return флаг, встретились ли фронты
+ */
+bool BiDirectionalPathFinder::_findMeeting(unsigned long direction) {
+    const PathNodeArena &nodes = _directions[direction]->getNodes();
+    const std::vector<unsigned int> &closedNodes = _directions[direction]->getClosedNodes();
+
+    for (unsigned long i = _prevClosedCnt[direction]; i < closedNodes.size(); i++) {
+        unsigned int otherNode = _findClosedNode(1 - direction, nodes.getKey(closedNodes[i]));
+        if (otherNode == PathNodeArena::NO_NODE)
+            continue;
+
+        _meetNodes[direction] = closedNodes[i];
+        _meetNodes[1 - direction] = otherNode;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * такт поиска: раунд из `ROUND_TICK_CNT` тактов каждого из направлений
+ * и проверка встречи фронтов
+ * @param state текущее состояние планировщика
+ * @return возвращает true, если планирование закончено
+ */
+bool BiDirectionalPathFinder::findTick(std::vector<double> &state) {
+    _threadPool->parallelFor(2, [this](unsigned long direction) { _runRound(direction); });
+
+    if (_showTrace)
+        bmpf::infoMsg("forward closedSet: ", _directions[0]->getClosedNodes().size(),
+                      " backward closedSet: ", _directions[1]->getClosedNodes().size());
+
+    // одно из направлений само дошло до своей цели, т.е. до корня другого
+    for (unsigned long direction = 0; direction < 2; direction++)
+        if (_directionFinished[direction] && _directions[direction]->getErrorCode() == NO_ERROR &&
+            _directions[direction]->getEndNode() != PathNodeArena::NO_NODE) {
+            _meetNodes[direction] = _directions[direction]->getEndNode();
+            _meetNodes[1 - direction] = 0;
+            _errorCode = NO_ERROR;
+            return true;
+        }
+
+    if (_findMeeting(0) || _findMeeting(1)) {
+        _errorCode = NO_ERROR;
+        return true;
+    }
+
+    // фронты не встретились, а одно из направлений закончило поиск
+    for (auto &direction: _directions)
+        if (direction->getErrorCode() != NO_ERROR) {
+            _errorCode = direction->getErrorCode();
+            return true;
+        }
+    if (_directionFinished[0] || _directionFinished[1]) {
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return true;
+    }
+
+    state = _directions[0]->getCurrentState();
+    return false;
+}
+
+/**
+ * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+ */
+void BiDirectionalPathFinder::buildPath() {
+    if (!_buildedPath.empty()) {
+        _errorCode = NO_ERROR;
+        return;
+    }
+
+    if (_meetNodes[0] == PathNodeArena::NO_NODE || _meetNodes[1] == PathNodeArena::NO_NODE) {
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return;
+    }
+
+    _buildedGridPath.clear();
+
+    // цепочка прямого направления: от ноды встречи к старту, потом разворачиваем
+    const PathNodeArena &forwardNodes = _directions[0]->getNodes();
+    for (unsigned int node = _meetNodes[0]; node != PathNodeArena::NO_NODE; node = forwardNodes.at(node).parent)
+        _buildedGridPath.emplace_back(forwardNodes.getCoords(node));
+    std::reverse(_buildedGridPath.begin(), _buildedGridPath.end());
+
+    // цепочка обратного направления: от предка ноды встречи к цели
+    const PathNodeArena &backwardNodes = _directions[1]->getNodes();
+    for (unsigned int node = backwardNodes.at(_meetNodes[1]).parent;
+         node != PathNodeArena::NO_NODE; node = backwardNodes.at(node).parent)
+        _buildedGridPath.emplace_back(backwardNodes.getCoords(node));
+
+    for (auto &coords: _buildedGridPath)
+        _buildedPath.emplace_back(coordsToState(coords));
+
+    _buildedGridPath.insert(_buildedGridPath.begin(), _startCoords);
+
+    if (!_coordsUsed) {
+        // add real start and end points
+        _buildedPath.insert(_buildedPath.begin(), _startState);
+        _buildedPath.emplace_back(_endState);
+    }
+    _buildedGridPath.emplace_back(_endCoords);
+
+    _pathLength = calculatePathLength(_buildedPath);
+}
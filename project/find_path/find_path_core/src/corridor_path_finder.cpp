@@ -0,0 +1,233 @@
+#include "corridor_path_finder.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace bmpf;
+
+/**
+ * конструктор
+ * @param scene сцена
+ * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+ * @param maxOpenSetSize максимальный размер открытого множества
+ * @param gridSize размер сетки планирования
+ * @param maxNodeCnt максимальное кол-во нод в закрытом множестве
+ * @param checkCache кэш результатов проверок на коллизии
+ * @param cacheScale во сколько раз сетка планировщика грубее сетки кэша
+ * @param kG коэффициент разницы в углах поворота сочленений робота
+ * @param kD коэффициент разницы в положениях звеньев робота
+ * @param threadCnt количество потоков планировщика
+ * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+ * только при извлечении из открытого множества
+ */
+CorridorPathFinder::CorridorPathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, unsigned int maxOpenSetSize, int gridSize,
+        unsigned int maxNodeCnt, const std::shared_ptr<GridCheckCache> &checkCache, int cacheScale,
+        unsigned int kG, unsigned int kD, int threadCnt, bool lazyCheck
+) : OneDirectionPathFinder(scene, showTrace, maxOpenSetSize, gridSize, maxNodeCnt, kG, kD, threadCnt, lazyCheck),
+    _checkCache(checkCache), _cacheScale(cacheScale) {
+    if (!checkCache || cacheScale < 1) {
+        char buf[1024];
+        sprintf(buf,
+                "CorridorPathFinder::CorridorPathFinder() ERROR: \n check cache is %s, cache scale is %d"
+                "\ncheck cache must be set, cache scale must be >= 1",
+                checkCache ? "set" : "null", cacheScale
+        );
+        throw std::invalid_argument(buf);
+    }
+}
+
+/**
+ * задать коридор
+ * @param coarseGridPath путь на сетке, которая в два раза грубее сетки планировщика
+ * @param width ширина коридора в ячейках грубой сетки
+ */
+void CorridorPathFinder::setCorridor(const std::vector<std::vector<int>> &coarseGridPath, int width) {
+    if (width < 1) {
+        char buf[1024];
+        sprintf(buf, "CorridorPathFinder::setCorridor() ERROR: \n width is %d, it must be >= 1", width);
+        throw std::invalid_argument(buf);
+    }
+    _corridor = coarseGridPath;
+    _corridorWidth = width;
+    _corridorCells.clear();
+
+    // стоимость шага между соседними ячейками пути считается так же, как
+    // эвристика: по координатам планировщика с весом kG и по положениям
+    // звеньев с весом kD
+    _corridorRemainders.assign(_corridor.size(), 0);
+    std::vector<int> cellCoords;
+    std::vector<int> nextCellCoords;
+    for (long i = (long) _corridor.size() - 2; i >= 0; i--) {
+        cellCoords.resize(_corridor[i].size());
+        nextCellCoords.resize(_corridor[i].size());
+        for (unsigned long j = 0; j < _corridor[i].size(); j++) {
+            cellCoords[j] = _corridor[i][j] * 2;
+            nextCellCoords[j] = _corridor[i + 1][j] * 2;
+        }
+        double step = 0;
+        if (_kD != 0)
+            step += _findLinkDistance(cellCoords, nextCellCoords) * _kD;
+        if (_kG != 0) {
+            double g = 0;
+            for (unsigned long j = 0; j < cellCoords.size(); j++)
+                g += std::abs(nextCellCoords[j] - cellCoords[j]);
+            step += g * _kG;
+        }
+        _corridorRemainders[i] = _corridorRemainders[i + 1] + step;
+    }
+}
+
+/**
+ * такт поиска
+ * @param state текущее состояние планировщика
+ * @return возвращает true, если планирование закончено
+ */
+bool CorridorPathFinder::findTick(std::vector<double> &state) {
+    if (OneDirectionPathFinder::findTick(state))
+        return true;
+
+    if (!_corridor.empty() && _stallCnt > _maxStallCnt) {
+        if (_showTrace)
+            bmpf::infoMsg("CorridorPathFinder: search stalled at coarse cell ", _farthestCell);
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * подготовка к планированию
+ * @param startState начальное состояние
+ * @param endState конечное состояние
+ */
+void CorridorPathFinder::prepare(const std::vector<double> &startState, const std::vector<double> &endState) {
+    _farthestCell = -1;
+    _stallCnt = 0;
+    OneDirectionPathFinder::prepare(startState, endState);
+}
+
+/**
+ * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+ * @param startCoords начальные координаты
+ * @param endCoords конечные координаты
+ */
+void CorridorPathFinder::prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) {
+    _farthestCell = -1;
+    _stallCnt = 0;
+    OneDirectionPathFinder::prepare(startCoords, endCoords);
+}
+
+/**
+ * проверка, лежат ли координаты в коридоре; если коридор не задан,
+ * все координаты лежат в нём
+ * @param coords координаты
+ * @return флаг, лежат ли координаты в коридоре
+ */
+bool CorridorPathFinder::isInCorridor(const std::vector<int> &coords) {
+    return _corridor.empty() || _findCorridorCell(coords) >= 0;
+}
+
+/**
+ * найти последнюю ячейку пути на грубой сетке, рядом с которой лежат
+ * координаты; найденный номер запоминается по ключу координат
+ * @param coords координаты
+ * @return номер ячейки или -1, если координаты лежат вне коридора
+ */
+long CorridorPathFinder::_findCorridorCell(const std::vector<int> &coords) {
+    // соседи разных нод во многом совпадают, поэтому весь коридор
+    // просматривается только для координат, которые ещё не встречались
+    GridKey key = _keyCoder.encode(coords);
+    auto it = _corridorCells.find(key);
+    if (it != _corridorCells.end())
+        return it->second;
+
+    long cell = -1;
+    for (long i = (long) _corridor.size() - 1; i >= 0; i--)
+        if (_isNearCell(coords, _corridor[i])) {
+            cell = i;
+            break;
+        }
+    _corridorCells.emplace(key, cell);
+    return cell;
+}
+
+/**
+ * проверка, лежат ли координаты рядом с ячейкой пути на грубой сетке
+ * @param coords координаты
+ * @param cell ячейка пути на грубой сетке
+ * @return флаг, лежат ли координаты рядом с ячейкой
+ */
+bool CorridorPathFinder::_isNearCell(const std::vector<int> &coords, const std::vector<int> &cell) const {
+    // сравнение ведётся в удвоенных координатах грубой сетки,
+    // чтобы не делить координаты планировщика пополам
+    for (unsigned long i = 0; i < coords.size(); i++)
+        if (std::abs(coords[i] - 2 * cell[i]) > 2 * _corridorWidth)
+            return false;
+    return true;
+}
+
+/**
+ * для всех соседей текущей ноды, лежащих в коридоре, метод должен добавить только
+ * подходящих в множество _openSet, если один из соседей
+ * имеет целевые указания (т.е. найден путь), то возвращаем индекс этой ноды,
+ * в противном случае должен быть возвращён PathNodeArena::NO_NODE
+ * @param currentNode индекс текущей ноды
+ * @param endCoords целевые координаты
+ * @return индекс найденной ноды или PathNodeArena::NO_NODE
+ */
+unsigned int CorridorPathFinder::_forEachNeighbor(unsigned int currentNode, std::vector<int> &endCoords) {
+    std::vector<int> currentCoords = _nodes.getCoords(currentNode);
+    GridKey endKey = _keyCoder.encode(endCoords);
+
+    if (_corridor.empty())
+        return OneDirectionPathFinder::_forEachNeighbor(currentNode, endCoords);
+
+    // эвристика считается до следующей ячейки пути на грубой сетке
+    // (на последней ячейке - до цели) плюс длина оставшейся части пути
+    long cell = _findCorridorCell(currentCoords);
+    if (cell > _farthestCell) {
+        _farthestCell = cell;
+        _stallCnt = 0;
+    } else
+        _stallCnt++;
+
+    unsigned long targetCell = std::min((unsigned long) std::max(cell + 1, 0L), _corridor.size() - 1);
+    std::vector<int> targetCoords = endCoords;
+    if (targetCell + 1 < _corridor.size())
+        for (unsigned long i = 0; i < targetCoords.size(); i++)
+            targetCoords[i] = _corridor[targetCell][i] * 2;
+    double remainder = _corridorRemainders[targetCell];
+
+    // собираем соседей из коридора по всем смещениям в один пакет
+    _clearNeighbors();
+    std::vector<int> neighborCoords(currentCoords.size());
+    for (const std::vector<int> &offset: _offsetList) {
+        bmpf::sumStates(currentCoords, offset, neighborCoords);
+        if (!isInCorridor(neighborCoords))
+            continue;
+        _addNeighbor(currentCoords, offset, targetCoords);
+        _neighborHeuristics[_neighborCnt - 1] += remainder;
+    }
+
+    return _acceptNeighbors(currentNode, endKey, _maxOpenSetSize);
+}
+
+/**
+ * найти результат проверки координат на коллизии в кэше
+ * @param coords координаты
+ * @param enabled в эту переменную записывается результат проверки
+ * @return флаг, найден ли результат
+ */
+bool CorridorPathFinder::_findCheckResult(const std::vector<int> &coords, bool &enabled) {
+    return _checkCache->find(coords, _cacheScale, enabled);
+}
+
+/**
+ * сохранить результат проверки координат на коллизии в кэш
+ * @param coords координаты
+ * @param enabled флаг, доступны ли координаты
+ */
+void CorridorPathFinder::_saveCheckResult(const std::vector<int> &coords, bool enabled) {
+    _checkCache->save(coords, _cacheScale, enabled);
+}
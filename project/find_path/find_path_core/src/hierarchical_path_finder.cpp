@@ -0,0 +1,209 @@
+#include "hierarchical_path_finder.h"
+
+using namespace bmpf;
+
+/**
+ * получить размер самой мелкой сетки
+ * @param coarseGridSize размер самой грубой сетки
+ * @param levelCnt кол-во уровней
+ * @return размер самой мелкой сетки
+ */
+static int getFineGridSize(int coarseGridSize, unsigned int levelCnt) {
+    if (coarseGridSize <= 0 || levelCnt < 1 || levelCnt > 16 ||
+        ((long) coarseGridSize << (levelCnt - 1)) > (1 << 30)) {
+        char buf[1024];
+        sprintf(buf,
+                "HierarchicalPathFinder ERROR: \n coarse grid size is %d, level count is %d"
+                "\ncoarse grid size must be positive, level count must be >= 1,"
+                " fine grid size must be <= 2^30",
+                coarseGridSize, levelCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+    return coarseGridSize << (levelCnt - 1);
+}
+
+/**
+ * конструктор
+ * @param scene сцена
+ * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+ * @param maxOpenSetSize максимальный размер открытого множества
+ * @param coarseGridSize размер самой грубой сетки
+ * @param levelCnt кол-во уровней
+ * @param maxNodeCnt максимальное кол-во нод в закрытом множестве на каждом уровне
+ * @param corridorWidth ширина коридора в ячейках сетки предыдущего уровня
+ * @param kG коэффициент разницы в углах поворота сочленений робота
+ * @param kD коэффициент разницы в положениях звеньев робота
+ * @param threadCnt количество потоков планировщика
+ * @param lazyCheck флаг, нужно ли проверять ноды на коллизии
+ * только при извлечении из открытого множества
+ */
+HierarchicalPathFinder::HierarchicalPathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, unsigned int maxOpenSetSize,
+        int coarseGridSize, unsigned int levelCnt, unsigned int maxNodeCnt, int corridorWidth,
+        unsigned int kG, unsigned int kD, int threadCnt, bool lazyCheck
+) : GridPathFinder(scene, showTrace, getFineGridSize(coarseGridSize, levelCnt), threadCnt),
+    _corridorWidth(corridorWidth) {
+    if (corridorWidth < 1) {
+        char buf[1024];
+        sprintf(buf, "HierarchicalPathFinder::HierarchicalPathFinder() ERROR: \n"
+                     "corridor width is %d, it must be >= 1", corridorWidth);
+        throw std::invalid_argument(buf);
+    }
+
+    _checkCache = std::make_shared<GridCheckCache>(scene->getJointCnt(), _gridSize);
+    for (unsigned int level = 0; level < levelCnt; level++)
+        _levels.emplace_back(std::make_shared<CorridorPathFinder>(
+                scene, showTrace, maxOpenSetSize, coarseGridSize << level, maxNodeCnt,
+                _checkCache, 1 << (levelCnt - 1 - level), kG, kD, threadCnt, lazyCheck
+        ));
+    _ready = true;
+}
+
+/**
+ * подготовка к планированию
+ * @param startState начальное состояние
+ * @param endState конечное состояние
+ */
+void HierarchicalPathFinder::prepare(const std::vector<double> &startState, const std::vector<double> &endState) {
+    // сцена могла измениться между поисками
+    _checkCache->clear();
+    _fallbackCnt = 0;
+
+    GridPathFinder::prepare(startState, endState);
+    if (_errorCode != NO_ERROR)
+        return;
+
+    _levels.front()->clearCorridor();
+    _startLevel(0);
+}
+
+/**
+ * построить путь, построенный путь должен быть сохранён в переменную _buildedPath
+ * @param startCoords начальные координаты на самой мелкой сетке
+ * @param endCoords конечные координаты на самой мелкой сетке
+ */
+void HierarchicalPathFinder::prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) {
+    _checkCache->clear();
+    _fallbackCnt = 0;
+
+    GridPathFinder::prepare(startCoords, endCoords);
+    if (_errorCode != NO_ERROR)
+        return;
+
+    _levels.front()->clearCorridor();
+    _startLevel(0);
+}
+
+/**
+ * начать поиск на уровне; уровни, на которых начальные и конечные
+ * координаты совпадают или не найдены, пропускаются
+ * @param level номер уровня
+ */
+void HierarchicalPathFinder::_startLevel(unsigned int level) {
+    _currentLevel = level;
+    const std::shared_ptr<CorridorPathFinder> &finder = _levels.at(level);
+
+    std::vector<int> startCoords = _startCoords;
+    std::vector<int> endCoords = _endCoords;
+    if (level + 1 < _levels.size()) {
+        // на грубых уровнях ищутся ближайшие свободные координаты
+        startCoords = finder->stateToCoords(coordsToState(_startCoords));
+        endCoords = finder->stateToCoords(coordsToState(_endCoords));
+        if (startCoords.empty() || endCoords.empty()) {
+            _nextLevel({});
+            return;
+        }
+        if (areStatesEqual(startCoords, endCoords)) {
+            _nextLevel({startCoords});
+            return;
+        }
+    }
+
+    if (_showTrace)
+        infoMsg("HierarchicalPathFinder: level ", level, " grid size ", finder->getGridSize(),
+                finder->hasCorridor() ? " with corridor" : " without corridor");
+
+    finder->prepare(startCoords, endCoords);
+}
+
+/**
+ * перейти к следующему уровню
+ * @param gridPath путь, найденный на текущем уровне, или пустой
+ * вектор, если следующий уровень должен искать путь без коридора
+ */
+void HierarchicalPathFinder::_nextLevel(const std::vector<std::vector<int>> &gridPath) {
+    const std::shared_ptr<CorridorPathFinder> &next = _levels.at(_currentLevel + 1);
+    if (gridPath.empty())
+        next->clearCorridor();
+    else
+        next->setCorridor(gridPath, _corridorWidth);
+    _startLevel(_currentLevel + 1);
+}
+
+/**
+ * такт поиска
+ * @param state текущее состояние планировщика
+ * @return возвращает true, если планирование закончено
+ */
+bool HierarchicalPathFinder::findTick(std::vector<double> &state) {
+    const std::shared_ptr<CorridorPathFinder> &finder = _levels.at(_currentLevel);
+    if (!finder->findTick(state))
+        return false;
+
+    bool isLastLevel = _currentLevel + 1 == _levels.size();
+
+    if (finder->getErrorCode() == NO_ERROR) {
+        if (isLastLevel)
+            return true;
+        finder->buildPath();
+        _nextLevel(finder->getBuildedGridPath());
+        return false;
+    }
+
+    if (finder->hasCorridor()) {
+        // путь мог проходить вне коридора, ищем на этом же уровне без него
+        _fallbackCnt++;
+        finder->clearCorridor();
+        _startLevel(_currentLevel);
+        return false;
+    }
+
+    if (!isLastLevel) {
+        // грубая сетка могла закрыть узкий проход, ищем на следующем уровне без коридора
+        _nextLevel({});
+        return false;
+    }
+
+    _errorCode = finder->getErrorCode();
+    return true;
+}
+
+/**
+ * построение пути
+ */
+void HierarchicalPathFinder::buildPath() {
+    if (!_buildedPath.empty()) {
+        _errorCode = NO_ERROR;
+        return;
+    }
+
+    const std::shared_ptr<CorridorPathFinder> &finder = _levels.back();
+    if (_currentLevel + 1 != _levels.size() || finder->getErrorCode() != NO_ERROR) {
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return;
+    }
+
+    finder->buildPath();
+    _buildedPath = finder->getBuildedPath();
+    _buildedGridPath = finder->getBuildedGridPath();
+
+    if (!_coordsUsed) {
+        // добавляем реальные начальную и конечную точки
+        _buildedPath.insert(_buildedPath.begin(), _startState);
+        _buildedPath.emplace_back(_endState);
+    }
+
+    _pathLength = calculatePathLength(_buildedPath);
+    _errorCode = NO_ERROR;
+}
@@ -0,0 +1,261 @@
+#include "ik_solver.h"
+
+#include <algorithm>
+
+using namespace bmpf;
+
+namespace {
+    /**
+     * максимальное изменение одной координаты за итерацию, рад
+     */
+    const double MAX_STEP = 0.5;
+}
+
+/**
+ * конструктор
+ * @param scene сцена
+ * @param collider коллайдер, проинициализированный по этой сцене
+ * @param threadCnt количество потоков для параллельного поиска
+ */
+IKSolver::IKSolver(
+        const std::shared_ptr<bmpf::Scene> &scene, const std::shared_ptr<bmpf::Collider> &collider,
+        unsigned int threadCnt
+) : _scene(scene), _collider(collider), _seedCnt(DEFAULT_SEED_CNT),
+    _maxIterationCnt(DEFAULT_MAX_ITERATION_CNT), _damping(0.05), _posEps(1e-4), _rotEps(1e-3) {
+    if (!scene)
+        throw std::runtime_error("IKSolver::IKSolver() ERROR: scene is null");
+    if (!collider)
+        throw std::runtime_error("IKSolver::IKSolver() ERROR: collider is null");
+
+    if (threadCnt > 1)
+        _threadPool = std::make_shared<ThreadPool>(threadCnt);
+}
+
+/**
+ * @brief найти состояние сцены по целевым положениям рабочих инструментов
+ * первым начальным состоянием служит предыдущее найденное решение,
+ * если его нет - середина диапазонов координат
+ * @param targetPoses целевые матрицы преобразования рабочих инструментов
+ * @param errorCode в эту переменную записывается код ошибки
+ * @return найденное состояние или пустой список, если решение не найдено
+ */
+std::vector<double> IKSolver::solve(const std::vector<Eigen::Matrix4d> &targetPoses, int &errorCode) {
+    if (!_lastSolution.empty() && _lastSolution.size() == _scene->getJointCnt())
+        return solve(targetPoses, std::vector<double>(_lastSolution), errorCode);
+
+    std::vector<double> seedState;
+    for (const auto &jointParams: _scene->getJointParamsList())
+        seedState.push_back((jointParams->minAngle + jointParams->maxAngle) / 2);
+    return solve(targetPoses, seedState, errorCode);
+}
+
+/**
+ * @brief найти состояние сцены по целевым положениям рабочих инструментов
+ * @param targetPoses целевые матрицы преобразования рабочих инструментов
+ * @param seedState первое начальное состояние (тёплый старт)
+ * @param errorCode в эту переменную записывается код ошибки
+ * @return найденное состояние или пустой список, если решение не найдено
+ */
+std::vector<double> IKSolver::solve(
+        const std::vector<Eigen::Matrix4d> &targetPoses, const std::vector<double> &seedState, int &errorCode
+) {
+    unsigned long jointCnt = _scene->getJointCnt();
+    if (targetPoses.size() != _scene->getActiveRobotCnt()) {
+        char buf[1024];
+        sprintf(buf,
+                "IKSolver::solve() ERROR: \n target pose count is %zu, active robot count is %lu"
+                "\nthey must be equal",
+                targetPoses.size(), _scene->getActiveRobotCnt()
+        );
+        throw std::invalid_argument(buf);
+    }
+    if (seedState.size() != jointCnt) {
+        char buf[1024];
+        sprintf(buf,
+                "IKSolver::solve() ERROR: \n seed state size is %zu, joint count is %lu"
+                "\nthey must be equal",
+                seedState.size(), jointCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    std::vector<std::shared_ptr<bmpf::JointParams>> jointParams = _scene->getJointParamsList();
+    std::vector<std::pair<long, long>> jointIndexRanges = _scene->getJointIndexRanges();
+    const std::vector<std::shared_ptr<bmpf::BaseRobot>> &robots = _scene->getRobots();
+
+    // начальные состояния: тёплый старт и случайные состояния
+    std::vector<std::vector<double>> states{seedState};
+    for (unsigned long i = 1; i < std::max(_seedCnt, 1ul); i++)
+        states.emplace_back(_scene->getRandomState());
+
+    // индексы роботов с сочленениями
+    std::vector<unsigned long> activeRobots;
+    for (unsigned long i = 0; i < robots.size(); i++)
+        if (robots[i]->getJointCnt() > 0)
+            activeRobots.push_back(i);
+
+    // каждый робот решается из каждого начального состояния независимо от остальных
+    std::vector<char> converged(states.size() * activeRobots.size(), false);
+    auto task = [&](unsigned long seedNum) {
+        std::vector<double> &state = states[seedNum];
+        for (unsigned long robotNum = 0; robotNum < activeRobots.size(); robotNum++) {
+            unsigned long i = activeRobots[robotNum];
+            long first = jointIndexRanges[i].first;
+            long last = jointIndexRanges[i].second + 1;
+            std::vector<double> robotState(state.begin() + first, state.begin() + last);
+            std::vector<std::shared_ptr<bmpf::JointParams>> robotJointParams(
+                    jointParams.begin() + first, jointParams.begin() + last
+            );
+            converged[seedNum * activeRobots.size() + robotNum] = solveRobot(
+                    *robots[i], robotJointParams, targetPoses[robotNum], robotState,
+                    _maxIterationCnt, _damping, _posEps, _rotEps
+            );
+            std::copy(robotState.begin(), robotState.end(), state.begin() + first);
+        }
+    };
+
+    if (_threadPool)
+        _threadPool->parallelFor(states.size(), task);
+    else
+        for (unsigned long i = 0; i < states.size(); i++)
+            task(i);
+
+    // номера начальных состояний, из которых сошёлся каждый из роботов
+    std::vector<std::vector<unsigned long>> robotSeeds(activeRobots.size());
+    unsigned long candidateCnt = 0;
+    for (unsigned long robotNum = 0; robotNum < activeRobots.size(); robotNum++) {
+        for (unsigned long seedNum = 0; seedNum < states.size(); seedNum++)
+            if (converged[seedNum * activeRobots.size() + robotNum])
+                robotSeeds[robotNum].push_back(seedNum);
+        if (robotSeeds[robotNum].empty()) {
+            errorCode = ERROR_CAN_NOT_FIND_SOLUTION;
+            return {};
+        }
+        candidateCnt = std::max(candidateCnt, (unsigned long) robotSeeds[robotNum].size());
+    }
+
+    // k-й кандидат составляется из k-х по счёту решений роботов (по кругу, если
+    // решений робота меньше), поэтому сошедшиеся из разных начальных
+    // состояний решения роботов комбинируются между собой
+    std::vector<std::vector<double>> candidates(candidateCnt, seedState);
+    for (unsigned long k = 0; k < candidateCnt; k++)
+        for (unsigned long robotNum = 0; robotNum < activeRobots.size(); robotNum++) {
+            const std::vector<unsigned long> &seeds = robotSeeds[robotNum];
+            const std::vector<double> &solution = states[seeds[k % seeds.size()]];
+            long first = jointIndexRanges[activeRobots[robotNum]].first;
+            long last = jointIndexRanges[activeRobots[robotNum]].second + 1;
+            std::copy(solution.begin() + first, solution.begin() + last, candidates[k].begin() + first);
+        }
+
+    // кандидаты с допустимыми углами проверяются коллайдером одним пакетом
+    std::vector<unsigned long> checkedIndexes;
+    for (unsigned long i = 0; i < candidates.size(); i++)
+        if (_scene->isStateEnabled(candidates[i]))
+            checkedIndexes.push_back(i);
+
+    if (checkedIndexes.empty()) {
+        errorCode = ERROR_CAN_NOT_FIND_SOLUTION;
+        return {};
+    }
+
+    unsigned long linkCnt = _scene->getLinkCnt();
+    std::vector<Eigen::Matrix4d> matrices(checkedIndexes.size() * linkCnt);
+    for (unsigned long j = 0; j < checkedIndexes.size(); j++)
+        _scene->fillTransformMatrices(candidates[checkedIndexes[j]], matrices.data() + j * linkCnt);
+    std::vector<bool> collided = _collider->areCollided(matrices, checkedIndexes.size());
+
+    // из безколлизионных решений выбираем ближайшее к тёплому старту
+    long bestIndex = -1;
+    double bestDistance = 0;
+    for (unsigned long j = 0; j < checkedIndexes.size(); j++) {
+        if (collided[j])
+            continue;
+        const std::vector<double> &state = candidates[checkedIndexes[j]];
+        double distance = 0;
+        for (unsigned long k = 0; k < jointCnt; k++)
+            distance += (state[k] - seedState[k]) * (state[k] - seedState[k]);
+        if (bestIndex < 0 || distance < bestDistance) {
+            bestIndex = (long) checkedIndexes[j];
+            bestDistance = distance;
+        }
+    }
+
+    if (bestIndex < 0) {
+        errorCode = ERROR_CAN_NOT_FIND_SOLUTION;
+        return {};
+    }
+
+    _lastSolution = candidates[bestIndex];
+    errorCode = NO_ERROR;
+    return _lastSolution;
+}
+
+/**
+ * @brief решить обратную задачу для одного робота
+ * итерации метода затухающих наименьших квадратов из состояния `state`;
+ * метод не меняет робота, поэтому его можно вызывать из разных потоков
+ * @param robot робот
+ * @param jointParams параметры сочленений робота
+ * @param targetPose целевая матрица преобразования рабочего инструмента
+ * @param state начальное состояние, в эту переменную записывается результат
+ * @param maxIterationCnt максимальное количество итераций
+ * @param damping коэффициент затухания lambda
+ * @param posEps допустимая ошибка положения
+ * @param rotEps допустимая ошибка ориентации (угол, рад)
+ * @return флаг, сошёлся ли метод
+ */
+bool IKSolver::solveRobot(
+        const bmpf::BaseRobot &robot, const std::vector<std::shared_ptr<bmpf::JointParams>> &jointParams,
+        const Eigen::Matrix4d &targetPose, std::vector<double> &state,
+        unsigned long maxIterationCnt, double damping, double posEps, double rotEps
+) {
+    if (state.size() != robot.getJointCnt() || jointParams.size() != robot.getJointCnt()) {
+        char buf[1024];
+        sprintf(buf,
+                "IKSolver::solveRobot() ERROR: \n state size is %zu, joint params count is %zu,"
+                " joint count is %lu\nthey must be equal",
+                state.size(), jointParams.size(), robot.getJointCnt()
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    Eigen::Matrix<double, 6, 6> dampingMatrix = damping * damping * Eigen::Matrix<double, 6, 6>::Identity();
+    for (unsigned long iteration = 0; ; iteration++) {
+        Eigen::Matrix<double, 6, 1> error = getPoseError(robot.getEndEffectorTransformMatrix(state), targetPose);
+        if (error.head<3>().norm() < posEps && error.tail<3>().norm() < rotEps)
+            return true;
+        if (iteration == maxIterationCnt)
+            return false;
+
+        Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian = robot.getEndEffectorJacobian(state);
+        Eigen::Matrix<double, 6, 6> jjt = jacobian * jacobian.transpose() + dampingMatrix;
+        Eigen::VectorXd delta = jacobian.transpose() * jjt.ldlt().solve(error);
+
+        // слишком длинный шаг уводит линеаризацию в сторону, поэтому он укорачивается
+        double maxDelta = delta.cwiseAbs().maxCoeff();
+        if (maxDelta > MAX_STEP)
+            delta *= MAX_STEP / maxDelta;
+
+        for (unsigned long i = 0; i < state.size(); i++)
+            state[i] = std::min(std::max(state[i] + delta(i), jointParams[i]->minAngle), jointParams[i]->maxAngle);
+    }
+}
+
+/**
+ * получить ошибку положения и ориентации рабочего инструмента:
+ * первые три элемента - разность положений, последние три - вектор
+ * поворота (ось, умноженная на угол) от текущей ориентации к целевой,
+ * оба в СК мира
+ * @param pose текущая матрица преобразования рабочего инструмента
+ * @param targetPose целевая матрица преобразования рабочего инструмента
+ * @return ошибка
+ */
+Eigen::Matrix<double, 6, 1> IKSolver::getPoseError(const Eigen::Matrix4d &pose, const Eigen::Matrix4d &targetPose) {
+    Eigen::Matrix<double, 6, 1> error;
+    error.head<3>() = targetPose.topRightCorner<3, 1>() - pose.topRightCorner<3, 1>();
+    Eigen::AngleAxisd rotation(
+            Eigen::Matrix3d(targetPose.topLeftCorner<3, 3>() * pose.topLeftCorner<3, 3>().transpose())
+    );
+    error.tail<3>() = rotation.angle() * rotation.axis();
+    return error;
+}
@@ -0,0 +1,543 @@
+#include "incremental_path_finder.h"
+
+#include <limits>
+
+using namespace bmpf;
+
+const char IncrementalPathFinder::CELL_UNKNOWN;
+const char IncrementalPathFinder::CELL_ENABLED;
+const char IncrementalPathFinder::CELL_DISABLED;
+
+/**
+ * бесконечная стоимость пути
+ */
+static const double INF = std::numeric_limits<double>::infinity();
+
+/**
+ * проверка, пересекаются ли параллелепипеды
+ * @param a координаты первого параллелепипеда
+ * @param b координаты второго параллелепипеда
+ * @return флаг, пересекаются ли параллелепипеды
+ */
+static bool areBoxesIntersected(const std::vector<double> &a, const std::vector<double> &b) {
+    for (unsigned int i = 0; i < 3; i++)
+        if (a.at(i) > b.at(i + 3) || b.at(i) > a.at(i + 3))
+            return false;
+    return true;
+}
+
+/**
+ * конструктор
+ * @param scene сцена
+ * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+ * @param gridSize размер сетки планирования
+ * @param maxNodeCnt максимальное кол-во раскрытых ячеек за один запрос
+ * @param threadCnt количество потоков планировщика
+ */
+IncrementalPathFinder::IncrementalPathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, int gridSize, unsigned int maxNodeCnt,
+        int threadCnt
+) : GridPathFinder(scene, showTrace, gridSize, threadCnt), _maxNodeCnt(maxNodeCnt) {
+    _ready = true;
+}
+
+/**
+ * подготовка к планированию; если конечные координаты совпадают с
+ * предыдущими, граф поиска переиспользуется
+ * @param startState начальное состояние
+ * @param endState конечное состояние
+ */
+void IncrementalPathFinder::prepare(const std::vector<double> &startState, const std::vector<double> &endState) {
+    GridPathFinder::prepare(startState, endState);
+    if (_errorCode != NO_ERROR)
+        return;
+    _prepareGraph();
+}
+
+/**
+ * подготовка к планированию; если конечные координаты совпадают с
+ * предыдущими, граф поиска переиспользуется
+ * @param startCoords начальные координаты
+ * @param endCoords конечные координаты
+ */
+void IncrementalPathFinder::prepare(std::vector<int> &startCoords, std::vector<int> &endCoords) {
+    GridPathFinder::prepare(startCoords, endCoords);
+    if (_errorCode != NO_ERROR)
+        return;
+    _prepareGraph();
+}
+
+/**
+ * подготовить граф поиска к запросу: сбросить его, если конечные
+ * координаты изменились, иначе учесть сдвиг начальной точки
+ */
+void IncrementalPathFinder::_prepareGraph() {
+    _graphReused = !_cells.empty() && _graphEndCoords == _endCoords;
+
+    if (_graphReused) {
+        // ключи открытого множества посчитаны для старой начальной точки,
+        // эвристика согласованна, поэтому достаточно увеличить их все
+        // на расстояние между старой и новой начальными точками
+        _km += _heuristic(_lastStartCoords, _startCoords);
+    } else {
+        resetGraph();
+        _graphEndCoords = _endCoords;
+        _graphEndKey = _keyCoder.encode(_endCoords);
+        Cell &endCell = _getCell(_graphEndKey);
+        endCell.state = CELL_ENABLED;
+        endCell.rhs = 0;
+        _updateQueue(_endCoords, endCell);
+    }
+
+    _lastStartCoords = _startCoords;
+    _expandCnt = 0;
+
+    if (_showTrace)
+        infoMsg("IncrementalPathFinder: graph is ", _graphReused ? "reused" : "reset", ", cells: ", _cells.size());
+}
+
+/**
+ * сбросить граф поиска, следующий запрос будет выполнен с нуля
+ */
+void IncrementalPathFinder::resetGraph() {
+    _cells.clear();
+    _openSet = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>();
+    _km = 0;
+    _graphEndCoords.clear();
+}
+
+/**
+ * такт поиска
+ * @param state текущее состояние планировщика
+ * @return возвращает true, если планирование закончено
+ */
+bool IncrementalPathFinder::findTick(std::vector<double> &state) {
+    _skipStaleItems();
+
+    // поиск закончен, когда начальная ячейка согласованна и
+    // её ключ не больше ключа любой ячейки открытого множества
+    auto startIt = _cells.find(_keyCoder.encode(_startCoords));
+    Cell startCell = startIt != _cells.end() ? startIt->second : Cell{INF, INF, CELL_UNKNOWN, false, false, {0, 0}};
+    if (_openSet.empty() ||
+        (!(_openSet.top().key < _calculateKey(_startCoords, startCell)) && startCell.g == startCell.rhs)) {
+        std::vector<std::vector<int>> gridPath;
+        if (startCell.g == INF || !_extractGridPath(gridPath)) {
+            _errorCode = ERROR_CAN_NOT_FIND_PATH;
+            return true;
+        }
+        // если помеченная ячейка пути оказалась недоступной, поиск продолжается
+        return _verifyGridPath(gridPath);
+    }
+
+    if (_expandCnt >= _maxNodeCnt) {
+        _errorCode = ERROR_REACHED_MAX_NODE_CNT;
+        return true;
+    }
+
+    QueueItem item = _openSet.top();
+    _openSet.pop();
+    Cell &cell = _cells.at(item.cellKey);
+    std::vector<int> coords;
+    _keyCoder.decode(item.cellKey, coords);
+
+    std::pair<double, double> key = _calculateKey(coords, cell);
+    if (item.key < key) {
+        cell.queueKey = key;
+        _openSet.push({key, item.cellKey});
+        return false;
+    }
+
+    _expandCnt++;
+    cell.open = false;
+
+    if (cell.g > cell.rhs) {
+        // стоимость пути уменьшилась: распространяем её на доступных соседей
+        cell.g = cell.rhs;
+        _checkNeighbors(coords);
+        double g = cell.g;
+        _forEachNeighbor(coords, [this, g](const GridKey &neighborKey, const std::vector<int> &neighborCoords,
+                                           double step) {
+            if (neighborKey == _graphEndKey)
+                return;
+            Cell &neighbor = _getCell(neighborKey);
+            if (neighbor.state == CELL_ENABLED && g + step < neighbor.rhs) {
+                neighbor.rhs = g + step;
+                _updateQueue(neighborCoords, neighbor);
+            }
+        });
+    } else {
+        // стоимость пути увеличилась: пересчитываем саму ячейку и всех соседей,
+        // которые могли получать стоимость через неё
+        cell.g = INF;
+        _updateVertex(coords);
+        _forEachNeighbor(coords, [this](const GridKey &neighborKey, const std::vector<int> &neighborCoords,
+                                        double /*step*/) {
+            if (_cells.count(neighborKey))
+                _updateVertex(neighborCoords);
+        });
+    }
+
+    state = coordsToState(coords);
+    return false;
+}
+
+/**
+ * построение пути
+ */
+void IncrementalPathFinder::buildPath() {
+    if (!_buildedPath.empty()) {
+        _errorCode = NO_ERROR;
+        return;
+    }
+
+    if (!_extractGridPath(_buildedGridPath)) {
+        _buildedGridPath.clear();
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return;
+    }
+
+    for (auto &coords: _buildedGridPath)
+        _buildedPath.emplace_back(coordsToState(coords));
+
+    _buildedGridPath.insert(_buildedGridPath.begin(), _startCoords);
+
+    if (!_coordsUsed) {
+        _buildedPath.insert(_buildedPath.begin(), _startState);
+        _buildedPath.emplace_back(_endState);
+    }
+    _buildedGridPath.emplace_back(_endCoords);
+
+    _pathLength = calculatePathLength(_buildedPath);
+    _errorCode = NO_ERROR;
+}
+
+/**
+ * добавить объект на сцену; если у объекта нет сочленений, перепроверяются
+ * только ячейки, затронутые его ограничивающим параллелепипедом,
+ * в противном случае граф поиска сбрасывается
+ * @param path путь к файлу с описанием
+ */
+void IncrementalPathFinder::addObjectToScene(std::string path) {
+    unsigned long jointCnt = _scene->getJointCnt();
+    PathFinder::addObjectToScene(std::move(path));
+
+    if (_scene->getJointCnt() != jointCnt)
+        resetGraph();
+    else
+        updateRegion(getObjectBoxCoords(_scene->getRobots().size() - 1), true, false);
+}
+
+/**
+ * удалить объект; если у объекта нет сочленений, перепроверяются
+ * только ячейки, затронутые его ограничивающим параллелепипедом,
+ * в противном случае граф поиска сбрасывается
+ * @param robotNum номер робота в списке роботов
+ */
+void IncrementalPathFinder::deleteObjectFromScene(long robotNum) {
+    if (_scene->getRobots().at(robotNum)->getJointCnt() != 0) {
+        PathFinder::deleteObjectFromScene(robotNum);
+        resetGraph();
+        return;
+    }
+
+    // параллелепипед нужно получить до того, как объект будет удалён из коллайдера
+    std::vector<double> boxCoords = getObjectBoxCoords(robotNum);
+    PathFinder::deleteObjectFromScene(robotNum);
+    updateRegion(boxCoords, false, true);
+}
+
+/**
+ * получить координаты параллелепипеда, ограничивающего объект без сочленений
+ * @param objectNum номер объекта в списке роботов
+ * @return координаты параллелепипеда:
+ * min.x(), min.y(), min.z(), max.x(), max.y(), max.z()
+ */
+std::vector<double> IncrementalPathFinder::getObjectBoxCoords(unsigned long objectNum) {
+    if (objectNum >= _scene->getRobots().size()) {
+        char buf[1024];
+        sprintf(buf,
+                "IncrementalPathFinder::getObjectBoxCoords() ERROR: \n objectNum is %zu, but object count is %zu",
+                objectNum, _scene->getRobots().size()
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    // положение объекта без сочленений от состояния не зависит
+    std::vector<double> state(_scene->getJointCnt(), 0);
+    return _collider->getBoxCoords(objectNum, _scene->getTransformMatrices(state));
+}
+
+/**
+ * @brief обновить граф поиска после изменения сцены внутри параллелепипеда
+ * находит ячейки графа поиска, в которых ограничивающий параллелепипед
+ * хотя бы одного робота пересекается с заданным. Недоступные ячейки
+ * перепроверяются сразу, у тех, доступность которых изменилась, и их
+ * соседей пересчитывается rhs. Доступные ячейки только помечаются:
+ * стоимость пути через них может лишь вырасти, поэтому их достаточно
+ * перепроверить, когда они окажутся на найденном пути.
+ * Доступность ячеек, от которых не зависит ни одна стоимость, сбрасывается
+ * @param boxCoords координаты параллелепипеда:
+ * min.x(), min.y(), min.z(), max.x(), max.y(), max.z()
+ * @param recheckEnabled флаг, нужно ли перепроверять доступные ячейки
+ * (при добавлении объекта недоступные ячейки доступными не станут)
+ * @param recheckDisabled флаг, нужно ли перепроверять недоступные ячейки
+ * (при удалении объекта доступные ячейки недоступными не станут)
+ */
+void IncrementalPathFinder::updateRegion(
+        const std::vector<double> &boxCoords, bool recheckEnabled, bool recheckDisabled
+) {
+    _affectedCellCnt = 0;
+    _changedCellCnt = 0;
+
+    std::vector<bool> areObjectsJointed = _scene->areObjectsJointed();
+    std::vector<GridKey> recheckedKeys;
+    std::vector<double> states;
+    std::vector<int> coords;
+    for (auto &item: _cells) {
+        Cell &cell = item.second;
+        if (cell.state == CELL_UNKNOWN || (cell.state == CELL_ENABLED ? !recheckEnabled : !recheckDisabled))
+            continue;
+
+        // доступная ячейка с бесконечными g и rhs не влияет ни на одну
+        // стоимость, её достаточно перепроверить, когда она понадобится
+        if (cell.state == CELL_ENABLED && cell.g == INF && cell.rhs == INF) {
+            cell.state = CELL_UNKNOWN;
+            cell.dirty = false;
+            continue;
+        }
+
+        _keyCoder.decode(item.first, coords);
+        std::vector<double> state = coordsToState(coords);
+        std::vector<Eigen::Matrix4d> matrices = _scene->getTransformMatrices(state);
+        for (unsigned long objectNum = 0; objectNum < areObjectsJointed.size(); objectNum++)
+            if (areObjectsJointed[objectNum] &&
+                areBoxesIntersected(_collider->getBoxCoords(objectNum, matrices), boxCoords)) {
+                _affectedCellCnt++;
+                if (cell.state == CELL_ENABLED)
+                    cell.dirty = true;
+                else {
+                    recheckedKeys.push_back(item.first);
+                    states.insert(states.end(), state.begin(), state.end());
+                }
+                break;
+            }
+    }
+
+    _setCellStates(recheckedKeys, checkStates(states, recheckedKeys.size()));
+
+    if (_showTrace)
+        infoMsg("IncrementalPathFinder: region is updated, affected cells: ", _affectedCellCnt,
+                ", changed cells: ", _changedCellCnt);
+}
+
+/**
+ * задать доступность перепроверенных ячеек; у ячеек, доступность которых
+ * изменилась, поменялись цены всех рёбер, поэтому rhs пересчитывается
+ * и у них, и у их соседей
+ * @param keys ключи координат ячеек
+ * @param enabled i-й элемент равен true, если i-я ячейка доступна
+ * @return флаг, изменилась ли доступность хотя бы одной ячейки
+ */
+bool IncrementalPathFinder::_setCellStates(const std::vector<GridKey> &keys, const std::vector<bool> &enabled) {
+    std::vector<std::vector<int>> changedCoords;
+    std::vector<int> coords;
+    for (unsigned long i = 0; i < keys.size(); i++) {
+        Cell &cell = _cells.at(keys[i]);
+        char state = enabled[i] ? CELL_ENABLED : CELL_DISABLED;
+        cell.dirty = false;
+        if (cell.state != state) {
+            cell.state = state;
+            _keyCoder.decode(keys[i], coords);
+            changedCoords.emplace_back(coords);
+        }
+    }
+    _changedCellCnt += changedCoords.size();
+
+    for (auto &cellCoords: changedCoords) {
+        _updateVertex(cellCoords);
+        _forEachNeighbor(cellCoords, [this](const GridKey &neighborKey, const std::vector<int> &neighborCoords,
+                                            double /*step*/) {
+            if (_cells.count(neighborKey))
+                _updateVertex(neighborCoords);
+        });
+    }
+    return !changedCoords.empty();
+}
+
+/**
+ * перепроверить помеченные ячейки пути одним пакетом
+ * @param gridPath путь по координатам сетки планирования
+ * @return флаг, остались ли все ячейки пути доступными
+ */
+bool IncrementalPathFinder::_verifyGridPath(const std::vector<std::vector<int>> &gridPath) {
+    std::vector<GridKey> keys;
+    std::vector<double> states;
+    for (auto &coords: gridPath) {
+        GridKey key = _keyCoder.encode(coords);
+        if (!_cells.at(key).dirty)
+            continue;
+        keys.push_back(key);
+        std::vector<double> state = coordsToState(coords);
+        states.insert(states.end(), state.begin(), state.end());
+    }
+    return !_setCellStates(keys, checkStates(states, keys.size()));
+}
+
+/**
+ * собрать путь от начальных координат к конечным по убыванию стоимости до цели
+ * @param gridPath в этот вектор записывается путь по координатам сетки планирования
+ * @return флаг, удалось ли собрать путь
+ */
+bool IncrementalPathFinder::_extractGridPath(std::vector<std::vector<int>> &gridPath) {
+    gridPath = {_startCoords};
+    for (unsigned long i = 0; !areStatesEqual(gridPath.back(), _endCoords); i++) {
+        if (i > _cells.size())
+            return false;
+        double minCost = INF;
+        std::vector<int> nextCoords;
+        _forEachNeighbor(gridPath.back(), [this, &minCost, &nextCoords](
+                const GridKey &neighborKey, const std::vector<int> &neighborCoords, double step
+        ) {
+            auto it = _cells.find(neighborKey);
+            if (it == _cells.end() || it->second.state != CELL_ENABLED)
+                return;
+            double cost = step + it->second.g;
+            if (cost < minCost) {
+                minCost = cost;
+                nextCoords = neighborCoords;
+            }
+        });
+        if (nextCoords.empty())
+            return false;
+        gridPath.emplace_back(nextCoords);
+    }
+    return true;
+}
+
+/**
+ * получить ячейку, при необходимости создав её
+ * @param key ключ координат ячейки
+ * @return ячейка
+ */
+IncrementalPathFinder::Cell &IncrementalPathFinder::_getCell(const GridKey &key) {
+    return _cells.emplace(key, Cell{INF, INF, CELL_UNKNOWN, false, false, {0, 0}}).first->second;
+}
+
+/**
+ * эвристика - взвешенное манхэттенское расстояние между координатами
+ * @param a первые координаты
+ * @param b вторые координаты
+ * @return оценка стоимости пути
+ */
+double IncrementalPathFinder::_heuristic(const std::vector<int> &a, const std::vector<int> &b) const {
+    double sum = 0;
+    for (unsigned long i = 0; i < a.size(); i++)
+        sum += std::abs(a[i] - b[i]) * _gridSteps[i];
+    return sum;
+}
+
+/**
+ * ключ ячейки в открытом множестве
+ * @param coords координаты ячейки
+ * @param cell ячейка
+ * @return ключ
+ */
+std::pair<double, double> IncrementalPathFinder::_calculateKey(const std::vector<int> &coords, const Cell &cell) const {
+    double minG = std::min(cell.g, cell.rhs);
+    return {minG + _heuristic(_startCoords, coords) + _km, minG};
+}
+
+/**
+ * положить ячейку в открытое множество, если она несогласованна,
+ * иначе убрать её оттуда
+ * @param coords координаты ячейки
+ * @param cell ячейка
+ */
+void IncrementalPathFinder::_updateQueue(const std::vector<int> &coords, Cell &cell) {
+    // старый элемент очереди не удаляется, а устаревает
+    cell.open = cell.g != cell.rhs;
+    if (cell.open) {
+        cell.queueKey = _calculateKey(coords, cell);
+        _openSet.push({cell.queueKey, _keyCoder.encode(coords)});
+    }
+}
+
+/**
+ * пересчитать rhs ячейки по её соседям и обновить открытое множество
+ * @param coords координаты ячейки
+ */
+void IncrementalPathFinder::_updateVertex(const std::vector<int> &coords) {
+    GridKey key = _keyCoder.encode(coords);
+    Cell &cell = _getCell(key);
+
+    if (key != _graphEndKey) {
+        double rhs = INF;
+        // конечная стоимость бывает только у доступных ячеек
+        if (cell.state == CELL_ENABLED)
+            _forEachNeighbor(coords, [this, &rhs](const GridKey &neighborKey,
+                                                  const std::vector<int> &/*neighborCoords*/, double step) {
+                auto it = _cells.find(neighborKey);
+                if (it != _cells.end() && it->second.state == CELL_ENABLED)
+                    rhs = std::min(rhs, it->second.g + step);
+            });
+        cell.rhs = rhs;
+    }
+
+    _updateQueue(coords, cell);
+}
+
+/**
+ * перебрать соседей ячейки внутри сетки
+ * @param coords координаты ячейки
+ * @param handler обработчик: ключ и координаты соседа, цена шага к нему
+ */
+void IncrementalPathFinder::_forEachNeighbor(
+        const std::vector<int> &coords,
+        const std::function<void(const GridKey &, const std::vector<int> &, double)> &handler
+) const {
+    std::vector<int> neighborCoords(coords);
+    for (unsigned long i = 0; i < coords.size(); i++)
+        for (int offset: {-1, 1}) {
+            neighborCoords[i] = coords[i] + offset;
+            if (neighborCoords[i] >= 0 && neighborCoords[i] < _gridSize)
+                handler(_keyCoder.encode(neighborCoords), neighborCoords, _gridSteps[i]);
+            neighborCoords[i] = coords[i];
+        }
+}
+
+/**
+ * проверить одним пакетом ещё не проверенных соседей ячейки
+ * @param coords координаты ячейки
+ */
+void IncrementalPathFinder::_checkNeighbors(const std::vector<int> &coords) {
+    std::vector<GridKey> keys;
+    std::vector<double> states;
+    _forEachNeighbor(coords, [this, &keys, &states](const GridKey &neighborKey,
+                                                    const std::vector<int> &neighborCoords, double /*step*/) {
+        if (_getCell(neighborKey).state != CELL_UNKNOWN)
+            return;
+        keys.push_back(neighborKey);
+        std::vector<double> state = coordsToState(neighborCoords);
+        states.insert(states.end(), state.begin(), state.end());
+    });
+
+    if (keys.empty())
+        return;
+
+    std::vector<bool> enabled = checkStates(states, keys.size());
+    for (unsigned long i = 0; i < keys.size(); i++)
+        _cells.at(keys[i]).state = enabled[i] ? CELL_ENABLED : CELL_DISABLED;
+}
+
+/**
+ * убрать из вершины открытого множества устаревшие элементы
+ */
+void IncrementalPathFinder::_skipStaleItems() {
+    while (!_openSet.empty()) {
+        const QueueItem &item = _openSet.top();
+        auto it = _cells.find(item.cellKey);
+        if (it != _cells.end() && it->second.open && it->second.queueKey == item.key)
+            return;
+        _openSet.pop();
+    }
+}
@@ -6,17 +6,16 @@ using namespace bmpf;
 /**
  * для всех соседей текущей ноды метод должен добавить только
  * подходящих в множество _openSet, если один из соседей
- * имеет целевые указания (т.е. найден путь), то возвращаем указатель на эту ноду,
- * в противном случае должен быть возвращён nullptr
- * @param currentNode текущая нода
+ * имеет целевые указания (т.е. найден путь), то возвращаем индекс этой ноды,
+ * в противном случае должен быть возвращён PathNodeArena::NO_NODE
+ * @param currentNode индекс текущей ноды
  * @param endCoords целевые координаты
- * @return найденная нода или null
+ * @return индекс найденной ноды или PathNodeArena::NO_NODE
  */
-std::shared_ptr<PathNode> OneDirectionOrderedPathFinder::_forEachNeighbor(
-        std::shared_ptr<PathNode> currentNode,
-        std::vector<int> &endCoords
-) {
-    std::vector<int> delta = bmpf::subtractStates(endCoords, currentNode->coords);
+unsigned int OneDirectionOrderedPathFinder::_forEachNeighbor(unsigned int currentNode, std::vector<int> &endCoords) {
+    std::vector<int> currentCoords = _nodes.getCoords(currentNode);
+    GridKey endKey = _keyCoder.encode(endCoords);
+    std::vector<int> delta = bmpf::subtractStates(endCoords, currentCoords);
 
     std::vector<unsigned long> sizeOrderedOffsetIndexes;
     if (bmpf::isStateLimited(delta, 1))
@@ -24,29 +23,12 @@ std::shared_ptr<PathNode> OneDirectionOrderedPathFinder::_forEachNeighbor(
     else
         sizeOrderedOffsetIndexes = _getOrderedOffsetIndexes(delta);
 
-    unsigned long listSize = sizeOrderedOffsetIndexes.size();
-
-    for (unsigned int i = 0; i < listSize; i++) {
-        std::vector<int> &offset = _offsetList.at(sizeOrderedOffsetIndexes.at(i));
-
-        std::vector<int> newCoords = bmpf::sumStates(currentNode->coords, offset);
-        double sum = _getPathNodeWeight(newCoords, endCoords);
-
-        std::shared_ptr<PathNode> newNode = tryToGetNeighborPtr(newCoords, currentNode, sum);
-
-        if (newNode) {
-            if (bmpf::areStatesEqual(newNode->coords, endCoords))
-                return newNode;
-
-            _openSet.insert(PathNodePtr(newNode));
-            if (_maxOpenSetSize != 0 && _openSet.size() > _maxOpenSetSize)
-                _openSet.erase(std::prev(_openSet.end()));
+    // собираем соседей в пакет в порядке смещений
+    _clearNeighbors();
+    for (unsigned long index: sizeOrderedOffsetIndexes)
+        _addNeighbor(currentCoords, _offsetList.at(index), endCoords);
 
-            continue;
-        }
-
-    }
-    return nullptr;
+    return _acceptNeighbors(currentNode, endKey, _maxOpenSetSize);
 }
 
 /**
@@ -57,31 +39,24 @@ std::shared_ptr<PathNode> OneDirectionOrderedPathFinder::_forEachNeighbor(
 std::vector<unsigned long> OneDirectionOrderedPathFinder::_getOrderedOffsetIndexesMultiRobot(
         std::vector<int> &deltas
 ) {
-    // специальная структура для сортировки смещений
+    // специальная структура для сортировки смещений; у роботов может быть
+    // разное число сочленений, поэтому каждый робот сравнивается по
+    // максимальному модулю отклонения среди своих координат
     struct RobotStruct {
         RobotStruct(unsigned int index, std::vector<int> &coords) {
             this->index = index;
             this->coords = coords;
+            maxDelta = 0;
+            for (int coord: coords)
+                maxDelta = std::max(maxDelta, std::abs(coord));
         }
 
         unsigned int index;
         std::vector<int> coords;
+        int maxDelta;
 
         bool operator<(const RobotStruct &obj) const {
-            //infoMsg(this->coords.size(), " ", obj.coords.size());
-
-            assert(this->coords.size() == obj.coords.size());
-            int aMax = std::abs(*this->coords.begin());
-            int bMax = std::abs(*obj.coords.begin());
-            for (int coord: this->coords) {
-                if (std::abs(coord) > aMax)
-                    aMax = std::abs(coord);
-            }
-            for (int coord: obj.coords) {
-                if (std::abs(coord) > bMax)
-                    bMax = std::abs(coord);
-            }
-            return aMax > bMax;
+            return maxDelta > obj.maxDelta;
         }
     };
 
@@ -103,8 +78,10 @@ std::vector<unsigned long> OneDirectionOrderedPathFinder::_getOrderedOffsetIndex
 
     std::vector<unsigned long> result;
     for (unsigned long k = 0; k < robotCnt; k++) {
-        for (int i = 0; i < 6; i++) {
-            unsigned long statePos = robotsStructs.at(k).index * 6 + i;
+        unsigned int robotIndex = robotsStructs.at(k).index;
+        unsigned long offset = _scene->getJointIndexRanges().at(robotIndex).first;
+        for (unsigned long i = 0; i < robotsStructs.at(k).coords.size(); i++) {
+            unsigned long statePos = offset + i;
             result.push_back(statePos * 2);
             result.push_back(statePos * 2 + 1);
         }
@@ -6,35 +6,22 @@ using namespace bmpf;
 /**
  * для всех соседей текущей ноды метод должен добавить только
  * подходящих в множество _openSet, если один из соседей
- * имеет целевые указания (т.е. найден путь), то возвращаем указатель на эту ноду,
- * в противном случае должен быть возвращён nullptr
- * @param currentNode текущая нода
+ * имеет целевые указания (т.е. найден путь), то возвращаем индекс этой ноды,
+ * в противном случае должен быть возвращён PathNodeArena::NO_NODE
+ * @param currentNode индекс текущей ноды
  * @param endCoords целевые координаты
- * @return найденная нода или null
+ * @return индекс найденной ноды или PathNodeArena::NO_NODE
  */
-std::shared_ptr<PathNode> OneDirectionPathFinder::_forEachNeighbor(
-        std::shared_ptr<PathNode> currentNode, std::vector<int> &endCoords
-) {
-    // перебираем смещения
-    for (const std::vector<int> &offset: _offsetList) {
-        std::vector<int> newCoords = bmpf::sumStates(currentNode->coords, offset);
+unsigned int OneDirectionPathFinder::_forEachNeighbor(unsigned int currentNode, std::vector<int> &endCoords) {
+    std::vector<int> currentCoords = _nodes.getCoords(currentNode);
+    GridKey endKey = _keyCoder.encode(endCoords);
 
-        double sum = _getPathNodeWeight(newCoords, endCoords);
+    // собираем соседей по всем смещениям в один пакет
+    _clearNeighbors();
+    for (const std::vector<int> &offset: _offsetList)
+        _addNeighbor(currentCoords, offset, endCoords);
 
-        std::shared_ptr<PathNode> newNode = tryToGetNeighborPtr(newCoords, currentNode, sum);
-
-        if (newNode) {
-            //  infoMsg("new node");
-            if (bmpf::areStatesEqual(newNode->coords, endCoords))
-                return newNode;
-
-            _openSet.insert(PathNodePtr(newNode));
-            if (_maxOpenSetSize != 0 && _openSet.size() > _maxOpenSetSize)
-                _openSet.erase(std::prev(_openSet.end()));
-
-        }
-    }
-    return nullptr;
+    return _acceptNeighbors(currentNode, endKey, _maxOpenSetSize);
 }
 
 /**
@@ -0,0 +1,195 @@
+#include "portfolio_path_finder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <set>
+
+using namespace bmpf;
+
+/**
+ * конструктор
+ * @param pathFinders планировщики с названиями алгоритмов
+ * @param raceCnt кол-во планировщиков, участвующих в каждой гонке,
+ * 0 - все планировщики
+ */
+PortfolioPathFinder::PortfolioPathFinder(
+        const std::vector<std::pair<std::string, std::shared_ptr<PathFinder>>> &pathFinders,
+        unsigned int raceCnt
+) {
+    if (pathFinders.empty())
+        throw std::invalid_argument("PortfolioPathFinder::PortfolioPathFinder() ERROR: \n path finder list is empty");
+
+    std::set<std::string> names;
+    std::set<PathFinder *> objects;
+    for (auto &item: pathFinders) {
+        if (!item.second) {
+            char buf[1024];
+            sprintf(buf, "PortfolioPathFinder::PortfolioPathFinder() ERROR: \n path finder %s is null",
+                    item.first.c_str());
+            throw std::invalid_argument(buf);
+        }
+        // одновременно работающие планировщики не могут делить состояние поиска
+        if (!names.insert(item.first).second || !objects.insert(item.second.get()).second) {
+            char buf[1024];
+            sprintf(buf, "PortfolioPathFinder::PortfolioPathFinder() ERROR: \n"
+                         " path finder %s is duplicated (by name or by object)", item.first.c_str());
+            throw std::invalid_argument(buf);
+        }
+        _names.emplace_back(item.first);
+        _pathFinders.emplace_back(item.second);
+    }
+
+    _raceCnt = raceCnt == 0 ? (unsigned int) _pathFinders.size() :
+               std::min(raceCnt, (unsigned int) _pathFinders.size());
+    _threadPool = std::make_shared<ThreadPool>(_raceCnt);
+    _errorCodes.resize(_pathFinders.size(), (int) PathFinder::NO_ERROR);
+
+    resetStats();
+}
+
+/**
+ * поиск пути: гонка планировщиков
+ * @param startState стартовое состояние
+ * @param endState конечное состояние
+ * @param errorCode в эту переменную записывается код ошибки:
+ * NO_ERROR, если хотя бы один планировщик нашёл путь, иначе
+ * код ошибки первого по порядку участника гонки
+ * @return путь победителя
+ */
+std::vector<std::vector<double>> PortfolioPathFinder::findPath(
+        const std::vector<double> &startState, const std::vector<double> &endState, int &errorCode
+) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<unsigned long> ranking = getRanking();
+    ranking.resize(_raceCnt);
+
+    // флаги отмены остаются выставленными после прошлой гонки
+    for (unsigned long num: ranking)
+        _pathFinders.at(num)->clearCancel();
+
+    std::fill(_errorCodes.begin(), _errorCodes.end(), (int) PathFinder::NO_ERROR);
+    std::vector<std::vector<double>> winnerPath;
+    double winnerTime = 0;
+    long winnerNum = -1;
+    std::mutex winnerMutex;
+
+    _threadPool->parallelFor(ranking.size(), [&](unsigned long pos) {
+        unsigned long num = ranking.at(pos);
+        int localErrorCode = PathFinder::NO_ERROR;
+        std::vector<std::vector<double>> path;
+        try {
+            path = _pathFinders.at(num)->findPath(startState, endState, localErrorCode);
+        } catch (std::exception &e) {
+            // исключение одного алгоритма не должно прерывать гонку
+            errMsg("PortfolioPathFinder::findPath() ", _names.at(num), " ERROR: ", e.what());
+            localErrorCode = PathFinder::ERROR_CAN_NOT_FIND_PATH;
+        }
+        _errorCodes.at(num) = localErrorCode;
+
+        if (localErrorCode != PathFinder::NO_ERROR || path.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(winnerMutex);
+        if (winnerNum >= 0)
+            return;
+
+        winnerNum = (long) num;
+        winnerPath = std::move(path);
+        winnerTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+        for (unsigned long otherNum: ranking)
+            if (otherNum != num)
+                _pathFinders.at(otherNum)->cancel();
+    });
+
+    // статистика
+    for (unsigned long num: ranking) {
+        _stats.at(num).raceCnt++;
+        if ((long) num == winnerNum) {
+            _stats.at(num).winCnt++;
+            _stats.at(num).winTimeInSeconds += winnerTime;
+        } else if (_errorCodes.at(num) != PathFinder::NO_ERROR &&
+                   _errorCodes.at(num) != PathFinder::ERROR_CANCELLED)
+            _stats.at(num).failCnt++;
+    }
+
+    _winnerNum = winnerNum;
+    errorCode = winnerNum >= 0 ? PathFinder::NO_ERROR : _errorCodes.at(ranking.front());
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    _calculationTimeInSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    return winnerPath;
+}
+
+/**
+ * получить номера алгоритмов в порядке убывания сглаженной доли побед
+ * @return номера алгоритмов
+ */
+std::vector<unsigned long> PortfolioPathFinder::getRanking() const {
+    std::vector<unsigned long> ranking;
+    for (unsigned long i = 0; i < _pathFinders.size(); i++)
+        ranking.push_back(i);
+
+    // при равных долях сохраняется порядок, заданный в конструкторе
+    std::stable_sort(ranking.begin(), ranking.end(), [this](unsigned long a, unsigned long b) {
+        return _getWinRate(a) > _getWinRate(b);
+    });
+    return ranking;
+}
+
+/**
+ * получить json-представление статистики алгоритмов
+ * @return json-представление
+ */
+Json::Value PortfolioPathFinder::getStatsJSON() const {
+    Json::Value json;
+    for (unsigned long i = 0; i < _pathFinders.size(); i++) {
+        Json::Value record;
+        record["name"] = _names.at(i);
+        record["raceCnt"] = (Json::UInt64) _stats.at(i).raceCnt;
+        record["winCnt"] = (Json::UInt64) _stats.at(i).winCnt;
+        record["failCnt"] = (Json::UInt64) _stats.at(i).failCnt;
+        record["winTime"] = _stats.at(i).winTimeInSeconds;
+        json[(int) i] = record;
+    }
+    return json;
+}
+
+/**
+ * загрузить статистику алгоритмов из json-представления,
+ * записи сопоставляются с алгоритмами по названиям, записи
+ * неизвестных алгоритмов пропускаются
+ * @param json json-представление
+ */
+void PortfolioPathFinder::loadStatsFromJSON(const Json::Value &json) {
+    for (const Json::Value &record: json) {
+        auto it = std::find(_names.begin(), _names.end(), record["name"].asString());
+        if (it == _names.end())
+            continue;
+
+        AlgorithmStat &stat = _stats.at(it - _names.begin());
+        stat.raceCnt = record["raceCnt"].asUInt64();
+        stat.winCnt = record["winCnt"].asUInt64();
+        stat.failCnt = record["failCnt"].asUInt64();
+        stat.winTimeInSeconds = record["winTime"].asDouble();
+    }
+}
+
+/**
+ * обнулить статистику алгоритмов
+ */
+void PortfolioPathFinder::resetStats() {
+    _stats.assign(_pathFinders.size(), AlgorithmStat{0, 0, 0, 0});
+}
+
+/**
+ * сглаженная доля побед алгоритма
+ * @param num номер алгоритма
+ * @return сглаженная доля побед
+ */
+double PortfolioPathFinder::_getWinRate(unsigned long num) const {
+    const AlgorithmStat &stat = _stats.at(num);
+    return (double) (stat.winCnt + 1) / (double) (stat.raceCnt + 2);
+}
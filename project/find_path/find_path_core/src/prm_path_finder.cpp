@@ -0,0 +1,669 @@
+#include "prm_path_finder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread_pool.h>
+
+using namespace bmpf;
+
+const char PRMPathFinder::EDGE_UNKNOWN;
+const char PRMPathFinder::EDGE_VALID;
+const char PRMPathFinder::EDGE_INVALID;
+
+/**
+ * сигнатура файла дорожной карты, последний символ - версия формата
+ */
+static const char ROADMAP_MAGIC[8] = {'B', 'M', 'P', 'F', 'P', 'R', 'M', '1'};
+
+/**
+ * во сколько раз шаг грубой проверки рёбер больше основного
+ */
+static const int COARSE_CHECK_FACTOR = 8;
+
+/**
+ * записать значение в поток
+ * @tparam T тип значения
+ * @param os поток
+ * @param value значение
+ */
+template<typename T>
+static void writeValue(std::ostream &os, const T &value) {
+    os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/**
+ * записать массив в поток
+ * @tparam T тип элементов
+ * @param os поток
+ * @param values массив
+ */
+template<typename T>
+static void writeArray(std::ostream &os, const std::vector<T> &values) {
+    os.write(reinterpret_cast<const char *>(values.data()), (std::streamsize) (values.size() * sizeof(T)));
+}
+
+/**
+ * прочитать значение из потока
+ * @tparam T тип значения
+ * @param is поток
+ * @param value в эту переменную записывается значение
+ * @return флаг, удалось ли прочитать значение
+ */
+template<typename T>
+static bool readValue(std::istream &is, T &value) {
+    return (bool) is.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+/**
+ * прочитать массив из потока
+ * @tparam T тип элементов
+ * @param is поток
+ * @param cnt кол-во элементов
+ * @param values в этот вектор записывается массив
+ * @return флаг, удалось ли прочитать массив
+ */
+template<typename T>
+static bool readArray(std::istream &is, unsigned long cnt, std::vector<T> &values) {
+    values.resize(cnt);
+    return (bool) is.read(reinterpret_cast<char *>(values.data()), (std::streamsize) (cnt * sizeof(T)));
+}
+
+/**
+ * конструктор, загружает дорожную карту из файла рядом
+ * с описанием сцены или строит её
+ * @param scene сцена
+ * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+ * @param vertexCnt кол-во вершин дорожной карты
+ * @param neighborCnt кол-во ближайших вершин, с которыми соединяется каждая вершина
+ * @param checkStep максимальное расстояние между проверяемыми точками ребра
+ * @param seed зерно генератора случайных чисел
+ * @param threadCnt количество потоков планировщика
+ */
+PRMPathFinder::PRMPathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, unsigned int vertexCnt,
+        unsigned int neighborCnt, double checkStep, unsigned int seed, int threadCnt
+) : PathFinder(scene, showTrace, threadCnt),
+    _vertexCnt(vertexCnt), _neighborCnt(neighborCnt), _checkStep(checkStep), _seed(seed), _rng(seed) {
+    if (vertexCnt < 1 || neighborCnt < 1 || !(checkStep > 0)) {
+        char buf[1024];
+        sprintf(buf,
+                "PRMPathFinder::PRMPathFinder() ERROR: \n vertex count is %u, neighbor count is %u,"
+                " check step is %f\nvertex and neighbor counts must be >= 1, check step must be positive",
+                vertexCnt, neighborCnt, checkStep
+        );
+        throw std::invalid_argument(buf);
+    }
+
+    if (!_scene->getScenePath().empty()) {
+        _roadmapPath = getRoadmapPath(_scene->getScenePath());
+        _roadmapDescription = _getRoadmapDescription();
+    }
+
+    if (_roadmapPath.empty() || !loadRoadmap(_roadmapPath)) {
+        buildRoadmap();
+        if (!_roadmapPath.empty() && !saveRoadmap(_roadmapPath))
+            errMsg("PRMPathFinder::PRMPathFinder() can not save roadmap to ", _roadmapPath);
+    }
+    _roadmapChanged = false;
+
+    _ready = true;
+}
+
+/**
+ * деструктор, сохраняет карту в файл сцены, если запросы
+ * изменили статусы её рёбер
+ */
+PRMPathFinder::~PRMPathFinder() {
+    // после изменения объектов сцены карта описывает уже другую сцену,
+    // и файл исходной сцены не перезаписывается
+    if (!_roadmapChanged || _roadmapPath.empty() || _getRoadmapDescription() != _roadmapDescription)
+        return;
+
+    if (!saveRoadmap(_roadmapPath))
+        errMsg("PRMPathFinder::~PRMPathFinder() can not save roadmap to ", _roadmapPath);
+}
+
+/**
+ * построить дорожную карту заново
+ */
+void PRMPathFinder::buildRoadmap() {
+    unsigned long dim = _scene->getJointCnt();
+    _vertices.reset(dim);
+    _rng.seed(_seed);
+
+    // случайные состояния проверяются пакетами, которые коллайдер
+    // распределяет по потокам; порядок вершин от числа потоков не зависит
+    unsigned long attemptCnt = 0;
+    while (_vertices.size() < _vertexCnt) {
+        unsigned long batchCnt = _vertexCnt - _vertices.size();
+        if (attemptCnt > (unsigned long) _vertexCnt * 1000)
+            throw std::runtime_error("PRMPathFinder::buildRoadmap() ERROR: can not find free states");
+        attemptCnt += batchCnt;
+
+        std::vector<double> states;
+        for (unsigned long i = 0; i < batchCnt; i++) {
+            std::vector<double> state = _getRandomState();
+            states.insert(states.end(), state.begin(), state.end());
+        }
+        std::vector<bool> enabled = checkStates(states, batchCnt);
+        for (unsigned long i = 0; i < batchCnt && _vertices.size() < _vertexCnt; i++)
+            if (enabled[i])
+                _vertices.add(std::vector<double>(states.begin() + i * dim, states.begin() + (i + 1) * dim));
+    }
+
+    // ближайшие соседи всех вершин ищутся параллельно
+    std::vector<std::vector<unsigned int>> neighbors(_vertices.size());
+    auto findNeighbors = [this, &neighbors](unsigned long vertex) {
+        neighbors[vertex] = _vertices.nearest(_vertices.getPoint((unsigned int) vertex), _neighborCnt + 1);
+    };
+    if (_threadCnt > 1) {
+        ThreadPool threadPool((unsigned int) _threadCnt);
+        threadPool.parallelFor(_vertices.size(), findNeighbors);
+    } else
+        for (unsigned long i = 0; i < _vertices.size(); i++)
+            findNeighbors(i);
+
+    // рёбра неориентированные, пара вершин упаковывается в одно число
+    std::vector<uint64_t> pairs;
+    for (unsigned int i = 0; i < neighbors.size(); i++)
+        for (unsigned int j: neighbors[i])
+            if (j != i)
+                pairs.push_back(((uint64_t) std::min(i, j) << 32) | std::max(i, j));
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    _edges.clear();
+    for (uint64_t pair: pairs) {
+        _edges.push_back((unsigned int) (pair >> 32));
+        _edges.push_back((unsigned int) pair);
+    }
+    _edgeStatuses.assign(pairs.size(), EDGE_UNKNOWN);
+    _buildAdjacency();
+    _roadmapLoaded = false;
+
+    if (_showTrace)
+        infoMsg("PRMPathFinder: roadmap is built, vertices: ", _vertices.size(), ", edges: ", _edgeStatuses.size());
+}
+
+/**
+ * добавить объект на сцену; если у объекта есть сочленения,
+ * карта строится заново, иначе перепроверяются вершины карты
+ * и допустимые рёбра (недопустимые такими и остаются)
+ * @param path путь к файлу с описанием
+ */
+void PRMPathFinder::addObjectToScene(std::string path) {
+    unsigned long jointCnt = _scene->getJointCnt();
+    PathFinder::addObjectToScene(std::move(path));
+
+    if (_scene->getJointCnt() != jointCnt)
+        buildRoadmap();
+    else
+        _resetEdgeStatuses(true);
+}
+
+/**
+ * удалить объект; если у объекта есть сочленения, карта строится
+ * заново, иначе перепроверяются вершины карты и все рёбра
+ * @param robotNum номер робота в списке роботов
+ */
+void PRMPathFinder::deleteObjectFromScene(long robotNum) {
+    unsigned long jointCnt = _scene->getJointCnt();
+    PathFinder::deleteObjectFromScene(robotNum);
+
+    if (_scene->getJointCnt() != jointCnt)
+        buildRoadmap();
+    else
+        _resetEdgeStatuses(false);
+}
+
+/**
+ * @brief обновить статусы рёбер после изменения объектов сцены без сочленений
+ * сбрасывает статусы рёбер в EDGE_UNKNOWN и перепроверяет вершины карты
+ * одним пакетом: рёбра, инцидентные занятым вершинам, сразу отмечаются
+ * как недопустимые, остальные проверяются лениво при следующих запросах
+ * @param keepInvalid флаг, нужно ли сохранить недопустимые рёбра;
+ * после добавления препятствия недопустимое ребро не может стать допустимым
+ */
+void PRMPathFinder::_resetEdgeStatuses(bool keepInvalid) {
+    for (char &status: _edgeStatuses)
+        if (!keepInvalid || status != EDGE_INVALID)
+            status = EDGE_UNKNOWN;
+
+    std::vector<double> states;
+    for (unsigned int i = 0; i < _vertices.size(); i++) {
+        std::vector<double> state = _vertices.getPoint(i);
+        states.insert(states.end(), state.begin(), state.end());
+    }
+    std::vector<bool> enabled = checkStates(states, _vertices.size());
+
+    unsigned long disabledCnt = 0;
+    for (unsigned int vertex = 0; vertex < _vertices.size(); vertex++) {
+        if (enabled[vertex])
+            continue;
+        disabledCnt++;
+        for (unsigned int i = _adjacencyOffsets[vertex]; i < _adjacencyOffsets[vertex + 1]; i++)
+            _edgeStatuses[_adjacency[i].second] = EDGE_INVALID;
+    }
+
+    if (_showTrace)
+        infoMsg("PRMPathFinder: edge statuses are reset, disabled vertices: ", disabledCnt);
+}
+
+/**
+ * загрузить дорожную карту из файла
+ * @param path путь к файлу
+ * @return флаг, загружена ли карта; карта не загружается, если файла
+ * нет, он повреждён или построен для другой сцены или других параметров
+ */
+bool PRMPathFinder::loadRoadmap(const std::string &path) {
+    std::ifstream ifs(path, std::ios_base::binary);
+    if (!ifs)
+        return false;
+
+    char magic[sizeof(ROADMAP_MAGIC)];
+    if (!ifs.read(magic, sizeof(magic)) || std::memcmp(magic, ROADMAP_MAGIC, sizeof(magic)) != 0)
+        return false;
+
+    uint64_t descriptionSize;
+    std::vector<char> description;
+    std::string expectedDescription = _getRoadmapDescription();
+    if (!readValue(ifs, descriptionSize) || descriptionSize != expectedDescription.size() ||
+        !readArray(ifs, descriptionSize, description) ||
+        std::string(description.begin(), description.end()) != expectedDescription)
+        return false;
+
+    uint32_t dim, vertexCnt, edgeCnt;
+    std::vector<double> states;
+    std::vector<uint32_t> edges;
+    std::vector<char> edgeStatuses;
+    if (!readValue(ifs, dim) || dim != _scene->getJointCnt() ||
+        !readValue(ifs, vertexCnt) || !readArray(ifs, (unsigned long) vertexCnt * dim, states) ||
+        !readValue(ifs, edgeCnt) || !readArray(ifs, (unsigned long) edgeCnt * 2, edges) ||
+        !readArray(ifs, edgeCnt, edgeStatuses))
+        return false;
+
+    for (uint32_t vertex: edges)
+        if (vertex >= vertexCnt)
+            return false;
+    for (char status: edgeStatuses)
+        if (status != EDGE_UNKNOWN && status != EDGE_VALID && status != EDGE_INVALID)
+            return false;
+
+    _vertices.reset(dim);
+    for (unsigned long i = 0; i < vertexCnt; i++)
+        _vertices.add(std::vector<double>(states.begin() + i * dim, states.begin() + (i + 1) * dim));
+    _edges.assign(edges.begin(), edges.end());
+    _edgeStatuses = edgeStatuses;
+    _buildAdjacency();
+    _roadmapLoaded = true;
+
+    if (_showTrace)
+        infoMsg("PRMPathFinder: roadmap is loaded from ", path);
+    return true;
+}
+
+/**
+ * сохранить дорожную карту в файл вместе с результатами проверок рёбер
+ * @param path путь к файлу
+ * @return флаг, сохранена ли карта
+ */
+bool PRMPathFinder::saveRoadmap(const std::string &path) const {
+    std::ofstream ofs(path, std::ios::out | std::ios::binary);
+    if (!ofs)
+        return false;
+
+    // числа записываются в порядке байт платформы
+    std::string description = _getRoadmapDescription();
+    ofs.write(ROADMAP_MAGIC, sizeof(ROADMAP_MAGIC));
+    writeValue(ofs, (uint64_t) description.size());
+    ofs.write(description.data(), (std::streamsize) description.size());
+
+    writeValue(ofs, (uint32_t) _vertices.getDim());
+    writeValue(ofs, (uint32_t) _vertices.size());
+    for (unsigned int i = 0; i < _vertices.size(); i++)
+        writeArray(ofs, _vertices.getPoint(i));
+
+    writeValue(ofs, (uint32_t) _edgeStatuses.size());
+    writeArray(ofs, std::vector<uint32_t>(_edges.begin(), _edges.end()));
+    writeArray(ofs, _edgeStatuses);
+    return (bool) ofs;
+}
+
+/**
+ * получить путь к файлу дорожной карты сцены:
+ * расширение ".json" заменяется на ".prm.bin"
+ * @param scenePath путь к описанию сцены
+ * @return путь к файлу дорожной карты
+ */
+std::string PRMPathFinder::getRoadmapPath(const std::string &scenePath) {
+    const std::string extension = ".json";
+    if (scenePath.size() >= extension.size() &&
+        scenePath.compare(scenePath.size() - extension.size(), extension.size(), extension) == 0)
+        return scenePath.substr(0, scenePath.size() - extension.size()) + ".prm.bin";
+    return scenePath + ".prm.bin";
+}
+
+/**
+ * получить описание сцены и параметров карты, по которому
+ * проверяется, подходит ли сохранённая карта
+ * @return описание сцены и параметров карты
+ */
+std::string PRMPathFinder::_getRoadmapDescription() const {
+    Json::Value json;
+    for (auto &objectModelPaths: _scene->getGroupedModelPaths()) {
+        Json::Value objectModels(Json::arrayValue);
+        for (auto &modelPath: objectModelPaths)
+            objectModels.append(modelPath);
+        json["models"].append(objectModels);
+    }
+    for (auto &transformVector: _scene->getGroupedTransformVector()) {
+        Json::Value transform(Json::arrayValue);
+        for (double val: transformVector)
+            transform.append(val);
+        json["transforms"].append(transform);
+    }
+    for (auto &jointParams: _scene->getJointParamsList()) {
+        json["minAngles"].append(jointParams->minAngle);
+        json["maxAngles"].append(jointParams->maxAngle);
+    }
+    json["vertexCnt"] = _vertexCnt;
+    json["neighborCnt"] = _neighborCnt;
+    json["checkStep"] = _checkStep;
+    json["seed"] = _seed;
+    return json.toStyledString();
+}
+
+/**
+ * получить случайное состояние в пределах допустимых углов
+ * (на коллизии не проверяется)
+ * @return случайное состояние
+ */
+std::vector<double> PRMPathFinder::_getRandomState() {
+    std::vector<double> state;
+    for (const auto &jointParams: _scene->getJointParamsList())
+        state.push_back(std::uniform_real_distribution<double>(jointParams->minAngle, jointParams->maxAngle)(_rng));
+    return state;
+}
+
+/**
+ * построить списки смежности по списку рёбер
+ */
+void PRMPathFinder::_buildAdjacency() {
+    _adjacencyOffsets.assign(_vertices.size() + 1, 0);
+    for (unsigned int vertex: _edges)
+        _adjacencyOffsets[vertex + 1]++;
+    for (unsigned long i = 1; i < _adjacencyOffsets.size(); i++)
+        _adjacencyOffsets[i] += _adjacencyOffsets[i - 1];
+
+    std::vector<unsigned int> positions(_adjacencyOffsets.begin(), _adjacencyOffsets.end() - 1);
+    _adjacency.resize(_edges.size());
+    for (unsigned int edge = 0; edge < _edgeStatuses.size(); edge++) {
+        unsigned int a = _edges[edge * 2];
+        unsigned int b = _edges[edge * 2 + 1];
+        _adjacency[positions[a]++] = {b, edge};
+        _adjacency[positions[b]++] = {a, edge};
+    }
+}
+
+/**
+ * подготовка к планированию
+ * @param startState начальное состояние
+ * @param endState конечное состояние
+ */
+void PRMPathFinder::prepare(const std::vector<double> &startState, const std::vector<double> &endState) {
+    if (_showTrace) {
+        infoMsg("PRMPathFinder::prepare");
+        infoState("start state: ", startState);
+        infoState("end state: ", endState);
+    }
+
+    if (!checkState(startState))
+        throw std::runtime_error("PRMPathFinder::prepare() ERROR: \n _startState is disabled");
+
+    if (!checkState(endState))
+        throw std::runtime_error("PRMPathFinder::prepare() ERROR: \n _endState is disabled");
+
+    _startState = startState;
+    _endState = endState;
+
+    // начальная и конечная вершины запроса идут сразу после вершин карты
+    auto startVertex = (unsigned int) _vertices.size();
+    unsigned int endVertex = startVertex + 1;
+    _queryEdges.clear();
+    _queryEdgeStatuses.clear();
+    _queryAdjacency.clear();
+    for (unsigned int vertex: _vertices.nearest(startState, _neighborCnt))
+        _addQueryEdge(startVertex, vertex);
+    for (unsigned int vertex: _vertices.nearest(endState, _neighborCnt))
+        _addQueryEdge(endVertex, vertex);
+    _addQueryEdge(startVertex, endVertex);
+
+    _pathVertices.clear();
+    _searchCnt = 0;
+    _errorCode = NO_ERROR;
+    _buildedPath.clear();
+}
+
+/**
+ * такт поиска
+ * @param state текущее состояние планировщика
+ * @return возвращает true, если планирование закончено
+ */
+bool PRMPathFinder::findTick(std::vector<double> &state) {
+    _searchCnt++;
+
+    std::vector<unsigned int> edges;
+    std::vector<unsigned int> vertices = _searchPath(edges);
+    if (vertices.empty()) {
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return true;
+    }
+    state = _getVertexState(vertices.at(vertices.size() - 2));
+
+    if (!_checkEdges(edges, vertices)) {
+        if (_showTrace)
+            infoMsg("PRMPathFinder: path with ", edges.size(), " edges is blocked, search again");
+        return false;
+    }
+
+    _pathVertices = vertices;
+    return true;
+}
+
+/**
+ * построение пути
+ */
+void PRMPathFinder::buildPath() {
+    if (!_buildedPath.empty()) {
+        _errorCode = NO_ERROR;
+        return;
+    }
+
+    if (_pathVertices.empty()) {
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return;
+    }
+
+    for (unsigned int vertex: _pathVertices)
+        _buildedPath.emplace_back(_getVertexState(vertex));
+
+    _pathLength = calculatePathLength(_buildedPath);
+    _errorCode = NO_ERROR;
+}
+
+/**
+ * добавить временное ребро запроса
+ * @param a первая вершина
+ * @param b вторая вершина
+ */
+void PRMPathFinder::_addQueryEdge(unsigned int a, unsigned int b) {
+    auto edge = (unsigned int) (_edgeStatuses.size() + _queryEdgeStatuses.size());
+    _queryEdges.push_back(a);
+    _queryEdges.push_back(b);
+    _queryEdgeStatuses.push_back(EDGE_UNKNOWN);
+    _queryAdjacency[a].push_back(edge);
+    _queryAdjacency[b].push_back(edge);
+}
+
+/**
+ * получить состояние вершины, в том числе начальной и конечной вершин запроса
+ * @param vertex индекс вершины
+ * @return состояние
+ */
+std::vector<double> PRMPathFinder::_getVertexState(unsigned int vertex) const {
+    if (vertex < _vertices.size())
+        return _vertices.getPoint(vertex);
+    return vertex == _vertices.size() ? _startState : _endState;
+}
+
+/**
+ * найти кратчайший путь по рёбрам, не отмеченным как недопустимые
+ * @param edges в этот вектор записываются рёбра пути: индекс ребра карты
+ * или индекс временного ребра, сдвинутый на кол-во рёбер карты
+ * @return вершины пути от начальной к конечной, пустой вектор, если пути нет
+ */
+std::vector<unsigned int> PRMPathFinder::_searchPath(std::vector<unsigned int> &edges) {
+    auto startVertex = (unsigned int) _vertices.size();
+    unsigned int endVertex = startVertex + 1;
+    unsigned long vertexCnt = _vertices.size() + 2;
+
+    std::vector<double> costs(vertexCnt, std::numeric_limits<double>::infinity());
+    std::vector<unsigned int> parents(vertexCnt, KDTree::NO_POINT);
+    std::vector<unsigned int> parentEdges(vertexCnt, KDTree::NO_POINT);
+    std::vector<char> closed(vertexCnt, false);
+
+    // A* с эвристикой - расстоянием до конечного состояния
+    typedef std::pair<double, unsigned int> QueueItem;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    costs[startVertex] = 0;
+    queue.emplace(getStateDistance(_startState, _endState), startVertex);
+
+    auto relax = [&](unsigned int vertex, const std::vector<double> &state, unsigned int neighbor, unsigned int edge) {
+        if (closed[neighbor] || _edgeStatus(edge) == EDGE_INVALID)
+            return;
+        std::vector<double> neighborState = _getVertexState(neighbor);
+        double cost = costs[vertex] + getStateDistance(state, neighborState);
+        if (cost < costs[neighbor]) {
+            costs[neighbor] = cost;
+            parents[neighbor] = vertex;
+            parentEdges[neighbor] = edge;
+            queue.emplace(cost + getStateDistance(neighborState, _endState), neighbor);
+        }
+    };
+
+    while (!queue.empty()) {
+        unsigned int vertex = queue.top().second;
+        queue.pop();
+        if (closed[vertex])
+            continue;
+        closed[vertex] = true;
+        if (vertex == endVertex)
+            break;
+
+        std::vector<double> state = _getVertexState(vertex);
+        if (vertex < _vertices.size())
+            for (unsigned int i = _adjacencyOffsets[vertex]; i < _adjacencyOffsets[vertex + 1]; i++)
+                relax(vertex, state, _adjacency[i].first, _adjacency[i].second);
+
+        auto it = _queryAdjacency.find(vertex);
+        if (it != _queryAdjacency.end())
+            for (unsigned int edge: it->second) {
+                unsigned long queryEdge = edge - _edgeStatuses.size();
+                unsigned int a = _queryEdges[queryEdge * 2];
+                relax(vertex, state, a == vertex ? _queryEdges[queryEdge * 2 + 1] : a, edge);
+            }
+    }
+
+    edges.clear();
+    if (!closed[endVertex])
+        return {};
+
+    std::vector<unsigned int> vertices;
+    for (unsigned int vertex = endVertex; vertex != KDTree::NO_POINT; vertex = parents[vertex]) {
+        vertices.push_back(vertex);
+        if (parentEdges[vertex] != KDTree::NO_POINT)
+            edges.push_back(parentEdges[vertex]);
+    }
+    std::reverse(vertices.begin(), vertices.end());
+    std::reverse(edges.begin(), edges.end());
+    return vertices;
+}
+
+/**
+ * проверить непроверенные рёбра пути и сохранить результаты: сначала
+ * все рёбра одним пакетом проверяются с крупным шагом, и только если ни одно
+ * из них не оказалось недопустимым, - с шагом `_checkStep`
+ * @param edges рёбра
+ * @param vertices вершины пути, i-е ребро соединяет i-ю и (i+1)-ю вершины
+ * @return флаг, допустимы ли все рёбра
+ */
+bool PRMPathFinder::_checkEdges(const std::vector<unsigned int> &edges, const std::vector<unsigned int> &vertices) {
+    // большая часть путей по непроверенным рёбрам недопустима,
+    // а препятствие обычно находится уже при грубой проверке
+    if (!_checkEdgeStates(edges, vertices, _checkStep * COARSE_CHECK_FACTOR, false))
+        return false;
+    return _checkEdgeStates(edges, vertices, _checkStep, true);
+}
+
+/**
+ * проверить непроверенные рёбра пути одним пакетом
+ * @param edges рёбра
+ * @param vertices вершины пути, i-е ребро соединяет i-ю и (i+1)-ю вершины
+ * @param checkStep максимальное расстояние между проверяемыми точками ребра
+ * @param markValid флаг, нужно ли отмечать допустимые рёбра; недопустимые
+ * рёбра отмечаются всегда
+ * @return флаг, допустимы ли все рёбра
+ */
+bool PRMPathFinder::_checkEdgeStates(
+        const std::vector<unsigned int> &edges, const std::vector<unsigned int> &vertices,
+        double checkStep, bool markValid
+) {
+    // непроверенные рёбра и границы их точек в пакете
+    std::vector<unsigned int> uncheckedEdges;
+    std::vector<unsigned long> stateOffsets{0};
+    std::vector<double> states;
+    unsigned long dim = _scene->getJointCnt();
+    for (unsigned long i = 0; i < edges.size(); i++) {
+        if (_edgeStatus(edges[i]) != EDGE_UNKNOWN)
+            continue;
+        std::vector<double> a = _getVertexState(vertices[i]);
+        std::vector<double> b = _getVertexState(vertices[i + 1]);
+        int checkCnt = std::max(1, (int) std::ceil(getStateDistance(a, b) / checkStep));
+        divideSegment(a, b, checkCnt, states);
+        uncheckedEdges.push_back(edges[i]);
+        stateOffsets.push_back(states.size() / dim);
+    }
+
+    if (uncheckedEdges.empty())
+        return true;
+
+    std::vector<bool> enabled = checkStates(states, states.size() / dim);
+    bool valid = true;
+    for (unsigned long i = 0; i < uncheckedEdges.size(); i++) {
+        bool edgeValid = std::find(enabled.begin() + (long) stateOffsets[i],
+                                   enabled.begin() + (long) stateOffsets[i + 1], false) ==
+                         enabled.begin() + (long) stateOffsets[i + 1];
+        if (!edgeValid || markValid) {
+            _edgeStatus(uncheckedEdges[i]) = edgeValid ? EDGE_VALID : EDGE_INVALID;
+            // изменённые статусы рёбер карты сохраняются при удалении планировщика
+            if (uncheckedEdges[i] < _edgeStatuses.size())
+                _roadmapChanged = true;
+        }
+        valid = valid && edgeValid;
+    }
+    return valid;
+}
+
+/**
+ * получить кол-во рёбер дорожной карты с заданным статусом
+ * @param status статус ребра
+ * @return кол-во рёбер
+ */
+unsigned long PRMPathFinder::getEdgeCnt(char status) const {
+    return (unsigned long) std::count(_edgeStatuses.begin(), _edgeStatuses.end(), status);
+}
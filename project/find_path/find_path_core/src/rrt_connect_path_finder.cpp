@@ -0,0 +1,241 @@
+#include "rrt_connect_path_finder.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace bmpf;
+
+/**
+ * конструктор
+ * @param scene сцена
+ * @param showTrace флаг, нужно ли выводить информацию во время поиска пути
+ * @param stepSize максимальная длина ребра дерева
+ * @param checkStep максимальное расстояние между проверяемыми точками ребра
+ * @param maxNodeCnt максимальное кол-во вершин в обоих деревьях
+ * @param seed зерно генератора случайных чисел
+ * @param threadCnt количество потоков планировщика
+ */
+RRTConnectPathFinder::RRTConnectPathFinder(
+        const std::shared_ptr<bmpf::Scene> &scene, bool showTrace, double stepSize, double checkStep,
+        unsigned int maxNodeCnt, unsigned int seed, int threadCnt
+) : PathFinder(scene, showTrace, threadCnt),
+    _stepSize(stepSize), _checkStep(checkStep), _maxNodeCnt(maxNodeCnt), _seed(seed), _rng(seed) {
+    if (!(stepSize > 0) || !(checkStep > 0) || maxNodeCnt < 2) {
+        char buf[1024];
+        sprintf(buf,
+                "RRTConnectPathFinder::RRTConnectPathFinder() ERROR: \n step size is %f, check step is %f,"
+                " max node count is %u\nsteps must be positive, max node count must be >= 2",
+                stepSize, checkStep, maxNodeCnt
+        );
+        throw std::invalid_argument(buf);
+    }
+    _ready = true;
+}
+
+/**
+ * подготовка к планированию
+ * @param startState начальное состояние
+ * @param endState конечное состояние
+ */
+void RRTConnectPathFinder::prepare(const std::vector<double> &startState, const std::vector<double> &endState) {
+    if (_showTrace) {
+        infoMsg("RRTConnectPathFinder::prepare");
+        infoState("start state: ", startState);
+        infoState("end state: ", endState);
+    }
+
+    if (!checkState(startState))
+        throw std::runtime_error("RRTConnectPathFinder::prepare() ERROR: \n _startState is disabled");
+
+    if (!checkState(endState))
+        throw std::runtime_error("RRTConnectPathFinder::prepare() ERROR: \n _endState is disabled");
+
+    _startState = startState;
+    _endState = endState;
+
+    _rng.seed(_seed);
+    for (Tree &tree: _trees) {
+        tree.states.reset(_scene->getJointCnt());
+        tree.parents.clear();
+    }
+    _addNode(_trees[0], startState, KDTree::NO_POINT);
+    _addNode(_trees[1], endState, KDTree::NO_POINT);
+    _activeTree = 0;
+    _connectNodes[0] = KDTree::NO_POINT;
+    _connectNodes[1] = KDTree::NO_POINT;
+
+    _errorCode = NO_ERROR;
+    _buildedPath.clear();
+}
+
+/**
+ * такт поиска
+ * @param state текущее состояние планировщика
+ * @return возвращает true, если планирование закончено
+ */
+bool RRTConnectPathFinder::findTick(std::vector<double> &state) {
+    if (_isFull()) {
+        errMsg("RRT trees are full");
+        _errorCode = ERROR_REACHED_MAX_NODE_CNT;
+        return true;
+    }
+
+    Tree &tree = _trees[_activeTree];
+    Tree &otherTree = _trees[1 - _activeTree];
+
+    unsigned int newNode = _extend(tree, _getRandomState());
+    if (newNode != KDTree::NO_POINT) {
+        state = tree.states.getPoint(newNode);
+        unsigned int otherNode = _connect(otherTree, state);
+        if (otherNode != KDTree::NO_POINT) {
+            _connectNodes[_activeTree] = newNode;
+            _connectNodes[1 - _activeTree] = otherNode;
+            if (_showTrace)
+                infoMsg("trees are connected, node count: ", getNodeCnt());
+            return true;
+        }
+    }
+
+    _activeTree = 1 - _activeTree;
+    return false;
+}
+
+/**
+ * построение пути
+ */
+void RRTConnectPathFinder::buildPath() {
+    if (!_buildedPath.empty()) {
+        _errorCode = NO_ERROR;
+        return;
+    }
+
+    if (_connectNodes[0] == KDTree::NO_POINT) {
+        _errorCode = ERROR_CAN_NOT_FIND_PATH;
+        return;
+    }
+
+    // от вершины соединения к начальному состоянию, потом в обратном порядке
+    for (unsigned int node = _connectNodes[0]; node != KDTree::NO_POINT; node = _trees[0].parents[node])
+        _buildedPath.emplace_back(_trees[0].states.getPoint(node));
+    std::reverse(_buildedPath.begin(), _buildedPath.end());
+
+    // вершина соединения есть в обоих деревьях, во втором она пропускается
+    for (unsigned int node = _trees[1].parents[_connectNodes[1]];
+         node != KDTree::NO_POINT; node = _trees[1].parents[node])
+        _buildedPath.emplace_back(_trees[1].states.getPoint(node));
+
+    _pathLength = calculatePathLength(_buildedPath);
+    _errorCode = NO_ERROR;
+}
+
+/**
+ * получить случайное состояние в пределах допустимых углов
+ * (на коллизии не проверяется)
+ * @return случайное состояние
+ */
+std::vector<double> RRTConnectPathFinder::_getRandomState() {
+    std::vector<double> state;
+    for (const auto &jointParams: _scene->getJointParamsList())
+        state.push_back(std::uniform_real_distribution<double>(jointParams->minAngle, jointParams->maxAngle)(_rng));
+    return state;
+}
+
+/**
+ * получить состояние на отрезке от from к to на расстоянии не больше длины шага
+ * @param from начало отрезка
+ * @param to конец отрезка
+ * @param reached в эту переменную записывается флаг, совпадает ли результат с to
+ * @return состояние
+ */
+std::vector<double> RRTConnectPathFinder::_steer(
+        const std::vector<double> &from, const std::vector<double> &to, bool &reached
+) const {
+    double distance = getStateDistance(from, to);
+    reached = distance <= _stepSize;
+    if (reached)
+        return to;
+    return sumStates(from, mulState(subtractStates(to, from), _stepSize / distance));
+}
+
+/**
+ * проверить ребро на коллизии, начало ребра - вершина дерева,
+ * т.е. оно уже проверено
+ * @param from начало ребра
+ * @param to конец ребра
+ * @return флаг, является ли ребро безколлизионным
+ */
+bool RRTConnectPathFinder::_checkEdge(const std::vector<double> &from, const std::vector<double> &to) {
+    // большая часть отбрасываемых рёбер заканчивается в коллизии,
+    // поэтому сначала отдельно проверяется конец ребра
+    if (!checkState(to))
+        return false;
+
+    int checkCnt = std::max(1, (int) std::ceil(getStateDistance(from, to) / _checkStep));
+    if (checkCnt == 1)
+        return true;
+
+    // одним пакетом проверяются только промежуточные точки ребра
+    unsigned long jointCnt = _scene->getJointCnt();
+    std::vector<double> states;
+    divideSegment(from, to, checkCnt, states);
+    states.erase(states.end() - (long) jointCnt, states.end());
+    states.erase(states.begin(), states.begin() + (long) jointCnt);
+
+    std::vector<bool> enabled = checkStates(states, states.size() / jointCnt);
+    return std::find(enabled.begin(), enabled.end(), false) == enabled.end();
+}
+
+/**
+ * добавить вершину в дерево
+ * @param tree дерево
+ * @param state состояние
+ * @param parent индекс предка
+ * @return индекс вершины
+ */
+unsigned int RRTConnectPathFinder::_addNode(Tree &tree, const std::vector<double> &state, unsigned int parent) {
+    tree.parents.push_back(parent);
+    return tree.states.add(state);
+}
+
+/**
+ * сделать шаг дерева в сторону состояния
+ * @param tree дерево
+ * @param target состояние, в сторону которого растёт дерево
+ * @return индекс новой вершины или KDTree::NO_POINT, если шаг невозможен
+ */
+unsigned int RRTConnectPathFinder::_extend(Tree &tree, const std::vector<double> &target) {
+    unsigned int nearNode = tree.states.nearest(target);
+    std::vector<double> nearState = tree.states.getPoint(nearNode);
+
+    bool reached;
+    std::vector<double> newState = _steer(nearState, target, reached);
+    if (!_checkEdge(nearState, newState))
+        return KDTree::NO_POINT;
+    return _addNode(tree, newState, nearNode);
+}
+
+/**
+ * растить дерево в сторону состояния, пока оно не будет достигнуто
+ * @param tree дерево
+ * @param target состояние, в сторону которого растёт дерево
+ * @return индекс вершины, совпадающей с target, или KDTree::NO_POINT,
+ * если дерево упёрлось в препятствие
+ */
+unsigned int RRTConnectPathFinder::_connect(Tree &tree, const std::vector<double> &target) {
+    // ближайшей к цели вершиной на каждом следующем шаге
+    // будет вершина, добавленная на предыдущем
+    unsigned int node = tree.states.nearest(target);
+    std::vector<double> state = tree.states.getPoint(node);
+
+    while (!_isFull()) {
+        bool reached;
+        std::vector<double> newState = _steer(state, target, reached);
+        if (!_checkEdge(state, newState))
+            return KDTree::NO_POINT;
+        node = _addNode(tree, newState, node);
+        if (reached)
+            return node;
+        state = newState;
+    }
+    return KDTree::NO_POINT;
+}
@@ -0,0 +1,161 @@
+#include <scene.h>
+#include <log.h>
+#include "state.h"
+
+#include <base/path_finder.h>
+#include <batch_path_finder.h>
+#include <one_direction_path_finder.h>
+
+std::shared_ptr<bmpf::Scene> scene;
+
+std::shared_ptr<bmpf::BatchPathFinder> batchPathFinder;
+
+/**
+ * фабрика планировщиков рабочих потоков
+ * @param sceneWrapper сцена
+ * @return планировщик
+ */
+std::shared_ptr<bmpf::PathFinder> createPathFinder(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    return std::make_shared<bmpf::OneDirectionPathFinder>(sceneWrapper, false, 1000, 10, 3000, 5, 1);
+}
+
+/**
+ * получить список задач: пары из тестов планировщика по одной оси
+ * и обратные к ним
+ * @return список задач
+ */
+std::vector<std::pair<std::vector<double>, std::vector<double>>> getTasks() {
+    std::vector<std::pair<std::vector<double>, std::vector<double>>> tasks{
+            {
+                    {-2.372, -2.251, 1.977, 0.031, 1.885, 5.093, -2.043, -0.717, -0.893, 0.307, 0.687, -0.148, 0.723,
+                     0.667, -1.421, -2.498, 1.934, -4.705, -2.144, -2.477, 1.529, 0.919, 1.333, 2.003},
+                    {0.262, -3.238, 1.314, 2.603, -0.827, -3.604, -1.641, -0.440, 1.958, 1.606, 1.474, -4.645, -2.421,
+                     -0.583, 0.134, -0.834, 2.049, -4.375, -2.353, -2.529, 0.148, -0.707, 0.145, -2.702}
+            },
+            {
+                    {-1.696, 0.453, -1.582, -0.569, 0.827, -2.817, -2.769, 0.360, 1.462, 1.441, -1.827, 5.589, -2.054,
+                     -1.892, -0.302, -1.915, 1.601, 5.947, 1.238, -0.023, -0.341, 0.757, 0.534, 0.494},
+                    {0.759, -2.957, 0.393, 3.176, 0.857, -4.351, 0.192, -2.326, 0.592, -0.243, 0.344, -3.707, -0.772,
+                     -0.119, -1.855, -1.959, -1.745, -2.263, 1.309, -0.623, 0.860, -2.320, 1.961, 1.648}
+            },
+            {
+                    {0.424, -1.120, -0.451, 0.686, 1.911, 2.587, -2.711, -1.546, 0.809, 1.582, -0.477, 3.787, -1.726,
+                     -2.643, -0.098, -0.535, 0.694, -1.908, 2.335, -2.895, -0.173, -0.286, -1.405, -6.011},
+                    {0.953, -0.871, 1.649, 0.838, 0.009, -3.227, -2.690, -3.014, 1.621, -0.725, 0.753, 2.779, -2.377,
+                     -0.351, -1.328, 1.305, -0.134, 0.552, 0.072, -0.539, 1.322, 2.754, -1.700, -1.526}
+            },
+            {
+                    {2.383, -2.842, -1.350, 2.419, -0.023, 0.089, 0.914, -2.245, 1.017, 2.578, 0.177, -6.047, 0.975,
+                     0.217, -1.405, -1.892, -0.042, -4.390, 1.751, -2.111, 1.679, 0.971, 1.904, 0.275},
+                    {0.216, -0.043, 1.438, 0.904, 1.970, 0.048, -1.262, -0.689, -0.150, -2.305, 0.711, 0.922, -0.511,
+                     -1.067, -1.322, 2.551, 0.294, 5.391, -1.561, -0.489, 0.030, 0.495, 1.869, -3.930}
+            }
+    };
+
+    unsigned long taskCnt = tasks.size();
+    for (unsigned long i = 0; i < taskCnt; i++)
+        tasks.emplace_back(tasks[i].second, tasks[i].first);
+
+    return tasks;
+}
+
+void testBatch() {
+    bmpf::infoMsg("test batch");
+
+    std::vector<std::pair<std::vector<double>, std::vector<double>>> tasks = getTasks();
+    std::vector<bmpf::BatchPathFinder::QueryResult> results = batchPathFinder->findPaths(tasks);
+    assert(results.size() == tasks.size());
+
+    // результаты идут в порядке задач и совпадают с последовательным поиском
+    std::shared_ptr<bmpf::PathFinder> pathFinder = createPathFinder(batchPathFinder->getScene());
+    for (unsigned long i = 0; i < tasks.size(); i++) {
+        int errorCode = -1;
+        std::vector<std::vector<double>> path = pathFinder->findPath(tasks[i].first, tasks[i].second, errorCode);
+
+        assert(results[i].errorCode == errorCode);
+        assert(results[i].path == path);
+        assert(results[i].workerNum < batchPathFinder->getWorkerCnt());
+        assert(results[i].calculationTimeInSeconds >= 0);
+        if (errorCode != bmpf::PathFinder::NO_ERROR)
+            continue;
+
+        assert(bmpf::getStateDistance(tasks[i].first, results[i].path.front()) < 0.0001);
+        assert(bmpf::getStateDistance(tasks[i].second, results[i].path.back()) < 0.0001);
+        assert(pathFinder->simpleCheckPath(results[i].path, 100));
+    }
+
+    double sumTime = 0;
+    for (auto &result: results)
+        sumTime += result.calculationTimeInSeconds;
+
+    bmpf::infoMsg(tasks.size(), " tasks, ", batchPathFinder->getCalculationTimeInSeconds(), " seconds, ",
+                  sumTime, " seconds in sum");
+}
+
+/**
+ * задача с совпадающими стартовым и конечным состояниями бросает исключение
+ * в планировщике, оно не прерывает пакет, а превращается в код ошибки
+ */
+void testThrowingTask() {
+    bmpf::infoMsg("test throwing task");
+
+    std::vector<std::pair<std::vector<double>, std::vector<double>>> tasks = getTasks();
+    tasks.insert(tasks.begin() + 1, {tasks[0].first, tasks[0].first});
+    std::vector<bmpf::BatchPathFinder::QueryResult> results = batchPathFinder->findPaths(tasks);
+    assert(results.size() == tasks.size());
+
+    assert(results[1].errorCode == bmpf::PathFinder::ERROR_CAN_NOT_FIND_PATH);
+    assert(results[1].path.empty());
+    assert(results[1].workerNum < batchPathFinder->getWorkerCnt());
+
+    std::shared_ptr<bmpf::PathFinder> pathFinder = createPathFinder(batchPathFinder->getScene());
+    for (unsigned long i = 0; i < tasks.size(); i++) {
+        if (i == 1)
+            continue;
+        int errorCode = -1;
+        std::vector<std::vector<double>> path = pathFinder->findPath(tasks[i].first, tasks[i].second, errorCode);
+        assert(results[i].errorCode == errorCode);
+        assert(results[i].path == path);
+    }
+}
+
+/**
+ * состояние неверной размерности - ошибка вызывающего кода,
+ * пакет не запускается
+ */
+void testWrongStateSize() {
+    bmpf::infoMsg("test wrong state size");
+
+    std::vector<std::pair<std::vector<double>, std::vector<double>>> tasks = getTasks();
+    tasks.back().second.pop_back();
+    bool thrown = false;
+    try {
+        batchPathFinder->findPaths(tasks);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void testEmpty() {
+    bmpf::infoMsg("test empty");
+    assert(batchPathFinder->findPaths({}).empty());
+}
+
+int main() {
+    bmpf::infoMsg("test batch path finder");
+
+    std::shared_ptr<bmpf::Scene> sceneWrapper = std::make_shared<bmpf::Scene>();
+    sceneWrapper->loadFromFile("../../../../config/murdf/4robots.json");
+
+    batchPathFinder = std::make_shared<bmpf::BatchPathFinder>(sceneWrapper, createPathFinder, 4);
+    assert(batchPathFinder->getWorkerCnt() == 4);
+
+    testBatch();
+    testThrowingTask();
+    testWrongStateSize();
+    testEmpty();
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
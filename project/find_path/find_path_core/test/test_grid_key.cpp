@@ -0,0 +1,99 @@
+#include <cassert>
+#include <unordered_set>
+#include <log.h>
+#include <base/grid_key.h>
+
+/**
+ * проверка упаковки и распаковки координат
+ */
+void testEncodeDecode() {
+    bmpf::infoMsg("test encode decode");
+    bmpf::GridKeyCoder coder(6, 15);
+    // значения [-1, 16] кодируются пятью битами
+    assert(coder.getBitCnt() == 5);
+
+    std::vector<int> coords{-1, 0, 7, 14, 15, 3};
+    bmpf::GridKey key = coder.encode(coords);
+    for (unsigned long i = 0; i < coords.size(); i++)
+        assert(coder.getCoord(key, i) == coords.at(i));
+
+    std::vector<int> decoded;
+    coder.decode(key, decoded);
+    assert(decoded == coords);
+
+    bool thrown = false;
+    try {
+        coder.encode({0, 0, 0, 0, 16, 0});
+    } catch (std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+/**
+ * проверка отсутствия коллизий на сцене из четырёх роботов:
+ * свёртка sum(coords[i]*gridSize^i) для 24 сочленений переполняется
+ * и даёт одинаковые значения для разных координат
+ */
+void testMultiRobotKeys() {
+    bmpf::infoMsg("test multi robot keys");
+    const unsigned long dim = 24;
+    const int gridSize = 16;
+    bmpf::GridKeyCoder coder(dim, gridSize);
+
+    std::vector<int> a(dim, 0);
+    std::vector<int> b(dim, 0);
+    // 16^16 = 2^64, поэтому старшие координаты при свёртке теряются
+    b.at(16) = 1;
+    b.at(23) = 15;
+
+    unsigned long conv = 0;
+    unsigned long m = 1;
+    for (int coord: b) {
+        conv += m * coord;
+        m *= gridSize;
+    }
+    assert(conv == 0);
+
+    assert(coder.encode(a) != coder.encode(b));
+
+    // все соседи точки должны давать разные ключи
+    std::unordered_set<bmpf::GridKey, bmpf::GridKeyHash> keys;
+    std::vector<int> center(dim, gridSize / 2);
+    keys.insert(coder.encode(center));
+    for (unsigned long i = 0; i < dim; i++) {
+        for (int delta: {-1, 1}) {
+            std::vector<int> neighbor = center;
+            neighbor.at(i) += delta;
+            assert(keys.insert(coder.encode(neighbor)).second);
+        }
+    }
+    assert(keys.size() == 2 * dim + 1);
+}
+
+/**
+ * проверка ограничения размерности
+ */
+void testMaxDim() {
+    bmpf::infoMsg("test max dim");
+    assert(bmpf::GridKeyCoder::getMaxDim(15) == 48);
+
+    bool thrown = false;
+    try {
+        bmpf::GridKeyCoder(bmpf::GridKeyCoder::getMaxDim(1000) + 1, 1000);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main() {
+    bmpf::infoMsg("test grid key");
+
+    testEncodeDecode();
+    testMultiRobotKeys();
+    testMaxDim();
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
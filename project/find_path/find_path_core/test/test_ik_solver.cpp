@@ -0,0 +1,110 @@
+#include <scene.h>
+#include <log.h>
+#include "state.h"
+
+#include <ik_solver.h>
+#include <one_direction_path_finder.h>
+
+/**
+ * количество тестов
+ */
+const int TEST_CNT = 10;
+
+std::shared_ptr<bmpf::Scene> scene;
+
+std::shared_ptr<bmpf::IKSolver> ikSolver;
+
+std::shared_ptr<bmpf::GridPathFinder> pathFinder;
+
+/**
+ * проверить, что рабочие инструменты в состоянии находятся в целевых положениях
+ * @param state состояние
+ * @param targetPoses целевые матрицы преобразования рабочих инструментов
+ */
+void checkPoses(const std::vector<double> &state, const std::vector<Eigen::Matrix4d> &targetPoses) {
+    std::vector<Eigen::Matrix4d> poses = scene->getEndEffectorTransformMatrices(state);
+    assert(poses.size() == targetPoses.size());
+    for (unsigned long i = 0; i < poses.size(); i++) {
+        Eigen::Matrix<double, 6, 1> error = bmpf::IKSolver::getPoseError(poses[i], targetPoses[i]);
+        assert(error.head<3>().norm() < 1e-3);
+        assert(error.tail<3>().norm() < 1e-2);
+    }
+}
+
+/**
+ * поиск безколлизионных состояний по положениям, достижимым из случайных состояний
+ */
+void testSolve() {
+    bmpf::infoMsg("test solve");
+    for (int i = 0; i < TEST_CNT; i++) {
+        std::vector<Eigen::Matrix4d> targetPoses = scene->getEndEffectorTransformMatrices(pathFinder->getRandomState());
+
+        int errorCode = bmpf::IKSolver::NO_ERROR;
+        std::vector<double> state = ikSolver->solve(targetPoses, errorCode);
+        assert(errorCode == bmpf::IKSolver::NO_ERROR);
+        assert(state.size() == scene->getJointCnt());
+        assert(pathFinder->checkState(state));
+        checkPoses(state, targetPoses);
+
+        // тёплый старт из найденного решения сразу попадает в цель
+        std::vector<double> warmState = ikSolver->solve(targetPoses, errorCode);
+        assert(errorCode == bmpf::IKSolver::NO_ERROR);
+        assert(bmpf::getStateDistance(state, warmState) < 0.0001);
+    }
+}
+
+/**
+ * поиск пути к положениям рабочих инструментов
+ */
+void testFindPathToPoses() {
+    bmpf::infoMsg("test find path to poses");
+    std::vector<double> start = pathFinder->getRandomState();
+    std::vector<Eigen::Matrix4d> endPoses = scene->getEndEffectorTransformMatrices(pathFinder->getRandomState());
+
+    int errorCode = bmpf::PathFinder::NO_ERROR;
+    std::vector<std::vector<double>> path = pathFinder->findPathToPoses(start, endPoses, errorCode);
+    if (errorCode != bmpf::PathFinder::NO_ERROR)
+        bmpf::errMsg("error code:", errorCode);
+
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(!path.empty());
+    assert(bmpf::getStateDistance(start, path.front()) < 0.0001);
+    checkPoses(path.back(), endPoses);
+    assert(pathFinder->simpleCheckPath(path, 100));
+}
+
+/**
+ * сцены отдельных роботов, созданные по списку объектов,
+ * знают, какие из их объектов имеют сочленения
+ */
+void testSingleRobotScenes() {
+    bmpf::infoMsg("test single robot scenes");
+    for (auto &singleRobotScene: scene->getSingleRobotScenes()) {
+        std::vector<bool> areObjectsJointed = singleRobotScene->areObjectsJointed();
+        assert(areObjectsJointed.size() == singleRobotScene->getRobots().size());
+        for (unsigned long i = 0; i < areObjectsJointed.size(); i++)
+            assert(areObjectsJointed[i] == (singleRobotScene->getRobots().at(i)->getJointCnt() != 0));
+    }
+}
+
+int main() {
+    bmpf::infoMsg("test ik solver");
+
+    scene = std::make_shared<bmpf::Scene>();
+    scene->loadFromFile("../../../../config/murdf/4robots.json");
+
+    pathFinder = std::make_shared<bmpf::OneDirectionPathFinder>(
+            scene, false, 1000, 10, 3000, 5, 1
+    );
+
+    std::shared_ptr<bmpf::Collider> collider = std::make_shared<bmpf::SolidCollider>();
+    collider->init(scene->getGroupedModelPaths(), false);
+    collider->setAllowedCollisionMatrix(pathFinder->getAllowedCollisions());
+    ikSolver = std::make_shared<bmpf::IKSolver>(scene, collider, 4);
+
+    testSingleRobotScenes();
+    testSolve();
+    testFindPathToPoses();
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <scene.h>
+#include <log.h>
+#include "state.h"
+
+#include <cmath>
+
+#include <base/path_finder.h>
+#include <incremental_path_finder.h>
+
+std::shared_ptr<bmpf::Scene> scene;
+
+std::shared_ptr<bmpf::IncrementalPathFinder> pathFinder;
+
+/**
+ * проверить, что все точки пути свободны
+ * @param path путь
+ */
+void checkPathStates(const std::vector<std::vector<double>> &path) {
+    for (auto &state: path)
+        assert(pathFinder->checkState(state));
+}
+
+void testPath(std::vector<double> &start, std::vector<double> &end) {
+    bmpf::infoMsg("test begin");
+    int errorCode = -1;
+    std::vector<std::vector<double>> path = pathFinder->findPath(start, end, errorCode);
+
+    if (errorCode != bmpf::PathFinder::NO_ERROR)
+        bmpf::errMsg("error code:", errorCode);
+
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(!path.empty());
+    assert(bmpf::getStateDistance(start, path.front()) < 0.0001);
+    assert(bmpf::getStateDistance(end, path.back()) < 0.0001);
+    checkPathStates(path);
+
+    bmpf::infoMsg("path is valid");
+
+    double pathLength = pathFinder->getPathLength();
+    unsigned int expandCnt = pathFinder->getExpandCnt();
+
+    // граф поиска уже согласован, поэтому повторный запрос
+    // не раскрывает ни одной ячейки
+    int repeatErrorCode = -1;
+    assert(pathFinder->findPath(start, end, repeatErrorCode) == path);
+    assert(repeatErrorCode == bmpf::PathFinder::NO_ERROR);
+    assert(pathFinder->isGraphReused());
+    assert(pathFinder->getExpandCnt() == 0);
+
+    // сцена не менялась, поэтому перепроверка всего графа
+    // не меняет ни доступность ячеек, ни длину пути
+    std::vector<double> boxCoords{-100, -100, -100, 100, 100, 100};
+    pathFinder->updateRegion(boxCoords);
+    assert(pathFinder->getChangedCellCnt() == 0);
+    path = pathFinder->findPath(start, end, repeatErrorCode);
+    assert(repeatErrorCode == bmpf::PathFinder::NO_ERROR);
+    assert(pathFinder->isGraphReused());
+    assert(pathFinder->getChangedCellCnt() == 0);
+    assert(std::abs(pathFinder->getPathLength() - pathLength) < 0.0001);
+    checkPathStates(path);
+
+    // поиск с нуля находит путь той же длины
+    pathFinder->resetGraph();
+    path = pathFinder->findPath(start, end, repeatErrorCode);
+    assert(repeatErrorCode == bmpf::PathFinder::NO_ERROR);
+    assert(!pathFinder->isGraphReused());
+    assert(pathFinder->getExpandCnt() == expandCnt);
+    assert(std::abs(pathFinder->getPathLength() - pathLength) < 0.0001);
+
+    bmpf::infoMsg(expandCnt, " expanded cells, ", pathFinder->getCellCnt(), " cells, path length ", pathLength);
+    bmpf::infoMsg(pathFinder->getCalculationTimeInSeconds(), " seconds");
+}
+
+void test1() {
+    bmpf::infoMsg("test 1");
+    std::vector<double> start
+            {-2.967, -0.855, 0.314, -1.937, -1.676, -3.665};
+    std::vector<double> end
+            {1.187, -0.035, -1.131, 0.000, 0.419, 3.665};
+    testPath(start, end);
+}
+
+void test2() {
+    bmpf::infoMsg("test 2");
+    std::vector<double> start
+            {0.424, -1.120, -0.451, 0.686, 1.911, 2.587};
+    std::vector<double> end
+            {0.953, -0.871, 1.649, 0.838, 0.009, -3.227};
+    testPath(start, end);
+}
+
+void testMovedStart() {
+    bmpf::infoMsg("test moved start");
+    std::vector<double> start
+            {-1.344, -0.959, 0.970, -0.756, -1.359, -0.948};
+    std::vector<double> end
+            {0.026, -0.979, 1.400, -0.713, 0.068, 2.742};
+
+    int errorCode = -1;
+    std::vector<std::vector<double>> path = pathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(path.size() > 3);
+
+    // робот сдвинулся вдоль построенного пути: конечная точка прежняя,
+    // поэтому граф поиска переиспользуется
+    std::vector<double> movedStart = path[path.size() / 2];
+    std::vector<std::vector<double>> movedPath = pathFinder->findPath(movedStart, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(pathFinder->isGraphReused());
+    assert(bmpf::getStateDistance(movedStart, movedPath.front()) < 0.0001);
+    assert(bmpf::getStateDistance(end, movedPath.back()) < 0.0001);
+    checkPathStates(movedPath);
+
+    bmpf::infoMsg("moved start path is valid, ", pathFinder->getExpandCnt(), " expanded cells");
+}
+
+/**
+ * препятствие ставится на найденный путь: исправленный граф даёт путь
+ * в обход препятствия той же длины, что и поиск с нуля
+ * @param sceneWrapper сцена
+ */
+void testObstacle(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    bmpf::infoMsg("test obstacle");
+    std::vector<double> start
+            {-2.967, -0.855, 0.314, -1.937, -1.676, -3.665};
+    std::vector<double> end
+            {1.187, -0.035, -1.131, 0.000, 0.419, 3.665};
+
+    int errorCode = -1;
+    std::vector<std::vector<double>> path = pathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(path.size() > 2);
+    double pathLength = pathFinder->getPathLength();
+
+    // препятствие ставится в положение рабочего инструмента
+    // в середине пути, так что путь становится недопустимым
+    std::vector<double> blockedState = path[path.size() / 2];
+    std::vector<double> position = sceneWrapper->getEndEffectorPositions(blockedState);
+    std::vector<double> transformVector{position[0], position[1], position[2], 0, 0, 0, 1, 1, 1};
+    unsigned long objectNum = sceneWrapper->addObject("../../../../config/urdf/sphere.urdf", transformVector);
+    pathFinder->updateCollider();
+    assert(!pathFinder->checkState(blockedState));
+    // ячейки начальной и конечной точек остаются свободными,
+    // поэтому конечные координаты не меняются и граф переиспользуется
+    assert(pathFinder->checkState(path[1]));
+    assert(pathFinder->checkState(path[path.size() - 2]));
+
+    pathFinder->updateRegion(pathFinder->getObjectBoxCoords(objectNum), true, false);
+    assert(pathFinder->getAffectedCellCnt() > 0);
+
+    std::vector<std::vector<double>> repairedPath = pathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(pathFinder->isGraphReused());
+    assert(bmpf::getStateDistance(start, repairedPath.front()) < 0.0001);
+    assert(bmpf::getStateDistance(end, repairedPath.back()) < 0.0001);
+    checkPathStates(repairedPath);
+    double repairedLength = pathFinder->getPathLength();
+    unsigned int repairExpandCnt = pathFinder->getExpandCnt();
+
+    // поиск с нуля на изменённой сцене находит путь той же длины
+    pathFinder->resetGraph();
+    pathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(!pathFinder->isGraphReused());
+    assert(std::abs(pathFinder->getPathLength() - repairedLength) < 0.0001);
+    bmpf::infoMsg("repair: ", repairExpandCnt, " expanded cells, full search: ", pathFinder->getExpandCnt(),
+                  " expanded cells, path length ", pathLength, " -> ", repairedLength);
+
+    // после удаления препятствия граф снова даёт прежнюю длину пути
+    pathFinder->deleteObjectFromScene((long) objectNum);
+    std::vector<std::vector<double>> restoredPath = pathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(pathFinder->isGraphReused());
+    assert(std::abs(pathFinder->getPathLength() - pathLength) < 0.0001);
+    checkPathStates(restoredPath);
+}
+
+int main() {
+    bmpf::infoMsg("test incremental path finder");
+
+    std::shared_ptr<bmpf::Scene> sceneWrapper = std::make_shared<bmpf::Scene>();
+    sceneWrapper->loadFromFile("../../../../config/murdf/demo_scene.json");
+
+    pathFinder = std::make_shared<bmpf::IncrementalPathFinder>(
+            sceneWrapper, false, 20, 1000000, 1
+    );
+
+    test1();
+    test2();
+    testMovedStart();
+    testObstacle(sceneWrapper);
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
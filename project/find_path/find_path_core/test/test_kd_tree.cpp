@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <log.h>
+#include <base/kd_tree.h>
+
+/**
+ * найти ближайшую точку перебором
+ * @param points точки
+ * @param point точка, для которой ищется ближайшая
+ * @return индекс ближайшей точки
+ */
+unsigned int bruteForceNearest(const std::vector<std::vector<double>> &points, const std::vector<double> &point) {
+    unsigned int best = bmpf::KDTree::NO_POINT;
+    double bestSqrDistance = 0;
+    for (unsigned int i = 0; i < points.size(); i++) {
+        double sqrDistance = 0;
+        for (unsigned long j = 0; j < point.size(); j++)
+            sqrDistance += (points[i][j] - point[j]) * (points[i][j] - point[j]);
+        if (best == bmpf::KDTree::NO_POINT || sqrDistance < bestSqrDistance) {
+            best = i;
+            bestSqrDistance = sqrDistance;
+        }
+    }
+    return best;
+}
+
+/**
+ * проверка добавления точек
+ */
+void testAdd() {
+    bmpf::infoMsg("test add");
+    bmpf::KDTree tree(3);
+    assert(tree.empty());
+    assert(tree.nearest({0, 0, 0}) == bmpf::KDTree::NO_POINT);
+
+    assert(tree.add({1, 2, 3}) == 0);
+    assert(tree.add({-1, 2, 3}) == 1);
+    assert(tree.add({1, 2, 3}) == 2);
+    assert(tree.size() == 3);
+    assert(tree.getPoint(1) == std::vector<double>({-1, 2, 3}));
+
+    assert(tree.nearest({-0.9, 2, 3}) == 1);
+    // из совпадающих точек находится первая добавленная
+    assert(tree.nearest({1, 2, 3}) == 0);
+
+    bool thrown = false;
+    try {
+        tree.add({1, 2});
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    tree.reset(2);
+    assert(tree.empty());
+    assert(tree.getDim() == 2);
+    assert(tree.add({1, 2}) == 0);
+}
+
+/**
+ * сравнение поиска ближайшей точки с перебором
+ * @param dim размерность точек
+ * @param pointCnt кол-во точек
+ */
+void testNearest(unsigned long dim, unsigned int pointCnt) {
+    bmpf::infoMsg("test nearest: dim ", dim, ", point count ", pointCnt);
+    std::mt19937 rng(dim * 1000 + pointCnt);
+    std::uniform_real_distribution<double> distribution(-3.14, 3.14);
+
+    bmpf::KDTree tree(dim);
+    std::vector<std::vector<double>> points;
+    for (unsigned int i = 0; i < pointCnt; i++) {
+        std::vector<double> point;
+        for (unsigned long j = 0; j < dim; j++)
+            point.push_back(distribution(rng));
+        assert(tree.add(point) == i);
+        points.push_back(point);
+    }
+
+    for (unsigned int i = 0; i < 200; i++) {
+        std::vector<double> point;
+        for (unsigned long j = 0; j < dim; j++)
+            point.push_back(distribution(rng));
+        assert(tree.nearest(point) == bruteForceNearest(points, point));
+
+        // несколько ближайших точек совпадают с первыми точками,
+        // отсортированными по расстоянию
+        std::vector<std::pair<double, unsigned int>> sorted;
+        for (unsigned int j = 0; j < points.size(); j++) {
+            double sqrDistance = 0;
+            for (unsigned long k = 0; k < dim; k++)
+                sqrDistance += (points[j][k] - point[k]) * (points[j][k] - point[k]);
+            sorted.emplace_back(sqrDistance, j);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<unsigned int> nearest = tree.nearest(point, 10);
+        assert(nearest.size() == 10);
+        for (unsigned int j = 0; j < nearest.size(); j++)
+            assert(nearest[j] == sorted[j].second);
+    }
+    assert(tree.nearest(points.front(), pointCnt + 5).size() == pointCnt);
+}
+
+int main() {
+    bmpf::infoMsg("test kd tree");
+
+    testAdd();
+    testNearest(2, 1000);
+    testNearest(6, 2000);
+    testNearest(24, 2000);
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
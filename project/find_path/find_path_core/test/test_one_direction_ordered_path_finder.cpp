@@ -110,6 +110,29 @@ void test6() {
     testPath(start, end);
 }
 
+/**
+ * сцена из роботов с разным числом сочленений (6 и 7)
+ */
+void testMixedDof() {
+    bmpf::infoMsg("test mixed dof");
+
+    std::shared_ptr<bmpf::Scene> mixedScene = std::make_shared<bmpf::Scene>();
+    mixedScene->loadFromFile("../../../../config/murdf/mixed_dof.json");
+    assert(mixedScene->getJointCnt() == 13);
+
+    pathFinder = std::make_shared<bmpf::OneDirectionOrderedPathFinder>(
+            mixedScene, false, 1000, 10, 3000, 1, 1
+    );
+
+    // отклонения роботов различаются, поэтому роботы упорядочиваются при поиске
+    std::vector<double> start(13, 0);
+    std::vector<double> end(13, 0);
+    end[0] = 1.0;
+    end[6] = -0.5;
+    end[12] = 1.5;
+    testPath(start, end);
+}
+
 int main() {
     bmpf::infoMsg("test one direction ordered finder");
 
@@ -127,6 +150,8 @@ int main() {
     test5();
     test6();
 
+    testMixedDof();
+
     bmpf::infoMsg("complete");
     return 0;
 }
@@ -2,6 +2,8 @@
 #include <log.h>
 #include "state.h"
 
+#include <cmath>
+
 #include <base/path_finder.h>
 #include <one_direction_path_finder.h>
 
@@ -108,6 +110,88 @@ void test6() {
     testPath(start, end);
 }
 
+/**
+ * те же задачи в ленивом и обычном режимах: в ленивом режиме ноды
+ * проверяются на коллизии только при извлечении из открытого множества.
+ * Открытое множество не ограничено, поэтому доступные ноды извлекаются
+ * в том же порядке, и пути обоих режимов совпадают
+ */
+void testLazyCheck(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    bmpf::infoMsg("test lazy check");
+    std::shared_ptr<bmpf::OneDirectionPathFinder> eagerPathFinder = std::make_shared<bmpf::OneDirectionPathFinder>(
+            sceneWrapper, false, 0, 10, 3000, 5, 1
+    );
+    std::shared_ptr<bmpf::OneDirectionPathFinder> lazyPathFinder = std::make_shared<bmpf::OneDirectionPathFinder>(
+            sceneWrapper, false, 0, 10, 3000, 5, 1, 1, true
+    );
+
+    for (auto test: {test1, test2}) {
+        pathFinder = eagerPathFinder;
+        test();
+        pathFinder = lazyPathFinder;
+        test();
+
+        assert(lazyPathFinder->getBuildedGridPath() == eagerPathFinder->getBuildedGridPath());
+        assert(std::abs(lazyPathFinder->getPathLength() - eagerPathFinder->getPathLength()) < 0.0001);
+        assert(lazyPathFinder->getSavedCheckCnt() > 0);
+        assert(eagerPathFinder->getSavedCheckCnt() == 0);
+    }
+}
+
+/**
+ * матрица разрешённых столкновений строится только по требованию,
+ * воспроизводима и не разрешает пары звеньев разных объектов,
+ * если хотя бы один из них - робот с сочленениями
+ */
+void testAllowedCollisions(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    bmpf::infoMsg("test allowed collisions");
+    assert(pathFinder->getAllowedCollisions().getLinkCnt() == 0);
+
+    bmpf::AllowedCollisionMatrix allowedCollisions = pathFinder->buildAllowedCollisionMatrix(500);
+    assert(pathFinder->buildAllowedCollisionMatrix(500).getAllowedPairs() == allowedCollisions.getAllowedPairs());
+
+    // номер объекта каждого звена
+    std::vector<unsigned long> linkObjects;
+    for (unsigned long i = 0; i < sceneWrapper->getRobots().size(); i++)
+        for (unsigned long j = 0; j < sceneWrapper->getRobots().at(i)->getLinkCnt(); j++)
+            linkObjects.emplace_back(i);
+    assert(allowedCollisions.getLinkCnt() == linkObjects.size());
+
+    for (auto &pair: allowedCollisions.getAllowedPairs()) {
+        unsigned long first = linkObjects.at(pair.first);
+        unsigned long second = linkObjects.at(pair.second);
+        if (first != second)
+            assert(sceneWrapper->getRobots().at(first)->getJointCnt() == 0 &&
+                   sceneWrapper->getRobots().at(second)->getJointCnt() == 0);
+    }
+
+    pathFinder->initAllowedCollisions(500);
+    assert(pathFinder->getAllowedCollisions().getAllowedPairs() == allowedCollisions.getAllowedPairs());
+    test1();
+}
+
+/**
+ * ошибка, возникшая во время тактов поиска, возвращается вызывающему
+ */
+void testMaxNodeCnt(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    bmpf::infoMsg("test max node cnt");
+    std::shared_ptr<bmpf::OneDirectionPathFinder> smallPathFinder = std::make_shared<bmpf::OneDirectionPathFinder>(
+            sceneWrapper, false, 1000, 10, 10, 5, 1
+    );
+    std::vector<double> start
+            {-2.372, -2.251, 1.977, 0.031, 1.885, 5.093, -2.043, -0.717, -0.893, 0.307, 0.687, -0.148, 0.723, 0.667,
+             -1.421,
+             -2.498, 1.934, -4.705, -2.144, -2.477, 1.529, 0.919, 1.333, 2.003};
+    std::vector<double> end
+            {0.262, -3.238, 1.314, 2.603, -0.827, -3.604, -1.641, -0.440, 1.958, 1.606, 1.474, -4.645, -2.421, -0.583,
+             0.134, -0.834, 2.049, -4.375, -2.353, -2.529, 0.148, -0.707, 0.145, -2.702};
+
+    int errorCode = bmpf::PathFinder::NO_ERROR;
+    std::vector<std::vector<double>> path = smallPathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::ERROR_REACHED_MAX_NODE_CNT);
+    assert(path.empty());
+}
+
 int main() {
     bmpf::infoMsg("test one direction path finder");
 
@@ -125,6 +209,10 @@ int main() {
     test5();
     test6();
 
+    testLazyCheck(sceneWrapper);
+    testAllowedCollisions(sceneWrapper);
+    testMaxNodeCnt(sceneWrapper);
+
     bmpf::infoMsg("complete");
     return 0;
 }
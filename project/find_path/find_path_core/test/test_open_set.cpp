@@ -0,0 +1,167 @@
+#include <cassert>
+#include <log.h>
+#include <base/open_set.h>
+
+/**
+ * хранилище нод для тестов
+ */
+bmpf::PathNodeArena nodes;
+/**
+ * упаковщик координат для тестов
+ */
+bmpf::GridKeyCoder coder;
+
+/**
+ * сбросить хранилище и упаковщик
+ * @param dim размерность координат
+ */
+void reset(unsigned long dim) {
+    nodes.reset(dim);
+    coder = bmpf::GridKeyCoder(dim, 1000);
+}
+
+unsigned int makeNode(const std::vector<int> &coords, double sum) {
+    return nodes.add(coords, coder.encode(coords), bmpf::PathNodeArena::NO_NODE, sum);
+}
+
+bmpf::GridKey key(const std::vector<int> &coords) {
+    return coder.encode(coords);
+}
+
+/**
+ * проверка хранилища нод
+ */
+void testArena() {
+    bmpf::infoMsg("test arena");
+    reset(3);
+    unsigned int root = nodes.add({1, 2, 3}, key({1, 2, 3}), bmpf::PathNodeArena::NO_NODE, 10);
+    unsigned int child = nodes.add({1, 2, 4}, key({1, 2, 4}), root, 9);
+    unsigned int grandChild = nodes.add({1, 3, 4}, key({1, 3, 4}), child, 8);
+
+    assert(nodes.size() == 3);
+    assert(nodes.at(root).order == 0);
+    assert(nodes.at(grandChild).order == 2);
+    assert(nodes.at(grandChild).parent == child);
+    assert(nodes.at(child).parent == root);
+    assert(nodes.getCoords(child) == std::vector<int>({1, 2, 4}));
+    assert(nodes.coordsEqual(grandChild, {1, 3, 4}));
+    assert(!nodes.coordsEqual(grandChild, {1, 2, 4}));
+    assert(nodes.getKey(child) == key({1, 2, 4}));
+
+    // проход по предкам от последней ноды к первой
+    std::vector<unsigned int> path;
+    for (unsigned int node = grandChild; node != bmpf::PathNodeArena::NO_NODE; node = nodes.at(node).parent)
+        path.push_back(node);
+    assert(path == std::vector<unsigned int>({grandChild, child, root}));
+
+    bool thrown = false;
+    try {
+        nodes.add({1, 2}, bmpf::GridKey{}, root, 0);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    reset(2);
+    assert(nodes.size() == 0);
+    assert(makeNode({5, 5}, 0) == 0);
+}
+
+/**
+ * ноды с одинаковой метрикой не должны схлопываться
+ */
+void testEqualSums() {
+    bmpf::infoMsg("test equal sums");
+    reset(3);
+    bmpf::OpenSet openSet(nodes);
+    for (int i = 0; i < 10; i++)
+        assert(openSet.push(makeNode({i, 0, 0}, 5)));
+
+    assert(openSet.size() == 10);
+    // при равенстве метрик ноды извлекаются в порядке добавления
+    for (int i = 0; i < 10; i++) {
+        assert(nodes.getCoords(openSet.top()).at(0) == i);
+        openSet.pop();
+    }
+    assert(openSet.empty());
+}
+
+/**
+ * проверка упорядоченности, поиска и удаления по координатам
+ */
+void testOrder() {
+    bmpf::infoMsg("test order");
+    reset(2);
+    bmpf::OpenSet openSet(nodes);
+    std::vector<double> sums{7, 3, 9, 1, 4, 8, 2, 6, 5, 0};
+    for (int i = 0; i < sums.size(); i++)
+        openSet.push(makeNode({i, 1}, sums.at(i)));
+
+    assert(openSet.contains(key({3, 1})));
+    assert(!openSet.contains(key({3, 2})));
+    assert(nodes.at(openSet.find(key({2, 1}))).sum == 9);
+    assert(openSet.find(key({2, 2})) == bmpf::PathNodeArena::NO_NODE);
+
+    assert(openSet.erase(key({3, 1})));
+    assert(!openSet.erase(key({3, 1})));
+    assert(!openSet.contains(key({3, 1})));
+
+    double prev = -1;
+    while (!openSet.empty()) {
+        assert(nodes.at(openSet.top()).sum >= prev);
+        prev = nodes.at(openSet.top()).sum;
+        openSet.pop();
+    }
+}
+
+/**
+ * проверка уменьшения метрики
+ */
+void testDecreaseKey() {
+    bmpf::infoMsg("test decrease key");
+    reset(1);
+    bmpf::OpenSet openSet(nodes);
+    for (int i = 0; i < 100; i++)
+        openSet.push(makeNode({i}, 100 + i));
+
+    // худшая метрика не должна заменять лучшую
+    assert(!openSet.push(makeNode({50}, 200)));
+    assert(nodes.at(openSet.find(key({50}))).sum == 150);
+
+    unsigned int better = makeNode({50}, 1);
+    assert(openSet.push(better));
+    assert(openSet.size() == 100);
+    assert(openSet.top() == better);
+}
+
+/**
+ * проверка ограничения размера
+ */
+void testTruncate() {
+    bmpf::infoMsg("test truncate");
+    reset(1);
+    bmpf::OpenSet openSet(nodes);
+    for (int i = 0; i < 1000; i++) {
+        openSet.push(makeNode({i}, 1000 - i));
+        openSet.truncate(100);
+        assert(openSet.size() <= 100 + 100 / 8);
+    }
+    for (int i = 999; !openSet.empty(); i--) {
+        assert(nodes.getCoords(openSet.top()).at(0) == i);
+        assert(openSet.contains(key({i})));
+        openSet.pop();
+    }
+}
+
+int main() {
+    bmpf::infoMsg("test open set");
+
+    testArena();
+    testEqualSums();
+    testOrder();
+    testDecreaseKey();
+    testTruncate();
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
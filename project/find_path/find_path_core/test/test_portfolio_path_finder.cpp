@@ -0,0 +1,162 @@
+#include <scene.h>
+#include <log.h>
+#include "state.h"
+
+#include <base/path_finder.h>
+#include <portfolio_path_finder.h>
+#include <one_direction_path_finder.h>
+#include <one_direction_ordered_path_finder.h>
+#include <all_directions_path_finder.h>
+
+std::shared_ptr<bmpf::Scene> scene;
+
+std::shared_ptr<bmpf::PortfolioPathFinder> portfolioPathFinder;
+
+unsigned long raceCnt = 0;
+
+void testPath(std::vector<double> &start, std::vector<double> &end) {
+    bmpf::infoMsg("test begin");
+    int errorCode = -1;
+    std::vector<std::vector<double>> path = portfolioPathFinder->findPath(start, end, errorCode);
+    raceCnt++;
+
+    if (errorCode != bmpf::PathFinder::NO_ERROR)
+        bmpf::errMsg("error code:", errorCode);
+
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(!path.empty());
+    assert(bmpf::getStateDistance(start, path.front()) < 0.0001);
+    assert(bmpf::getStateDistance(end, path.back()) < 0.0001);
+
+    long winnerNum = portfolioPathFinder->getWinnerNum();
+    assert(winnerNum >= 0);
+    assert(portfolioPathFinder->getPathFinder(winnerNum)->simpleCheckPath(path, 100));
+    assert(portfolioPathFinder->getErrorCodes().at(winnerNum) == bmpf::PathFinder::NO_ERROR);
+
+    bmpf::infoMsg("path is valid");
+
+    // все алгоритмы участвуют в каждой гонке, в каждой гонке один победитель
+    unsigned long winCnt = 0;
+    for (unsigned long i = 0; i < portfolioPathFinder->getAlgorithmCnt(); i++) {
+        assert(portfolioPathFinder->getStat(i).raceCnt == raceCnt);
+        winCnt += portfolioPathFinder->getStat(i).winCnt;
+    }
+    assert(winCnt == raceCnt);
+
+    bmpf::infoMsg("winner ", portfolioPathFinder->getName(winnerNum), ", ",
+                  portfolioPathFinder->getCalculationTimeInSeconds(), " seconds");
+}
+
+void test1() {
+    bmpf::infoMsg("test 1");
+    std::vector<double> start
+            {-2.967, -0.855, 0.314, -1.937, -1.676, -3.665};
+    std::vector<double> end
+            {1.187, -0.035, -1.131, 0.000, 0.419, 3.665};
+    testPath(start, end);
+}
+
+void test2() {
+    bmpf::infoMsg("test 2");
+    std::vector<double> start
+            {-1.696, 0.453, -1.582, -0.569, 0.827, -2.817};
+    std::vector<double> end
+            {0.759, -2.957, 0.393, 3.176, 0.857, -4.351};
+    testPath(start, end);
+}
+
+void test3() {
+    bmpf::infoMsg("test 3");
+    std::vector<double> start
+            {0.424, -1.120, -0.451, 0.686, 1.911, 2.587};
+    std::vector<double> end
+            {0.953, -0.871, 1.649, 0.838, 0.009, -3.227};
+    testPath(start, end);
+}
+
+/**
+ * отменённый планировщик прерывает поиск до первого такта,
+ * проверяется победитель последней гонки на её же задаче
+ */
+void testCancel() {
+    bmpf::infoMsg("test cancel");
+    std::vector<double> start
+            {0.424, -1.120, -0.451, 0.686, 1.911, 2.587};
+    std::vector<double> end
+            {0.953, -0.871, 1.649, 0.838, 0.009, -3.227};
+
+    const std::shared_ptr<bmpf::PathFinder> &pathFinder =
+            portfolioPathFinder->getPathFinder(portfolioPathFinder->getWinnerNum());
+    pathFinder->cancel();
+    int errorCode = -1;
+    assert(pathFinder->findPath(start, end, errorCode).empty());
+    assert(errorCode == bmpf::PathFinder::ERROR_CANCELLED);
+
+    pathFinder->clearCancel();
+    assert(!pathFinder->findPath(start, end, errorCode).empty());
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+}
+
+/**
+ * статистика сохраняется в json и загружается в другой портфель,
+ * в гонке из одного участника участвует лучший по статистике алгоритм
+ */
+void testStats() {
+    bmpf::infoMsg("test stats");
+    std::vector<std::pair<std::string, std::shared_ptr<bmpf::PathFinder>>> pathFinders;
+    for (unsigned long i = 0; i < portfolioPathFinder->getAlgorithmCnt(); i++)
+        pathFinders.emplace_back(portfolioPathFinder->getName(i), portfolioPathFinder->getPathFinder(i));
+
+    bmpf::PortfolioPathFinder loadedPortfolio(pathFinders, 1);
+    loadedPortfolio.loadStatsFromJSON(portfolioPathFinder->getStatsJSON());
+    assert(loadedPortfolio.getRanking() == portfolioPathFinder->getRanking());
+    for (unsigned long i = 0; i < loadedPortfolio.getAlgorithmCnt(); i++) {
+        assert(loadedPortfolio.getStat(i).raceCnt == portfolioPathFinder->getStat(i).raceCnt);
+        assert(loadedPortfolio.getStat(i).winCnt == portfolioPathFinder->getStat(i).winCnt);
+    }
+
+    std::vector<double> start
+            {-1.696, 0.453, -1.582, -0.569, 0.827, -2.817};
+    std::vector<double> end
+            {0.759, -2.957, 0.393, 3.176, 0.857, -4.351};
+    unsigned long bestNum = loadedPortfolio.getRanking().front();
+    int errorCode = -1;
+    loadedPortfolio.findPath(start, end, errorCode);
+    assert(loadedPortfolio.getWinnerNum() == (errorCode == bmpf::PathFinder::NO_ERROR ? (long) bestNum : -1));
+    for (unsigned long i = 0; i < loadedPortfolio.getAlgorithmCnt(); i++)
+        assert(loadedPortfolio.getStat(i).raceCnt == raceCnt + (i == bestNum ? 1 : 0));
+
+    loadedPortfolio.resetStats();
+    assert(loadedPortfolio.getStat(bestNum).raceCnt == 0);
+}
+
+int main() {
+    bmpf::infoMsg("test portfolio path finder");
+
+    std::shared_ptr<bmpf::Scene> sceneWrapper = std::make_shared<bmpf::Scene>();
+    sceneWrapper->loadFromFile("../../../../config/murdf/demo_scene.json");
+
+    portfolioPathFinder = std::make_shared<bmpf::PortfolioPathFinder>(
+            std::vector<std::pair<std::string, std::shared_ptr<bmpf::PathFinder>>>{
+                    {"one_direction",         std::make_shared<bmpf::OneDirectionPathFinder>(
+                            sceneWrapper, false, 1000, 10, 3000, 5, 1
+                    )},
+                    {"ordered_one_direction", std::make_shared<bmpf::OneDirectionOrderedPathFinder>(
+                            sceneWrapper, false, 1000, 10, 3000, 5, 1
+                    )},
+                    {"all_directions",        std::make_shared<bmpf::AllDirectionsPathFinder>(
+                            sceneWrapper, false, 1000, 10, 3000, 5, 1
+                    )}
+            }
+    );
+    assert(portfolioPathFinder->getRaceCnt() == 3);
+
+    test1();
+    test2();
+    test3();
+    testCancel();
+    testStats();
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
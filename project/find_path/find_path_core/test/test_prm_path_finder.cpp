@@ -0,0 +1,230 @@
+#include <scene.h>
+#include <log.h>
+#include "state.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include <base/path_finder.h>
+#include <prm_path_finder.h>
+
+std::shared_ptr<bmpf::Scene> scene;
+
+std::shared_ptr<bmpf::PRMPathFinder> pathFinder;
+
+/**
+ * записать в последний байт файла карты, т.е. в статус последнего ребра,
+ * значение, которого нет среди статусов рёбер
+ * @param path путь к файлу карты
+ */
+void corruptLastEdgeStatus(const std::string &path) {
+    std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+    assert(fs);
+    fs.seekp(-1, std::ios::end);
+    fs.put((char) 7);
+    assert(fs);
+}
+
+/**
+ * проверить, что рёбра пути не задевают препятствий
+ * @param path путь
+ * @return флаг, допустим ли путь
+ */
+bool checkPathEdges(const std::vector<std::vector<double>> &path) {
+    for (unsigned long i = 1; i < path.size(); i++) {
+        double distance = bmpf::getStateDistance(path[i - 1], path[i]);
+        if (!pathFinder->divideCheckPathSegment(
+                path[i - 1], path[i], (int) std::ceil(distance / pathFinder->getCheckStep()) + 1
+        ))
+            return false;
+    }
+    return true;
+}
+
+void testPath(std::vector<double> &start, std::vector<double> &end) {
+    bmpf::infoMsg("test begin");
+    int errorCode = -1;
+    std::vector<std::vector<double>> path = pathFinder->findPath(start, end, errorCode);
+
+    if (errorCode != bmpf::PathFinder::NO_ERROR)
+        bmpf::errMsg("error code:", errorCode);
+
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(!path.empty());
+    assert(bmpf::getStateDistance(start, path.front()) < 0.0001);
+    assert(bmpf::getStateDistance(end, path.back()) < 0.0001);
+
+    // рёбра пути проверены с шагом не больше checkStep
+    assert(checkPathEdges(path));
+
+    bmpf::infoMsg("path is valid");
+
+    // рёбра уже проверены, поэтому повторный запрос решается за один такт
+    int repeatErrorCode = -1;
+    assert(pathFinder->findPath(start, end, repeatErrorCode) == path);
+    assert(repeatErrorCode == bmpf::PathFinder::NO_ERROR);
+    assert(pathFinder->getSearchCnt() == 1);
+
+    bmpf::infoMsg(pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_VALID), " valid edges, ",
+                  pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_INVALID), " invalid edges, path length ",
+                  pathFinder->getPathLength());
+    bmpf::infoMsg(pathFinder->getCalculationTimeInSeconds(), " seconds");
+}
+
+void test1() {
+    bmpf::infoMsg("test 1");
+    std::vector<double> start
+            {-2.372, -2.251, 1.977, 0.031, 1.885, 5.093, -2.043, -0.717, -0.893, 0.307, 0.687, -0.148, 0.723, 0.667,
+             -1.421,
+             -2.498, 1.934, -4.705, -2.144, -2.477, 1.529, 0.919, 1.333, 2.003};
+    std::vector<double> end
+            {0.262, -3.238, 1.314, 2.603, -0.827, -3.604, -1.641, -0.440, 1.958, 1.606, 1.474, -4.645, -2.421, -0.583,
+             0.134, -0.834, 2.049, -4.375, -2.353, -2.529, 0.148, -0.707, 0.145, -2.702};
+    testPath(start, end);
+}
+
+void test2() {
+    bmpf::infoMsg("test 2");
+
+    std::vector<double> start
+            {-1.696, 0.453, -1.582, -0.569, 0.827, -2.817, -2.769, 0.360, 1.462, 1.441, -1.827, 5.589, -2.054, -1.892,
+             -0.302, -1.915, 1.601, 5.947, 1.238, -0.023, -0.341, 0.757, 0.534, 0.494};
+    std::vector<double> end
+            {0.759, -2.957, 0.393, 3.176, 0.857, -4.351, 0.192, -2.326, 0.592, -0.243, 0.344, -3.707, -0.772, -0.119,
+             -1.855, -1.959, -1.745, -2.263, 1.309, -0.623, 0.860, -2.320, 1.961, 1.648};
+
+    testPath(start, end);
+}
+
+void testSnapshot(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    bmpf::infoMsg("test snapshot");
+
+    // карта с результатами проверок рёбер загружается без изменений
+    const std::string path = "test_prm_path_finder.prm.bin";
+    assert(pathFinder->saveRoadmap(path));
+
+    auto loadedPathFinder = std::make_shared<bmpf::PRMPathFinder>(sceneWrapper, false, 2000, 10, 0.05, 1);
+    assert(loadedPathFinder->loadRoadmap(path));
+    assert(loadedPathFinder->isRoadmapLoaded());
+    assert(loadedPathFinder->getVertexCnt() == pathFinder->getVertexCnt());
+    assert(loadedPathFinder->getEdgeCnt() == pathFinder->getEdgeCnt());
+    assert(loadedPathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_VALID) ==
+           pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_VALID));
+    assert(loadedPathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_INVALID) ==
+           pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_INVALID));
+
+    // карта, построенная с другими параметрами, не загружается
+    auto otherPathFinder = std::make_shared<bmpf::PRMPathFinder>(sceneWrapper, false, 2000, 5, 0.05, 1);
+    assert(!otherPathFinder->loadRoadmap(path));
+    assert(!otherPathFinder->isRoadmapLoaded());
+
+    // карта с недопустимым статусом ребра не загружается
+    corruptLastEdgeStatus(path);
+    assert(!otherPathFinder->loadRoadmap(path));
+
+    std::remove(path.c_str());
+    bmpf::infoMsg("snapshot is valid");
+}
+
+void testObstacle(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    bmpf::infoMsg("test obstacle");
+    std::vector<double> start
+            {-2.372, -2.251, 1.977, 0.031, 1.885, 5.093, -2.043, -0.717, -0.893, 0.307, 0.687, -0.148, 0.723, 0.667,
+             -1.421,
+             -2.498, 1.934, -4.705, -2.144, -2.477, 1.529, 0.919, 1.333, 2.003};
+    std::vector<double> end
+            {0.262, -3.238, 1.314, 2.603, -0.827, -3.604, -1.641, -0.440, 1.958, 1.606, 1.474, -4.645, -2.421, -0.583,
+             0.134, -0.834, 2.049, -4.375, -2.353, -2.529, 0.148, -0.707, 0.145, -2.702};
+
+    int errorCode = -1;
+    std::vector<std::vector<double>> path = pathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+
+    // у препятствия нет сочленений, поэтому карта не перестраивается,
+    // а результаты проверок допустимых рёбер сбрасываются
+    unsigned long vertexCnt = pathFinder->getVertexCnt();
+    unsigned long invalidEdgeCnt = pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_INVALID);
+    pathFinder->addObjectToScene("../../../../config/urdf/sphere.urdf");
+    assert(pathFinder->getVertexCnt() == vertexCnt);
+    assert(pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_VALID) == 0);
+    assert(pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_INVALID) >= invalidEdgeCnt);
+
+    // новый путь обходит препятствие
+    bool pathIsFree = checkPathEdges(path);
+    std::vector<std::vector<double>> obstaclePath = pathFinder->findPath(start, end, errorCode);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(bmpf::getStateDistance(start, obstaclePath.front()) < 0.0001);
+    assert(bmpf::getStateDistance(end, obstaclePath.back()) < 0.0001);
+    assert(checkPathEdges(obstaclePath));
+    assert(pathIsFree || obstaclePath != path);
+
+    // после удаления препятствия снова находится кратчайший путь
+    pathFinder->deleteObjectFromScene((long) sceneWrapper->getRobots().size() - 1);
+    assert(pathFinder->getVertexCnt() == vertexCnt);
+    assert(pathFinder->findPath(start, end, errorCode) == path);
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+
+    bmpf::infoMsg("obstacle path is valid, previous path is ", pathIsFree ? "free" : "blocked");
+}
+
+/**
+ * статусы рёбер, найденные запросами, сохраняются в файл сцены при удалении
+ * планировщика, а повреждённый файл не загружается, и карта строится заново
+ */
+void testRoadmapFile(const std::shared_ptr<bmpf::Scene> &sceneWrapper) {
+    bmpf::infoMsg("test roadmap file");
+    const std::string roadmapPath = bmpf::PRMPathFinder::getRoadmapPath(sceneWrapper->getScenePath());
+
+    // предыдущий планировщик сам перезаписал бы файл при удалении
+    pathFinder.reset();
+    std::remove(roadmapPath.c_str());
+
+    pathFinder = std::make_shared<bmpf::PRMPathFinder>(sceneWrapper, false, 2000, 10, 0.05, 1);
+    assert(!pathFinder->isRoadmapLoaded());
+    assert(pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_VALID) == 0);
+    test1();
+    unsigned long validEdgeCnt = pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_VALID);
+    unsigned long invalidEdgeCnt = pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_INVALID);
+    assert(validEdgeCnt > 0);
+    pathFinder.reset();
+
+    pathFinder = std::make_shared<bmpf::PRMPathFinder>(sceneWrapper, false, 2000, 10, 0.05, 1);
+    assert(pathFinder->isRoadmapLoaded());
+    assert(pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_VALID) == validEdgeCnt);
+    assert(pathFinder->getEdgeCnt(bmpf::PRMPathFinder::EDGE_INVALID) == invalidEdgeCnt);
+    unsigned long edgeCnt = pathFinder->getEdgeCnt();
+    pathFinder.reset();
+
+    corruptLastEdgeStatus(roadmapPath);
+    pathFinder = std::make_shared<bmpf::PRMPathFinder>(sceneWrapper, false, 2000, 10, 0.05, 1);
+    assert(!pathFinder->isRoadmapLoaded());
+    assert(pathFinder->getEdgeCnt() == edgeCnt);
+    test2();
+
+    bmpf::infoMsg("roadmap file is valid");
+}
+
+int main() {
+    bmpf::infoMsg("test prm path finder");
+
+    std::shared_ptr<bmpf::Scene> sceneWrapper = std::make_shared<bmpf::Scene>();
+    sceneWrapper->loadFromFile("../../../../config/murdf/4robots.json");
+
+    // карту сцены строит только первый планировщик, второй загружает её
+    // из файла рядом с описанием сцены
+    std::remove(bmpf::PRMPathFinder::getRoadmapPath(sceneWrapper->getScenePath()).c_str());
+    pathFinder = std::make_shared<bmpf::PRMPathFinder>(sceneWrapper, false, 2000, 10, 0.05, 1);
+    assert(!pathFinder->isRoadmapLoaded());
+    pathFinder = std::make_shared<bmpf::PRMPathFinder>(sceneWrapper, false, 2000, 10, 0.05, 1);
+    assert(pathFinder->isRoadmapLoaded());
+
+    test1();
+    test2();
+    testSnapshot(sceneWrapper);
+    testObstacle(sceneWrapper);
+    testRoadmapFile(sceneWrapper);
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <scene.h>
+#include <log.h>
+#include "state.h"
+
+#include <cmath>
+
+#include <base/path_finder.h>
+#include <rrt_connect_path_finder.h>
+
+std::shared_ptr<bmpf::Scene> scene;
+
+std::shared_ptr<bmpf::RRTConnectPathFinder> pathFinder;
+
+void testPath(std::vector<double> &start, std::vector<double> &end) {
+    bmpf::infoMsg("test begin");
+    int errorCode = -1;
+    std::vector<std::vector<double>> path = pathFinder->findPath(start, end, errorCode);
+
+    if (errorCode != bmpf::PathFinder::NO_ERROR)
+        bmpf::errMsg("error code:", errorCode);
+
+    assert(errorCode == bmpf::PathFinder::NO_ERROR);
+    assert(!path.empty());
+    assert(bmpf::getStateDistance(start, path.front()) < 0.0001);
+    assert(bmpf::getStateDistance(end, path.back()) < 0.0001);
+
+    // рёбра не длиннее шага дерева и проверены с шагом не больше checkStep
+    for (unsigned long i = 1; i < path.size(); i++) {
+        double distance = bmpf::getStateDistance(path[i - 1], path[i]);
+        assert(distance <= pathFinder->getStepSize() + 0.0001);
+        assert(pathFinder->divideCheckPathSegment(
+                path[i - 1], path[i], (int) std::ceil(distance / pathFinder->getCheckStep()) + 1
+        ));
+    }
+
+    bmpf::infoMsg("path is valid");
+
+    // с тем же зерном находится тот же путь
+    int repeatErrorCode = -1;
+    assert(pathFinder->findPath(start, end, repeatErrorCode) == path);
+    assert(repeatErrorCode == bmpf::PathFinder::NO_ERROR);
+
+    bmpf::infoMsg(pathFinder->getNodeCnt(), " nodes, path length ", pathFinder->getPathLength());
+    bmpf::infoMsg(pathFinder->getCalculationTimeInSeconds(), " seconds");
+}
+
+void test1() {
+    bmpf::infoMsg("test 1");
+    std::vector<double> start
+            {-2.372, -2.251, 1.977, 0.031, 1.885, 5.093, -2.043, -0.717, -0.893, 0.307, 0.687, -0.148, 0.723, 0.667,
+             -1.421,
+             -2.498, 1.934, -4.705, -2.144, -2.477, 1.529, 0.919, 1.333, 2.003};
+    std::vector<double> end
+            {0.262, -3.238, 1.314, 2.603, -0.827, -3.604, -1.641, -0.440, 1.958, 1.606, 1.474, -4.645, -2.421, -0.583,
+             0.134, -0.834, 2.049, -4.375, -2.353, -2.529, 0.148, -0.707, 0.145, -2.702};
+    testPath(start, end);
+}
+
+void test2() {
+    bmpf::infoMsg("test 2");
+
+    std::vector<double> start
+            {-1.696, 0.453, -1.582, -0.569, 0.827, -2.817, -2.769, 0.360, 1.462, 1.441, -1.827, 5.589, -2.054, -1.892,
+             -0.302, -1.915, 1.601, 5.947, 1.238, -0.023, -0.341, 0.757, 0.534, 0.494};
+    std::vector<double> end
+            {0.759, -2.957, 0.393, 3.176, 0.857, -4.351, 0.192, -2.326, 0.592, -0.243, 0.344, -3.707, -0.772, -0.119,
+             -1.855, -1.959, -1.745, -2.263, 1.309, -0.623, 0.860, -2.320, 1.961, 1.648};
+
+    testPath(start, end);
+}
+
+int main() {
+    bmpf::infoMsg("test rrt connect path finder");
+
+    std::shared_ptr<bmpf::Scene> sceneWrapper = std::make_shared<bmpf::Scene>();
+    sceneWrapper->loadFromFile("../../../../config/murdf/4robots.json");
+
+    pathFinder = std::make_shared<bmpf::RRTConnectPathFinder>(sceneWrapper, false);
+
+    test1();
+    test2();
+
+    bmpf::infoMsg("complete");
+    return 0;
+}
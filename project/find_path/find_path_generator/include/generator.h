@@ -17,6 +17,9 @@
 #include "one_direction_ordered_path_finder.h"
 #include "state.h"
 #include "all_directions_path_finder.h"
+#include "rrt_connect_path_finder.h"
+#include "prm_path_finder.h"
+#include "incremental_path_finder.h"
 #include "base/path_finder.h"
 
 /**
@@ -27,6 +30,10 @@
  * смещается в первую очередь в сторону наибольшего отклонения
  * "multirobot" - режим с многими роботами
  * "continuous" - непрерывный планировщик
+ * "rrt_connect" - RRT-Connect, размер решётки не используется
+ * "prm" - ленивая вероятностная дорожная карта, сохраняется рядом с описанием сцены,
+ * размер решётки не используется
+ * "incremental" - D* Lite, граф поиска переиспользуется между запросами с той же целью
  */
 class Generator {
 public:
@@ -41,6 +41,18 @@ Generator::Generator(const std::string &scenePath, const std::vector<std::string
             _pathFinders.push_back(std::make_shared<ContinuousPathFinder>(
                     sceneWrapper, trace, 1000, gridSize, 5000, 0.01
             ));
+        else if (algorithm == "rrt_connect")
+            _pathFinders.push_back(std::make_shared<bmpf::RRTConnectPathFinder>(
+                    sceneWrapper, trace
+            ));
+        else if (algorithm == "prm")
+            _pathFinders.push_back(std::make_shared<bmpf::PRMPathFinder>(
+                    sceneWrapper, trace
+            ));
+        else if (algorithm == "incremental")
+            _pathFinders.push_back(std::make_shared<bmpf::IncrementalPathFinder>(
+                    sceneWrapper, trace, gridSize, 100000
+            ));
     }
 }
 
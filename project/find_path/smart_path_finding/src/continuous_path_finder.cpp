@@ -56,6 +56,7 @@ void ContinuousPathFinder::prepare(const std::vector<double> &startState, const
             _scene, _showTrace, _maxOpenSetSize, _gridSize,
             _maxNodeCnt, _threadCnt
     );
+    _globalPathFinder->setCancelFlag(_cancelFlag);
     _globalPathFinder->prepare(startState, endState);
 }
 
@@ -66,6 +67,11 @@ void ContinuousPathFinder::prepare(const std::vector<double> &startState, const
 void ContinuousPathFinder::buildPath() {
     _globalPathFinder->buildPath();
 
+    if (isCancelled()) {
+        _errorCode = ERROR_CANCELLED;
+        return;
+    }
+
     // собираем единый путь, длина итогового пути будет равна
     // самому длинному из единичных роботов, недостающие участки
     // достраиваются за счёт копирования последнего состояния
@@ -125,6 +131,7 @@ void ContinuousPathFinder::buildPath() {
                     _scene, _showTrace, _maxOpenSetSize, _gridSize,
                     _maxNodeCnt, _threadCnt
             );
+            _localPathFinder->setCancelFlag(_cancelFlag);
             errCode = NO_ERROR;
 
             localPath = _localPathFinder->checkTask(
@@ -142,6 +149,12 @@ void ContinuousPathFinder::buildPath() {
                 );
             }
 
+            // вложенные поиски отменяются вместе с этим планировщиком
+            if (isCancelled()) {
+                _errorCode = ERROR_CANCELLED;
+                return;
+            }
+
         } while (errCode != NO_ERROR);
 
         // добавляем все состояния пути до первого состояния с коллизией исключительно
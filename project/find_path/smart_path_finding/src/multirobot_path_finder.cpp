@@ -86,6 +86,7 @@ void MultiRobotPathFinder::prepare(const std::vector<double> &startState, const
             _scene, _showTrace, _maxOpenSetSize, _scaleGridSize,
             _maxNodeCnt, 1, 0, _threadCnt
     );
+    _scaleWholeScenePathFinder->setCancelFlag(_cancelFlag);
 }
 
 
@@ -238,6 +239,7 @@ void MultiRobotPathFinder::buildPath() {
                     _scene, _showTrace, _maxOpenSetSize, _gridSize,
                     _maxNodeCnt, 1, 0, _threadCnt
             );
+            _wholeScenePathFinder->setCancelFlag(_cancelFlag);
             errCode = NO_ERROR;
 
             if (collisionStartIndex == 1 || collisionEndIndex == notCheckedPath.size() - 2) {
@@ -250,11 +252,18 @@ void MultiRobotPathFinder::buildPath() {
                     if (errCode == NO_ERROR)
                         break;
 
+                    // вложенные поиски отменяются вместе с этим планировщиком
+                    if (isCancelled()) {
+                        _errorCode = ERROR_CANCELLED;
+                        return;
+                    }
+
                     _scaleGridSize = (int) ((_scaleGridSize) * 1.3);
                     _scaleWholeScenePathFinder = std::make_shared<bmpf::OneDirectionOrderedPathFinder>(
                             _scene, _showTrace, _maxOpenSetSize, _scaleGridSize,
                             _maxNodeCnt, 1, 0, _threadCnt
                     );
+                    _scaleWholeScenePathFinder->setCancelFlag(_cancelFlag);
                 } while (errCode != NO_ERROR);
             } else {
                 localPath = _wholeScenePathFinder->findGridPath(
@@ -264,6 +273,11 @@ void MultiRobotPathFinder::buildPath() {
                 );
             }
 
+            if (isCancelled()) {
+                _errorCode = ERROR_CANCELLED;
+                return;
+            }
+
 
             if (errCode == bmpf::GridPathFinder::ERROR_CAN_NOT_FIND_FREE_START_POINT) {
                 if (collisionStartIndex > 1) {
@@ -1,5 +1,7 @@
 #include "optimize_path_median.h"
 
+#include <algorithm>
+
 using namespace bmpf;
 
 /**
@@ -12,18 +14,23 @@ std::vector<std::vector<double>> MedianPathOptimizer::optimizePath(std::vector<s
 
     auto dividedPath = bmpf::PathFinder::splitPath(path, _divideCnt);
 
+    // без промежуточных проверок точки пути не сдвигаются
+    if (_checkCnt <= 0)
+        return dividedPath;
+
     for (int j = 0; j < _optimizeLoopCnt; j++) {
         for (int i = 1; i < dividedPath.size() - 1; i++) {
             auto middle = bmpf::sumStates(dividedPath.at(i - 1), bmpf::mulState(
                     bmpf::subtractStates(dividedPath.at(i + 1), dividedPath.at(i - 1)), 0.5));
 
-            if (_pf->checkState(middle)) {
-                if (_checkCnt > 0)
-                    if (_pf->divideCheckPathSegment(dividedPath.at(i - 1), middle, _checkCnt) &&
-                        _pf->divideCheckPathSegment(dividedPath.at(i + 1), middle, _checkCnt)) {
-                        dividedPath.at(i) = middle;
-                    }
-            }
+            // середина и оба отрезка до соседних точек проверяются одним пакетом
+            std::vector<double> states = middle;
+            bmpf::PathFinder::divideSegment(dividedPath.at(i - 1), middle, _checkCnt, states);
+            bmpf::PathFinder::divideSegment(dividedPath.at(i + 1), middle, _checkCnt, states);
+
+            std::vector<bool> enabled = _pf->checkStates(states, states.size() / middle.size());
+            if (std::find(enabled.begin(), enabled.end(), false) == enabled.end())
+                dividedPath.at(i) = middle;
         }
     }
 